@@ -4,21 +4,37 @@
 #include <stdlib.h>
 #include <math.h>
 #include <float.h>
+#include <pthread.h>
 
 #include "s21_matrix/s21_matrix.h"
+#include "s21_matrix/s21_fixed_matrices.h"
+#include "util/allocator.h"
+#include "util/jobs.h"
 #include "util/prettify_c.h"
 #include "util/cur_time.h"
 #include "util/common_vecs.h"
 #include "obj_parser/obj_parser.h"
+#include "obj_parser/mesh_export.h"
+#include "obj_parser/mesh_cache.h"
+#include "obj_parser/mesh_import.h"
+#include "obj_parser/glb.h"
+#include "util/block_reader.h"
+#include "util/block_stream.h"
 
 #define SIDEBAR_WIDTH 300
 #define SENSITIVITY 0.005
 #define M_PI 3.14159265359
 #define FOV 90.0
 #define EDIT_FLAGS NK_EDIT_SIMPLE | NK_EDIT_SELECTABLE | NK_EDIT_CLIPBOARD
+#define CATALOG_PATH "assets/catalog.bin"
+#define CATALOG_ROW_HEIGHT 20
 
 static Mesh create_tex_square_mesh();
+static FloatArray16 identity_placement();
 static void app_load_model(App* this, const char* filename);
+static void app_export_model(App* this, MeshExportFormat format);
+static AppCatalog app_catalog_create();
+static void app_catalog_free(AppCatalog* catalog);
 
 App* app_create(GLFWwindow* window) {
   debugln("Creating app...");
@@ -27,6 +43,7 @@ App* app_create(GLFWwindow* window) {
 
   str_t model_filename = str_literal("assets/teapot_normals.obj");
   AppSettings settings = app_settings_load("assets/settings.bin", &model_filename);
+  block_reader_set_default(settings.file_reader);
 
   (*result) = (App){
     .window = window,
@@ -37,8 +54,11 @@ App* app_create(GLFWwindow* window) {
     .model_filename = model_filename,
     .model_indices_count = 0,
     .model_vertices_count = 0,
+    .export_status = str_literal(""),
+    .catalog = app_catalog_create(),
 
     .settings = settings,
+    .transforms = {.is_built = false},
   };
 
   nk_textedit_init_default(&result->model_to_load);
@@ -61,6 +81,8 @@ void app_free(App* app) {
   app_input_free(app->input);
   nk_textedit_free(&app->model_to_load);
   str_free(app->model_filename);
+  str_free(app->export_status);
+  app_catalog_free(&app->catalog);
   app_settings_free(app->settings);
   free(app);
 }
@@ -96,12 +118,23 @@ AppSettings app_settings_create() {
 
     .solid_color_model = false,
     .model_color = {.r = 1.0, .g = 1.0, .b = 0.0, .a = 1.0},
+
+    .mesh_cache_mb = 512,
+    .mesh_cache_models = 8,
+    .mesh_cache_keeps_data = false,
+
+    .file_reader = BLOCK_READER_READ,
   };
 }
 AppResources app_resources_create() {
   return (AppResources) {
     //.model = ???
     .has_model = false,
+    .has_model_data = false,
+    .model_path = str_literal(""),
+    .model_placement = identity_placement(),
+    // app_draw_ui applies the limits from the settings
+    .recent_models = mesh_lru_create(0, 0, false),
 
     .tex_square = create_tex_square_mesh(),
 
@@ -128,8 +161,10 @@ void app_settings_free(AppSettings settings) {
 }
 
 void app_resources_free(AppResources resources) {
-  if (resources.has_model)
-    mesh_delete(resources.model);
+  if (resources.has_model) mesh_delete(resources.model);
+  if (resources.has_model_data) mesh_data_free(resources.model_data);
+  str_free(resources.model_path);
+  mesh_lru_free(&resources.recent_models);
   mesh_delete(resources.tex_square);
 
   gl_program_free(resources.shader);
@@ -166,10 +201,9 @@ static GLint glLoc(GLuint program, const char* name) {
 static FloatArray16 get_view_persp_matrix(double fov_deg, double aspect_ratio, Vec3 camera_pos, Vec3 camera_rot);
 static FloatArray16 get_view_proj_matrix(double size, double aspect_ratio, Vec3 camera_pos, Vec3 camera_rot);
 
-static void draw_object_textured(const matrix_t* transform, Mesh mesh, Texture tex, const GlProgram* program);
+static void draw_object_textured(const mat_float_4x4* transform, Mesh mesh, Texture tex, const GlProgram* program);
 
-static FloatArray16 app_calc_total_vp(const App* this, GLFWwindow* window);
-static FloatArray16 app_calc_skybox_vp(const App* this, GLFWwindow* window);
+static void app_update_transforms(App* this, int width, int height);
 
 static void app_draw_background(App* this, GLFWwindow* window);
 static void app_draw_skybox(App* this, GLFWwindow* window);
@@ -177,28 +211,27 @@ static void app_draw_model(App* this, GLFWwindow* window, const FloatArray16* ob
 static void app_draw_points(App* this, GLFWwindow* window, const FloatArray16* object);
 static void app_draw_floor(App* this, GLFWwindow* window);
 static void app_draw_ui(App* this, struct nk_context* ctx, GLFWwindow* window);
+static void app_draw_catalog(App* this, struct nk_context* ctx);
 
-static matrix_t get_object_transform(const App* this);
+static matrix_t get_object_transform(const AppSettings* settings);
 
 void app_render(App* this, struct nk_context* ctx, GLFWwindow* window) {
   int width, height;
   glfwGetFramebufferSize(window, &width, &height);
   if (width is 0 or height is 0) return;
 
-  matrix_t object_mat = get_object_transform(this);
-  FloatArray16 object = s21_matrix_to_farray(&object_mat);
-  s21_remove_matrix(&object_mat);
-
+  app_update_transforms(this, width, height);
+  const FloatArray16* object = &this->transforms.object;
 
   app_draw_background(this, window);
 
   if (this->settings.has_sky)    app_draw_skybox(this, window);
   if (this->resources.has_model and this->settings.show_model) 
-    app_draw_model(this, window, &object);
+    app_draw_model(this, window, object);
   if (this->settings.has_floor)  app_draw_floor(this, window);
 
   if (this->settings.vertices_draw_type is_not VERTICES_DRAW_NONE)
-    app_draw_points(this, window, &object);
+    app_draw_points(this, window, object);
 
   app_draw_ui(this, ctx, window);
 }
@@ -207,33 +240,96 @@ void app_render(App* this, struct nk_context* ctx, GLFWwindow* window) {
 
 
 
-static double get_aspect_ratio(GLFWwindow* window) {
-  int width, height;
-  glfwGetFramebufferSize(window, &width, &height);
-  return (double) width / (double) height;
+static bool vec3_eq(Vec3 a, Vec3 b) {
+  return a.x is b.x and a.y is b.y and a.z is b.z;
 }
 
-static FloatArray16 app_calc_total_vp(const App* this, GLFWwindow* window) {
-  double aspect_ratio = get_aspect_ratio(window);
-  FloatArray16 total_mvp_arr;
-  if (this->settings.is_perspective)
-    total_mvp_arr  = get_view_persp_matrix(FOV, aspect_ratio, this->settings.camera_pos, this->settings.camera_rot);
-  else
-    total_mvp_arr = get_view_proj_matrix(this->settings.projection_size, aspect_ratio, this->settings.camera_pos, this->settings.camera_rot);
-  
-  return total_mvp_arr;
+static matrix_t matrix_from_farray(const FloatArray16* array) {
+  matrix_t result;
+  assert_m(s21_create_matrix(4, 4, &result) is OK);
+  for (int row = 0; row < 4; row++)
+    for (int col = 0; col < 4; col++) result.matrix[row][col] = array->data[row * 4 + col];
+  return result;
 }
 
-static FloatArray16 app_calc_skybox_vp(const App* this, GLFWwindow* window) {
-  double aspect_ratio = get_aspect_ratio(window);
+// MeshData of every format is in display axes already
+static FloatArray16 identity_placement() {
+  matrix_t unit = s21_create_unit_matrix();
+  FloatArray16 result = s21_matrix_to_farray(&unit);
+  s21_remove_matrix(&unit);
+  return result;
+}
+
+static FloatArray16 calc_view_proj(const AppSettings* settings, double aspect_ratio) {
+  if (settings->is_perspective)
+    return get_view_persp_matrix(FOV, aspect_ratio, settings->camera_pos, settings->camera_rot);
+  else
+    return get_view_proj_matrix(settings->projection_size, aspect_ratio, settings->camera_pos, settings->camera_rot);
+}
 
-  FloatArray16 skybox_vp;
-  if (this->settings.is_perspective)
-    skybox_vp = get_view_persp_matrix(FOV, aspect_ratio, (Vec3){0,0,0}, this->settings.camera_rot);
+static FloatArray16 calc_skybox_view_proj(const AppSettings* settings, double aspect_ratio) {
+  if (settings->is_perspective)
+    return get_view_persp_matrix(FOV, aspect_ratio, (Vec3){0,0,0}, settings->camera_rot);
   else
-    skybox_vp = get_view_proj_matrix(0.25 - (0.25 / (1.0 + this->settings.projection_size)), aspect_ratio, (Vec3){0,0,0}, this->settings.camera_rot); 
+    return get_view_proj_matrix(0.25 - (0.25 / (1.0 + settings->projection_size)), aspect_ratio, (Vec3){0,0,0}, settings->camera_rot); 
+}
+
+// Compares the settings with the ones the matrices were built from and
+// rebuilds only what is out of date
+static void app_update_transforms(App* this, int width, int height) {
+  AppTransforms* t = &this->transforms;
+  const AppSettings* s = &this->settings;
+  t->frames++;
+
+  bool object_dirty = not t->is_built
+    or not vec3_eq(t->object_pos, s->object_pos)
+    or not vec3_eq(t->object_rot, s->object_rot)
+    or not vec3_eq(t->object_scale, s->object_scale)
+    or memcmp(&t->placement, &this->resources.model_placement, sizeof(t->placement)) is_not 0;
+  bool projection_dirty = not t->is_built
+    or t->width is_not width or t->height is_not height
+    or t->is_perspective is_not s->is_perspective
+    or t->projection_size is_not s->projection_size;
+  bool rotation_dirty = projection_dirty or not vec3_eq(t->camera_rot, s->camera_rot);
+  bool view_dirty = rotation_dirty or not vec3_eq(t->camera_pos, s->camera_pos);
+
+  if (object_dirty) {
+    // A model uploaded in file axes is placed first, then transformed
+    matrix_t object_mat = get_object_transform(s);
+    matrix_t placement = matrix_from_farray(&this->resources.model_placement);
+    matrix_t placed;
+    assert_m(s21_mult_matrix(&object_mat, &placement, &placed) is OK);
+    t->object = s21_matrix_to_farray(&placed);
+    s21_remove_matrix(&object_mat);
+    s21_remove_matrix(&placement);
+    s21_remove_matrix(&placed);
+
+    t->object_pos = s->object_pos;
+    t->object_rot = s->object_rot;
+    t->object_scale = s->object_scale;
+    t->placement = this->resources.model_placement;
+    t->object_rebuilds++;
+  }
 
-  return skybox_vp;
+  t->width = width;
+  t->height = height;
+  t->aspect_ratio = (double) width / (double) height;
+  t->is_perspective = s->is_perspective;
+  t->projection_size = s->projection_size;
+  t->camera_rot = s->camera_rot;
+  t->camera_pos = s->camera_pos;
+
+  // The skybox ignores camera position, so moving around keeps it
+  if (rotation_dirty) {
+    t->skybox_view_proj = calc_skybox_view_proj(s, t->aspect_ratio);
+    t->skybox_rebuilds++;
+  }
+  if (view_dirty) {
+    t->view_proj = calc_view_proj(s, t->aspect_ratio);
+    t->view_proj_rebuilds++;
+  }
+
+  t->is_built = true;
 }
 
 static void app_draw_background(App* this, GLFWwindow* window) {
@@ -248,24 +344,24 @@ static void app_draw_background(App* this, GLFWwindow* window) {
 }
 
 static void app_draw_skybox(App* this, GLFWwindow* window) {
-  FloatArray16 skybox_vp = app_calc_skybox_vp(this, window);
-  skybox_draw(&this->resources.sky, skybox_vp);
+  unused(window);
+  skybox_draw(&this->resources.sky, this->transforms.skybox_view_proj);
   glClear(GL_DEPTH_BUFFER_BIT);
 }
 
 
-static matrix_t get_object_transform(const App* this) {
-  matrix_t obj_shift = s21_create_shift_matrix       (this->settings.object_pos.x, this->settings.object_pos.y, this->settings.object_pos.z);
-  matrix_t obj_scale = s21_create_scale_matrix       (this->settings.object_scale.x, this->settings.object_scale.y, this->settings.object_scale.z);
-  matrix_t obj_rotation = s21_create_rotations_camera(this->settings.object_rot.x, this->settings.object_rot.y, this->settings.object_rot.z);
-  matrix_t object_temp1, object;
+static matrix_t get_object_transform(const AppSettings* settings) {
+  matrix_t obj_shift = s21_create_shift_matrix       (settings->object_pos.x, settings->object_pos.y, settings->object_pos.z);
+  matrix_t obj_scale = s21_create_scale_matrix       (settings->object_scale.x, settings->object_scale.y, settings->object_scale.z);
+  matrix_t obj_rotation = s21_create_rotations_camera(settings->object_rot.x, settings->object_rot.y, settings->object_rot.z);
+  matrix_t object;
 
-  assert_m(s21_mult_matrix(&obj_shift, &obj_rotation, &object_temp1) is OK); // shift(3) <- rotation(2)
-  assert_m(s21_mult_matrix(&object_temp1, &obj_scale, &object) is OK); // (shift(3) <- rotation(2)) <- scale(1)
+  // shift(3) <- rotation(2) <- scale(1)
+  matrix_t* chain[] = {&obj_shift, &obj_rotation, &obj_scale};
+  assert_m(s21_mult_chain(chain, LEN(chain), &object) is OK);
   s21_remove_matrix(&obj_shift);
   s21_remove_matrix(&obj_scale);
   s21_remove_matrix(&obj_rotation);
-  s21_remove_matrix(&object_temp1);
   
   return object;
 }
@@ -277,15 +373,16 @@ static void app_draw_model(App* this, GLFWwindow* window, const FloatArray16* ob
   glEnable(GL_DEPTH_TEST);
   glDepthFunc(GL_GEQUAL);
 
-  double aspect_ratio = get_aspect_ratio(window);
+  unused(window);
+  double aspect_ratio = this->transforms.aspect_ratio;
   GLuint prog = this->resources.shader.program;
-  FloatArray16 total_mvp_arr = app_calc_total_vp(this, window);
+  const FloatArray16* total_mvp_arr = &this->transforms.view_proj;
 
   glUseProgram(prog);
   glUniform1f(glLoc(prog, "u_aspect_ratio"), (float) aspect_ratio);
   glUniform1i(glLoc(prog, "is_stripple"), this->settings.dotted_lines ? 1 : 0); // uniform from sleepy
   glUniform1i(glLoc(prog, "u_is_solid_color"), this->settings.solid_color_model ? 1 : 0); // uniform from sleepy
-  glUniformMatrix4fv(glLoc(prog, "u_vp"), 1, GL_TRUE, total_mvp_arr.data);
+  glUniformMatrix4fv(glLoc(prog, "u_vp"), 1, GL_TRUE, total_mvp_arr->data);
   glUniformMatrix4fv(glLoc(prog, "u_object"), 1, GL_TRUE, object->data); 
   glUniform4f(
     glLoc(prog, "u_solid_color"), 
@@ -303,14 +400,15 @@ static void app_draw_model(App* this, GLFWwindow* window, const FloatArray16* ob
 
 
 static void app_draw_points(App* this, GLFWwindow* window, const FloatArray16* object) {
-  double aspect_ratio = get_aspect_ratio(window);
+  unused(window);
+  double aspect_ratio = this->transforms.aspect_ratio;
   GLuint prog = this->resources.shader_points.program;
-  FloatArray16 total_mvp_arr = app_calc_total_vp(this, window);
+  const FloatArray16* total_mvp_arr = &this->transforms.view_proj;
 
   glUseProgram(prog);
   glUniform1f(glLoc(prog, "u_aspect_ratio"), (float) aspect_ratio);
   glUniform1i(glLoc(prog, "u_is_circle"), this->settings.vertices_draw_type is VERTICES_DRAW_CIRCLE ? 1 : 0); // uniform from sleepy
-  glUniformMatrix4fv(glLoc(prog, "u_vp"), 1, GL_TRUE, total_mvp_arr.data);
+  glUniformMatrix4fv(glLoc(prog, "u_vp"), 1, GL_TRUE, total_mvp_arr->data);
   glUniform4f(
     glLoc(prog, "u_points_color"), 
     this->settings.vertices_color.r,  
@@ -329,15 +427,18 @@ static void app_draw_points(App* this, GLFWwindow* window, const FloatArray16* o
 
 
 static void app_draw_floor(App* this, GLFWwindow* window) {
-  FloatArray16 total_mvp_arr = app_calc_total_vp(this, window);
+  unused(window);
+  const FloatArray16* total_mvp_arr = &this->transforms.view_proj;
 
   glUseProgram(this->resources.shader_tex.program);
-  glUniformMatrix4fv(glLoc(this->resources.shader_tex.program, "u_vp"), 1, GL_TRUE, total_mvp_arr.data);
-  matrix_t floor = s21_create_scaleshift_matrix(1000.0, 1000.0, 1.0, 0.0, 0.0, -0.6);
+  glUniformMatrix4fv(glLoc(this->resources.shader_tex.program, "u_vp"), 1, GL_TRUE, total_mvp_arr->data);
+  mat_float_4x4 floor = mat_float_4x4_identity();
+  floor.m[0][0] = 1000.0f;
+  floor.m[1][1] = 1000.0f;
+  floor.m[2][3] = -0.6f;
 
   glUniform2f(glLoc(this->resources.shader_tex.program, "u_texture_scale"), 1000.0, 1000.0);
   draw_object_textured(&floor, this->resources.tex_square, this->resources.concrete, &this->resources.shader_tex);
-  s21_remove_matrix(&floor);
 }
 
 #define RGB_PICKER(ctx, label, short_name, ptr) \
@@ -354,6 +455,7 @@ static void app_draw_floor(App* this, GLFWwindow* window) {
 static void app_draw_ui(App* this, struct nk_context* ctx, GLFWwindow* window) {
   int height;
   glfwGetWindowSize(window, null, &height);
+  AllocTag old_tag = alloc_tag_set(ALLOC_TAG_UI);
 
   if (nk_begin(ctx, "Main window", nk_rect(0, 0, SIDEBAR_WIDTH, height), 0)) {
     // Sidebar
@@ -381,10 +483,64 @@ static void app_draw_ui(App* this, struct nk_context* ctx, GLFWwindow* window) {
       str_free(filename);
     }
 
-    str_t model_info = str_owned("Vertices: %d | Indices: %d", this->model_vertices_count, this->model_indices_count);
+    // How model files are read, the fastest depends on the disk they are on.
+    // One the system lacks falls back to read
+    nk_layout_row_dynamic(ctx, 30, BLOCK_READER_KINDS);
+    for (BlockReaderKind kind = 0; kind < BLOCK_READER_KINDS; kind++) {
+      if (nk_check_label(ctx, block_reader_name(kind), this->settings.file_reader is (int)kind))
+        this->settings.file_reader = kind;
+    }
+    block_reader_set_default(this->settings.file_reader);
+    nk_layout_row_dynamic(ctx, 30, 1);
+
+    // Labels live in the frame arena, so drawing the UI does not touch the heap
+    str_t model_info = str_frame("Vertices: %d | Indices: %d", this->model_vertices_count, this->model_indices_count);
     nk_label(ctx, model_info.string, NK_TEXT_ALIGN_LEFT);
-    str_free(model_info);
+
+    // Writes the model as it is placed now, next to the loaded file
+    if (this->resources.has_model) {
+      nk_layout_row_dynamic(ctx, 30, 3);
+      if (nk_button_label(ctx, "Export OBJ")) app_export_model(this, MESH_EXPORT_OBJ);
+      if (nk_button_label(ctx, "Export PLY")) app_export_model(this, MESH_EXPORT_PLY);
+      if (nk_button_label(ctx, "Export STL")) app_export_model(this, MESH_EXPORT_STL);
+      nk_layout_row_dynamic(ctx, 30, 1);
+      nk_label(ctx, this->export_status.string, NK_TEXT_ALIGN_LEFT);
+      str_t load_info = str_frame("Loaded in %.2f ms%s", this->model_load_secs * 1000,
+        this->is_model_from_cache ? " from the cache" : "");
+      nk_label(ctx, load_info.string, NK_TEXT_ALIGN_LEFT);
+    }
+
+    // Models switched away from stay on the GPU within these limits
+    MeshLru* recent = &this->resources.recent_models;
+    str_t cache_info = str_frame("Mesh cache: %d models, %.1f MB | hits %ld | misses %ld | evicted %ld",
+      recent->stats.count, recent->stats.bytes / 1e6, recent->stats.hits, recent->stats.misses, recent->stats.evictions);
+    nk_label(ctx, cache_info.string, NK_TEXT_ALIGN_LEFT);
+    nk_property_int(ctx, "Cache MB", 0, &this->settings.mesh_cache_mb, 65536, 64, 4);
+    nk_property_int(ctx, "Cached models", 0, &this->settings.mesh_cache_models, 256, 1, 0.2);
+    nk_checkbox_label(ctx, "Cache CPU copies", &this->settings.mesh_cache_keeps_data);
+    mesh_lru_set_limits(recent, (size_t)this->settings.mesh_cache_mb << 20,
+      this->settings.mesh_cache_models, this->settings.mesh_cache_keeps_data);
+
+    str_t rebuilds_info = str_frame("Rebuilds in %ld frames: object %ld | view %ld | sky %ld",
+      this->transforms.frames, this->transforms.object_rebuilds,
+      this->transforms.view_proj_rebuilds, this->transforms.skybox_rebuilds);
+    nk_label(ctx, rebuilds_info.string, NK_TEXT_ALIGN_LEFT);
+
+    JobStats jobs = jobs_stats();
+    str_t jobs_info = str_frame("Jobs: %ld on %d workers | steals %ld | idle %.1fs",
+      jobs.jobs, jobs.workers, jobs.steals, jobs.idle_secs);
+    nk_label(ctx, jobs_info.string, NK_TEXT_ALIGN_LEFT);
+
+#ifndef NDEBUG
+    str_t allocs_info = str_frame("Heap allocations last frame: %ld", my_allocator_frame_allocs());
+    nk_label(ctx, allocs_info.string, NK_TEXT_ALIGN_LEFT);
+#endif
 
+    nk_spacer(ctx);
+    nk_label(ctx, "Catalog", NK_TEXT_ALIGN_CENTERED);
+    app_draw_catalog(this, ctx);
+
+    nk_layout_row_dynamic(ctx, 30, 1);
     nk_spacer(ctx);
     nk_label(ctx, "View", NK_TEXT_ALIGN_CENTERED);
     
@@ -461,6 +617,7 @@ static void app_draw_ui(App* this, struct nk_context* ctx, GLFWwindow* window) {
   }
 
   nk_end(ctx);
+  alloc_tag_set(old_tag);
 }
 
 
@@ -540,12 +697,9 @@ void app_settings_save(const AppSettings* settings, const char* model_name, cons
 
 
 
-static void draw_object_textured(const matrix_t* transform, Mesh mesh, Texture tex, const GlProgram* program) {
-  // We need to transform matrix into 1D row-major array of floats to pass it into opengl
-  FloatArray16 array = s21_matrix_to_farray(transform);
-
+static void draw_object_textured(const mat_float_4x4* transform, Mesh mesh, Texture tex, const GlProgram* program) {
   // GL_TRUE means row-major. GL_FALSE would mean column-major
-  glUniformMatrix4fv(glLoc(program->program, "u_object"), 1, GL_TRUE, array.data);
+  glUniformMatrix4fv(glLoc(program->program, "u_object"), 1, GL_TRUE, mat_float_4x4_data(transform));
 
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, tex.texture_id);
@@ -555,58 +709,35 @@ static void draw_object_textured(const matrix_t* transform, Mesh mesh, Texture t
   mesh_draw(mesh);
 }
 
-static matrix_t get_camera_view_matrix(Vec3 camera_pos, Vec3 camera_rot) {
-  matrix_t camera_shift_mat = s21_create_shift_matrix(-camera_pos.x, -camera_pos.y, -camera_pos.z);
-  matrix_t camera_rot_mat = s21_create_rotations_camera(-camera_rot.y, -camera_rot.x, -camera_rot.z);
-
-  matrix_t camera;
-  // camera = camera_rot_mat * camera_shift_mat;
-  assert_m(s21_mult_matrix(&camera_rot_mat, &camera_shift_mat, &camera) is OK);
-  s21_remove_matrix(&camera_shift_mat);
-  s21_remove_matrix(&camera_rot_mat);
-
-  return camera;
-}
-
-static matrix_t mul_proj_by_view(matrix_t proj, matrix_t view) {
+// projection * view_to_camera * camera^-1, where camera^-1 = rotation * shift
+static FloatArray16 mul_proj_by_view(matrix_t projection, Vec3 camera_pos, Vec3 camera_rot) {
   matrix_t view_to_camera = s21_create_view_to_camera();
+  matrix_t camera_rot_mat = s21_create_rotations_camera(-camera_rot.y, -camera_rot.x, -camera_rot.z);
+  matrix_t camera_shift_mat = s21_create_shift_matrix(-camera_pos.x, -camera_pos.y, -camera_pos.z);
 
-  matrix_t temp_a;
-  // projection * view_to_camera * camera^-1
-  assert_m(s21_mult_matrix(&proj, &view_to_camera, &temp_a) is OK);
-  s21_remove_matrix(&proj);
+  matrix_t total;
+  matrix_t* chain[] = {&projection, &view_to_camera, &camera_rot_mat, &camera_shift_mat};
+  assert_m(s21_mult_chain(chain, LEN(chain), &total) is OK);
+  s21_remove_matrix(&projection);
   s21_remove_matrix(&view_to_camera);
+  s21_remove_matrix(&camera_rot_mat);
+  s21_remove_matrix(&camera_shift_mat);
 
-  matrix_t total_mvp;
-  assert_m(s21_mult_matrix(&temp_a, &view, &total_mvp) is OK);
-  s21_remove_matrix(&temp_a);
-  s21_remove_matrix(&view);
+  FloatArray16 total_mvp_arr = s21_matrix_to_farray(&total);
+  s21_remove_matrix(&total);
 
-  return total_mvp;
+  return total_mvp_arr;
 }
 
 static FloatArray16 get_view_persp_matrix(double fov_deg, double aspect_ratio, Vec3 camera_pos, Vec3 camera_rot) {
-  matrix_t camera = get_camera_view_matrix(camera_pos, camera_rot);
   matrix_t projection = s21_create_perspective_matrix(fov_deg * M_PI / 180.0, 0.1, 2000.0, aspect_ratio);
-  matrix_t total = mul_proj_by_view(projection, camera);
-
-  FloatArray16 total_mvp_arr = s21_matrix_to_farray(&total);
-  s21_remove_matrix(&total);
-
-  return total_mvp_arr;
+  return mul_proj_by_view(projection, camera_pos, camera_rot);
 }
 
 
 static FloatArray16 get_view_proj_matrix(double size, double aspect_ratio, Vec3 camera_pos, Vec3 camera_rot) {
-  matrix_t camera = get_camera_view_matrix(camera_pos, camera_rot);
-
   matrix_t projection = s21_create_projection_matrix(size, 0.1, 2000.0, aspect_ratio);
-  matrix_t total = mul_proj_by_view(projection, camera);
-
-  FloatArray16 total_mvp_arr = s21_matrix_to_farray(&total);
-  s21_remove_matrix(&total);
-
-  return total_mvp_arr;
+  return mul_proj_by_view(projection, camera_pos, camera_rot);
 }
 
 void app_on_scroll(App* this, double x, double y) {
@@ -698,7 +829,7 @@ void app_on_key_press(App* this, int key, int scancode, int action, int mods) {
 
 
 bool app_input_is_pressed(const AppInput* input, int keycode) {
-  if (input->are_keys_pressed.length <= keycode)
+  if (keycode < 0 or input->are_keys_pressed.length <= (size_t)keycode)
     return false;
   else
     return input->are_keys_pressed.data[keycode];
@@ -707,7 +838,10 @@ void app_input_on_key(AppInput* input, int keycode, int action) {
   if (not (action is GLFW_PRESS or action is GLFW_RELEASE))
     return;
 
-  while (input->are_keys_pressed.length < (keycode + 1))
+  if (keycode < 0)
+    return;
+
+  while (input->are_keys_pressed.length < (size_t)keycode + 1)
     vec_Bool_push(&input->are_keys_pressed, false);
 
   input->are_keys_pressed.data[keycode] = action is GLFW_PRESS ? true : false;
@@ -745,29 +879,295 @@ static Mesh create_tex_square_mesh() {
 #include "obj_parser/obj_mdl_to_mesh.h"
 
 
-static void app_load_model(App* this, const char* filename) {
-  FILE* file = fopen(filename, "r");
+// The format is told by the first bytes: caches from 3dviewer-convert and
+// binary PLY, STL and GLB skip text parsing, anything else is an OBJ, maybe
+// gzip or zstd compressed
+static bool app_read_model_data(const char* filename, MeshData* out) {
+  // Also false for an .obj.zst in a build without zstd
+  if (not block_stream_is_supported(filename)) return false;
 
-  if (file) {
-    fclose(file);
-    ObjModel mdl = obj_parse_model(filename);
+  switch (mesh_file_detect(filename)) {
+    case MESH_FILE_CACHE: return mesh_cache_read(filename, out);
+    case MESH_FILE_PLY: return mesh_import_ply(filename, out);
+    case MESH_FILE_STL: return mesh_import_stl(filename, out);
+    case MESH_FILE_GLB: return mesh_import_glb(filename, out);
+    case MESH_FILE_OBJ: break;
+  }
+  ObjModel mdl = obj_parse_model(filename);
+  debugln("Parsed model, gonna convert to mesh! It has %ld vertices and %ld faces", (long)mdl.vertices.length, (long)mdl.faces.length);
+  *out = obj_model_to_mesh_data(&mdl);
+  obj_model_free(mdl);
+  return true;
+}
+
+// A GLB laid out the way the shader reads it goes to the GPU straight from
+// the mapping and is drawn in its own axes, anything else through MeshData
+static bool app_upload_model(const char* filename, CachedMesh* out) {
+  GlbFile glb;
+  if (mesh_file_detect(filename) is MESH_FILE_GLB and glb_open(filename, &glb)) {
+    bool is_ready = glb_is_gpu_ready(&glb);
+    if (is_ready) {
+      *out = (CachedMesh) {
+        .mesh = mesh_from_glb(&glb),
+        .has_data = false,
+        .vertices_count = glb.primitives.data[0].positions.count,
+        .placement = glb_placement(&glb.primitives.data[0]),
+      };
+    }
+    glb_close(&glb);
+    if (is_ready) return true;
+  }
+
+  MeshData data;
+  if (not app_read_model_data(filename, &data)) return false;
+  *out = (CachedMesh) {
+    .mesh = mesh_from_data(&data),
+    .data = data,
+    .has_data = true,
+    .vertices_count = data.vertices.length / MESH_DATA_STRIDE,
+    .placement = identity_placement(),
+  };
+  return true;
+}
 
-    debugln("Parsed model, gonna convert to mesh! It has %d vertices and %d faces", mdl.vertices.length, mdl.faces.length);
-    Mesh mesh = obj_model_to_mesh(mdl);
+static void app_load_model(App* this, const char* filename) {
+  AppResources* resources = &this->resources;
+  double start = wall_time_secs();
+  CachedMesh model;
+  bool is_from_cache = mesh_lru_take(&resources->recent_models, filename, &model);
+  bool is_loaded = is_from_cache;
+
+  if (not is_loaded) {
+    FileInfo file;
+    if (file_info(filename, &file) and app_upload_model(filename, &model)) {
+      model.file = file;
+      is_loaded = true;
+    }
+  }
 
-    if (this->resources.has_model)
-      mesh_delete(this->resources.model);
-    this->resources.model = mesh;
-    this->model_vertices_count = mdl.vertices.length;
-    this->model_indices_count = mesh.indices_count;
+  if (is_loaded) {
+    // The model shown so far waits in the cache, switching back is instant
+    if (resources->has_model) {
+      mesh_lru_put(&resources->recent_models, resources->model_path.string, (CachedMesh) {
+        .mesh = resources->model,
+        .data = resources->model_data,
+        .has_data = resources->has_model_data,
+        .vertices_count = this->model_vertices_count,
+        .file = resources->model_file,
+        .placement = resources->model_placement,
+      });
+    }
+    resources->model = model.mesh;
+    resources->model_data = model.data;
+    resources->has_model_data = model.has_data;
+    resources->model_file = model.file;
+    resources->model_placement = model.placement;
+    str_free(resources->model_path);
+    resources->model_path = str_owned("%s", filename);
+    this->model_vertices_count = model.vertices_count;
+    this->model_indices_count = model.mesh.indices_count;
+    this->model_load_secs = wall_time_secs() - start;
+    this->is_model_from_cache = is_from_cache;
 
     str_t new_model_filename = str_owned("%s", filename);
     str_free(this->model_filename);
     this->model_filename = new_model_filename;
 
-    this->resources.has_model = true;
+    resources->has_model = true;
+    if (not is_from_cache) my_allocator_dump_short();
   } else {
     str_free(this->model_filename);
     this->model_filename = str_owned("Cannot open file '%s'", filename);
   }
-}
\ No newline at end of file
+}
+
+// A model the cache kept only on the GPU is read again, if its file has not
+// changed since it was shown
+static bool app_ensure_model_data(App* this) {
+  AppResources* resources = &this->resources;
+  if (resources->has_model_data) return true;
+
+  FileInfo now;
+  if (not file_info(resources->model_path.string, &now) or now.size is_not resources->model_file.size or
+      now.mtime_ns is_not resources->model_file.mtime_ns)
+    return false;
+  resources->has_model_data = app_read_model_data(resources->model_path.string, &resources->model_data);
+  return resources->has_model_data;
+}
+
+static void app_export_model(App* this, MeshExportFormat format) {
+  // "assets/cube.obj" -> "assets/cube_export.ply"
+  const char* filename = this->resources.model_path.string;
+  const char* extension = strrchr(filename, '.');
+  if (extension is null or strchr(extension, '/'))
+    extension = filename + strlen(filename);
+  str_t base = str_slice_to_owned((StrSlice) {.start = filename, .length = extension - filename});
+  str_t path = str_owned("%s_export.%s", base.string, mesh_export_extension(format));
+
+  matrix_t object = get_object_transform(&this->settings);
+  double start = wall_time_secs();
+  bool ok = app_ensure_model_data(this) and
+            mesh_export(&this->resources.model_data, &object, format, path.string);
+  double secs = wall_time_secs() - start;
+  s21_remove_matrix(&object);
+
+  str_free(this->export_status);
+  if (ok)
+    this->export_status = str_owned("Saved %s in %.2fs", path.string, secs);
+  else
+    this->export_status = str_owned("Cannot export to '%s'", path.string);
+  debugln("%s", this->export_status.string);
+
+  str_free(path);
+  str_free(base);
+}
+
+struct CatalogScan {
+  const Catalog* old;
+  str_t root;
+  Catalog result;
+  CatalogProgress progress;
+  // A thread of its own: a worker would be held for the whole scan, and with
+  // one CPU there are none to run it
+  pthread_t thread;
+  bool has_thread;
+  atomic_bool is_done;
+};
+
+static AppCatalog app_catalog_create() {
+  AppCatalog result = {
+    .matches = vec_int_create(),
+    .query = str_literal(""),
+    .scan = null,
+  };
+  if (not catalog_load(CATALOG_PATH, &result.catalog))
+    debugln("No catalog at %s, press Scan to make one", CATALOG_PATH);
+  catalog_search(&result.catalog, "", &result.matches);
+
+  nk_textedit_init_default(&result.root);
+  nk_textedit_text(&result.root, "assets", (int)strlen("assets"));
+  nk_textedit_init_default(&result.search);
+  return result;
+}
+
+static void app_catalog_free(AppCatalog* catalog) {
+  // The scan reads the old catalog, it has to finish first
+  if (catalog->scan) {
+    if (catalog->scan->has_thread) pthread_join(catalog->scan->thread, null);
+    catalog_free(catalog->scan->result);
+    str_free(catalog->scan->root);
+    free(catalog->scan);
+  }
+  catalog_free(catalog->catalog);
+  vec_int_free(catalog->matches);
+  str_free(catalog->query);
+  nk_textedit_free(&catalog->root);
+  nk_textedit_free(&catalog->search);
+}
+
+static void* catalog_scan_main(void* ctx) {
+  CatalogScan* scan = ctx;
+  scan->result = catalog_scan(scan->old, scan->root.string, &scan->progress);
+  atomic_store(&scan->is_done, true);
+  return null;
+}
+
+static void app_catalog_start_scan(AppCatalog* catalog) {
+  if (catalog->scan) return;
+  CatalogScan* scan = calloc(1, sizeof(CatalogScan));
+  assert_alloc(scan);
+  scan->old = &catalog->catalog;
+  scan->root = str_slice_to_owned((StrSlice) {
+    .start = nk_str_get_const(&catalog->root.string),
+    .length = nk_str_len(&catalog->root.string),
+  });
+  catalog->scan = scan;
+  // Without the thread the scan runs here, and the window waits for it
+  scan->has_thread = pthread_create(&scan->thread, null, catalog_scan_main, scan) is 0;
+  if (not scan->has_thread) catalog_scan_main(scan);
+}
+
+// Takes the result of a finished scan, called every frame
+static void app_catalog_poll(AppCatalog* catalog) {
+  CatalogScan* scan = catalog->scan;
+  if (scan is null or not atomic_load(&scan->is_done)) return;
+  if (scan->has_thread) pthread_join(scan->thread, null);
+
+  catalog_free(catalog->catalog);
+  catalog->catalog = scan->result;
+  if (not catalog_save(&catalog->catalog, CATALOG_PATH))
+    debugln("Cannot save the catalog to %s", CATALOG_PATH);
+  catalog_search(&catalog->catalog, catalog->query.string, &catalog->matches);
+  debugln("Catalog of %s: %ld models, %ld scanned", scan->root.string,
+    (long)catalog->catalog.entries.length, atomic_load(&scan->progress.scanned));
+
+  str_free(scan->root);
+  free(scan);
+  catalog->scan = null;
+}
+
+// Searches again only when the query was edited, the list is drawn from the
+// matches of the last search
+static void app_catalog_update_search(AppCatalog* catalog) {
+  StrSlice query = {
+    .start = nk_str_get_const(&catalog->search.string),
+    .length = nk_str_len(&catalog->search.string),
+  };
+  if (str_slice_eq(query, str_slice_from_str_t(&catalog->query))) return;
+
+  str_free(catalog->query);
+  catalog->query = str_slice_to_owned(query);
+  catalog_search(&catalog->catalog, catalog->query.string, &catalog->matches);
+}
+
+static void app_draw_catalog(App* this, struct nk_context* ctx) {
+  AppCatalog* catalog = &this->catalog;
+  app_catalog_poll(catalog);
+
+  nk_layout_row_dynamic(ctx, 30, 1);
+  nk_label(ctx, "Folder:", NK_TEXT_ALIGN_LEFT);
+  nk_edit_buffer(ctx, EDIT_FLAGS, &catalog->root, nk_filter_default);
+  if (catalog->scan) {
+    const CatalogProgress* progress = &catalog->scan->progress;
+    str_t scan_info = str_frame("Scanning: %ld of %ld files read, %ld found",
+      atomic_load(&progress->scanned), atomic_load(&progress->to_scan), atomic_load(&progress->found));
+    nk_label(ctx, scan_info.string, NK_TEXT_ALIGN_LEFT);
+  } else if (nk_button_label(ctx, "Scan")) {
+    app_catalog_start_scan(catalog);
+  }
+
+  nk_label(ctx, "Search:", NK_TEXT_ALIGN_LEFT);
+  nk_edit_buffer(ctx, EDIT_FLAGS, &catalog->search, nk_filter_default);
+  app_catalog_update_search(catalog);
+  str_t found_info = str_frame("%ld of %ld models",
+    (long)catalog->matches.length, (long)catalog->catalog.entries.length);
+  nk_label(ctx, found_info.string, NK_TEXT_ALIGN_LEFT);
+
+  // Only the visible rows are laid out, so the list costs the same with 100k
+  // entries as with ten
+  nk_layout_row_dynamic(ctx, 300, 1);
+  struct nk_list_view view;
+  if (nk_list_view_begin(ctx, &view, "Catalog", NK_WINDOW_BORDER, CATALOG_ROW_HEIGHT, (int)catalog->matches.length)) {
+    nk_layout_row_dynamic(ctx, CATALOG_ROW_HEIGHT, 1);
+    for (int i = view.begin; i < view.end; i++) {
+      const CatalogEntry* entry = &catalog->catalog.entries.data[catalog->matches.data[i]];
+      const char* path = catalog_path(&catalog->catalog, catalog->matches.data[i]);
+      const char* name = strrchr(path, '/');
+      name = name ? name + 1 : path;
+
+      if (nk_widget_is_hovered(ctx)) {
+        str_t tooltip = str_frame("%s | %.1f MB | %lu normals | min %.2f %.2f %.2f | max %.2f %.2f %.2f",
+          path, entry->size / 1e6, (unsigned long)entry->stats.normals_count,
+          entry->stats.min[0], entry->stats.min[1], entry->stats.min[2],
+          entry->stats.max[0], entry->stats.max[1], entry->stats.max[2]);
+        nk_tooltip(ctx, tooltip.string);
+      }
+      str_t row = str_frame("%s | %lu v | %lu f", name,
+        (unsigned long)entry->stats.vertices_count, (unsigned long)entry->stats.faces_count);
+      bool is_loaded = strcmp(path, this->model_filename.string) is 0;
+      if (nk_select_label(ctx, row.string, NK_TEXT_ALIGN_LEFT, is_loaded) and not is_loaded)
+        app_load_model(this, path);
+    }
+    nk_list_view_end(&view);
+  }
+}
@@ -10,6 +10,9 @@
 #include "ui/shader_loader.h"
 #include "ui/texture.h"
 #include "ui/skybox.h"
+#include "ui/mesh_lru.h"
+#include "obj_parser/mesh_data.h"
+#include "obj_parser/catalog.h"
 
 typedef struct Vec3 {
   double x, y, z;
@@ -42,11 +45,26 @@ typedef struct AppSettings {
 
   bool solid_color_model;
   struct nk_colorf model_color;
+
+  // Limits of AppResources.recent_models
+  int mesh_cache_mb, mesh_cache_models;
+  bool mesh_cache_keeps_data;
+
+  // BlockReaderKind models are read with
+  int file_reader;
 } AppSettings;
 
 typedef struct AppResources {
   Mesh model;
-  bool has_model;
+  // What model was uploaded from, kept for exporting. A model the cache kept
+  // only on the GPU has none until it is exported
+  MeshData model_data;
+  bool has_model, has_model_data;
+  str_t model_path;
+  FileInfo model_file;
+  FloatArray16 model_placement;  // see CachedMesh
+  // Models shown before this one
+  MeshLru recent_models;
 
   Mesh tex_square;
   GlProgram shader, shader_tex, shader_points;
@@ -54,12 +72,46 @@ typedef struct AppResources {
   Skybox sky;
 } AppResources;
 
+// Matrices derived from AppSettings and the framebuffer size. They are
+// computed once per frame by app_render and each one is rebuilt only when
+// the settings it depends on have changed since the last frame.
+typedef struct AppTransforms {
+  // Inputs of the last rebuild
+  bool is_built;
+  int width, height;
+  bool is_perspective;
+  double projection_size;
+  Vec3 object_pos, object_rot, object_scale;
+  Vec3 camera_pos, camera_rot;
+  FloatArray16 placement;
+
+  double aspect_ratio;
+  FloatArray16 object;
+  FloatArray16 view_proj;
+  FloatArray16 skybox_view_proj;
+
+  // How many times each matrix was rebuilt, shown in the sidebar
+  long frames;
+  long object_rebuilds, view_proj_rebuilds, skybox_rebuilds;
+} AppTransforms;
+
 typedef struct AppInput {
   double last_mouse_x, last_mouse_y;
   bool is_mouse_locked;
   vec_Bool are_keys_pressed;
 } AppInput;
 
+// A rescan running in the background, defined in app.c
+typedef struct CatalogScan CatalogScan;
+
+typedef struct AppCatalog {
+  Catalog catalog;
+  vec_int matches;  // entries shown, for query
+  str_t query;
+  struct nk_text_edit root, search;
+  CatalogScan* scan;  // null when no scan runs
+} AppCatalog;
+
 typedef struct App {
   GLFWwindow* window;
   AppResources resources;
@@ -71,8 +123,13 @@ typedef struct App {
   // Model stuff
   str_t model_filename;
   int model_vertices_count, model_indices_count;
+  double model_load_secs;
+  bool is_model_from_cache;
+  str_t export_status;
+  AppCatalog catalog;
 
   AppSettings settings;
+  AppTransforms transforms;
 } App;
 
 AppSettings app_settings_create();
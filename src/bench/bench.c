@@ -0,0 +1,97 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../s21_matrix/s21_simd.h"
+#include "../util/common_vecs.h"
+
+#define VECTOR_C BenchResult
+#include "../util/vector.h"
+
+// Wall clock, clock() would count CPU time of every thread
+double bench_now_secs() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const vec_double *sorted, int percent) {
+  int rank = (sorted->length * percent + 99) / 100;
+  return sorted->data[rank > 0 ? rank - 1 : 0];
+}
+
+BenchSuite bench_suite_create(const char *name) {
+  printf("%s\n%-28s %6s %12s %12s %12s\n", name, "case", "size", "min ns",
+         "median ns", "p95 ns");
+  return (BenchSuite){.name = name, .results = vec_BenchResult_create()};
+}
+
+void bench_suite_free(BenchSuite suite) {
+  vec_BenchResult_free(suite.results);
+}
+
+BenchResult bench_run(BenchSuite *suite, const char *name, int size,
+                      bench_fn_t fn, void *ctx) {
+  long warmup_calls = 0;
+  double start = bench_now_secs(), elapsed = 0.0;
+  while (elapsed < BENCH_WARMUP_SECS) {
+    fn(ctx);
+    warmup_calls++;
+    elapsed = bench_now_secs() - start;
+  }
+
+  long calls = (long)(warmup_calls * BENCH_SAMPLE_SECS / elapsed) + 1;
+  vec_double samples = vec_double_with_capacity(BENCH_SAMPLES);
+  for (int sample = 0; sample < BENCH_SAMPLES; sample++) {
+    start = bench_now_secs();
+    for (long i = 0; i < calls; i++) fn(ctx);
+    vec_double_push(&samples, (bench_now_secs() - start) / calls * 1e9);
+  }
+  qsort(samples.data, samples.length, sizeof(double), compare_doubles);
+
+  BenchResult result = {
+      .name = name,
+      .size = size,
+      .calls_per_sample = calls,
+      .min_ns = samples.data[0],
+      .median_ns = percentile(&samples, 50),
+      .p95_ns = percentile(&samples, 95),
+  };
+  vec_double_free(samples);
+
+  printf("%-28s %6d %12.1f %12.1f %12.1f\n", name, size, result.min_ns,
+         result.median_ns, result.p95_ns);
+  vec_BenchResult_push(&suite->results, result);
+  return result;
+}
+
+bool bench_write_json(const BenchSuite *suite, const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) return false;
+
+  fprintf(file, "{\n  \"suite\": \"%s\",\n", suite->name);
+  fprintf(file, "  \"compiler\": \"%s\",\n", __VERSION__);
+  fprintf(file, "  \"simd\": \"%s\",\n",
+          s21_simd_has_avx2() ? "avx2" : "scalar");
+  fprintf(file, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+  fprintf(file, "  \"samples\": %d,\n  \"results\": [\n", BENCH_SAMPLES);
+  for (size_t i = 0; i < suite->results.length; i++) {
+    const BenchResult *r = &suite->results.data[i];
+    fprintf(file,
+            "    {\"name\": \"%s\", \"size\": %d, \"calls_per_sample\": %ld, "
+            "\"min_ns\": %.3f, \"median_ns\": %.3f, \"p95_ns\": %.3f}%s\n",
+            r->name, r->size, r->calls_per_sample, r->min_ns, r->median_ns,
+            r->p95_ns, i + 1 < suite->results.length ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+
+  return fclose(file) == 0;
+}
@@ -0,0 +1,51 @@
+#ifndef SRC_BENCH_BENCH_H_
+#define SRC_BENCH_BENCH_H_
+
+/**
+ * Tiny harness for micro-benchmarks. Every case is warmed up, then timed in
+ * BENCH_SAMPLES samples of many calls each. Results are reported per call as
+ * min, median and 95th percentile, printed as a table and saved as JSON so
+ * that runs of two releases can be diffed.
+ */
+
+#include <stdbool.h>
+
+// Time spent calling the case before measuring, also used to find out how
+// many calls make up one sample
+#define BENCH_WARMUP_SECS 0.02
+// Each sample is at least this long, which hides the timer resolution
+#define BENCH_SAMPLE_SECS 0.002
+#define BENCH_SAMPLES 31
+
+typedef void (*bench_fn_t)(void *ctx);
+
+typedef struct BenchResult {
+  const char *name;  // not owned, usually a literal
+  int size;
+  long calls_per_sample;
+  double min_ns;
+  double median_ns;
+  double p95_ns;
+} BenchResult;
+
+#define VECTOR_H BenchResult
+#include "../util/vector.h"
+
+typedef struct BenchSuite {
+  const char *name;
+  vec_BenchResult results;
+} BenchSuite;
+
+BenchSuite bench_suite_create(const char *name);
+void bench_suite_free(BenchSuite suite);
+
+// Measures fn(ctx), prints a row of the table and keeps the result
+BenchResult bench_run(BenchSuite *suite, const char *name, int size,
+                      bench_fn_t fn, void *ctx);
+
+// Returns false if the file cannot be written
+bool bench_write_json(const BenchSuite *suite, const char *path);
+
+double bench_now_secs();
+
+#endif  // SRC_BENCH_BENCH_H_
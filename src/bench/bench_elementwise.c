@@ -0,0 +1,140 @@
+// Throughput of s21_sum_matrix, s21_sub_matrix, s21_mult_number and
+// s21_transpose at sizes that fit in L1, in L2 and only in DRAM. Every
+// operation is compared with the previous implementation, which walked the
+// row pointers element by element. Both sides allocate their result the same
+// way, so only the loops differ. JSON goes to the first argument,
+// bench_elementwise.json by default.
+
+#include <stdio.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../util/prettify_c.h"
+#include "bench.h"
+
+typedef int (*bench_op_t)(matrix_t *A, matrix_t *B, matrix_t *result);
+
+typedef struct OpCase {
+  bench_op_t op;
+  matrix_t *A;
+  matrix_t *B;
+} OpCase;
+
+static int legacy_add_sub(matrix_t *A, matrix_t *B, matrix_t *result,
+                          int operation) {
+  int ret_val = s21_create_matrix(A->rows, A->columns, result);
+  for (int i = 0; i < A->rows; i++)
+    for (int j = 0; j < A->columns; j++)
+      if (operation == 0)
+        result->matrix[i][j] = A->matrix[i][j] + B->matrix[i][j];
+      else
+        result->matrix[i][j] = A->matrix[i][j] - B->matrix[i][j];
+  return ret_val;
+}
+
+static int legacy_sum(matrix_t *A, matrix_t *B, matrix_t *result) {
+  return legacy_add_sub(A, B, result, 0);
+}
+
+static int legacy_sub(matrix_t *A, matrix_t *B, matrix_t *result) {
+  return legacy_add_sub(A, B, result, 1);
+}
+
+static int legacy_scale(matrix_t *A, matrix_t *B, matrix_t *result) {
+  (void)B;
+  int ret_val = s21_create_matrix(A->rows, A->columns, result);
+  for (int i = 0; i < A->rows; i++)
+    for (int j = 0; j < A->columns; j++)
+      result->matrix[i][j] = A->matrix[i][j] * 1.5;
+  return ret_val;
+}
+
+static int legacy_transpose(matrix_t *A, matrix_t *B, matrix_t *result) {
+  (void)B;
+  int ret_val = s21_create_matrix(A->columns, A->rows, result);
+  for (int i = 0; i < A->rows; i++)
+    for (int j = 0; j < A->columns; j++)
+      result->matrix[j][i] = A->matrix[i][j];
+  return ret_val;
+}
+
+static int new_scale(matrix_t *A, matrix_t *B, matrix_t *result) {
+  (void)B;
+  return s21_mult_number(A, 1.5, result);
+}
+
+static int new_transpose(matrix_t *A, matrix_t *B, matrix_t *result) {
+  (void)B;
+  return s21_transpose(A, result);
+}
+
+static void run_op(void *ctx) {
+  OpCase *c = ctx;
+  matrix_t result;
+  c->op(c->A, c->B, &result);
+  s21_remove_matrix(&result);
+}
+
+int main(int argc, char **argv) {
+  const char *json_path = argc > 1 ? argv[1] : "bench_elementwise.json";
+  BenchSuite suite = bench_suite_create("s21_elementwise");
+
+  struct {
+    const char *level;
+    int side;
+  } sizes[] = {
+      {"L1", 32},      // 3 x 8 KB
+      {"L2", 128},     // 3 x 128 KB
+      {"DRAM", 2048},  // 3 x 32 MB
+  };
+  struct {
+    const char *name;
+    const char *legacy_name;
+    bench_op_t legacy;
+    bench_op_t current;
+    int bytes_per_element;  // read + written
+  } ops[] = {
+      {"sum", "sum_legacy", legacy_sum, s21_sum_matrix, 24},
+      {"sub", "sub_legacy", legacy_sub, s21_sub_matrix, 24},
+      {"mult_number", "mult_number_legacy", legacy_scale, new_scale, 16},
+      {"transpose", "transpose_legacy", legacy_transpose, new_transpose, 16},
+  };
+
+  for (size_t s = 0; s < LEN(sizes); s++) {
+    matrix_t A, B;
+    s21_create_matrix(sizes[s].side, sizes[s].side, &A);
+    s21_create_matrix(sizes[s].side, sizes[s].side, &B);
+    for (int i = 0; i < A.rows; i++)
+      for (int j = 0; j < A.columns; j++) {
+        A.matrix[i][j] = i * 0.5 + j;
+        B.matrix[i][j] = i - j * 0.25;
+      }
+
+    double elements = (double)A.rows * A.columns;
+    for (size_t o = 0; o < LEN(ops); o++) {
+      OpCase legacy_case = {ops[o].legacy, &A, &B};
+      OpCase current_case = {ops[o].current, &A, &B};
+      BenchResult legacy = bench_run(&suite, ops[o].legacy_name, A.rows,
+                                     run_op, &legacy_case);
+      BenchResult current =
+          bench_run(&suite, ops[o].name, A.rows, run_op, &current_case);
+      printf("  %s %s: %.3f -> %.3f ns per element, %.2fx, %.2f GB/s\n",
+             sizes[s].level, ops[o].name, legacy.median_ns / elements,
+             current.median_ns / elements, legacy.median_ns / current.median_ns,
+             ops[o].bytes_per_element * elements / current.median_ns);
+    }
+
+    s21_remove_matrix(&A);
+    s21_remove_matrix(&B);
+  }
+
+  int ret_val = 0;
+  if (bench_write_json(&suite, json_path)) {
+    printf("Results saved to %s\n", json_path);
+  } else {
+    fprintf(stderr, "Failed to write %s\n", json_path);
+    ret_val = 1;
+  }
+
+  bench_suite_free(suite);
+  return ret_val;
+}
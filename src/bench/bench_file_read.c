@@ -0,0 +1,196 @@
+// Throughput of reading one file through every block_reader backend: read()
+// with posix_fadvise, mmap and io_uring. Each backend reads the file once
+// cold, right after its pages were dropped from the page cache, then
+// BENCH_FILE_READ_WARM_RUNS times warm, keeping the fastest. Every byte is
+// looked at (newlines are counted, as the parser would find them), so mmap
+// can not win by not touching the pages. How much of the file was still
+// cached before the cold run is printed too: the kernel drops only pages
+// nobody else holds, and some file systems keep them anyway.
+// Arguments: JSON path (bench_file_read.json), file to read (a generated
+// OBJ of BENCH_FILE_READ_GENERATED_MB without it).
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE  // mincore
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../util/block_reader.h"
+#include "../util/prettify_c.h"
+#include "bench.h"
+
+#define SCRATCH_PATH "bench_file_read.tmp"
+#define BENCH_FILE_READ_GENERATED_MB 256
+#define BENCH_FILE_READ_WARM_RUNS 3
+
+typedef struct ReadResult {
+  BlockReaderKind kind;
+  bool is_available;
+  double cached_before_cold;  // share of pages, -1 if unknown
+  double cold_secs, warm_secs;
+  long newlines;
+} ReadResult;
+
+static double file_mb(const char *path) {
+  struct stat info;
+  return stat(path, &info) is 0 ? info.st_size / (1024.0 * 1024.0) : 0;
+}
+
+static bool generate_file(const char *path, int mb) {
+  FILE *file = fopen(path, "wb");
+  if (file is null) return false;
+  srand(21);
+  long bytes = (long)mb << 20;
+  for (long line = 0; ftell(file) < bytes; line++) {
+    if (line % 2 is 0)
+      fprintf(file, "v %f %f %f\n", rand() / (float)RAND_MAX, rand() / (float)RAND_MAX,
+              rand() / (float)RAND_MAX);
+    else
+      fprintf(file, "f %ld %ld %ld\n", line / 2 + 1, line / 2 + 2, line / 2 + 3);
+  }
+  return fclose(file) is 0;
+}
+
+// Asks the kernel to forget the cached pages of path
+static void drop_cache(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return;
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+// Share of the pages of path in the page cache, -1 if it can not be told
+static double cached_share(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return -1;
+  struct stat info;
+  double share = -1;
+  if (fstat(fd, &info) is 0 and info.st_size > 0) {
+    void *map = mmap(null, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map is_not MAP_FAILED) {
+      long page = sysconf(_SC_PAGESIZE);
+      size_t pages = (info.st_size + page - 1) / page;
+      unsigned char *resident = malloc(pages);
+      if (resident and mincore(map, info.st_size, resident) is 0) {
+        size_t count = 0;
+        for (size_t i = 0; i < pages; i++) count += resident[i] & 1;
+        share = (double)count / pages;
+      }
+      free(resident);
+      munmap(map, info.st_size);
+    }
+  }
+  close(fd);
+  return share;
+}
+
+// Seconds to read the whole file, -1 if it failed
+static double read_file(const char *path, BlockReaderKind kind, long *newlines) {
+  double start = bench_now_secs();
+  BlockReader *reader = block_reader_open(path, kind);
+  if (reader is null) return -1;
+  const char *data;
+  size_t length;
+  *newlines = 0;
+  while (block_reader_next(reader, &data, &length)) {
+    for (const char *at = data, *end = data + length;
+         (at = memchr(at, '\n', end - at)); at++)
+      (*newlines)++;
+  }
+  bool failed = block_reader_failed(reader);
+  block_reader_close(reader);
+  return failed ? -1 : bench_now_secs() - start;
+}
+
+static ReadResult run_reader(const char *path, BlockReaderKind kind) {
+  ReadResult result = {.kind = kind, .cold_secs = -1, .warm_secs = -1};
+  result.is_available = block_reader_is_available(kind);
+  if (not result.is_available) return result;
+
+  drop_cache(path);
+  result.cached_before_cold = cached_share(path);
+  result.cold_secs = read_file(path, kind, &result.newlines);
+  for (int run = 0; run < BENCH_FILE_READ_WARM_RUNS; run++) {
+    double secs = read_file(path, kind, &result.newlines);
+    if (secs >= 0 and (result.warm_secs < 0 or secs < result.warm_secs)) result.warm_secs = secs;
+  }
+  return result;
+}
+
+// Times of -1 are reads that failed, null in the JSON
+static void write_json_number(FILE *file, const char *name, double value, bool is_valid) {
+  if (is_valid)
+    fprintf(file, ", \"%s\": %.4f", name, value);
+  else
+    fprintf(file, ", \"%s\": null", name);
+}
+
+static bool write_json(const ReadResult *results, int count, const char *path,
+                       const char *file_path, double mb) {
+  FILE *file = fopen(path, "w");
+  if (file is null) return false;
+
+  fprintf(file, "{\n  \"suite\": \"file_read\",\n");
+  fprintf(file, "  \"compiler\": \"%s\",\n  \"file\": \"%s\",\n  \"mb\": %.2f,\n",
+          __VERSION__, file_path, mb);
+  fprintf(file, "  \"results\": [\n");
+  for (int i = 0; i < count; i++) {
+    const ReadResult *r = &results[i];
+    fprintf(file, "    {\"reader\": \"%s\", \"available\": %s", block_reader_name(r->kind),
+            r->is_available ? "true" : "false");
+    if (r->is_available) {
+      fprintf(file, ", \"cached_before_cold\": %.3f", r->cached_before_cold);
+      write_json_number(file, "cold_secs", r->cold_secs, r->cold_secs >= 0);
+      write_json_number(file, "warm_secs", r->warm_secs, r->warm_secs >= 0);
+      write_json_number(file, "cold_mb_per_sec", mb / r->cold_secs, r->cold_secs > 0);
+      write_json_number(file, "warm_mb_per_sec", mb / r->warm_secs, r->warm_secs > 0);
+    }
+    fprintf(file, "}%s\n", i + 1 < count ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+
+  return fclose(file) is 0;
+}
+
+int main(int argc, char **argv) {
+  const char *json_path = argc > 1 ? argv[1] : "bench_file_read.json";
+  const char *path = argc > 2 ? argv[2] : SCRATCH_PATH;
+  bool is_generated = argc <= 2;
+  if (is_generated and not generate_file(path, BENCH_FILE_READ_GENERATED_MB)) {
+    fprintf(stderr, "Failed to write %s\n", path);
+    return 1;
+  }
+  double mb = file_mb(path);
+
+  printf("file_read, %s, %.1f MB\n%-10s %8s %10s %10s %10s %10s\n", path, mb, "reader",
+         "cached", "cold s", "cold MB/s", "warm s", "warm MB/s");
+  ReadResult results[BLOCK_READER_KINDS];
+  for (BlockReaderKind kind = 0; kind < BLOCK_READER_KINDS; kind++) {
+    results[kind] = run_reader(path, kind);
+    ReadResult r = results[kind];
+    if (not r.is_available)
+      printf("%-10s not available\n", block_reader_name(kind));
+    else if (r.cold_secs < 0 or r.warm_secs < 0)
+      printf("%-10s %7.0f%% read failed\n", block_reader_name(kind), r.cached_before_cold * 100);
+    else
+      printf("%-10s %7.0f%% %10.3f %10.1f %10.3f %10.1f\n", block_reader_name(kind),
+             r.cached_before_cold * 100, r.cold_secs, mb / r.cold_secs, r.warm_secs,
+             mb / r.warm_secs);
+  }
+  if (is_generated) remove(path);
+
+  int ret_val = 0;
+  if (write_json(results, BLOCK_READER_KINDS, json_path, path, mb)) {
+    printf("Results saved to %s\n", json_path);
+  } else {
+    fprintf(stderr, "Failed to write %s\n", json_path);
+    ret_val = 1;
+  }
+  return ret_val;
+}
@@ -0,0 +1,239 @@
+// util/hashmap.h against a naive chained hash map, the kind that allocates
+// a node per entry. Keys are random 64-bit integers. Every case inserts,
+// looks up present keys or looks up absent keys. JSON goes to the first
+// argument, bench_hashmap.json by default.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../util/allocator.h"
+#include "../util/prettify_c.h"
+#include "bench.h"
+
+typedef uint64_t u64;
+
+static u64 u64_identity(u64 key) { return key; }
+
+#define HASHMAP_K u64
+#define HASHMAP_V u64
+#define HASHMAP_HASH u64_identity
+#define HASHMAP_MAKE_STATIC
+#include "../util/hashmap.h"
+
+typedef struct ChainNode {
+  u64 key, value;
+  struct ChainNode *next;
+} ChainNode;
+
+// Load factor 1, grows by doubling and relinking the nodes
+typedef struct ChainedMap {
+  ChainNode **buckets;
+  size_t bucket_count;
+  size_t length;
+} ChainedMap;
+
+static size_t chained_bucket(const ChainedMap *map, u64 key) {
+  return hash_u64(key) & (map->bucket_count - 1);
+}
+
+static ChainedMap chained_create() {
+  return (ChainedMap){
+      .buckets = calloc(8, sizeof(ChainNode*)), .bucket_count = 8, .length = 0};
+}
+
+static void chained_grow(ChainedMap *map) {
+  ChainedMap grown = {.buckets = calloc(map->bucket_count * 2, sizeof(ChainNode*)),
+                      .bucket_count = map->bucket_count * 2,
+                      .length = map->length};
+  for (size_t b = 0; b < map->bucket_count; b++) {
+    for (ChainNode *node = map->buckets[b]; node;) {
+      ChainNode *next = node->next;
+      size_t i = chained_bucket(&grown, node->key);
+      node->next = grown.buckets[i];
+      grown.buckets[i] = node;
+      node = next;
+    }
+  }
+  free(map->buckets);
+  *map = grown;
+}
+
+static u64 *chained_get(const ChainedMap *map, u64 key) {
+  for (ChainNode *node = map->buckets[chained_bucket(map, key)]; node;
+       node = node->next)
+    if (node->key is key) return &node->value;
+  return null;
+}
+
+static void chained_insert(ChainedMap *map, u64 key, u64 value) {
+  u64 *existing = chained_get(map, key);
+  if (existing) {
+    *existing = value;
+    return;
+  }
+  if (map->length >= map->bucket_count) chained_grow(map);
+
+  ChainNode *node = malloc(sizeof(ChainNode));
+  size_t i = chained_bucket(map, key);
+  *node = (ChainNode){.key = key, .value = value, .next = map->buckets[i]};
+  map->buckets[i] = node;
+  map->length++;
+}
+
+static void chained_free(ChainedMap map) {
+  for (size_t b = 0; b < map.bucket_count; b++) {
+    for (ChainNode *node = map.buckets[b]; node;) {
+      ChainNode *next = node->next;
+      free(node);
+      node = next;
+    }
+  }
+  free(map.buckets);
+}
+
+typedef struct MapCase {
+  u64 *keys;     // inserted
+  u64 *present;  // keys in another order
+  u64 *absent;   // never inserted
+  size_t count;
+  map_u64_u64 robin_hood;
+  ChainedMap chained;
+} MapCase;
+
+// Keeps the results observable, so nothing is optimized away
+static volatile u64 Sink;
+
+static void run_insert_robin_hood(void *ctx) {
+  MapCase *c = ctx;
+  map_u64_u64 map = map_u64_u64_create();
+  for (size_t i = 0; i < c->count; i++) map_u64_u64_insert(&map, c->keys[i], i);
+  Sink = map.length;
+  map_u64_u64_free(map);
+}
+
+static void run_insert_reserved_robin_hood(void *ctx) {
+  MapCase *c = ctx;
+  map_u64_u64 map = map_u64_u64_with_capacity(c->count);
+  for (size_t i = 0; i < c->count; i++) map_u64_u64_insert(&map, c->keys[i], i);
+  Sink = map.length;
+  map_u64_u64_free(map);
+}
+
+static void run_insert_chained(void *ctx) {
+  MapCase *c = ctx;
+  ChainedMap map = chained_create();
+  for (size_t i = 0; i < c->count; i++) chained_insert(&map, c->keys[i], i);
+  Sink = map.length;
+  chained_free(map);
+}
+
+static void run_hit_robin_hood(void *ctx) {
+  MapCase *c = ctx;
+  u64 sum = 0;
+  for (size_t i = 0; i < c->count; i++)
+    sum += *map_u64_u64_get(&c->robin_hood, c->present[i]);
+  Sink = sum;
+}
+
+static void run_hit_chained(void *ctx) {
+  MapCase *c = ctx;
+  u64 sum = 0;
+  for (size_t i = 0; i < c->count; i++)
+    sum += *chained_get(&c->chained, c->present[i]);
+  Sink = sum;
+}
+
+static void run_miss_robin_hood(void *ctx) {
+  MapCase *c = ctx;
+  size_t found = 0;
+  for (size_t i = 0; i < c->count; i++)
+    found += map_u64_u64_get(&c->robin_hood, c->absent[i]) is_not null;
+  Sink = found;
+}
+
+static void run_miss_chained(void *ctx) {
+  MapCase *c = ctx;
+  size_t found = 0;
+  for (size_t i = 0; i < c->count; i++)
+    found += chained_get(&c->chained, c->absent[i]) is_not null;
+  Sink = found;
+}
+
+static u64 random_u64(u64 *state) {
+  *state += 0x9e3779b97f4a7c15ull;
+  return hash_u64(*state);
+}
+
+int main(int argc, char **argv) {
+  const char *json_path = argc > 1 ? argv[1] : "bench_hashmap.json";
+  BenchSuite suite = bench_suite_create("hashmap");
+
+  const int counts[] = {1000, 100000, 1000000};
+  struct {
+    const char *name;
+    bench_fn_t fn;
+  } cases[] = {
+      {"insert_robin_hood", run_insert_robin_hood},
+      {"insert_reserved_robin_hood", run_insert_reserved_robin_hood},
+      {"insert_chained", run_insert_chained},
+      {"lookup_hit_robin_hood", run_hit_robin_hood},
+      {"lookup_hit_chained", run_hit_chained},
+      {"lookup_miss_robin_hood", run_miss_robin_hood},
+      {"lookup_miss_chained", run_miss_chained},
+  };
+
+  u64 seed = 21;
+  for (size_t n = 0; n < LEN(counts); n++) {
+    MapCase c = {
+        .keys = malloc(sizeof(u64) * counts[n]),
+        .present = malloc(sizeof(u64) * counts[n]),
+        .absent = malloc(sizeof(u64) * counts[n]),
+        .count = counts[n],
+        .robin_hood = map_u64_u64_create(),
+        .chained = chained_create(),
+    };
+    // Odd keys are inserted, even ones are not
+    for (size_t i = 0; i < c.count; i++) {
+      u64 key = random_u64(&seed);
+      c.keys[i] = key | 1;
+      c.absent[i] = key & ~1ull;
+      map_u64_u64_insert(&c.robin_hood, c.keys[i], i);
+      chained_insert(&c.chained, c.keys[i], i);
+    }
+
+    // Chained nodes are allocated one after another, looking them up in the
+    // insertion order would walk memory sequentially
+    memcpy(c.present, c.keys, sizeof(u64) * c.count);
+    for (size_t i = c.count - 1; i > 0; i--) {
+      size_t j = random_u64(&seed) % (i + 1);
+      u64 tmp = c.present[i];
+      c.present[i] = c.present[j];
+      c.present[j] = tmp;
+    }
+
+    // Per call of the case, so divided by count below
+    for (size_t k = 0; k < LEN(cases); k++) {
+      BenchResult r = bench_run(&suite, cases[k].name, counts[n], cases[k].fn, &c);
+      printf("  %.2f ns per key\n", r.median_ns / counts[n]);
+    }
+
+    map_u64_u64_free(c.robin_hood);
+    chained_free(c.chained);
+    free(c.keys);
+    free(c.present);
+    free(c.absent);
+  }
+
+  int ret_val = 0;
+  if (bench_write_json(&suite, json_path)) {
+    printf("Results saved to %s\n", json_path);
+  } else {
+    fprintf(stderr, "Failed to write %s\n", json_path);
+    ret_val = 1;
+  }
+
+  bench_suite_free(suite);
+  return ret_val;
+}
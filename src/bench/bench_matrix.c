@@ -0,0 +1,158 @@
+// Speed of the matrix_t API. Results go to the table on stdout and to the
+// JSON file given as the first argument (bench_matrix.json by default), which
+// is meant to be kept and diffed between releases.
+
+#include <stdio.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../util/prettify_c.h"
+#include "bench.h"
+
+typedef struct MatrixCase {
+  int size;
+  matrix_t a;
+  matrix_t b;
+} MatrixCase;
+
+typedef struct ChainCase {
+  matrix_t *chain[4];
+} ChainCase;
+
+// Keeps the results observable, so nothing is optimized away
+static volatile double Sink;
+
+// Diagonally dominant, so it is never singular
+static matrix_t create_test_matrix(int size, int seed) {
+  matrix_t m;
+  assert_m(s21_create_matrix(size, size, &m) is OK);
+  for (int i = 0; i < size; i++)
+    for (int j = 0; j < size; j++)
+      m.matrix[i][j] = (i is j ? size : 0) + ((i * 7 + j * 3 + seed) % 11) / 11.0;
+  return m;
+}
+
+static MatrixCase case_create(int size) {
+  return (MatrixCase){
+      .size = size,
+      .a = create_test_matrix(size, 1),
+      .b = create_test_matrix(size, 2),
+  };
+}
+
+static void case_free(MatrixCase *c) {
+  s21_remove_matrix(&c->a);
+  s21_remove_matrix(&c->b);
+}
+
+static void run_create_remove(void *ctx) {
+  MatrixCase *c = ctx;
+  matrix_t m;
+  s21_create_matrix(c->size, c->size, &m);
+  s21_remove_matrix(&m);
+}
+
+static void run_mult(void *ctx) {
+  MatrixCase *c = ctx;
+  matrix_t result;
+  s21_mult_matrix(&c->a, &c->b, &result);
+  Sink = result.matrix[0][0];
+  s21_remove_matrix(&result);
+}
+
+static void run_determinant(void *ctx) {
+  MatrixCase *c = ctx;
+  double result;
+  s21_determinant(&c->a, &result);
+  Sink = result;
+}
+
+static void run_inverse(void *ctx) {
+  MatrixCase *c = ctx;
+  matrix_t result;
+  s21_inverse_matrix(&c->a, &result);
+  Sink = result.matrix[0][0];
+  s21_remove_matrix(&result);
+}
+
+static void run_complements(void *ctx) {
+  MatrixCase *c = ctx;
+  matrix_t result;
+  s21_calc_complements(&c->a, &result);
+  Sink = result.matrix[0][0];
+  s21_remove_matrix(&result);
+}
+
+static void run_mvp_pairwise(void *ctx) {
+  ChainCase *c = ctx;
+  matrix_t acc, next;
+  s21_mult_matrix(c->chain[0], c->chain[1], &acc);
+  for (int i = 2; i < (int)LEN(c->chain); i++) {
+    s21_mult_matrix(&acc, c->chain[i], &next);
+    s21_remove_matrix(&acc);
+    acc = next;
+  }
+  Sink = acc.matrix[0][0];
+  s21_remove_matrix(&acc);
+}
+
+static void run_mvp_chain(void *ctx) {
+  ChainCase *c = ctx;
+  matrix_t result;
+  s21_mult_chain(c->chain, LEN(c->chain), &result);
+  Sink = result.matrix[0][0];
+  s21_remove_matrix(&result);
+}
+
+static void bench_sizes(BenchSuite *suite, const char *name, bench_fn_t fn,
+                        const int *sizes, int count) {
+  for (int i = 0; i < count; i++) {
+    MatrixCase c = case_create(sizes[i]);
+    bench_run(suite, name, sizes[i], fn, &c);
+    case_free(&c);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *json_path = argc > 1 ? argv[1] : "bench_matrix.json";
+  BenchSuite suite = bench_suite_create("s21_matrix");
+
+  // Determinant, inverse and complements use cofactor expansion, which is
+  // O(n!), so they stop at 8
+  const int alloc_sizes[] = {4, 64, 512};
+  const int mult_sizes[] = {4, 16, 64, 256};
+  const int cofactor_sizes[] = {3, 4, 6, 8};
+
+  bench_sizes(&suite, "create_remove", run_create_remove, alloc_sizes,
+              LEN(alloc_sizes));
+  bench_sizes(&suite, "mult_matrix", run_mult, mult_sizes, LEN(mult_sizes));
+  bench_sizes(&suite, "determinant", run_determinant, cofactor_sizes,
+              LEN(cofactor_sizes));
+  bench_sizes(&suite, "inverse_matrix", run_inverse, cofactor_sizes,
+              LEN(cofactor_sizes));
+  bench_sizes(&suite, "calc_complements", run_complements, cofactor_sizes,
+              LEN(cofactor_sizes));
+
+  // The model-view-projection product the viewer builds every frame
+  matrix_t proj = s21_create_perspective_matrix(1.5, 0.1, 2000.0, 1.3);
+  matrix_t view = s21_create_view_to_camera();
+  matrix_t rot = s21_create_rotations_camera(0.3, -1.2, 2.5);
+  matrix_t shift = s21_create_shift_matrix(1.0, -2.0, 3.5);
+  ChainCase mvp = {{&proj, &view, &rot, &shift}};
+  bench_run(&suite, "mvp_pairwise", 4, run_mvp_pairwise, &mvp);
+  bench_run(&suite, "mvp_mult_chain", 4, run_mvp_chain, &mvp);
+  s21_remove_matrix(&proj);
+  s21_remove_matrix(&view);
+  s21_remove_matrix(&rot);
+  s21_remove_matrix(&shift);
+
+  int ret_val = 0;
+  if (bench_write_json(&suite, json_path)) {
+    printf("Results saved to %s\n", json_path);
+  } else {
+    fprintf(stderr, "Failed to write %s\n", json_path);
+    ret_val = 1;
+  }
+
+  bench_suite_free(suite);
+  return ret_val;
+}
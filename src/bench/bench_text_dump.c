@@ -0,0 +1,135 @@
+// Throughput of writing a large text dump, the way an OBJ file is written:
+// "v x y z" lines of floats and "f a b c" lines of indices, half of each.
+// Compares fprintf, x_printf into a FILE* and x_printf into a
+// BufferedOutStream, with %f and with the shortest %$float. Every case
+// writes the whole dump once into a scratch file, which is removed after.
+// Arguments: JSON path (bench_text_dump.json), line count (10000000).
+
+#define _POSIX_C_SOURCE 200809L  // fileno
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../util/better_io.h"
+#include "../util/prettify_c.h"
+#include "bench.h"
+
+#define SCRATCH_PATH "bench_text_dump.tmp"
+// Values repeat after this many, so generating them is not measured
+#define VALUES_COUNT (1 << 16)
+
+typedef enum Writer {
+  WRITER_FPRINTF,
+  WRITER_X_PRINTF_FILE,
+  WRITER_X_PRINTF_BUFFERED,
+  WRITER_X_PRINTF_BUFFERED_SHORTEST,
+  WRITER_COUNT,
+} Writer;
+
+static const char *const WRITER_NAMES[] = {
+    "fprintf", "x_printf_file", "x_printf_buffered",
+    "x_printf_buffered_shortest"};
+
+typedef struct DumpResult {
+  Writer writer;
+  long lines;
+  double secs;
+  double mb;
+} DumpResult;
+
+static float Values[VALUES_COUNT];
+static int Indices[VALUES_COUNT];
+
+static void write_dump(Writer writer, FILE *file, long lines) {
+  BufferedOutStream buffered = {0};
+  OutStream stream = outstream_from_file(file);
+  if (writer >= WRITER_X_PRINTF_BUFFERED) {
+    buffered = buffered_outstream_create(fileno(file), 0);
+    stream = outstream_from_buffered(&buffered);
+  }
+  const char *vertex_format =
+      writer is WRITER_X_PRINTF_BUFFERED_SHORTEST ? "v %$float %$float %$float\n"
+                                                  : "v %f %f %f\n";
+
+  for (long line = 0; line < lines; line++) {
+    size_t i = (size_t)line % (VALUES_COUNT - 2);
+    if (line % 2 is 0) {
+      if (writer is WRITER_FPRINTF)
+        fprintf(file, "v %f %f %f\n", Values[i], Values[i + 1], Values[i + 2]);
+      else
+        x_sprintf(stream, vertex_format, Values[i], Values[i + 1], Values[i + 2]);
+    } else {
+      if (writer is WRITER_FPRINTF)
+        fprintf(file, "f %d %d %d\n", Indices[i], Indices[i + 1], Indices[i + 2]);
+      else
+        x_sprintf(stream, "f %d %d %d\n", Indices[i], Indices[i + 1], Indices[i + 2]);
+    }
+  }
+
+  if (writer >= WRITER_X_PRINTF_BUFFERED) buffered_outstream_free(&buffered);
+}
+
+static DumpResult run_dump(Writer writer, long lines) {
+  DumpResult result = {.writer = writer, .lines = lines, .secs = -1};
+  FILE *file = fopen(SCRATCH_PATH, "wb");
+  if (file is null) return result;
+
+  double start = bench_now_secs();
+  write_dump(writer, file, lines);
+  fflush(file);
+  result.secs = bench_now_secs() - start;
+  result.mb = ftell(file) / (1024.0 * 1024.0);
+
+  fclose(file);
+  remove(SCRATCH_PATH);
+  return result;
+}
+
+static bool write_json(const DumpResult *results, int count, const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file is null) return false;
+
+  fprintf(file, "{\n  \"suite\": \"text_dump\",\n");
+  fprintf(file, "  \"compiler\": \"%s\",\n  \"results\": [\n", __VERSION__);
+  for (int i = 0; i < count; i++) {
+    const DumpResult *r = &results[i];
+    fprintf(file,
+            "    {\"writer\": \"%s\", \"lines\": %ld, \"secs\": %.4f, "
+            "\"mb\": %.2f, \"mb_per_sec\": %.2f}%s\n",
+            WRITER_NAMES[r->writer], r->lines, r->secs, r->mb, r->mb / r->secs,
+            i + 1 < count ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+
+  return fclose(file) is 0;
+}
+
+int main(int argc, char **argv) {
+  const char *json_path = argc > 1 ? argv[1] : "bench_text_dump.json";
+  long lines = argc > 2 ? atol(argv[2]) : 10000000;
+
+  srand(21);
+  for (int i = 0; i < VALUES_COUNT; i++) {
+    Values[i] = (float)rand() / RAND_MAX * 20.0f - 10.0f;
+    Indices[i] = rand() % 1000000 + 1;
+  }
+
+  printf("text_dump, %ld lines\n%-28s %10s %10s %10s\n", lines, "writer", "secs",
+         "MB", "MB/s");
+  DumpResult results[WRITER_COUNT];
+  for (Writer writer = 0; writer < WRITER_COUNT; writer++) {
+    results[writer] = run_dump(writer, lines);
+    DumpResult r = results[writer];
+    printf("%-28s %10.3f %10.1f %10.1f\n", WRITER_NAMES[writer], r.secs, r.mb,
+           r.mb / r.secs);
+  }
+
+  int ret_val = 0;
+  if (write_json(results, WRITER_COUNT, json_path)) {
+    printf("Results saved to %s\n", json_path);
+  } else {
+    fprintf(stderr, "Failed to write %s\n", json_path);
+    ret_val = 1;
+  }
+  return ret_val;
+}
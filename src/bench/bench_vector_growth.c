@@ -0,0 +1,150 @@
+// Peak RSS and time of growing a float vector one push at a time, the way
+// the parser fills its arrays, under the three growth policies of vector.h.
+// Every case runs in a forked child, so its peak RSS is not hidden by an
+// earlier, bigger case. JSON goes to the first argument,
+// bench_vector_growth.json by default.
+
+#define _GNU_SOURCE  // wait4
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../util/common_vecs.h"
+#include "../util/prettify_c.h"
+#include "bench.h"
+
+typedef enum Policy { POLICY_COPY, POLICY_REALLOC, POLICY_HUGE } Policy;
+
+static const char *const POLICY_NAMES[] = {"copy", "realloc", "huge"};
+
+typedef struct GrowthResult {
+  Policy policy;
+  long size_mb;
+  double secs;
+  long peak_rss_mb;
+  long minor_faults;
+} GrowthResult;
+
+// Grows with malloc + memcpy + free, like any vector without
+// VECTOR_REALLOC_FN
+typedef float CopyFloat;
+// Grows with REALLOC, which is what the parser used before VECTOR_HUGE_ALLOC
+typedef float ReallocFloat;
+
+#define VECTOR_H CopyFloat
+#include "../util/vector.h"
+#define VECTOR_H ReallocFloat
+#include "../util/vector.h"
+#define VECTOR_H GrowthResult
+#include "../util/vector.h"
+
+// Before allocator.h, which defines VECTOR_REALLOC_FN
+#define VECTOR_C CopyFloat
+#include "../util/vector.h"
+
+#include "../util/allocator.h"
+
+#define VECTOR_C ReallocFloat
+#include "../util/vector.h"
+
+#define VECTOR_C GrowthResult
+#include "../util/vector.h"
+
+// Keeps the vector observable, so the pushes are not optimized away
+static volatile float Sink;
+
+#define GROW(vec_type, count)                                         \
+  {                                                                   \
+    vec_type v = CONCAT(vec_type, _create)();                         \
+    for (size_t i = 0; i < (count); i++)                              \
+      CONCAT(vec_type, _push)(&v, (float)i);                          \
+    Sink = v.data[v.length / 2];                                      \
+    CONCAT(vec_type, _free)(v);                                       \
+  }
+
+static void grow(Policy policy, size_t count) {
+  if (policy is POLICY_COPY)
+    GROW(vec_CopyFloat, count)
+  else if (policy is POLICY_REALLOC)
+    GROW(vec_ReallocFloat, count)
+  else
+    GROW(vec_float, count)
+}
+
+static GrowthResult run_in_child(Policy policy, long size_mb) {
+  GrowthResult result = {.policy = policy, .size_mb = size_mb, .secs = -1};
+  int fds[2];
+  assert_m(pipe(fds) is 0);
+
+  pid_t pid = fork();
+  assert_m(pid >= 0);
+  if (pid is 0) {
+    close(fds[0]);
+    double start = bench_now_secs();
+    grow(policy, (size_t)size_mb * 1024 * 1024 / sizeof(float));
+    double secs = bench_now_secs() - start;
+    ssize_t written = write(fds[1], &secs, sizeof(secs));
+    _exit(written is sizeof(secs) ? 0 : 1);
+  }
+
+  close(fds[1]);
+  if (read(fds[0], &result.secs, sizeof(result.secs)) is_not sizeof(result.secs))
+    result.secs = -1;
+  close(fds[0]);
+
+  int status;
+  struct rusage usage;
+  assert_m(wait4(pid, &status, 0, &usage) is pid);
+  result.peak_rss_mb = usage.ru_maxrss / 1024;
+  result.minor_faults = usage.ru_minflt;
+  return result;
+}
+
+static bool write_json(const vec_GrowthResult *results, const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file is null) return false;
+
+  fprintf(file, "{\n  \"suite\": \"vector_growth\",\n");
+  fprintf(file, "  \"compiler\": \"%s\",\n  \"results\": [\n", __VERSION__);
+  for (size_t i = 0; i < results->length; i++) {
+    const GrowthResult *r = &results->data[i];
+    fprintf(file,
+            "    {\"policy\": \"%s\", \"size_mb\": %ld, \"secs\": %.4f, "
+            "\"peak_rss_mb\": %ld, \"minor_faults\": %ld}%s\n",
+            POLICY_NAMES[r->policy], r->size_mb, r->secs, r->peak_rss_mb,
+            r->minor_faults, i + 1 < results->length ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+
+  return fclose(file) is 0;
+}
+
+int main(int argc, char **argv) {
+  const char *json_path = argc > 1 ? argv[1] : "bench_vector_growth.json";
+  const long sizes_mb[] = {64, 256, 1024};
+
+  printf("vector_growth\n%-8s %8s %10s %14s %14s\n", "policy", "size MB",
+         "secs", "peak RSS MB", "minor faults");
+  vec_GrowthResult results = vec_GrowthResult_create();
+  for (size_t s = 0; s < LEN(sizes_mb); s++) {
+    for (Policy policy = POLICY_COPY; policy <= POLICY_HUGE; policy++) {
+      GrowthResult r = run_in_child(policy, sizes_mb[s]);
+      printf("%-8s %8ld %10.3f %14ld %14ld\n", POLICY_NAMES[policy], r.size_mb,
+             r.secs, r.peak_rss_mb, r.minor_faults);
+      vec_GrowthResult_push(&results, r);
+    }
+  }
+
+  int ret_val = 0;
+  if (write_json(&results, json_path)) {
+    printf("Results saved to %s\n", json_path);
+  } else {
+    fprintf(stderr, "Failed to write %s\n", json_path);
+    ret_val = 1;
+  }
+
+  vec_GrowthResult_free(results);
+  return ret_val;
+}
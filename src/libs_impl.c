@@ -10,6 +10,11 @@
 #define NK_GLFW_GL3_IMPLEMENTATION
 #include <nuklear_glfw_gl3.h>
 
+// Images are counted as textures by the allocator
+#include "util/allocator.h"
+#define STBI_MALLOC my_malloc
+#define STBI_REALLOC my_realloc
+#define STBI_FREE my_free
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -10,6 +10,8 @@
 
 #include "app.h"
 #include "util/allocator.h"
+#include "util/jobs.h"
+#include "util/logger.h"
 #include "util/prettify_c.h"
 #include "util/cur_time.h"
 
@@ -45,9 +47,11 @@ int main() {
   GLFWwindow* window;
   struct nk_context* ctx;
   struct nk_glfw glfw = {0};
+  logger_init(stdout);
   initialize_all(&window, &ctx, &glfw);
 
   // ===== Program initialization
+  jobs_init(-1);
   App* app = app_create(window);
 
   // We need to pass in app pointer so call
@@ -60,6 +64,7 @@ int main() {
   double last_frame = current_time_secs();
   while (!glfwWindowShouldClose(window)) {
     double now = current_time_secs();
+    frame_arena_reset();
     glfwSwapBuffers(window);
     glfwPollEvents();
 
@@ -87,8 +92,14 @@ int main() {
   glfwDestroyWindow(window);
   debugln("Terminating GLFW");
   glfwTerminate();
+  debugln("Stopping the workers...");
+  jobs_shutdown();
   debugln("Done. Stopping the program");
+  // The allocator report below is printed directly, after the queued log
+  logger_shutdown();
+  arena_free(*frame_arena());
   my_allocator_dump_short();
+  my_allocator_free();
   return 0;
 }
 
@@ -0,0 +1,239 @@
+#include "catalog.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../util/allocator.h"
+#include "../util/better_string.h"
+#include "../util/dir_walk.h"
+#include "../util/jobs.h"
+#include "../util/mapped_file.h"
+#include "../util/prettify_c.h"
+
+#define CATALOG_BYTE_ORDER 0x01020304u
+
+typedef struct CatalogHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;  // 0x01020304 written natively
+  uint32_t entry_size;  // sizeof(CatalogEntry), changes with the layout
+  uint32_t reserved;
+  uint64_t entries_count, paths_size;
+} CatalogHeader;
+
+// A file catalog_scan found, before it has an entry
+typedef struct FoundFile {
+  char* path;
+  FileInfo info;
+} FoundFile;
+
+#define VECTOR_ITEM_TYPE FoundFile
+#define VECTOR_IMPLEMENTATION
+#include "../util/vector.h"  // vec_FoundFile
+
+// After the local vector, VECTOR_C leaves the headers switched off
+#define VECTOR_C CatalogEntry
+#include "../util/vector.h"
+
+typedef struct ScanJob {
+  Catalog* catalog;
+  const int* entries;  // to scan
+  CatalogProgress* progress;
+} ScanJob;
+
+Catalog catalog_create() {
+  return (Catalog) {
+    .entries = vec_CatalogEntry_create(),
+    .paths = vec_char_create(),
+    .search_text = vec_char_create(),
+  };
+}
+
+void catalog_free(Catalog catalog) {
+  vec_CatalogEntry_free(catalog.entries);
+  vec_char_free(catalog.paths);
+  vec_char_free(catalog.search_text);
+}
+
+const char* catalog_path(const Catalog* catalog, size_t i) {
+  return catalog->paths.data + catalog->entries.data[i].path_offset;
+}
+
+static uint32_t add_path(Catalog* catalog, const char* path, size_t length) {
+  uint32_t offset = (uint32_t)catalog->paths.length;
+  vec_char_push_n(&catalog->paths, path, length + 1);
+  return offset;
+}
+
+static void build_search_text(Catalog* catalog) {
+  vec_char_resize_uninit(&catalog->search_text, catalog->paths.length);
+  for (size_t i = 0; i < catalog->paths.length; i++)
+    catalog->search_text.data[i] = (char)tolower((unsigned char)catalog->paths.data[i]);
+}
+
+static bool entries_are_valid(const CatalogEntry* entries, size_t count, const char* paths, size_t paths_size) {
+  for (size_t i = 0; i < count; i++) {
+    uint64_t end = (uint64_t)entries[i].path_offset + entries[i].path_length;
+    if (end >= paths_size or paths[end] is_not '\0') return false;
+  }
+  return true;
+}
+
+bool catalog_load(const char* index_path, Catalog* out) {
+  *out = catalog_create();
+  MappedFile file;
+  if (not mapped_file_open(index_path, &file)) return false;
+
+  const CatalogHeader* header = (const CatalogHeader*)file.data;
+  bool ok = file.size >= sizeof(CatalogHeader) and
+            memcmp(header->magic, CATALOG_MAGIC, sizeof(header->magic)) is 0 and
+            header->version is CATALOG_VERSION and
+            header->byte_order is CATALOG_BYTE_ORDER and
+            header->entry_size is sizeof(CatalogEntry) and
+            header->entries_count <= (file.size - sizeof(CatalogHeader)) / sizeof(CatalogEntry) and
+            header->paths_size is file.size - sizeof(CatalogHeader) - header->entries_count * sizeof(CatalogEntry);
+
+  const CatalogEntry* entries = (const CatalogEntry*)(header + 1);
+  const char* paths = ok ? (const char*)(entries + header->entries_count) : null;
+  ok = ok and entries_are_valid(entries, header->entries_count, paths, header->paths_size);
+  if (ok) {
+    vec_CatalogEntry_push_n(&out->entries, entries, header->entries_count);
+    vec_char_push_n(&out->paths, paths, header->paths_size);
+    build_search_text(out);
+  }
+  mapped_file_close(&file);
+  return ok;
+}
+
+bool catalog_save(const Catalog* catalog, const char* index_path) {
+  CatalogHeader header = {
+    .version = CATALOG_VERSION,
+    .byte_order = CATALOG_BYTE_ORDER,
+    .entry_size = sizeof(CatalogEntry),
+    .entries_count = catalog->entries.length,
+    .paths_size = catalog->paths.length,
+  };
+  memcpy(header.magic, CATALOG_MAGIC, sizeof(header.magic));
+
+  // Renamed over the old index when complete, like mesh_cache_write
+  str_t temp_path = str_owned("%s.tmp", index_path);
+  FILE* file = fopen(temp_path.string, "wb");
+  bool ok = file is_not null;
+  if (ok) {
+    size_t entries_size = catalog->entries.length * sizeof(CatalogEntry);
+    ok = fwrite(&header, sizeof(header), 1, file) is 1;
+    ok = ok and (entries_size is 0 or fwrite(catalog->entries.data, 1, entries_size, file) is entries_size);
+    ok = ok and (catalog->paths.length is 0 or fwrite(catalog->paths.data, 1, catalog->paths.length, file) is catalog->paths.length);
+    ok = fclose(file) is 0 and ok;
+    ok = ok and rename(temp_path.string, index_path) is 0;
+    if (not ok) remove(temp_path.string);
+  }
+
+  str_free(temp_path);
+  return ok;
+}
+
+static void collect_obj(void* ctx, const char* path, const char* relative, const FileInfo* info) {
+  unused(relative);
+  if (not path_has_extension(path, ".obj")) return;
+
+  size_t length = strlen(path);
+  FoundFile found = {.path = MALLOC(length + 1), .info = *info};
+  assert_alloc(found.path);
+  memcpy(found.path, path, length + 1);
+  vec_FoundFile_push(ctx, found);
+}
+
+static int compare_found(const void* a, const void* b) {
+  return strcmp(((const FoundFile*)a)->path, ((const FoundFile*)b)->path);
+}
+
+// Index of the entry for path, -1 if there is none
+static long find_entry(const Catalog* catalog, const char* path) {
+  size_t low = 0, high = catalog->entries.length;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    int cmp = strcmp(catalog_path(catalog, mid), path);
+    if (cmp is 0) return (long)mid;
+    if (cmp < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return -1;
+}
+
+static void scan_entries(void* ctx, size_t begin, size_t end) {
+  const ScanJob* job = ctx;
+  for (size_t i = begin; i < end; i++) {
+    CatalogEntry* entry = &job->catalog->entries.data[job->entries[i]];
+    // Gone or unreadable: kept with an mtime that never matches, so the next
+    // scan tries again
+    if (not obj_stats_scan(catalog_path(job->catalog, job->entries[i]), &entry->stats))
+      entry->mtime_ns = -1;
+    if (job->progress) atomic_fetch_add(&job->progress->scanned, 1);
+  }
+}
+
+Catalog catalog_scan(const Catalog* old, const char* root, CatalogProgress* progress) {
+  AllocTag old_tag = alloc_tag_set(ALLOC_TAG_PARSER);
+  vec_FoundFile found = vec_FoundFile_create();
+  dir_walk(root, collect_obj, &found);
+  qsort(found.data, found.length, sizeof(FoundFile), compare_found);
+  if (progress) atomic_store(&progress->found, (long)found.length);
+
+  Catalog catalog = catalog_create();
+  vec_CatalogEntry_reserve(&catalog.entries, found.length);
+  vec_int to_scan = vec_int_create();
+
+  for (size_t i = 0; i < found.length; i++) {
+    size_t length = strlen(found.data[i].path);
+    CatalogEntry entry = {
+      .path_offset = add_path(&catalog, found.data[i].path, length),
+      .path_length = (uint32_t)length,
+      .size = found.data[i].info.size,
+      .mtime_ns = found.data[i].info.mtime_ns,
+    };
+
+    long old_index = old ? find_entry(old, found.data[i].path) : -1;
+    const CatalogEntry* old_entry = old_index >= 0 ? &old->entries.data[old_index] : null;
+    if (old_entry and old_entry->size is entry.size and old_entry->mtime_ns is entry.mtime_ns)
+      entry.stats = old_entry->stats;
+    else
+      vec_int_push(&to_scan, (int)i);
+
+    vec_CatalogEntry_push(&catalog.entries, entry);
+    FREE(found.data[i].path);
+  }
+  vec_FoundFile_free(found);
+
+  // One job per file, files differ in size by orders of magnitude
+  if (progress) atomic_store(&progress->to_scan, (long)to_scan.length);
+  ScanJob job = {.catalog = &catalog, .entries = to_scan.data, .progress = progress};
+  parallel_for(0, to_scan.length, 1, scan_entries, &job);
+  vec_int_free(to_scan);
+
+  build_search_text(&catalog);
+  alloc_tag_set(old_tag);
+  return catalog;
+}
+
+void catalog_search(const Catalog* catalog, const char* query, vec_int* out) {
+  char words[256];
+  size_t length = strlen(query);
+  if (length >= sizeof(words)) length = sizeof(words) - 1;
+  for (size_t i = 0; i < length; i++) {
+    char c = (char)tolower((unsigned char)query[i]);
+    words[i] = c is ' ' ? '\0' : c;
+  }
+  words[length] = '\0';
+
+  out->length = 0;
+  for (size_t e = 0; e < catalog->entries.length; e++) {
+    const char* text = catalog->search_text.data + catalog->entries.data[e].path_offset;
+    bool matches = true;
+    for (size_t w = 0; w < length and matches; w += strlen(words + w) + 1)
+      if (words[w] and not strstr(text, words + w)) matches = false;
+    if (matches) vec_int_push(out, (int)e);
+  }
+}
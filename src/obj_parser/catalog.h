@@ -0,0 +1,60 @@
+#ifndef CATALOG_H_
+#define CATALOG_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "../util/common_vecs.h"
+#include "obj_stats.h"
+
+/**
+ * Index of the OBJs below a directory, with the ObjStats of each. Rescanning
+ * only reads the files whose size or mtime changed, the rest keep their
+ * entries. On disk it is the entries array and the paths blob as they are in
+ * memory, behind a header.
+ */
+
+#define CATALOG_MAGIC "3DVCATLG"
+#define CATALOG_VERSION 1
+
+typedef struct CatalogEntry {
+  uint32_t path_offset, path_length;  // in Catalog.paths, NUL-terminated
+  uint64_t size;
+  int64_t mtime_ns;
+  ObjStats stats;
+} CatalogEntry;
+
+#define VECTOR_H CatalogEntry
+#include "../util/vector.h"  // vec_CatalogEntry
+
+typedef struct Catalog {
+  vec_CatalogEntry entries;  // sorted by path
+  vec_char paths;
+  vec_char search_text;      // paths in lower case, for catalog_search
+} Catalog;
+
+// Filled while catalog_scan runs, may be read from other threads
+typedef struct CatalogProgress {
+  atomic_long found;    // OBJ files below the root
+  atomic_long scanned;  // of the ones that needed a scan
+  atomic_long to_scan;
+} CatalogProgress;
+
+Catalog catalog_create();
+void catalog_free(Catalog catalog);
+const char* catalog_path(const Catalog* catalog, size_t i);
+
+// False, with an empty catalog, if the index is missing or not valid
+bool catalog_load(const char* index_path, Catalog* out);
+bool catalog_save(const Catalog* catalog, const char* index_path);
+
+// Catalog of the OBJs below root now, reusing the entries of old (may be
+// null) for files with the same path, size and mtime. The others are
+// scanned in parallel. progress may be null
+Catalog catalog_scan(const Catalog* old, const char* root, CatalogProgress* progress);
+
+// Indices of the entries whose path contains every space-separated word of
+// query, case-insensitively, in path order
+void catalog_search(const Catalog* catalog, const char* query, vec_int* out);
+
+#endif // CATALOG_H_
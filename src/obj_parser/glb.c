@@ -0,0 +1,389 @@
+#include "glb.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "../util/json.h"
+#include "../util/prettify_c.h"
+
+#define VECTOR_C GlbPrimitive
+#include "../util/vector.h"
+
+#define GLB_HEADER_SIZE 12
+#define GLB_CHUNK_HEADER_SIZE 8
+#define GLB_CHUNK_JSON 0x4E4F534Au  // "JSON"
+#define GLB_CHUNK_BIN 0x004E4942u   // "BIN\0"
+#define GLB_TRIANGLES 4
+// Deeper node trees are refused, so a hostile file can not exhaust the stack
+#define GLB_MAX_DEPTH 64
+
+// Top level arrays of the JSON chunk and where the BIN chunk is
+typedef struct GlbScene {
+  const Json* json;
+  int accessors, buffer_views, meshes, nodes;
+  const char* bin;
+  size_t bin_size;
+  int nodes_left;  // a node is visited once, more visits mean a cycle
+  vec_GlbPrimitive* primitives;
+} GlbScene;
+
+static const float IDENTITY[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+static uint32_t get_u32_le(const char* p) {
+  const unsigned char* b = (const unsigned char*)p;
+  return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static size_t component_size(int type) {
+  switch (type) {
+    case GLB_BYTE:
+    case GLB_UNSIGNED_BYTE: return 1;
+    case GLB_SHORT:
+    case GLB_UNSIGNED_SHORT: return 2;
+    case GLB_UNSIGNED_INT:
+    case GLB_FLOAT: return 4;
+    default: return 0;
+  }
+}
+
+// A non-negative integer, -1 for anything else
+static int as_index(const Json* json, int token) {
+  double value = json_number(json, token, -1);
+  return value >= 0 and value <= INT_MAX and value is floor(value) ? (int)value : -1;
+}
+
+static int get_index(const Json* json, int object, const char* key) {
+  return as_index(json, json_get(json, object, key));
+}
+
+// Absent sizes are 0, like the offsets glTF leaves out
+static bool get_size(const Json* json, int object, const char* key, size_t* out) {
+  int token = json_get(json, object, key);
+  *out = 0;
+  if (token < 0) return true;
+  double value = json_number(json, token, -1);
+  if (value < 0 or value > (double)UINT32_MAX or value is_not floor(value)) return false;
+  *out = (size_t)value;
+  return true;
+}
+
+static float number_at(const Json* json, int array, int i, float fallback) {
+  return (float)json_number(json, json_at(json, array, i), fallback);
+}
+
+static int type_components(const Json* json, int token) {
+  static const char* const TYPES[] = {"SCALAR", "VEC2", "VEC3", "VEC4"};
+  for (int i = 0; i < (int)LEN(TYPES); i++)
+    if (json_string_is(json, token, TYPES[i])) return i + 1;
+  return 0;
+}
+
+static bool read_accessor(const GlbScene* scene, int index, int components, GlbAccessor* out) {
+  const Json* json = scene->json;
+  int accessor = json_at(json, scene->accessors, index);
+  if (accessor < 0 or json_get(json, accessor, "sparse") >= 0) return false;
+  int view = json_at(json, scene->buffer_views, get_index(json, accessor, "bufferView"));
+  if (view < 0 or get_index(json, view, "buffer") is_not 0) return false;
+
+  size_t view_offset, view_length, view_stride, offset;
+  if (not get_size(json, view, "byteOffset", &view_offset) or not get_size(json, view, "byteLength", &view_length) or
+      not get_size(json, view, "byteStride", &view_stride) or not get_size(json, accessor, "byteOffset", &offset) or
+      not get_size(json, accessor, "count", &out->count))
+    return false;
+
+  out->component_type = as_index(json, json_get(json, accessor, "componentType"));
+  out->components = type_components(json, json_get(json, accessor, "type"));
+  out->normalized = json_bool(json, json_get(json, accessor, "normalized"), false);
+  size_t element_size = component_size(out->component_type) * out->components;
+  if (element_size is 0 or out->components is_not components or out->count > INT_MAX) return false;
+  out->stride = view_stride ? view_stride : element_size;
+  if (out->stride < element_size) return false;
+
+  // The accessor lies in the view, the view in the BIN chunk
+  if (view_offset > scene->bin_size or view_length > scene->bin_size - view_offset) return false;
+  if (out->count > 0 and (offset > view_length or view_length - offset < element_size or
+                          out->count - 1 > (view_length - offset - element_size) / out->stride))
+    return false;
+  out->data = scene->bin + view_offset + offset;
+
+  int min = json_get(json, accessor, "min");
+  int max = json_get(json, accessor, "max");
+  out->has_bounds = components is 3 and json_length(json, min) is 3 and json_length(json, max) is 3;
+  for (int j = 0; j < 3 and out->has_bounds; j++) {
+    out->min[j] = number_at(json, min, j, 0);
+    out->max[j] = number_at(json, max, j, 0);
+  }
+  return true;
+}
+
+// Row-major, out = a * b
+static void multiply(const float a[16], const float b[16], float out[16]) {
+  for (int r = 0; r < 4; r++)
+    for (int c = 0; c < 4; c++) {
+      float sum = 0;
+      for (int k = 0; k < 4; k++) sum += a[r * 4 + k] * b[k * 4 + c];
+      out[r * 4 + c] = sum;
+    }
+}
+
+// The node matrix, or translation * rotation * scale
+static void local_transform(const Json* json, int node, float out[16]) {
+  int matrix = json_get(json, node, "matrix");
+  if (json_length(json, matrix) is 16) {
+    // Column-major in the file
+    for (int i = 0; i < 16; i++) out[(i % 4) * 4 + i / 4] = number_at(json, matrix, i, 0);
+    return;
+  }
+
+  int t = json_get(json, node, "translation");
+  int r = json_get(json, node, "rotation");
+  int s = json_get(json, node, "scale");
+  float x = number_at(json, r, 0, 0), y = number_at(json, r, 1, 0);
+  float z = number_at(json, r, 2, 0), w = number_at(json, r, 3, 1);
+  const float rotation[3][3] = {
+    {1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w)},
+    {2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w)},
+    {2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y)},
+  };
+  memcpy(out, IDENTITY, sizeof(IDENTITY));
+  for (int row = 0; row < 3; row++) {
+    for (int col = 0; col < 3; col++) out[row * 4 + col] = rotation[row][col] * number_at(json, s, col, 1);
+    out[row * 4 + 3] = number_at(json, t, row, 0);
+  }
+}
+
+static bool add_mesh(GlbScene* scene, int index, const float world[16]) {
+  const Json* json = scene->json;
+  int mesh = json_at(json, scene->meshes, index);
+  int primitives = json_get(json, mesh, "primitives");
+  if (mesh < 0) return false;
+
+  for (int i = 0; i < json_length(json, primitives); i++) {
+    int p = json_at(json, primitives, i);
+    int attributes = json_get(json, p, "attributes");
+    int mode = json_get(json, p, "mode");
+    int positions = get_index(json, attributes, "POSITION");
+    if ((mode >= 0 and as_index(json, mode) is_not GLB_TRIANGLES) or positions < 0) continue;
+
+    GlbPrimitive primitive = {.has_normals = json_get(json, attributes, "NORMAL") >= 0,
+                              .has_indices = json_get(json, p, "indices") >= 0};
+    memcpy(primitive.world, world, sizeof(primitive.world));
+    if (not read_accessor(scene, positions, 3, &primitive.positions)) return false;
+    if (primitive.has_normals and
+        (not read_accessor(scene, get_index(json, attributes, "NORMAL"), 3, &primitive.normals) or
+         primitive.normals.count is_not primitive.positions.count))
+      return false;
+
+    if (primitive.has_indices) {
+      const GlbAccessor* indices = &primitive.indices;
+      if (not read_accessor(scene, get_index(json, p, "indices"), 1, &primitive.indices)) return false;
+      if (indices->component_type is_not GLB_UNSIGNED_BYTE and indices->component_type is_not GLB_UNSIGNED_SHORT and
+          indices->component_type is_not GLB_UNSIGNED_INT)
+        return false;
+      // Checked once here, so neither the conversion nor the GPU reads
+      // past the vertices
+      for (size_t k = 0; k < indices->count; k++)
+        if (glb_read_index(indices, k) >= primitive.positions.count) return false;
+    }
+    vec_GlbPrimitive_push(scene->primitives, primitive);
+  }
+  return true;
+}
+
+static bool walk_node(GlbScene* scene, int index, const float parent[16], int depth) {
+  const Json* json = scene->json;
+  int node = json_at(json, scene->nodes, index);
+  if (node < 0 or depth >= GLB_MAX_DEPTH or scene->nodes_left-- <= 0) return false;
+
+  float local[16], world[16];
+  local_transform(json, node, local);
+  multiply(parent, local, world);
+  if (json_get(json, node, "mesh") >= 0 and not add_mesh(scene, get_index(json, node, "mesh"), world)) return false;
+
+  int children = json_get(json, node, "children");
+  for (int i = 0; i < json_length(json, children); i++)
+    if (not walk_node(scene, as_index(json, json_at(json, children, i)), world, depth + 1)) return false;
+  return true;
+}
+
+static bool walk_scene(GlbScene* scene) {
+  const Json* json = scene->json;
+  int scenes = json_get(json, 0, "scenes");
+  if (scenes < 0) {
+    // Nothing says how to place the meshes, they are shown as stored
+    for (int m = 0; m < json_length(json, scene->meshes); m++)
+      if (not add_mesh(scene, m, IDENTITY)) return false;
+    return true;
+  }
+
+  int index = json_get(json, 0, "scene") >= 0 ? get_index(json, 0, "scene") : 0;
+  int root = json_at(json, scenes, index);
+  int nodes = json_get(json, root, "nodes");
+  if (root < 0) return false;
+  for (int i = 0; i < json_length(json, nodes); i++)
+    if (not walk_node(scene, as_index(json, json_at(json, nodes, i)), IDENTITY, 0)) return false;
+  return true;
+}
+
+static bool read_glb(GlbFile* glb) {
+  const char* data = glb->file.data;
+  size_t size = glb->file.size;
+  if (data is null or size < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE or memcmp(data, "glTF", 4) is_not 0 or
+      get_u32_le(data + 4) is_not 2)
+    return false;
+  // Whatever follows the length in the header is not part of the file
+  if (get_u32_le(data + 8) < size) size = get_u32_le(data + 8);
+
+  const char* json_text = data + GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE;
+  size_t json_size = get_u32_le(data + GLB_HEADER_SIZE);
+  size_t bin_offset = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + json_size;
+  if (get_u32_le(data + GLB_HEADER_SIZE + 4) is_not GLB_CHUNK_JSON or bin_offset > size) return false;
+
+  const char* bin = null;
+  size_t bin_size = 0;
+  if (size - bin_offset >= GLB_CHUNK_HEADER_SIZE and get_u32_le(data + bin_offset + 4) is GLB_CHUNK_BIN) {
+    bin_size = get_u32_le(data + bin_offset);
+    bin = data + bin_offset + GLB_CHUNK_HEADER_SIZE;
+    if (bin_size > size - bin_offset - GLB_CHUNK_HEADER_SIZE) return false;
+  }
+
+  Json json;
+  bool ok = json_parse(json_text, json_size, &json) and json.tokens.data[0].type is JSON_OBJECT;
+  if (ok) {
+    // Buffer 0 is the BIN chunk only when it has no uri, external files are
+    // not read
+    int buffer = json_at(&json, json_get(&json, 0, "buffers"), 0);
+    bool is_external = json_get(&json, buffer, "uri") >= 0;
+    GlbScene scene = {
+      .json = &json,
+      .accessors = json_get(&json, 0, "accessors"),
+      .buffer_views = json_get(&json, 0, "bufferViews"),
+      .meshes = json_get(&json, 0, "meshes"),
+      .nodes = json_get(&json, 0, "nodes"),
+      .bin = is_external ? null : bin,
+      .bin_size = is_external ? 0 : bin_size,
+      .primitives = &glb->primitives,
+    };
+    scene.nodes_left = json_length(&json, scene.nodes);
+    ok = walk_scene(&scene);
+  }
+  json_free(json);
+  return ok;
+}
+
+bool glb_open(const char* path, GlbFile* out) {
+  if (not mapped_file_open(path, &out->file)) return false;
+  out->primitives = vec_GlbPrimitive_create();
+  if (read_glb(out)) return true;
+  glb_close(out);
+  return false;
+}
+
+void glb_close(GlbFile* glb) {
+  vec_GlbPrimitive_free(glb->primitives);
+  mapped_file_close(&glb->file);
+}
+
+// glTF is little-endian, like every machine the viewer runs on, so values
+// are plain loads. memcpy keeps them legal at any alignment
+static float read_component(const char* p, int type, bool normalized) {
+  switch (type) {
+    case GLB_BYTE: {
+      int8_t value;
+      memcpy(&value, p, sizeof(value));
+      return normalized ? fmaxf(value / 127.0f, -1) : value;
+    }
+    case GLB_UNSIGNED_BYTE: {
+      uint8_t value;
+      memcpy(&value, p, sizeof(value));
+      return normalized ? value / 255.0f : value;
+    }
+    case GLB_SHORT: {
+      int16_t value;
+      memcpy(&value, p, sizeof(value));
+      return normalized ? fmaxf(value / 32767.0f, -1) : value;
+    }
+    case GLB_UNSIGNED_SHORT: {
+      uint16_t value;
+      memcpy(&value, p, sizeof(value));
+      return normalized ? value / 65535.0f : value;
+    }
+    case GLB_UNSIGNED_INT: {
+      uint32_t value;
+      memcpy(&value, p, sizeof(value));
+      return (float)value;
+    }
+    default: {
+      float value;
+      memcpy(&value, p, sizeof(value));
+      return value;
+    }
+  }
+}
+
+void glb_read_floats(const GlbAccessor* accessor, size_t i, float* out) {
+  const char* element = accessor->data + i * accessor->stride;
+  size_t size = component_size(accessor->component_type);
+  for (int j = 0; j < accessor->components; j++)
+    out[j] = read_component(element + j * size, accessor->component_type, accessor->normalized);
+}
+
+unsigned glb_read_index(const GlbAccessor* accessor, size_t i) {
+  const char* element = accessor->data + i * accessor->stride;
+  switch (accessor->component_type) {
+    case GLB_UNSIGNED_BYTE: return *(const unsigned char*)element;
+    case GLB_UNSIGNED_SHORT: {
+      uint16_t value;
+      memcpy(&value, element, sizeof(value));
+      return value;
+    }
+    default: {
+      uint32_t value;
+      memcpy(&value, element, sizeof(value));
+      return value;
+    }
+  }
+}
+
+size_t glb_accessor_span(const GlbAccessor* accessor) {
+  if (accessor->count is 0) return 0;
+  return (accessor->count - 1) * accessor->stride + component_size(accessor->component_type) * accessor->components;
+}
+
+static bool is_float_vec3(const GlbAccessor* accessor) {
+  // GL reads floats at offsets and strides that are multiples of 4
+  return accessor->component_type is GLB_FLOAT and (uintptr_t)accessor->data % 4 is 0 and accessor->stride % 4 is 0;
+}
+
+bool glb_is_gpu_ready(const GlbFile* glb) {
+  if (glb->primitives.length is_not 1) return false;
+  const GlbPrimitive* p = &glb->primitives.data[0];
+  // Indices can not have a stride in glTF, the check is for hand-made files
+  return is_float_vec3(&p->positions) and p->positions.has_bounds and p->has_normals and is_float_vec3(&p->normals) and
+         p->has_indices and p->indices.stride is component_size(p->indices.component_type) and
+         glb_accessor_span(&p->positions) + glb_accessor_span(&p->normals) < INT_MAX and
+         glb_accessor_span(&p->indices) < INT_MAX;
+}
+
+FloatArray16 glb_placement(const GlbPrimitive* primitive) {
+  const float* world = primitive->world;
+  const GlbAccessor* positions = &primitive->positions;
+
+  // The lowest file y of the transformed corners of the bounds, exact while
+  // the nodes do not rotate the model
+  float lowest = FLT_MAX;
+  for (int corner = 0; corner < 8; corner++) {
+    float y = world[7];
+    for (int j = 0; j < 3; j++) y += world[4 + j] * (corner & (1 << j) ? positions->max[j] : positions->min[j]);
+    if (y < lowest) lowest = y;
+  }
+
+  // Rows of the world matrix in display order, z x y
+  static const int ROWS[4] = {2, 0, 1, 3};
+  FloatArray16 result;
+  for (int r = 0; r < 4; r++)
+    for (int c = 0; c < 4; c++) result.data[r * 4 + c] = world[ROWS[r] * 4 + c];
+  result.data[2 * 4 + 3] -= lowest;
+  return result;
+}
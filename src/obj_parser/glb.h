@@ -0,0 +1,73 @@
+#ifndef GLB_H_
+#define GLB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../s21_matrix/s21_matrix.h"
+#include "../util/mapped_file.h"
+
+/**
+ * Binary glTF 2.0: a JSON chunk describing the scene and a BIN chunk with
+ * the vertex data. glb_open walks the default scene and describes every
+ * triangle primitive by where its data lies in the mapped file, nothing is
+ * decoded. mesh_import_glb turns that into MeshData, mesh_from_glb uploads
+ * the bytes as they are stored when glb_is_gpu_ready.
+ */
+
+// glTF uses the OpenGL enum values for component types, they go to GL as is
+#define GLB_BYTE 5120
+#define GLB_UNSIGNED_BYTE 5121
+#define GLB_SHORT 5122
+#define GLB_UNSIGNED_SHORT 5123
+#define GLB_UNSIGNED_INT 5125
+#define GLB_FLOAT 5126
+
+typedef struct GlbAccessor {
+  const char* data;  // the first element, in the mapped file
+  size_t count;
+  size_t stride;     // bytes from one element to the next
+  int component_type;
+  int components;    // 1 for SCALAR, 3 for VEC3
+  bool normalized;
+  bool has_bounds;
+  float min[3], max[3];
+} GlbAccessor;
+
+typedef struct GlbPrimitive {
+  GlbAccessor positions, normals, indices;
+  bool has_normals, has_indices;
+  // Node transforms down to the primitive, row-major like FloatArray16, in
+  // the axes of the file
+  float world[16];
+} GlbPrimitive;
+
+#define VECTOR_H GlbPrimitive
+#include "../util/vector.h"  // vec_GlbPrimitive
+
+typedef struct GlbFile {
+  MappedFile file;
+  vec_GlbPrimitive primitives;
+} GlbFile;
+
+// False for a file that is not GLB 2.0, refers to external buffers, has
+// sparse accessors, or ranges and indices out of bounds. Primitives other
+// than triangle lists are skipped
+bool glb_open(const char* path, GlbFile* out);
+void glb_close(GlbFile* glb);
+
+// Reads element i of the accessor as floats, normalized integers scaled
+// to [-1, 1] or [0, 1]
+void glb_read_floats(const GlbAccessor* accessor, size_t i, float* out);
+unsigned glb_read_index(const GlbAccessor* accessor, size_t i);
+// Bytes from data to the end of the last element
+size_t glb_accessor_span(const GlbAccessor* accessor);
+
+// One primitive with float positions and normals and unsigned indices, so
+// the file bytes can be drawn without conversion
+bool glb_is_gpu_ready(const GlbFile* glb);
+// Takes positions of the primitive, as stored, to the display axes of
+// MeshData: the node transforms, file (x, y, z) drawn as (z, x, y), and the
+// bottom of the position bounds at z = 0
+FloatArray16 glb_placement(const GlbPrimitive* primitive);
+
+#endif // GLB_H_
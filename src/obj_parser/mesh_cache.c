@@ -0,0 +1,131 @@
+#include "mesh_cache.h"
+#include <stdio.h>
+#include <string.h>
+#include "../util/allocator.h"
+#include "../util/better_string.h"
+#include "../util/prettify_c.h"
+
+#define MESH_CACHE_ALIGN 64
+#define MESH_CACHE_BYTE_ORDER 0x01020304u
+
+static uint64_t align_offset(uint64_t offset) {
+  return (offset + MESH_CACHE_ALIGN - 1) / MESH_CACHE_ALIGN * MESH_CACHE_ALIGN;
+}
+
+static bool write_padded(FILE* file, const void* data, size_t size, uint64_t* offset) {
+  static const char ZEROS[MESH_CACHE_ALIGN] = {0};
+  uint64_t padding = align_offset(*offset) - *offset;
+  bool ok = fwrite(ZEROS, 1, padding, file) is padding and
+            (size is 0 or fwrite(data, 1, size, file) is size);
+  *offset += padding + size;
+  return ok;
+}
+
+bool mesh_cache_write(const MeshData* data, const char* path) {
+  MeshCacheHeader header = {
+    .version = MESH_CACHE_VERSION,
+    .byte_order = MESH_CACHE_BYTE_ORDER,
+    .stride = MESH_DATA_STRIDE,
+    .floats_count = data->vertices.length,
+    .indices_count = data->indices.length,
+  };
+  memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+  header.floats_offset = align_offset(sizeof(header));
+  header.indices_offset = align_offset(header.floats_offset + header.floats_count * sizeof(float));
+
+  str_t temp_path = str_owned("%s.tmp", path);
+  FILE* file = fopen(temp_path.string, "wb");
+  bool ok = file is_not null;
+  if (ok) {
+    uint64_t offset = 0;
+    ok = write_padded(file, &header, sizeof(header), &offset);
+    ok = ok and write_padded(file, data->vertices.data, header.floats_count * sizeof(float), &offset);
+    ok = ok and write_padded(file, data->indices.data, header.indices_count * sizeof(int), &offset);
+    ok = fclose(file) is 0 and ok;
+    ok = ok and rename(temp_path.string, path) is 0;
+    if (not ok) remove(temp_path.string);
+  }
+
+  str_free(temp_path);
+  return ok;
+}
+
+bool mesh_cache_is_cache(const char* path) {
+  char magic[sizeof(MESH_CACHE_MAGIC) - 1];
+  FILE* file = fopen(path, "rb");
+  if (file is null) return false;
+  bool ok = fread(magic, 1, sizeof(magic), file) is sizeof(magic);
+  fclose(file);
+  return ok and memcmp(magic, MESH_CACHE_MAGIC, sizeof(magic)) is 0;
+}
+
+// An array of count 4-byte items at offset lies inside the file
+static bool fits(const MappedFile* file, uint64_t offset, uint64_t count) {
+  return offset % MESH_CACHE_ALIGN is 0 and offset <= file->size and
+         count <= (file->size - offset) / 4;
+}
+
+static bool header_is_valid(const MappedFile* file, const MeshCacheHeader* header) {
+  return file->size >= sizeof(MeshCacheHeader) and
+         memcmp(header->magic, MESH_CACHE_MAGIC, sizeof(header->magic)) is 0 and
+         header->version is MESH_CACHE_VERSION and
+         header->byte_order is MESH_CACHE_BYTE_ORDER and
+         header->stride is MESH_DATA_STRIDE and
+         header->floats_count % MESH_DATA_STRIDE is 0 and
+         header->indices_count % 3 is 0 and
+         fits(file, header->floats_offset, header->floats_count) and
+         fits(file, header->indices_offset, header->indices_count);
+}
+
+bool mesh_cache_map(const char* path, MeshCacheView* out) {
+  MappedFile file;
+  if (not mapped_file_open(path, &file)) return false;
+
+  const MeshCacheHeader* header = (const MeshCacheHeader*)file.data;
+  if (not header_is_valid(&file, header)) {
+    mapped_file_close(&file);
+    return false;
+  }
+
+  MeshCacheView view = {
+    .file = file,
+    .vertices = (const float*)(file.data + header->floats_offset),
+    .indices = (const int*)(file.data + header->indices_offset),
+    .floats_count = header->floats_count,
+    .indices_count = header->indices_count,
+  };
+
+  int vertices_count = (int)(view.floats_count / MESH_DATA_STRIDE);
+  for (size_t i = 0; i < view.indices_count; i++) {
+    if (view.indices[i] < 0 or view.indices[i] >= vertices_count) {
+      mapped_file_close(&file);
+      return false;
+    }
+  }
+
+  *out = view;
+  return true;
+}
+
+void mesh_cache_unmap(MeshCacheView* view) {
+  mapped_file_close(&view->file);
+  *view = (MeshCacheView) {0};
+}
+
+bool mesh_cache_read(const char* path, MeshData* out) {
+  MeshCacheView view;
+  if (not mesh_cache_map(path, &view)) return false;
+
+  AllocTag old_tag = alloc_tag_set(ALLOC_TAG_MESH);
+  MeshData data = {
+    .vertices = vec_float_with_capacity(view.floats_count),
+    .indices = vec_int_with_capacity(view.indices_count),
+  };
+  vec_float_push_n(&data.vertices, view.vertices, view.floats_count);
+  vec_int_push_n(&data.indices, view.indices, view.indices_count);
+  alloc_tag_set(old_tag);
+
+  mesh_cache_unmap(&view);
+  *out = data;
+  return true;
+}
@@ -0,0 +1,50 @@
+#ifndef MESH_CACHE_H_
+#define MESH_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../util/mapped_file.h"
+#include "mesh_data.h"
+
+/**
+ * Binary mesh cache: MeshData as it is in memory, behind a fixed header, so
+ * loading it is a mapping and a copy instead of parsing text. Vertices and
+ * indices start at 64-byte aligned offsets. The cache is written in the byte
+ * order of the machine and is rejected by one with the other order.
+ */
+
+#define MESH_CACHE_MAGIC "3DVMESH\n"
+#define MESH_CACHE_VERSION 1
+#define MESH_CACHE_EXTENSION "mesh"
+
+typedef struct MeshCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;  // 0x01020304 written natively
+  uint32_t stride;      // floats per vertex, MESH_DATA_STRIDE
+  uint32_t reserved;
+  uint64_t floats_count, indices_count;
+  uint64_t floats_offset, indices_offset;
+} MeshCacheHeader;
+
+// Points into the mapped file, valid until mesh_cache_unmap
+typedef struct MeshCacheView {
+  MappedFile file;
+  const float* vertices;
+  const int* indices;
+  size_t floats_count, indices_count;
+} MeshCacheView;
+
+// Writes into a temporary file next to path and renames it over path, so an
+// interrupted run never leaves a cut cache that looks up to date
+bool mesh_cache_write(const MeshData* data, const char* path);
+
+// Checks only the magic
+bool mesh_cache_is_cache(const char* path);
+// False if the file is not a valid cache, including indices out of range
+bool mesh_cache_map(const char* path, MeshCacheView* out);
+void mesh_cache_unmap(MeshCacheView* view);
+// Maps and copies into vectors owned by the caller
+bool mesh_cache_read(const char* path, MeshData* out);
+
+#endif // MESH_CACHE_H_
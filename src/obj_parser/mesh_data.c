@@ -0,0 +1,100 @@
+#include "mesh_data.h"
+#include "../util/allocator.h"
+#include "../util/jobs.h"
+#include <float.h>
+#include <string.h>
+
+// Vertices per job when filling the vertex buffer
+#define VERTICES_PER_JOB (1 << 15)
+
+typedef struct VertexFillJob {
+  const Vertex* src;
+  float* dest;
+  float lowest_y;
+} VertexFillJob;
+
+static void fill_vertices(void* ctx, size_t begin, size_t end);
+static int index_to_id(FaceIndex index, vec_float* vertices, const vec_Normal* norm_src);
+
+static float find_lowest_y(const vec_Vertex* vertices) {
+  float lowest_y = FLT_MAX;
+  
+  for (size_t i = 0; i < vertices->length; i++)
+    if (vertices->data[i].y < lowest_y)
+      lowest_y = vertices->data[i].y;
+
+  return lowest_y;
+}
+
+MeshData obj_model_to_mesh_data(const ObjModel* model) {
+  AllocTag old_tag = alloc_tag_set(ALLOC_TAG_MESH);
+  float lowest_y = find_lowest_y(&model->vertices);
+
+  // Both sizes are known up front, so neither vector reallocates. Every
+  // vertex owns its 6 floats, so they are filled in parallel, with the model
+  // bottom placed at z = 0 right away
+  vec_float vertices = vec_float_with_capacity(model->vertices.length * MESH_DATA_STRIDE);
+  vec_float_resize_uninit(&vertices, model->vertices.length * MESH_DATA_STRIDE);
+  VertexFillJob fill = {model->vertices.data, vertices.data, lowest_y};
+  parallel_for(0, model->vertices.length, VERTICES_PER_JOB, fill_vertices, &fill);
+
+  size_t triangles_count = 0;
+  for (size_t f = 0; f < model->faces.length; f++)
+    if (model->faces.data[f].indices.length >= 3)
+      triangles_count += model->faces.data[f].indices.length - 2;
+
+  vec_int indices = vec_int_with_capacity(triangles_count * 3);
+
+  for (size_t f = 0; f < model->faces.length; f++) {
+    const Face* face = &model->faces.data[f];
+    assert_m(face->indices.length >= 3);
+
+    #define INDEX_TO_ID(i) index_to_id(face->indices.data[i], &vertices, &model->normals) 
+    int start_id = INDEX_TO_ID(0);
+    int mid_id = INDEX_TO_ID(1);
+    for (size_t i = 2; i < face->indices.length; i++) {
+      int cur_id = INDEX_TO_ID(i);
+      int triangle[] = {start_id, mid_id, cur_id};
+      vec_int_push_n(&indices, triangle, 3);
+      mid_id = cur_id;
+    }
+    #undef INDEX_TO_ID
+  }
+
+  alloc_tag_set(old_tag);
+  return (MeshData) {.vertices = vertices, .indices = indices};
+}
+
+void mesh_data_free(MeshData data) {
+  vec_float_free(data.vertices);
+  vec_int_free(data.indices);
+}
+
+static int index_to_id(FaceIndex index, vec_float* vertices, const vec_Normal* norm_src) {
+  int id = index.point - 1;
+  
+  if (index.normal >= 1) {
+    assert_m(id >= 0 and vertices->length >= (size_t)id * 6 + 6);
+    Normal n = norm_src->data[index.normal - 1];
+    vertices->data[id * 6 + 3] = n.z;
+    vertices->data[id * 6 + 4] = n.x;
+    vertices->data[id * 6 + 5] = n.y;
+  }
+
+  return id;
+}
+
+static void fill_vertices(void* ctx, size_t begin, size_t end) {
+  const VertexFillJob* job = ctx;
+  Normal normal = {0, 1, 0};
+
+  for (size_t i = begin; i < end; i++) {
+    Vertex vertex = job->src[i];
+    // We swap cuz we have different axes positions
+    float data[] = {
+        vertex.z, vertex.x, vertex.y - job->lowest_y,
+        normal.z, normal.x, normal.y,
+    };
+    memcpy(job->dest + i * 6, data, sizeof(data));
+  }
+}
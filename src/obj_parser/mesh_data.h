@@ -0,0 +1,20 @@
+#ifndef MESH_DATA_H_
+#define MESH_DATA_H_
+
+#include "../util/common_vecs.h"
+#include "obj_parser.h"
+
+// Floats per vertex: position, then normal
+#define MESH_DATA_STRIDE 6
+
+// CPU-side copy of what obj_model_to_mesh uploads: vertices in display axes
+// (file z, x, y) with the model bottom at z = 0, and 0-based triangles
+typedef struct MeshData {
+  vec_float vertices;
+  vec_int indices;
+} MeshData;
+
+MeshData obj_model_to_mesh_data(const ObjModel* model);
+void mesh_data_free(MeshData data);
+
+#endif // MESH_DATA_H_
@@ -0,0 +1,349 @@
+#define _POSIX_C_SOURCE 200809L  // fileno
+
+#include "mesh_export.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../util/allocator.h"
+#include "../util/better_io.h"
+#include "../util/better_io/fmt_number.h"
+#include "../util/jobs.h"
+#include "../util/prettify_c.h"
+
+// Vertices or triangles formatted by one job
+#define EXPORT_CHUNK_ITEMS 4096
+// Chunks formatted at once per thread. Their buffers are reused for the
+// whole file, so memory does not grow with the model
+#define EXPORT_CHUNKS_PER_THREAD 2
+
+#define OBJ_FLOATS_LINE_MAX (3 + 3 * (FMT_NUMBER_MAX + 1) + 1)
+#define OBJ_FACE_LINE_MAX (2 + 3 * (2 * FMT_NUMBER_MAX + 3) + 1)
+#define PLY_VERTEX_SIZE (6 * 4)
+#define PLY_FACE_SIZE (1 + 3 * 4)
+#define STL_HEADER_SIZE 80
+#define STL_TRIANGLE_SIZE 50
+
+typedef struct ExportMesh {
+  // Transformed, still in display axes, MESH_DATA_STRIDE floats per vertex
+  const float* vertices;
+  const int* indices;
+  size_t vertices_count, triangles_count;
+  bool flip_winding;
+} ExportMesh;
+
+// Writes one vertex or triangle into out, returns the size written
+typedef size_t (*FormatItemFn)(const ExportMesh* mesh, size_t item, char* out);
+
+typedef struct ExportSection {
+  FormatItemFn format;
+  size_t items_count;
+  size_t max_item_size;
+} ExportSection;
+
+typedef struct ChunkBatch {
+  const ExportMesh* mesh;
+  const ExportSection* section;
+  size_t first_item;
+  char* buffers;  // chunk c starts at c * chunk_capacity
+  size_t chunk_capacity;
+  size_t* lengths;
+} ChunkBatch;
+
+const char* mesh_export_extension(MeshExportFormat format) {
+  static const char* const EXTENSIONS[] = {"obj", "ply", "stl"};
+  assert_m(format >= 0 and format < MESH_EXPORT_FORMAT_COUNT);
+  return EXTENSIONS[format];
+}
+
+// Display axes are (file z, file x, file y), see obj_model_to_mesh_data
+static void get_position(const ExportMesh* mesh, size_t vertex, float out[3]) {
+  const float* v = mesh->vertices + vertex * MESH_DATA_STRIDE;
+  out[0] = v[1];
+  out[1] = v[2];
+  out[2] = v[0];
+}
+
+static void normalize(float v[3]) {
+  float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  if (length > 0)
+    for (int i = 0; i < 3; i++) v[i] /= length;
+}
+
+static void get_normal(const ExportMesh* mesh, size_t vertex, float out[3]) {
+  const float* v = mesh->vertices + vertex * MESH_DATA_STRIDE + 3;
+  out[0] = v[1];
+  out[1] = v[2];
+  out[2] = v[0];
+  normalize(out);
+}
+
+static void get_triangle(const ExportMesh* mesh, size_t triangle, int out[3]) {
+  const int* t = mesh->indices + triangle * 3;
+  out[0] = t[0];
+  out[1] = mesh->flip_winding ? t[2] : t[1];
+  out[2] = mesh->flip_winding ? t[1] : t[2];
+}
+
+// Binary formats are little-endian whatever the machine is
+static char* put_u32_le(char* out, uint32_t value) {
+  for (int i = 0; i < 4; i++) out[i] = (char)(value >> (8 * i));
+  return out + 4;
+}
+
+static char* put_f32_le(char* out, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return put_u32_le(out, bits);
+}
+
+static char* put_floats_line(char* out, const char* prefix, const float v[3]) {
+  size_t prefix_length = strlen(prefix);
+  memcpy(out, prefix, prefix_length);
+  out += prefix_length;
+  for (int i = 0; i < 3; i++) {
+    *out++ = ' ';
+    out += fmt_float_shortest(out, v[i]);
+  }
+  *out++ = '\n';
+  return out;
+}
+
+static size_t format_obj_vertex(const ExportMesh* mesh, size_t item, char* out) {
+  float position[3];
+  get_position(mesh, item, position);
+  return put_floats_line(out, "v", position) - out;
+}
+
+static size_t format_obj_normal(const ExportMesh* mesh, size_t item, char* out) {
+  float normal[3];
+  get_normal(mesh, item, normal);
+  return put_floats_line(out, "vn", normal) - out;
+}
+
+// Every vertex has its own normal, so both indices are the same
+static size_t format_obj_face(const ExportMesh* mesh, size_t item, char* out) {
+  int ids[3];
+  get_triangle(mesh, item, ids);
+  char* start = out;
+  *out++ = 'f';
+  for (int i = 0; i < 3; i++) {
+    *out++ = ' ';
+    out += fmt_u64(out, (uint64_t)ids[i] + 1);
+    *out++ = '/';
+    *out++ = '/';
+    out += fmt_u64(out, (uint64_t)ids[i] + 1);
+  }
+  *out++ = '\n';
+  return out - start;
+}
+
+static size_t format_ply_vertex(const ExportMesh* mesh, size_t item, char* out) {
+  float position[3], normal[3];
+  get_position(mesh, item, position);
+  get_normal(mesh, item, normal);
+  char* start = out;
+  for (int i = 0; i < 3; i++) out = put_f32_le(out, position[i]);
+  for (int i = 0; i < 3; i++) out = put_f32_le(out, normal[i]);
+  return out - start;
+}
+
+static size_t format_ply_face(const ExportMesh* mesh, size_t item, char* out) {
+  int ids[3];
+  get_triangle(mesh, item, ids);
+  char* start = out;
+  *out++ = 3;
+  for (int i = 0; i < 3; i++) out = put_u32_le(out, (uint32_t)ids[i]);
+  return out - start;
+}
+
+static size_t format_stl_triangle(const ExportMesh* mesh, size_t item, char* out) {
+  int ids[3];
+  float p[3][3];
+  get_triangle(mesh, item, ids);
+  for (int i = 0; i < 3; i++) get_position(mesh, ids[i], p[i]);
+
+  // Counter-clockwise seen from outside, zero for a degenerate triangle
+  float a[3], b[3];
+  for (int i = 0; i < 3; i++) {
+    a[i] = p[1][i] - p[0][i];
+    b[i] = p[2][i] - p[0][i];
+  }
+  float normal[3] = {
+      a[1] * b[2] - a[2] * b[1],
+      a[2] * b[0] - a[0] * b[2],
+      a[0] * b[1] - a[1] * b[0],
+  };
+  normalize(normal);
+
+  char* start = out;
+  for (int i = 0; i < 3; i++) out = put_f32_le(out, normal[i]);
+  for (int v = 0; v < 3; v++)
+    for (int i = 0; i < 3; i++) out = put_f32_le(out, p[v][i]);
+  *out++ = 0;  // attribute byte count
+  *out++ = 0;
+  return out - start;
+}
+
+static void format_chunks(void* ctx, size_t begin, size_t end) {
+  const ChunkBatch* batch = ctx;
+  const ExportSection* section = batch->section;
+
+  for (size_t chunk = begin; chunk < end; chunk++) {
+    size_t first = batch->first_item + chunk * EXPORT_CHUNK_ITEMS;
+    size_t last = first + EXPORT_CHUNK_ITEMS;
+    if (last > section->items_count) last = section->items_count;
+
+    char* out = batch->buffers + chunk * batch->chunk_capacity;
+    size_t length = 0;
+    for (size_t item = first; item < last; item++)
+      length += section->format(batch->mesh, item, out + length);
+    batch->lengths[chunk] = length;
+  }
+}
+
+// Formats a few chunks per thread at a time, then writes them in file order
+static void write_section(const ExportMesh* mesh, const ExportSection* section, ChunkBatch* batch, size_t chunks_count, OutStream stream) {
+  batch->section = section;
+  size_t batch_items = chunks_count * EXPORT_CHUNK_ITEMS;
+
+  for (size_t first = 0; first < section->items_count; first += batch_items) {
+    size_t items = section->items_count - first;
+    if (items > batch_items) items = batch_items;
+    size_t chunks = (items + EXPORT_CHUNK_ITEMS - 1) / EXPORT_CHUNK_ITEMS;
+
+    batch->mesh = mesh;
+    batch->first_item = first;
+    parallel_for(0, chunks, 1, format_chunks, batch);
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+      outstream_put_slice(batch->buffers + chunk * batch->chunk_capacity, batch->lengths[chunk], stream);
+  }
+}
+
+static void write_header(const ExportMesh* mesh, MeshExportFormat format, OutStream stream) {
+  long vertices = (long)mesh->vertices_count;
+  long triangles = (long)mesh->triangles_count;
+
+  if (format is MESH_EXPORT_OBJ) {
+    x_sprintf(stream, "# 3D Viewer export: %ld vertices, %ld triangles\n", vertices, triangles);
+  } else if (format is MESH_EXPORT_PLY) {
+    x_sprintf(stream,
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "comment 3D Viewer export\n"
+      "element vertex %ld\n"
+      "property float x\nproperty float y\nproperty float z\n"
+      "property float nx\nproperty float ny\nproperty float nz\n"
+      "element face %ld\n"
+      "property list uchar int vertex_indices\n"
+      "end_header\n", vertices, triangles);
+  } else {
+    char header[STL_HEADER_SIZE + 4] = "3D Viewer export";
+    put_u32_le(header + STL_HEADER_SIZE, (uint32_t)triangles);
+    outstream_put_slice(header, sizeof(header), stream);
+  }
+}
+
+// The cofactor matrix of the upper 3x3 is the inverse transpose times the
+// determinant, so it turns normals the right way without dividing by it
+static matrix_t normal_matrix(const matrix_t* transform, double* out_det) {
+  double** m = transform->matrix;
+  matrix_t result;
+  assert_m(s21_create_matrix(4, 4, &result) is OK);
+
+  for (int r = 0; r < 3; r++)
+    for (int c = 0; c < 3; c++)
+      result.matrix[r][c] = m[(r + 1) % 3][(c + 1) % 3] * m[(r + 2) % 3][(c + 2) % 3] -
+                            m[(r + 1) % 3][(c + 2) % 3] * m[(r + 2) % 3][(c + 1) % 3];
+  result.matrix[3][3] = 1;
+
+  *out_det = 0;
+  for (int c = 0; c < 3; c++) *out_det += m[0][c] * result.matrix[0][c];
+  // Mirrored: the cofactors point inwards
+  if (*out_det < 0)
+    for (int r = 0; r < 3; r++)
+      for (int c = 0; c < 3; c++) result.matrix[r][c] = -result.matrix[r][c];
+
+  return result;
+}
+
+static bool indices_are_valid(const MeshData* data) {
+  int vertices_count = (int)(data->vertices.length / MESH_DATA_STRIDE);
+  for (size_t i = 0; i < data->indices.length; i++)
+    if (data->indices.data[i] < 0 or data->indices.data[i] >= vertices_count)
+      return false;
+  return true;
+}
+
+bool mesh_export(const MeshData* data, const matrix_t* transform, MeshExportFormat format, const char* path) {
+  if (format < 0 or format >= MESH_EXPORT_FORMAT_COUNT) return false;
+  if (transform and (not s21_is_matrix_valid(transform) or transform->rows is_not 4 or transform->columns is_not 4))
+    return false;
+  if (not indices_are_valid(data)) return false;
+
+  FILE* file = fopen(path, "wb");
+  if (file is null) return false;
+
+  size_t vertices_count = data->vertices.length / MESH_DATA_STRIDE;
+  size_t floats_size = vertices_count * MESH_DATA_STRIDE * sizeof(float);
+  float* vertices = huge_malloc(floats_size ? floats_size : 1);
+  assert_alloc(vertices);
+  if (floats_size) memcpy(vertices, data->vertices.data, floats_size);
+
+  ExportMesh mesh = {
+    .vertices = vertices,
+    .indices = data->indices.data,
+    .vertices_count = vertices_count,
+    .triangles_count = data->indices.length / 3,
+  };
+
+  if (transform and vertices_count) {
+    double det;
+    matrix_t normals = normal_matrix(transform, &det);
+    s21_transform_points(transform, vertices, vertices, vertices_count, MESH_DATA_STRIDE);
+    s21_transform_points(&normals, vertices + 3, vertices + 3, vertices_count, MESH_DATA_STRIDE);
+    s21_remove_matrix(&normals);
+    mesh.flip_winding = det < 0;
+  }
+
+  ExportSection sections[3];
+  size_t sections_count = 0;
+  if (format is MESH_EXPORT_OBJ) {
+    sections[sections_count++] = (ExportSection) {format_obj_vertex, vertices_count, OBJ_FLOATS_LINE_MAX};
+    sections[sections_count++] = (ExportSection) {format_obj_normal, vertices_count, OBJ_FLOATS_LINE_MAX};
+    sections[sections_count++] = (ExportSection) {format_obj_face, mesh.triangles_count, OBJ_FACE_LINE_MAX};
+  } else if (format is MESH_EXPORT_PLY) {
+    sections[sections_count++] = (ExportSection) {format_ply_vertex, vertices_count, PLY_VERTEX_SIZE};
+    sections[sections_count++] = (ExportSection) {format_ply_face, mesh.triangles_count, PLY_FACE_SIZE};
+  } else {
+    sections[sections_count++] = (ExportSection) {format_stl_triangle, mesh.triangles_count, STL_TRIANGLE_SIZE};
+  }
+
+  size_t max_item_size = 0;
+  for (size_t i = 0; i < sections_count; i++)
+    if (sections[i].max_item_size > max_item_size)
+      max_item_size = sections[i].max_item_size;
+
+  size_t chunks_count = (size_t)(jobs_worker_count() + 1) * EXPORT_CHUNKS_PER_THREAD;
+  ChunkBatch batch = {
+    .chunk_capacity = max_item_size * EXPORT_CHUNK_ITEMS,
+    .lengths = MALLOC(chunks_count * sizeof(size_t)),
+  };
+  batch.buffers = huge_malloc(chunks_count * batch.chunk_capacity);
+  assert_alloc(batch.lengths);
+  assert_alloc(batch.buffers);
+
+  BufferedOutStream buffered = buffered_outstream_create(fileno(file), 0);
+  OutStream stream = outstream_from_buffered(&buffered);
+  write_header(&mesh, format, stream);
+  for (size_t i = 0; i < sections_count; i++)
+    write_section(&mesh, &sections[i], &batch, chunks_count, stream);
+
+  bool ok = buffered_outstream_free(&buffered);
+  ok = fclose(file) is 0 and ok;
+
+  huge_free(batch.buffers);
+  FREE(batch.lengths);
+  huge_free(vertices);
+  return ok;
+}
@@ -0,0 +1,26 @@
+#ifndef MESH_EXPORT_H_
+#define MESH_EXPORT_H_
+
+#include <stdbool.h>
+#include "../s21_matrix/s21_matrix.h"
+#include "mesh_data.h"
+
+typedef enum MeshExportFormat {
+  MESH_EXPORT_OBJ,  // text, v / vn / f lines
+  MESH_EXPORT_PLY,  // binary, positions, normals and triangles
+  MESH_EXPORT_STL,  // binary, triangles with their face normal
+  MESH_EXPORT_FORMAT_COUNT,
+} MeshExportFormat;
+
+// "obj", "ply", "stl"
+const char* mesh_export_extension(MeshExportFormat format);
+
+// Writes the mesh with transform (a 4x4 object matrix in display axes, as
+// drawn, or null for none) baked into positions and normals, in the axes of
+// the OBJ file it came from. Mirroring transforms keep the triangles facing
+// outwards. The text or records are built in parallel chunks and written in
+// order. Returns false if the file can not be written or the mesh has
+// indices out of range
+bool mesh_export(const MeshData* data, const matrix_t* transform, MeshExportFormat format, const char* path);
+
+#endif // MESH_EXPORT_H_
@@ -0,0 +1,664 @@
+#include "mesh_import.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../util/allocator.h"
+#include "../util/dir_walk.h"
+#include "../util/jobs.h"
+#include "../util/mapped_file.h"
+#include "../util/prettify_c.h"
+#include "glb.h"
+#include "mesh_cache.h"
+
+// Vertices or triangles decoded by one job
+#define ITEMS_PER_CHUNK (1 << 14)
+#define STL_HEADER_SIZE 80
+#define STL_TRIANGLE_SIZE 50
+#define PLY_MAX_ELEMENTS 16
+#define PLY_MAX_PROPERTIES 24
+#define PLY_NAME_MAX 32
+#define PLY_LINE_MAX 256
+
+typedef enum PlyType {
+  PLY_INT8,
+  PLY_UINT8,
+  PLY_INT16,
+  PLY_UINT16,
+  PLY_INT32,
+  PLY_UINT32,
+  PLY_FLOAT32,
+  PLY_FLOAT64,
+  PLY_TYPE_COUNT,
+} PlyType;
+
+static const struct {
+  const char* name;
+  const char* alias;
+  size_t size;
+} PLY_TYPES[PLY_TYPE_COUNT] = {
+  [PLY_INT8] = {"char", "int8", 1},
+  [PLY_UINT8] = {"uchar", "uint8", 1},
+  [PLY_INT16] = {"short", "int16", 2},
+  [PLY_UINT16] = {"ushort", "uint16", 2},
+  [PLY_INT32] = {"int", "int32", 4},
+  [PLY_UINT32] = {"uint", "uint32", 4},
+  [PLY_FLOAT32] = {"float", "float32", 4},
+  [PLY_FLOAT64] = {"double", "float64", 8},
+};
+
+typedef struct PlyProperty {
+  char name[PLY_NAME_MAX];
+  PlyType type;  // of the items, for a list
+  bool is_list;
+  PlyType count_type;
+  size_t offset;  // in the record, meaningful while no list comes before
+} PlyProperty;
+
+typedef struct PlyElement {
+  char name[PLY_NAME_MAX];
+  uint64_t count;
+  PlyProperty properties[PLY_MAX_PROPERTIES];
+  int properties_count;
+  bool has_lists;
+  size_t record_size;  // of the records without lists
+} PlyElement;
+
+typedef struct PlyHeader {
+  bool is_big_endian;
+  PlyElement elements[PLY_MAX_ELEMENTS];
+  int elements_count;
+  size_t body_offset;
+} PlyHeader;
+
+// x y z, then nx ny nz
+typedef struct PlyVertexJob {
+  const char* records;
+  size_t record_size, count;
+  bool is_big_endian;
+  bool is_float_le;  // every field a float32 in a little-endian file
+  bool has_normals;
+  size_t offsets[6];
+  PlyType types[6];
+  float* dest;
+  float* chunk_lows;
+} PlyVertexJob;
+
+typedef struct StlJob {
+  const char* triangles;
+  size_t count;
+  float* dest;
+  int* indices;
+  float* chunk_lows;
+} StlJob;
+
+typedef struct GlbVertexJob {
+  const GlbPrimitive* primitive;
+  float normal_matrix[9];  // row-major
+  float* dest;             // the first vertex of the primitive
+  float* chunk_lows;
+} GlbVertexJob;
+
+typedef struct FloorJob {
+  float* vertices;
+  float lowest;
+} FloorJob;
+
+static uint32_t get_u32_le(const char* p) {
+  const unsigned char* b = (const unsigned char*)p;
+  return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+// A plain load on little-endian machines
+static float get_f32_le(const char* p) {
+  uint32_t bits = get_u32_le(p);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// A scalar of the given type, in the byte order of the file
+static double ply_read(const char* p, PlyType type, bool is_big_endian) {
+  const unsigned char* b = (const unsigned char*)p;
+  size_t size = PLY_TYPES[type].size;
+  uint64_t bits = 0;
+  for (size_t i = 0; i < size; i++)
+    bits |= (uint64_t)b[is_big_endian ? size - 1 - i : i] << (8 * i);
+
+  switch (type) {
+    case PLY_INT8: return (int8_t)bits;
+    case PLY_UINT8: return (uint8_t)bits;
+    case PLY_INT16: return (int16_t)bits;
+    case PLY_UINT16: return (uint16_t)bits;
+    case PLY_INT32: return (int32_t)bits;
+    case PLY_UINT32: return (uint32_t)bits;
+    case PLY_FLOAT32: {
+      uint32_t bits32 = (uint32_t)bits;
+      float value;
+      memcpy(&value, &bits32, sizeof(value));
+      return value;
+    }
+    default: {
+      double value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+  }
+}
+
+MeshFileFormat mesh_file_detect(const char* path) {
+  char head[STL_HEADER_SIZE + 4];
+  FILE* file = fopen(path, "rb");
+  if (file is null) return MESH_FILE_OBJ;
+  size_t length = fread(head, 1, sizeof(head), file);
+  fclose(file);
+
+  FileInfo info;
+  if (length >= sizeof(MESH_CACHE_MAGIC) - 1 and memcmp(head, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC) - 1) is 0)
+    return MESH_FILE_CACHE;
+  if (length >= 4 and memcmp(head, "glTF", 4) is 0)
+    return MESH_FILE_GLB;
+  if (length >= 4 and memcmp(head, "ply", 3) is 0 and (head[3] is '\n' or head[3] is '\r'))
+    return MESH_FILE_PLY;
+  // Binary STL has no magic, but its size follows from the triangle count
+  if (length is sizeof(head) and file_info(path, &info) and
+      info.size is sizeof(head) + (uint64_t)get_u32_le(head + STL_HEADER_SIZE) * STL_TRIANGLE_SIZE)
+    return MESH_FILE_STL;
+  return MESH_FILE_OBJ;
+}
+
+static MeshData mesh_data_uninit(size_t vertices_count, size_t indices_count) {
+  AllocTag old_tag = alloc_tag_set(ALLOC_TAG_MESH);
+  MeshData data = {
+    .vertices = vec_float_with_capacity(vertices_count * MESH_DATA_STRIDE),
+    .indices = vec_int_with_capacity(indices_count),
+  };
+  vec_float_resize_uninit(&data.vertices, vertices_count * MESH_DATA_STRIDE);
+  alloc_tag_set(old_tag);
+  return data;
+}
+
+static size_t chunks_for(size_t count) {
+  return (count + ITEMS_PER_CHUNK - 1) / ITEMS_PER_CHUNK;
+}
+
+static void lower_to_floor(void* ctx, size_t begin, size_t end) {
+  const FloorJob* job = ctx;
+  for (size_t i = begin; i < end; i++) job->vertices[i * MESH_DATA_STRIDE + 2] -= job->lowest;
+}
+
+// Every decoding chunk left the lowest file y it saw, the bottom goes to z = 0
+// like in obj_model_to_mesh_data
+static void place_on_floor(MeshData* data, const float* chunk_lows, size_t chunks_count) {
+  if (chunks_count is 0) return;
+  FloorJob job = {.vertices = data->vertices.data, .lowest = FLT_MAX};
+  for (size_t c = 0; c < chunks_count; c++)
+    if (chunk_lows[c] < job.lowest) job.lowest = chunk_lows[c];
+  parallel_for(0, data->vertices.length / MESH_DATA_STRIDE, ITEMS_PER_CHUNK, lower_to_floor, &job);
+}
+
+static void cross(const float a[3], const float b[3], const float c[3], float out[3]) {
+  float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+  out[0] = e1[1] * e2[2] - e1[2] * e2[1];
+  out[1] = e1[2] * e2[0] - e1[0] * e2[2];
+  out[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static void normalize(float v[3]) {
+  float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  if (length > 0)
+    for (int i = 0; i < 3; i++) v[i] /= length;
+}
+
+// ---------------------------------------------------------------- PLY
+
+static bool parse_ply_type(const char* name, PlyType* out) {
+  for (int t = 0; t < PLY_TYPE_COUNT; t++) {
+    if (strcmp(name, PLY_TYPES[t].name) is 0 or strcmp(name, PLY_TYPES[t].alias) is 0) {
+      *out = (PlyType)t;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool parse_ply_property(const char* line, PlyElement* element) {
+  if (element is null or element->properties_count is PLY_MAX_PROPERTIES) return false;
+  PlyProperty* property = &element->properties[element->properties_count++];
+  char count_type[PLY_NAME_MAX], type[PLY_NAME_MAX];
+
+  if (sscanf(line, "property list %31s %31s %31s", count_type, type, property->name) is 3) {
+    property->is_list = true;
+    element->has_lists = true;
+    return parse_ply_type(count_type, &property->count_type) and parse_ply_type(type, &property->type);
+  }
+  if (sscanf(line, "property %31s %31s", type, property->name) is_not 2) return false;
+  property->offset = element->record_size;
+  if (not parse_ply_type(type, &property->type)) return false;
+  element->record_size += PLY_TYPES[property->type].size;
+  return true;
+}
+
+static bool parse_ply_header(const char* data, size_t size, PlyHeader* out) {
+  memset(out, 0, sizeof(*out));
+  bool has_format = false;
+  PlyElement* element = null;
+  const char* end = data + size;
+
+  for (const char* p = data; p < end;) {
+    const char* line_end = memchr(p, '\n', end - p);
+    if (line_end is null) return false;
+    char line[PLY_LINE_MAX];
+    size_t length = line_end - p < PLY_LINE_MAX ? (size_t)(line_end - p) : PLY_LINE_MAX - 1;
+    memcpy(line, p, length);
+    if (length > 0 and line[length - 1] is '\r') length--;
+    line[length] = '\0';
+    p = line_end + 1;
+
+    unsigned long long count;
+    char name[PLY_NAME_MAX];
+    if (strcmp(line, "end_header") is 0) {
+      out->body_offset = p - data;
+      return has_format;
+    } else if (strncmp(line, "format ", 7) is 0) {
+      // ASCII is left to converters, scanners write binary
+      has_format = strncmp(line, "format binary_little_endian ", 28) is 0 or
+                   strncmp(line, "format binary_big_endian ", 25) is 0;
+      if (not has_format) return false;
+      out->is_big_endian = line[14] is 'b';
+    } else if (sscanf(line, "element %31s %llu", name, &count) is 2) {
+      if (out->elements_count is PLY_MAX_ELEMENTS) return false;
+      element = &out->elements[out->elements_count++];
+      strcpy(element->name, name);
+      element->count = count;
+    } else if (strncmp(line, "property ", 9) is 0) {
+      if (not parse_ply_property(line, element)) return false;
+    }
+  }
+  return false;
+}
+
+static const PlyProperty* find_ply_property(const PlyElement* element, const char* name) {
+  for (int i = 0; i < element->properties_count; i++)
+    if (strcmp(element->properties[i].name, name) is 0) return &element->properties[i];
+  return null;
+}
+
+// Bytes a record of element takes at the least, with every list empty
+static size_t ply_min_record_size(const PlyElement* element) {
+  size_t size = element->record_size;
+  for (int i = 0; i < element->properties_count; i++)
+    if (element->properties[i].is_list) size += PLY_TYPES[element->properties[i].count_type].size;
+  return size;
+}
+
+// Whether body_size bytes can hold the records of every element, so the
+// counts in the header can be allocated for
+static bool ply_counts_fit(const PlyHeader* header, size_t body_size) {
+  for (int e = 0; e < header->elements_count; e++) {
+    const PlyElement* element = &header->elements[e];
+    size_t min_size = ply_min_record_size(element);
+    if (min_size is 0) continue;
+    if (body_size / min_size < element->count) return false;
+    body_size -= element->count * min_size;
+  }
+  return true;
+}
+
+// Walks the records of element from p. With indices, fans of the list
+// property faces_list go there. Returns where the records end, or null if
+// they run past end or an index is out of range
+static const char* walk_ply_element(const PlyElement* element, const char* p, const char* end, bool is_big_endian,
+                                    const PlyProperty* faces_list, int vertices_count, vec_int* indices) {
+  if (not element->has_lists) {
+    if (element->record_size > 0 and (uint64_t)(end - p) / element->record_size < element->count) return null;
+    return p + element->count * element->record_size;
+  }
+
+  for (uint64_t r = 0; r < element->count; r++) {
+    for (int i = 0; i < element->properties_count; i++) {
+      const PlyProperty* property = &element->properties[i];
+      size_t item_size = PLY_TYPES[property->type].size;
+      if (not property->is_list) {
+        if ((size_t)(end - p) < item_size) return null;
+        p += item_size;
+        continue;
+      }
+
+      size_t count_size = PLY_TYPES[property->count_type].size;
+      if ((size_t)(end - p) < count_size) return null;
+      double items = ply_read(p, property->count_type, is_big_endian);
+      p += count_size;
+      if (items < 0 or items > (double)(size_t)(end - p) / item_size) return null;
+
+      size_t items_count = (size_t)items;
+      if (property is faces_list and items_count >= 3) {
+        int ids[3];
+        for (size_t k = 0; k < items_count; k++) {
+          double id = ply_read(p + k * item_size, property->type, is_big_endian);
+          if (id < 0 or id >= vertices_count) return null;
+          // Fan: (0, 1, 2), (0, 2, 3), ...
+          ids[k < 2 ? k : 2] = (int)id;
+          if (k >= 2) {
+            vec_int_push_n(indices, ids, 3);
+            ids[1] = ids[2];
+          }
+        }
+      }
+      p += items_count * item_size;
+    }
+  }
+  return p;
+}
+
+static void decode_ply_vertices(void* ctx, size_t begin, size_t end) {
+  const PlyVertexJob* job = ctx;
+  int fields = job->has_normals ? 6 : 3;
+
+  for (size_t c = begin; c < end; c++) {
+    size_t first = c * ITEMS_PER_CHUNK;
+    size_t last = first + ITEMS_PER_CHUNK < job->count ? first + ITEMS_PER_CHUNK : job->count;
+    float lowest = FLT_MAX;
+
+    for (size_t i = first; i < last; i++) {
+      const char* record = job->records + i * job->record_size;
+      float v[6] = {0};
+      if (job->is_float_le) {
+        for (int f = 0; f < fields; f++) v[f] = get_f32_le(record + job->offsets[f]);
+      } else {
+        for (int f = 0; f < fields; f++)
+          v[f] = (float)ply_read(record + job->offsets[f], job->types[f], job->is_big_endian);
+      }
+
+      // Display axes, as in obj_model_to_mesh_data
+      float* dest = job->dest + i * MESH_DATA_STRIDE;
+      float swapped[] = {v[2], v[0], v[1], v[5], v[3], v[4]};
+      memcpy(dest, swapped, sizeof(swapped));
+      if (v[1] < lowest) lowest = v[1];
+    }
+    job->chunk_lows[c] = lowest;
+  }
+}
+
+// Area-weighted sums of the normals of the faces around every vertex from
+// first_vertex on, which start at 0, over the triangles from first_index on.
+// The display axes are a rotation of the file ones, so the cross product
+// works in them as well
+static void compute_normals(MeshData* data, size_t first_vertex, size_t first_index) {
+  float* v = data->vertices.data;
+  size_t vertices_count = data->vertices.length / MESH_DATA_STRIDE;
+  for (size_t i = first_index; i + 2 < data->indices.length; i += 3) {
+    const int* t = data->indices.data + i;
+    float normal[3];
+    cross(v + t[0] * MESH_DATA_STRIDE, v + t[1] * MESH_DATA_STRIDE, v + t[2] * MESH_DATA_STRIDE, normal);
+    for (int k = 0; k < 3; k++)
+      for (int j = 0; j < 3; j++) v[t[k] * MESH_DATA_STRIDE + 3 + j] += normal[j];
+  }
+
+  for (size_t i = first_vertex; i < vertices_count; i++) {
+    float* normal = v + i * MESH_DATA_STRIDE + 3;
+    // A vertex on no face points up, like OBJ vertices without a normal
+    if (normal[0] is 0 and normal[1] is 0 and normal[2] is 0) normal[2] = 1;
+    normalize(normal);
+  }
+}
+
+static bool import_ply(const char* data, size_t size, MeshData* out) {
+  PlyHeader header;
+  if (not parse_ply_header(data, size, &header)) return false;
+
+  const PlyElement* vertices = null;
+  const char* vertices_start = null;
+  const char* p = data + header.body_offset;
+  const char* end = data + size;
+  for (int e = 0; e < header.elements_count; e++)
+    if (strcmp(header.elements[e].name, "vertex") is 0) vertices = &header.elements[e];
+  if (vertices is null or vertices->has_lists or vertices->count > INT_MAX) return false;
+  if (not ply_counts_fit(&header, size - header.body_offset)) return false;
+
+  static const char* const FIELDS[] = {"x", "y", "z", "nx", "ny", "nz"};
+  PlyVertexJob job = {
+    .record_size = vertices->record_size,
+    .count = vertices->count,
+    .is_big_endian = header.is_big_endian,
+    .is_float_le = not header.is_big_endian,
+    .has_normals = true,
+  };
+  for (int f = 0; f < 6; f++) {
+    const PlyProperty* property = find_ply_property(vertices, FIELDS[f]);
+    if (property is null and f < 3) return false;
+    if (property is null) {
+      job.has_normals = false;
+      break;
+    }
+    job.offsets[f] = property->offset;
+    job.types[f] = property->type;
+    job.is_float_le = job.is_float_le and property->type is PLY_FLOAT32;
+  }
+
+  // Faces are read as they come, vertices decoded once their place is known
+  *out = mesh_data_uninit(vertices->count, 0);
+  bool ok = true;
+  for (int e = 0; e < header.elements_count and ok; e++) {
+    const PlyElement* element = &header.elements[e];
+    const PlyProperty* faces_list = null;
+    if (element is vertices) {
+      vertices_start = p;
+    } else if (strcmp(element->name, "face") is 0) {
+      faces_list = find_ply_property(element, "vertex_indices");
+      if (faces_list is null) faces_list = find_ply_property(element, "vertex_index");
+      if (faces_list and not faces_list->is_list) faces_list = null;
+      // Faces with fewer than three items add no triangle, the count only
+      // bounds how many there can be
+      if (faces_list) {
+        size_t face_min_size = ply_min_record_size(element) + 3 * PLY_TYPES[faces_list->type].size;
+        size_t faces_fit = (size_t)(end - p) / face_min_size;
+        vec_int_reserve(&out->indices, (element->count < faces_fit ? element->count : faces_fit) * 3);
+      }
+    }
+    p = walk_ply_element(element, p, end, header.is_big_endian, faces_list, (int)vertices->count, &out->indices);
+    ok = p is_not null;
+  }
+
+  if (ok) {
+    size_t chunks_count = chunks_for(job.count);
+    float* chunk_lows = MALLOC(sizeof(float) * (chunks_count + 1));
+    assert_alloc(chunk_lows);
+    job.records = vertices_start;
+    job.dest = out->vertices.data;
+    job.chunk_lows = chunk_lows;
+    parallel_for(0, chunks_count, 1, decode_ply_vertices, &job);
+    place_on_floor(out, chunk_lows, chunks_count);
+    FREE(chunk_lows);
+    if (not job.has_normals) compute_normals(out, 0, 0);
+  } else {
+    mesh_data_free(*out);
+  }
+  return ok;
+}
+
+bool mesh_import_ply(const char* path, MeshData* out) {
+  MappedFile file;
+  if (not mapped_file_open(path, &file)) return false;
+  bool ok = file.data and import_ply(file.data, file.size, out);
+  mapped_file_close(&file);
+  return ok;
+}
+
+// ---------------------------------------------------------------- STL
+
+static void decode_stl_triangles(void* ctx, size_t begin, size_t end) {
+  const StlJob* job = ctx;
+
+  for (size_t c = begin; c < end; c++) {
+    size_t first = c * ITEMS_PER_CHUNK;
+    size_t last = first + ITEMS_PER_CHUNK < job->count ? first + ITEMS_PER_CHUNK : job->count;
+    float lowest = FLT_MAX;
+
+    for (size_t t = first; t < last; t++) {
+      // Normal, 3 vertices, 2 bytes of attributes
+      const char* record = job->triangles + t * STL_TRIANGLE_SIZE;
+      float normal[3], points[3][3];
+      for (int j = 0; j < 3; j++) normal[j] = get_f32_le(record + j * 4);
+      for (int k = 0; k < 3; k++)
+        for (int j = 0; j < 3; j++) points[k][j] = get_f32_le(record + 12 + k * 12 + j * 4);
+      if (normal[0] is 0 and normal[1] is 0 and normal[2] is 0) cross(points[0], points[1], points[2], normal);
+      normalize(normal);
+
+      for (int k = 0; k < 3; k++) {
+        float* dest = job->dest + (t * 3 + k) * MESH_DATA_STRIDE;
+        float swapped[] = {points[k][2], points[k][0], points[k][1], normal[2], normal[0], normal[1]};
+        memcpy(dest, swapped, sizeof(swapped));
+        job->indices[t * 3 + k] = (int)(t * 3 + k);
+        if (points[k][1] < lowest) lowest = points[k][1];
+      }
+    }
+    job->chunk_lows[c] = lowest;
+  }
+}
+
+static bool import_stl(const char* data, size_t size, MeshData* out) {
+  if (size < STL_HEADER_SIZE + 4) return false;
+  size_t count = get_u32_le(data + STL_HEADER_SIZE);
+  if ((size - STL_HEADER_SIZE - 4) / STL_TRIANGLE_SIZE < count or count > INT_MAX / 3) return false;
+
+  *out = mesh_data_uninit(count * 3, count * 3);
+  vec_int_resize_uninit(&out->indices, count * 3);
+  size_t chunks_count = chunks_for(count);
+  float* chunk_lows = MALLOC(sizeof(float) * (chunks_count + 1));
+  assert_alloc(chunk_lows);
+
+  StlJob job = {
+    .triangles = data + STL_HEADER_SIZE + 4,
+    .count = count,
+    .dest = out->vertices.data,
+    .indices = out->indices.data,
+    .chunk_lows = chunk_lows,
+  };
+  parallel_for(0, chunks_count, 1, decode_stl_triangles, &job);
+  place_on_floor(out, chunk_lows, chunks_count);
+  FREE(chunk_lows);
+  return true;
+}
+
+bool mesh_import_stl(const char* path, MeshData* out) {
+  MappedFile file;
+  if (not mapped_file_open(path, &file)) return false;
+  bool ok = file.data and import_stl(file.data, file.size, out);
+  mapped_file_close(&file);
+  return ok;
+}
+
+// ---------------------------------------------------------------- GLB
+
+// Normals go through the cofactors of the world matrix, the inverse
+// transpose scaled by the determinant. A mirroring world flips them, the
+// sign of the determinant flips them back
+static float normal_matrix(const float world[16], float out[9]) {
+  const float* w = world;
+  float c0[3] = {w[0], w[4], w[8]}, c1[3] = {w[1], w[5], w[9]}, c2[3] = {w[2], w[6], w[10]};
+  const float zero[3] = {0, 0, 0};
+  float columns[3][3];
+  cross(zero, c1, c2, columns[0]);
+  cross(zero, c2, c0, columns[1]);
+  cross(zero, c0, c1, columns[2]);
+  float det = c0[0] * columns[0][0] + c0[1] * columns[0][1] + c0[2] * columns[0][2];
+  float sign = det < 0 ? -1 : 1;
+  for (int r = 0; r < 3; r++)
+    for (int k = 0; k < 3; k++) out[r * 3 + k] = sign * columns[k][r];
+  return det;
+}
+
+static void decode_glb_vertices(void* ctx, size_t begin, size_t end) {
+  const GlbVertexJob* job = ctx;
+  const GlbPrimitive* primitive = job->primitive;
+  const float* w = primitive->world;
+  const float* m = job->normal_matrix;
+  size_t count = primitive->positions.count;
+
+  for (size_t c = begin; c < end; c++) {
+    size_t first = c * ITEMS_PER_CHUNK;
+    size_t last = first + ITEMS_PER_CHUNK < count ? first + ITEMS_PER_CHUNK : count;
+    float lowest = FLT_MAX;
+
+    for (size_t i = first; i < last; i++) {
+      float p[3], n[3] = {0, 0, 0}, world[3], normal[3] = {0, 0, 0};
+      glb_read_floats(&primitive->positions, i, p);
+      for (int r = 0; r < 3; r++) world[r] = w[r * 4] * p[0] + w[r * 4 + 1] * p[1] + w[r * 4 + 2] * p[2] + w[r * 4 + 3];
+      if (primitive->has_normals) {
+        glb_read_floats(&primitive->normals, i, n);
+        for (int r = 0; r < 3; r++) normal[r] = m[r * 3] * n[0] + m[r * 3 + 1] * n[1] + m[r * 3 + 2] * n[2];
+        normalize(normal);
+      }
+
+      float* dest = job->dest + i * MESH_DATA_STRIDE;
+      float swapped[] = {world[2], world[0], world[1], normal[2], normal[0], normal[1]};
+      memcpy(dest, swapped, sizeof(swapped));
+      if (world[1] < lowest) lowest = world[1];
+    }
+    job->chunk_lows[c] = lowest;
+  }
+}
+
+// Every primitive, with its node transforms baked in, becomes a part of one
+// MeshData. Primitives without normals get computed ones, without indices
+// their vertices are taken in order
+static bool import_glb(const GlbFile* glb, MeshData* out) {
+  size_t vertices_count = 0, indices_count = 0, chunks_count = 0;
+  for (size_t p = 0; p < glb->primitives.length; p++) {
+    const GlbPrimitive* primitive = &glb->primitives.data[p];
+    size_t count = primitive->has_indices ? primitive->indices.count : primitive->positions.count;
+    vertices_count += primitive->positions.count;
+    indices_count += count - count % 3;
+    chunks_count += chunks_for(primitive->positions.count);
+  }
+  if (vertices_count > INT_MAX or indices_count > INT_MAX) return false;
+
+  *out = mesh_data_uninit(vertices_count, indices_count);
+  float* chunk_lows = MALLOC(sizeof(float) * (chunks_count + 1));
+  assert_alloc(chunk_lows);
+  size_t first_vertex = 0, first_chunk = 0;
+
+  for (size_t p = 0; p < glb->primitives.length; p++) {
+    const GlbPrimitive* primitive = &glb->primitives.data[p];
+    size_t first_index = out->indices.length;
+    GlbVertexJob job = {
+      .primitive = primitive,
+      .dest = out->vertices.data + first_vertex * MESH_DATA_STRIDE,
+      .chunk_lows = chunk_lows + first_chunk,
+    };
+    // Mirrored triangles keep facing out with two corners swapped
+    bool is_mirrored = normal_matrix(primitive->world, job.normal_matrix) < 0;
+    size_t chunks = chunks_for(primitive->positions.count);
+    parallel_for(0, chunks, 1, decode_glb_vertices, &job);
+
+    size_t count = primitive->has_indices ? primitive->indices.count : primitive->positions.count;
+    for (size_t i = 0; i + 2 < count; i += 3) {
+      int triangle[3];
+      for (int k = 0; k < 3; k++) {
+        size_t id = primitive->has_indices ? glb_read_index(&primitive->indices, i + k) : i + k;
+        triangle[is_mirrored and k > 0 ? 3 - k : k] = (int)(first_vertex + id);
+      }
+      vec_int_push_n(&out->indices, triangle, 3);
+    }
+    if (not primitive->has_normals) compute_normals(out, first_vertex, first_index);
+
+    first_vertex += primitive->positions.count;
+    first_chunk += chunks;
+  }
+
+  place_on_floor(out, chunk_lows, chunks_count);
+  FREE(chunk_lows);
+  return true;
+}
+
+bool mesh_import_glb(const char* path, MeshData* out) {
+  GlbFile glb;
+  if (not glb_open(path, &glb)) return false;
+  bool ok = import_glb(&glb, out);
+  glb_close(&glb);
+  return ok;
+}
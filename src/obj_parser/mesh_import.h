@@ -0,0 +1,41 @@
+#ifndef MESH_IMPORT_H_
+#define MESH_IMPORT_H_
+
+#include <stdbool.h>
+#include "mesh_data.h"
+
+/**
+ * Loaders for the binary formats scanners write, so they need no conversion
+ * to OBJ text first. They give the same MeshData as obj_model_to_mesh_data,
+ * in display axes with the model bottom at z = 0. The file is read through a
+ * mapping and its records are decoded in parallel chunks.
+ */
+
+typedef enum MeshFileFormat {
+  MESH_FILE_OBJ,    // anything not recognized below, parsed as OBJ text
+  MESH_FILE_CACHE,  // from 3dviewer-convert, see mesh_cache.h
+  MESH_FILE_PLY,
+  MESH_FILE_STL,    // binary
+  MESH_FILE_GLB,    // binary glTF, see glb.h
+} MeshFileFormat;
+
+// By the first bytes of the file, not by its extension. OBJ for a file that
+// can not be read, so the caller reports it the usual way
+MeshFileFormat mesh_file_detect(const char* path);
+
+// Binary PLY, little or big endian: vertex x y z of any scalar type, with nx
+// ny nz if present, and polygon faces, triangulated as fans. Other elements
+// and properties are skipped. Normals missing from the file are computed
+// from the faces. False for ASCII PLY, a truncated file or indices out of
+// range
+bool mesh_import_ply(const char* path, MeshData* out);
+
+// Binary STL. Triangles keep their own 3 vertices with the facet normal, or
+// the normal of the triangle if the facet one is zero
+bool mesh_import_stl(const char* path, MeshData* out);
+
+// Binary glTF: the triangles of every mesh in the default scene, placed by
+// their nodes. False where glb_open is
+bool mesh_import_glb(const char* path, MeshData* out);
+
+#endif // MESH_IMPORT_H_
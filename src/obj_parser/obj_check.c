@@ -0,0 +1,418 @@
+#include "obj_check.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../util/block_stream.h"
+#include "../util/common_vecs.h"
+#include "../util/dir_walk.h"
+#include "../util/prettify_c.h"
+#include "mesh_data.h"
+#include "obj_parser.h"
+#include "obj_stats.h"
+
+typedef uint64_t u64;
+typedef uint32_t u32;
+
+static inline u64 edge_key_identity(u64 key) { return key; }
+
+#define HASHMAP_K u64
+#define HASHMAP_V u32
+#define HASHMAP_NAME EdgeCounts
+#define HASHMAP_HASH edge_key_identity
+#include "../util/hashmap.h"
+
+// Spilled edges are split by hash into this many temporary files, so that
+// each one is counted with a table of about 1 / EDGE_PARTITIONS the size
+#define EDGE_PARTITION_BITS 6
+#define EDGE_PARTITIONS (1 << EDGE_PARTITION_BITS)
+#define EDGE_TABLE_MIN_ENTRIES 64
+// A face is flat when twice its area is below this share of its longest
+// edge squared, which is as close to zero as float positions get
+#define DEGENERATE_AREA_RATIO 1e-7
+// Forward indices of one kind held in memory, more go to a temporary file
+#define FORWARD_PENDING_MAX (1 << 16)
+
+enum { INDEX_POINT, INDEX_TEXTURE, INDEX_NORMAL, INDEX_KINDS };
+
+typedef struct Checker {
+  ObjCheck* out;
+  // Of the first max_positions vertices only, the budget allows no more
+  vec_Vertex positions;
+  size_t max_positions;
+  // 0-based vertices of the face being read, -1 where out of range
+  vec_int corners;
+  // Positive indices past the lines read so far, which are checked against
+  // the counts at the end. Those the lines since have reached are dropped
+  // when the vector fills, the rest go to a temporary file
+  vec_int forward[INDEX_KINDS];
+  FILE* forward_spills[INDEX_KINDS];
+
+  EdgeCounts edges;
+  size_t max_edges;  // entries the budget allows
+  FILE* partitions[EDGE_PARTITIONS];
+  bool is_spilling;
+} Checker;
+
+static bool is_blank(char c) { return c is ' ' or c is '\t' or c is '\r'; }
+static bool is_digit(char c) { return c >= '0' and c <= '9'; }
+
+static size_t edge_table_bytes(const EdgeCounts* edges) {
+  return edges->capacity * (sizeof(EdgeCounts_Entry) + sizeof(uint8_t));
+}
+
+static void note_memory(Checker* checker) {
+  u64 bytes = checker->positions.capacity * sizeof(Vertex) + edge_table_bytes(&checker->edges) +
+              BLOCK_STREAM_BLOCKS * BLOCK_STREAM_BLOCK_SIZE;
+  for (int kind = 0; kind < INDEX_KINDS; kind++) bytes += checker->forward[kind].capacity * sizeof(int);
+  if (bytes > checker->out->peak_bytes) checker->out->peak_bytes = bytes;
+}
+
+// ---------------------------------------------------------------- Edges
+
+static bool open_partitions(Checker* checker) {
+  for (int i = 0; i < EDGE_PARTITIONS; i++) {
+    checker->partitions[i] = tmpfile();
+    if (checker->partitions[i] is null) {
+      for (int j = 0; j < i; j++) fclose(checker->partitions[j]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Moves the table out to the partitions, each edge with the count so far
+static void spill_edges(Checker* checker) {
+  if (not checker->is_spilling) {
+    if (not open_partitions(checker)) {
+      // No room for temporary files: the table grows past the budget
+      checker->max_edges = SIZE_MAX;
+      return;
+    }
+    checker->is_spilling = true;
+    checker->out->has_spilled_edges = true;
+  }
+  size_t iter = 0;
+  for (EdgeCounts_Entry* entry; (entry = EdgeCounts_next(&checker->edges, &iter));) {
+    FILE* file = checker->partitions[hash_u64(entry->key) >> (64 - EDGE_PARTITION_BITS)];
+    fwrite(&entry->key, sizeof(entry->key), 1, file);
+    fwrite(&entry->value, sizeof(entry->value), 1, file);
+  }
+  EdgeCounts_clear(&checker->edges);
+}
+
+static void add_edge_count(EdgeCounts* edges, u64 key, u32 count) {
+  u32* value = EdgeCounts_get_or_insert(edges, key, 0, null);
+  *value = *value > UINT32_MAX - count ? UINT32_MAX : *value + count;
+}
+
+static void add_edge(Checker* checker, int a, int b) {
+  if (a < 0 or b < 0 or a is b) return;
+  u64 key = a < b ? (u64)a << 32 | (u64)b : (u64)b << 32 | (u64)a;
+  if (checker->edges.length >= checker->max_edges and
+      EdgeCounts_get(&checker->edges, key) is null)
+    spill_edges(checker);
+  add_edge_count(&checker->edges, key, 1);
+}
+
+static void tally_edges(const EdgeCounts* edges, ObjCheck* out) {
+  size_t iter = 0;
+  for (EdgeCounts_Entry* entry; (entry = EdgeCounts_next(edges, &iter));) {
+    out->edges_count++;
+    out->boundary_edges += entry->value is 1;
+    out->non_manifold_edges += entry->value > 2;
+  }
+}
+
+// Every edge lands in one partition, so each is counted on its own
+static void finish_edges(Checker* checker) {
+  if (not checker->is_spilling) {
+    tally_edges(&checker->edges, checker->out);
+    return;
+  }
+  spill_edges(checker);
+  for (int i = 0; i < EDGE_PARTITIONS; i++) {
+    FILE* file = checker->partitions[i];
+    rewind(file);
+    u64 key;
+    u32 count;
+    while (fread(&key, sizeof(key), 1, file) is 1 and fread(&count, sizeof(count), 1, file) is 1)
+      add_edge_count(&checker->edges, key, count);
+    note_memory(checker);
+    tally_edges(&checker->edges, checker->out);
+    EdgeCounts_clear(&checker->edges);
+    fclose(file);
+  }
+}
+
+// ---------------------------------------------------------------- Lines
+
+// Reads an index like "12" or "-3", false when there are no digits. Past
+// INT32_MAX it stops growing, which is out of range either way
+static bool parse_index(const char** at, const char* end, int64_t* out) {
+  const char* p = *at;
+  bool negative = p < end and *p is '-';
+  if (p < end and (*p is '-' or *p is '+')) p++;
+  if (p is end or not is_digit(*p)) return false;
+  // 64 bits, long has only 32 on Windows
+  int64_t value = 0;
+  for (; p < end and is_digit(*p); p++)
+    if (value <= INT32_MAX) value = value * 10 + (*p - '0');
+  *out = negative ? -value : value;
+  *at = p;
+  return true;
+}
+
+static uint64_t kind_count(const ObjCheck* out, int kind) {
+  return kind is INDEX_POINT     ? out->vertices_count
+         : kind is INDEX_TEXTURE ? out->texture_coords_count
+                                 : out->normals_count;
+}
+
+static void spill_forward(Checker* checker, int kind) {
+  vec_int* pending = &checker->forward[kind];
+  if (checker->forward_spills[kind] is null) checker->forward_spills[kind] = tmpfile();
+  // No room for a temporary file: the vector grows past the budget
+  if (checker->forward_spills[kind] is null) return;
+  fwrite(pending->data, sizeof(int), pending->length, checker->forward_spills[kind]);
+  pending->length = 0;
+}
+
+static void add_forward(Checker* checker, int kind, int index) {
+  vec_int* pending = &checker->forward[kind];
+  if (pending->length is pending->capacity and pending->length >= FORWARD_PENDING_MAX) {
+    // Whatever comes later, these are in range
+    u64 count = kind_count(checker->out, kind);
+    size_t kept = 0;
+    for (size_t i = 0; i < pending->length; i++)
+      if ((u64)pending->data[i] > count) pending->data[kept++] = pending->data[i];
+    pending->length = kept;
+    if (kept > FORWARD_PENDING_MAX / 2) spill_forward(checker, kind);
+  }
+  vec_int_push(pending, index);
+}
+
+static u64 count_out_of_range(const vec_int* indices, u64 count) {
+  u64 result = 0;
+  for (size_t i = 0; i < indices->length; i++) result += (u64)indices->data[i] > count;
+  return result;
+}
+
+// Reads the spilled indices back through the vector, a vector full at a time
+static void finish_forward(Checker* checker, int kind) {
+  vec_int* pending = &checker->forward[kind];
+  FILE* file = checker->forward_spills[kind];
+  u64 count = kind_count(checker->out, kind);
+  checker->out->out_of_range_indices += count_out_of_range(pending, count);
+  if (file is null) return;
+  rewind(file);
+  while ((pending->length = fread(pending->data, sizeof(int), pending->capacity, file)) > 0)
+    checker->out->out_of_range_indices += count_out_of_range(pending, count);
+  fclose(file);
+}
+
+// As OBJ counts them: from 1, or back from the last line read when negative.
+// Returns the 0-based index, -1 if it points at no line
+static int resolve_index(Checker* checker, int kind, int64_t index) {
+  int64_t count = (int64_t)kind_count(checker->out, kind);
+  if (index > 0 and index <= INT32_MAX) {
+    // Most readers accept lines that come later, the end tells
+    if (index > count) add_forward(checker, kind, (int)index);
+    return (int)(index - 1);
+  }
+  if (index < 0 and -index <= count) return (int)(count + index);
+  checker->out->out_of_range_indices++;
+  return -1;
+}
+
+// Twice the area of the polygon, by Newell's method, against its longest
+// edge. False if a corner is not known yet, or is past the kept positions
+static bool is_flat(const Checker* checker) {
+  const vec_int* corners = &checker->corners;
+  double normal[3] = {0, 0, 0}, longest = 0;
+  for (size_t i = 0; i < corners->length; i++) {
+    int a = corners->data[i], b = corners->data[(i + 1) % corners->length];
+    if ((size_t)a >= checker->positions.length or (size_t)b >= checker->positions.length) {
+      size_t last = (size_t)(a > b ? a : b);
+      if (last < checker->out->vertices_count) checker->out->has_unchecked_areas = true;
+      return false;
+    }
+    Vertex p = checker->positions.data[a], q = checker->positions.data[b];
+    normal[0] += ((double)p.y - q.y) * ((double)p.z + q.z);
+    normal[1] += ((double)p.z - q.z) * ((double)p.x + q.x);
+    normal[2] += ((double)p.x - q.x) * ((double)p.y + q.y);
+    double dx = (double)p.x - q.x, dy = (double)p.y - q.y, dz = (double)p.z - q.z;
+    double length = dx * dx + dy * dy + dz * dz;
+    if (length > longest) longest = length;
+  }
+  double area = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+  return area <= DEGENERATE_AREA_RATIO * longest;
+}
+
+static bool is_degenerate(const Checker* checker) {
+  const vec_int* corners = &checker->corners;
+  if (corners->length < 3) return true;
+  for (size_t i = 0; i < corners->length; i++) {
+    if (corners->data[i] < 0) return false;  // counted as out of range
+    for (size_t j = i + 1; j < corners->length; j++)
+      if (corners->data[i] is corners->data[j]) return true;
+  }
+  return is_flat(checker);
+}
+
+// Corners like "v", "v/vt", "v/vt/vn" or "v//vn"
+static void check_face(Checker* checker, const char* p, const char* end) {
+  ObjCheck* out = checker->out;
+  out->faces_count++;
+  checker->corners.length = 0;
+  for (;;) {
+    while (p < end and is_blank(*p)) p++;
+    if (p is end) break;
+
+    int64_t indices[INDEX_KINDS] = {0, 0, 0};
+    bool has[INDEX_KINDS] = {false, false, false};
+    has[INDEX_POINT] = parse_index(&p, end, &indices[INDEX_POINT]);
+    for (int kind = INDEX_TEXTURE; has[INDEX_POINT] and kind < INDEX_KINDS and p < end and *p is '/'; kind++) {
+      p++;
+      has[kind] = parse_index(&p, end, &indices[kind]);
+    }
+    if (not has[INDEX_POINT] or (p < end and not is_blank(*p))) {
+      out->bad_lines++;
+      return;
+    }
+    vec_int_push(&checker->corners, resolve_index(checker, INDEX_POINT, indices[INDEX_POINT]));
+    for (int kind = INDEX_TEXTURE; kind < INDEX_KINDS; kind++)
+      if (has[kind]) resolve_index(checker, kind, indices[kind]);
+  }
+
+  size_t count = checker->corners.length;
+  out->degenerate_faces += is_degenerate(checker);
+  if (count >= 3) out->triangles_count += count - 2;
+  out->parsed_bytes += sizeof(Face) + count * sizeof(FaceIndex);
+  if (count >= 3) {
+    for (size_t i = 0; i < count; i++)
+      add_edge(checker, checker->corners.data[i], checker->corners.data[(i + 1) % count]);
+    note_memory(checker);
+  }
+}
+
+static void check_vertex(Checker* checker, const char* p, const char* end) {
+  ObjCheck* out = checker->out;
+  float v[3];
+  bool is_read = true;
+  for (int i = 0; i < 3 and is_read; i++) {
+    while (p < end and is_blank(*p)) p++;
+    const char* next = obj_stats_parse_float(p, end, &v[i]);
+    // A number too large for a float reads as inf, which nothing can draw
+    is_read = next is_not p and isfinite(v[i]);
+    p = next;
+  }
+  out->vertices_count++;
+  out->parsed_bytes += sizeof(Vertex);
+  if (is_read) {
+    for (int i = 0; i < 3; i++) {
+      if (v[i] < out->min[i]) out->min[i] = v[i];
+      if (v[i] > out->max[i]) out->max[i] = v[i];
+    }
+  } else {
+    // Still numbered, so the indices after it stay right
+    out->bad_lines++;
+    v[0] = v[1] = v[2] = NAN;
+  }
+
+  vec_Vertex* positions = &checker->positions;
+  if (positions->length >= checker->max_positions) return;
+  // Doubling would overshoot the budget
+  if (positions->length is positions->capacity and positions->capacity * 2 > checker->max_positions)
+    vec_Vertex_reserve(positions, checker->max_positions);
+  vec_Vertex_push(positions, (Vertex) {v[0], v[1], v[2]});
+  if (positions->length is positions->capacity) note_memory(checker);
+}
+
+// Only that the line has the numbers it needs
+static bool has_numbers(const char* p, const char* end, int count) {
+  for (int i = 0; i < count; i++) {
+    while (p < end and is_blank(*p)) p++;
+    float value;
+    const char* next = obj_stats_parse_float(p, end, &value);
+    if (next is p) return false;
+    p = next;
+  }
+  return true;
+}
+
+static void check_line(void* ctx, char* line, size_t length) {
+  Checker* checker = ctx;
+  ObjCheck* out = checker->out;
+  const char* end = line + length;
+  out->text_bytes += length + 1;
+  if (length < 2) return;
+
+  if (line[0] is 'v' and line[1] is ' ') {
+    check_vertex(checker, line + 2, end);
+  } else if (line[0] is 'f' and line[1] is ' ') {
+    check_face(checker, line + 2, end);
+  } else if (length >= 3 and line[0] is 'v' and line[1] is 'n' and line[2] is ' ') {
+    out->normals_count++;
+    out->parsed_bytes += sizeof(Normal);
+    out->bad_lines += not has_numbers(line + 3, end, 3);
+  } else if (length >= 3 and line[0] is 'v' and line[1] is 't' and line[2] is ' ') {
+    out->texture_coords_count++;
+    out->bad_lines += not has_numbers(line + 3, end, 1);
+  }
+}
+
+// ---------------------------------------------------------------- Check
+
+static size_t max_edges_for(size_t budget) {
+  size_t entry_bytes = sizeof(EdgeCounts_Entry) + sizeof(uint8_t);
+  size_t capacity = 1;
+  while (capacity * 2 * entry_bytes <= budget) capacity *= 2;
+  size_t entries = capacity / 8 * HASHMAP_MAX_LOAD_8THS;
+  return entries > EDGE_TABLE_MIN_ENTRIES ? entries : EDGE_TABLE_MIN_ENTRIES;
+}
+
+bool obj_check_file(const char* path, size_t edge_budget, ObjCheck* out) {
+  *out = (ObjCheck) {
+    .min = {FLT_MAX, FLT_MAX, FLT_MAX},
+    .max = {-FLT_MAX, -FLT_MAX, -FLT_MAX},
+  };
+  FileInfo info;
+  BlockStream* stream = file_info(path, &info) ? block_stream_open(path) : null;
+  if (stream is null) return false;
+  out->file_bytes = info.size;
+
+  Checker checker = {
+    .out = out,
+    .positions = vec_Vertex_create(),
+    .max_positions = edge_budget / sizeof(Vertex),
+    .corners = vec_int_create(),
+    .edges = EdgeCounts_create(),
+    .max_edges = max_edges_for(edge_budget),
+  };
+  for (int kind = 0; kind < INDEX_KINDS; kind++) checker.forward[kind] = vec_int_create();
+
+  out->is_truncated = not block_stream_for_each_line(stream, check_line, &checker);
+  block_stream_close(stream);
+
+  note_memory(&checker);
+  for (int kind = 0; kind < INDEX_KINDS; kind++) {
+    finish_forward(&checker, kind);
+    vec_int_free(checker.forward[kind]);
+  }
+  finish_edges(&checker);
+
+  out->mesh_bytes = out->vertices_count * MESH_DATA_STRIDE * sizeof(float) +
+                    out->triangles_count * 3 * sizeof(int);
+  vec_Vertex_free(checker.positions);
+  vec_int_free(checker.corners);
+  EdgeCounts_free(checker.edges);
+  return true;
+}
+
+bool obj_check_has_problems(const ObjCheck* check) {
+  return check->bad_lines > 0 or check->degenerate_faces > 0 or check->out_of_range_indices > 0 or
+         check->non_manifold_edges > 0 or check->is_truncated;
+}
@@ -0,0 +1,58 @@
+#ifndef OBJ_CHECK_H_
+#define OBJ_CHECK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Edge table size an obj_check_file call keeps in memory by default
+#define OBJ_CHECK_EDGE_BUDGET ((size_t)256 << 20)
+
+// What is in an OBJ and what is wrong with it, for validating models in bulk
+typedef struct ObjCheck {
+  uint64_t vertices_count, texture_coords_count, normals_count, faces_count;
+  // The faces fanned into triangles, as the viewer draws them
+  uint64_t triangles_count;
+  // Of the v lines, in file axes. min > max when there are none
+  float min[3], max[3];
+
+  // v, vt, vn and f lines whose numbers do not read, or for v do not fit
+  // in a float
+  uint64_t bad_lines;
+  // Faces with under three corners, one vertex twice or no area
+  uint64_t degenerate_faces;
+  // Face corners pointing at no v, vt or vn line
+  uint64_t out_of_range_indices;
+  // Distinct edges of the faces, those of one face only (the border of an
+  // open surface) and those shared by more than two (non-manifold)
+  uint64_t edges_count, boundary_edges, non_manifold_edges;
+
+  // Bytes of the file as stored, and of its text once decompressed
+  uint64_t file_bytes, text_bytes;
+  // Of the ObjModel obj_parse_model builds, and of the MeshData drawn
+  uint64_t parsed_bytes, mesh_bytes;
+  // The most the check itself held, and whether its edges went through
+  // temporary files to stay within the budget
+  uint64_t peak_bytes;
+  bool has_spilled_edges;
+  // Some faces were not tested for area, their vertices came past the
+  // positions the budget keeps
+  bool has_unchecked_areas;
+  // The file ends early or is corrupt, all above is of what came before
+  bool is_truncated;
+} ObjCheck;
+
+// Reads the file once as a stream, .obj.gz and .obj.zst too, keeping
+// neither the text nor the faces. What stays in memory is an edge table of
+// up to edge_budget bytes and, for the area test, the positions of as many
+// vertices as fit in edge_budget bytes too, 12 bytes each. Past the budget
+// edges are sorted out into temporary files and counted one file at a time,
+// and faces on later vertices are not tested for area. Indices to lines
+// further on are held until the end, in temporary files when there are
+// many. False if the file can not be read
+bool obj_check_file(const char* path, size_t edge_budget, ObjCheck* out);
+
+// Whether the check found anything wrong
+bool obj_check_has_problems(const ObjCheck* check);
+
+#endif  // OBJ_CHECK_H_
@@ -2,8 +2,16 @@
 #define OBJ_MDL_TO_MESH_H_
 
 #include "../ui/mesh.h"
+#include "glb.h"
+#include "mesh_data.h"
 #include "obj_parser.h"
 
+// Frees the model
 Mesh obj_model_to_mesh(ObjModel model);
+// Uploads the data, which stays owned by the caller
+Mesh mesh_from_data(const MeshData* data);
+// Uploads the bytes of the file as they are, for glb_is_gpu_ready files.
+// They stay in file axes, the mesh is drawn with glb_placement
+Mesh mesh_from_glb(const GlbFile* glb);
 
-#endif // OBJ_MDL_TO_MESH_H_
\ No newline at end of file
+#endif // OBJ_MDL_TO_MESH_H_
@@ -3,26 +3,33 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "../util/allocator.h"
 #include "../util/better_io.h"
+#include "../util/block_stream.h"
+#include "../util/dir_walk.h"
 #include "../util/prettify_c.h"
 
 #define VECTOR_C FaceIndex
 #include "../util/vector.h"
 
+// One entry per line of the file, so these grow the largest
 #define VECTOR_C Face
 #define VECTOR_ITEM_DESTRUCTOR face_free
+#define VECTOR_HUGE_ALLOC
 #include "../util/vector.h"
 
 #define VECTOR_C Vertex
+#define VECTOR_HUGE_ALLOC
 #include "../util/vector.h"
 
 #define VECTOR_C Normal
+#define VECTOR_HUGE_ALLOC
 #include "../util/vector.h"
 
 static int scan_type(const char* line);
-static Vertex parse_vertex(const char* line);
+static bool parse_vertex(const char* line, Vertex* vertex);
 
-static vec_FaceIndex parse_indices(const char* line, int cur_vertices_count);
+static bool parse_indices(const char* line, int cur_vertices_count, vec_FaceIndex* indices);
 
 void face_print(const Face* face, OutStream os) {
   for (size_t i = 1; i < (size_t)face->indices.length; i++) {
@@ -39,9 +46,11 @@ void face_free(Face face) { vec_FaceIndex_free(face.indices); }
 #define TYPE3 3
 #define TYPE4 4
 
+// 0 for a token with more than two slashes
+
 static int scan_type(const char* line) {
   int vCount = 0;
-  for (int i = 0; line[i] != ' '; i++) {
+  for (int i = 0; line[i] != ' ' and line[i] != '\0'; i++) {
     if (line[i] == '/') vCount++;
     if (line[i] == '/' and line[i + 1] == '/') return TYPE4;  // type 4
   }
@@ -52,102 +61,153 @@ static int scan_type(const char* line) {
   else if (vCount == 2)
     return TYPE3;  // Type 3
   else
-    panic("Unsupported type");  // Unsupported type
+    return 0;  // Unsupported type
 }
 
 static char* my_strdup(const char* text) {
   size_t len = strlen(text);
-  char* buffer = (char*)malloc((len + 1) * sizeof(char));
+  char* buffer = (char*)MALLOC((len + 1) * sizeof(char));
   strcpy(buffer, text);
   return buffer;
 }
 
-static vec_FaceIndex parse_indices(const char* line, int cur_vertices_count) {
+// False if a token is not a number of the line's index type, or points
+// back past the first vertex
+static bool parse_indices(const char* line, int cur_vertices_count, vec_FaceIndex* indices) {
     int type = 0;
 
     type = scan_type(line);
+    if (type is 0) return false;
+
+    // A face rarely has more than a handful of indices, so count them once
+    // and allocate exactly
+    int tokens_count = 0;
+    for (const char* c = line; *c; c++)
+        if (*c != ' ' and *c != '\n' and *c != '\r' and (c == line or c[-1] == ' '))
+            tokens_count++;
 
-    vec_FaceIndex indices = vec_FaceIndex_create();
+    *indices = vec_FaceIndex_with_capacity(tokens_count);
+    bool is_parsed = true;
     char* line_tmp = my_strdup(line); // дубликат строки тк strtok может уродовать строку и насиловать
     char* token = strtok(line_tmp, " "); // обрезка f 
     
-    while (token != NULL){
-        FaceIndex index;
+    while (token != NULL and is_parsed){
+        FaceIndex index = {0};
 
         if (type is TYPE1){
-            sscanf(token, "%d", &index.point); // it is v
-            index.texture_pos = 0;
-            index.normal = 0;
+            is_parsed = sscanf(token, "%d", &index.point) is 1; // it is v
         } else if (type is TYPE2) {
-            sscanf(token, "%d/%d", &index.point, &index.texture_pos); // it is v/vt
-            index.normal = 0;
+            is_parsed = sscanf(token, "%d/%d", &index.point, &index.texture_pos) is 2; // it is v/vt
         } else if (type is TYPE3) {
-            sscanf(token, "%d/%d/%d", &index.point, &index.texture_pos, &index.normal); // it is v/vt/vn
+            is_parsed = sscanf(token, "%d/%d/%d", &index.point, &index.texture_pos, &index.normal) is 3; // it is v/vt/vn
         } else if (type is TYPE4) {
-            sscanf(token, "%d//%d",  &index.point, &index.normal);// it is v//vn
-            index.texture_pos = 0;
-        } else {
-            panic("Unsupported index type");
+            is_parsed = sscanf(token, "%d//%d",  &index.point, &index.normal) is 2;// it is v//vn
         }
 
-        if (index.point < 0)
-            index.point = ((index.point % cur_vertices_count) + cur_vertices_count) % cur_vertices_count;
+        // -1 is the last vertex read so far
+        if (index.point < 0) {
+            is_parsed = is_parsed and -index.point <= cur_vertices_count;
+            index.point += cur_vertices_count + 1;
+        }
 
-        vec_FaceIndex_push(&indices, index);
+        vec_FaceIndex_push(indices, index);
         token = strtok(NULL, " "); //последовательное извлечение каждого токена
-    } free(line_tmp);
-    return indices; 
+    } FREE(line_tmp);
+    if (not is_parsed) vec_FaceIndex_free(*indices);
+    return is_parsed;
 }
 
-static Vertex parse_vertex(const char* line) {
-  Vertex vertex;
-  if (sscanf(line, "v %f %f %f", &vertex.x, &vertex.y, &vertex.z) == 3) {
-    return vertex;
-  } else {
-    panic("Unsupported vertex format!");
-  }
+static bool parse_vertex(const char* line, Vertex* vertex) {
+  return sscanf(line, "v %f %f %f", &vertex->x, &vertex->y, &vertex->z) == 3;
+}
+
+static bool parse_normal(const char* line, Normal* n) {
+  return sscanf(line, "vn %f %f %f", &n->x, &n->y, &n->z) is 3;
 }
 
-static Normal parse_normal(const char* line) {
-  Normal n;
-  if (sscanf(line, "vn %f %f %f", &n.x, &n.y, &n.z) is 3) {
-    return n;
-  } else {
-    panic("Unsupported vertex format!");
+// A mesh can be built from the face: three corners or more, each at a
+// vertex and a normal there is
+static bool is_face_complete(const Face* face, const ObjModel* model) {
+  if (face->indices.length < 3) return false;
+  for (size_t i = 0; i < face->indices.length; i++) {
+    FaceIndex index = face->indices.data[i];
+    if (index.point < 1 or (size_t)index.point > model->vertices.length) return false;
+    if (index.normal > 0 and (size_t)index.normal > model->normals.length) return false;
   }
+  return true;
 }
 
-ObjModel obj_parse_model(const char* filepath) {
-    vec_Vertex vertices = vec_Vertex_create();
-    vec_Face faces = vec_Face_create();
-    vec_Normal normals = vec_Normal_create();
-
-    FILE *file = fopen(filepath, "r");
-    assert_m(file and "Failed to open file"); 
-
-    char line[10240];
-    while (fgets(line, sizeof(line), file)) {
-        if (line[0] == 'v' && line[1] == ' ') {
-            Vertex v = parse_vertex(line);
-            vec_Vertex_push(&vertices, v);
-        }
-        if (strncmp(line, "vn ", 3) is 0) {
-            Normal n = parse_normal(line);
-            vec_Normal_push(&normals, n);
-        }
-        if (line[0] == 'f' && line[1] == ' ') {
-            vec_FaceIndex indices = parse_indices(line + 2, vertices.length); // +2 to skip 'f '
-            Face face = {.indices = indices};
-            vec_Face_push(&faces, face); 
-        } 
+static void parse_line(void* ctx, char* line, size_t length) {
+    ObjModel* model = ctx;
+    unused(length);
+    // A bad vertex or normal is kept as zeros so the ones after it keep
+    // their numbers, a bad face is left out
+    if (line[0] == 'v' && line[1] == ' ') {
+        Vertex v = {0};
+        if (not parse_vertex(line, &v)) model->bad_lines++;
+        vec_Vertex_push(&model->vertices, v);
+    }
+    if (strncmp(line, "vn ", 3) is 0) {
+        Normal n = {0};
+        if (not parse_normal(line, &n)) model->bad_lines++;
+        vec_Normal_push(&model->normals, n);
+    }
+    if (line[0] == 'f' && line[1] == ' ') {
+        Face face;
+        if (parse_indices(line + 2, (int)model->vertices.length, &face.indices)) // +2 to skip 'f '
+            vec_Face_push(&model->faces, face);
+        else
+            model->bad_lines++;
     } 
-    fclose(file);
+}
 
-    return (ObjModel) {
-        .faces = faces,
-        .vertices = vertices,
-        .normals = normals,
+// Faces can point at vertices and normals that come later in the file, so
+// they are only checked once all of it is read
+static void remove_incomplete_faces(ObjModel* model) {
+    size_t kept = 0;
+    for (size_t f = 0; f < model->faces.length; f++) {
+        Face face = model->faces.data[f];
+        if (is_face_complete(&face, model)) {
+            model->faces.data[kept++] = face;
+        } else {
+            face_free(face);
+            model->bad_lines++;
+        }
+    }
+    model->faces.length = kept;
+}
+
+// The file comes in blocks, decompressed on another thread if it is .gz or
+// .zst, and its lines are parsed where they are
+ObjModel obj_parse_model(const char* filepath) {
+    AllocTag old_tag = alloc_tag_set(ALLOC_TAG_PARSER);
+    ObjModel model = {
+        .vertices = vec_Vertex_create(),
+        .faces = vec_Face_create(),
+        .normals = vec_Normal_create(),
     };
+
+    BlockStream* stream = block_stream_open(filepath);
+    assert_m(stream and "Failed to open file"); 
+
+    model.is_truncated = not block_stream_for_each_line(stream, parse_line, &model);
+    if (model.is_truncated)
+        debugln("'%s' ends early or is corrupt, parsed what came before", filepath);
+    remove_incomplete_faces(&model);
+    if (model.bad_lines > 0)
+        debugln("'%s' has %ld bad lines, parsed the rest", filepath, (long)model.bad_lines);
+
+    block_stream_close(stream);
+    alloc_tag_set(old_tag);
+    return model;
+}
+
+static const char* const OBJ_EXTENSIONS[] = {".obj", ".obj.gz", ".obj.zst"};
+
+size_t obj_path_extension_length(const char* path) {
+  for (size_t i = 0; i < LEN(OBJ_EXTENSIONS); i++)
+    if (path_has_extension(path, OBJ_EXTENSIONS[i])) return strlen(OBJ_EXTENSIONS[i]);
+  return 0;
 }
 
 void obj_model_free(ObjModel mdl) {
@@ -46,9 +46,18 @@ typedef struct ObjModel {
     vec_Vertex vertices;
     vec_Face faces;
     vec_Normal normals;
+    size_t bad_lines; // v, vn and f lines that could not be parsed
+    bool is_truncated; // the file ended early or is corrupt, the model is what came before
 } ObjModel;
 
+// Never fails on a malformed line: bad vertices and normals are read as
+// zeros, and faces with too few corners or indices out of range are left
+// out, all counted in bad_lines
 ObjModel obj_parse_model(const char* filepath);
 void obj_model_free(ObjModel mdl);
 
+// Length of the extension of an OBJ path: .obj, or .obj.gz and .obj.zst for
+// compressed ones. 0 for any other path
+size_t obj_path_extension_length(const char* path);
+
 #endif // OBJ_PARSER_H_
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "obj_stats.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "../util/hashmap.h"  // hash_u64
+#include "../util/mapped_file.h"
+#include "../util/prettify_c.h"
+
+#define PRIME_1 0x9e3779b185ebca87ull
+#define PRIME_2 0xc2b2ae3d27d4eb4full
+
+static const double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static bool is_digit(char c) { return c >= '0' and c <= '9'; }
+static bool is_blank(char c) { return c is ' ' or c is '\t'; }
+
+const char* obj_stats_parse_float(const char* p, const char* end, float* out) {
+  const char* start = p;
+  bool negative = false;
+  if (p < end and (*p is '-' or *p is '+')) negative = *p++ is '-';
+
+  // Digits past the 19th do not fit and only move the exponent
+  uint64_t mantissa = 0;
+  int digits = 0, exponent = 0;
+  bool any = false;
+  for (; p < end and is_digit(*p); p++, any = true) {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+      digits += mantissa > 0;
+    } else {
+      exponent++;
+    }
+  }
+  if (p < end and *p is '.') {
+    for (p++; p < end and is_digit(*p); p++, any = true) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        digits += mantissa > 0;
+        exponent--;
+      }
+    }
+  }
+  if (not any) return start;
+
+  if (p + 1 < end and (*p is 'e' or *p is 'E')) {
+    const char* e = p + 1;
+    bool e_negative = false;
+    if (*e is '-' or *e is '+') e_negative = *e++ is '-';
+    if (e < end and is_digit(*e)) {
+      int value = 0;
+      for (; e < end and is_digit(*e); e++)
+        if (value < 10000) value = value * 10 + (*e - '0');
+      exponent += e_negative ? -value : value;
+      p = e;
+    }
+  }
+
+  double value = (double)mantissa;
+  if (exponent >= 0 and exponent < (int)LEN(POW10))
+    value *= POW10[exponent];
+  else if (exponent < 0 and -exponent < (int)LEN(POW10))
+    value /= POW10[-exponent];
+  else
+    value *= pow(10, exponent);
+
+  *out = (float)(negative ? -value : value);
+  return p;
+}
+
+static inline uint64_t rotl(uint64_t x, int bits) {
+  return (x << bits) | (x >> (64 - bits));
+}
+
+// Four independent lanes, so hashing is not one long multiply chain and
+// keeps up with the line scan
+static uint64_t hash_content(const char* data, size_t size) {
+  uint64_t lanes[4] = {PRIME_1 + PRIME_2, PRIME_2, 0, -PRIME_1};
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    for (int l = 0; l < 4; l++) {
+      uint64_t word;
+      memcpy(&word, data + i + l * 8, 8);
+      lanes[l] = rotl(lanes[l] + word * PRIME_2, 31) * PRIME_1;
+    }
+  }
+
+  uint64_t hash = size;
+  for (int l = 0; l < 4; l++) hash = hash_u64(hash ^ lanes[l]);
+  for (; i < size; i += 8) {
+    uint64_t word = 0;
+    memcpy(&word, data + i, size - i < 8 ? size - i : 8);
+    hash = hash_u64(hash ^ word);
+  }
+  return hash;
+}
+
+static void add_vertex(ObjStats* stats, const char* p, const char* end) {
+  float v[3];
+  for (int i = 0; i < 3; i++) {
+    while (p < end and is_blank(*p)) p++;
+    const char* next = obj_stats_parse_float(p, end, &v[i]);
+    if (next is p) return;
+    p = next;
+  }
+  for (int i = 0; i < 3; i++) {
+    if (v[i] < stats->min[i]) stats->min[i] = v[i];
+    if (v[i] > stats->max[i]) stats->max[i] = v[i];
+  }
+}
+
+ObjStats obj_stats_from_text(const char* text, size_t size) {
+  ObjStats stats = {
+    .min = {FLT_MAX, FLT_MAX, FLT_MAX},
+    .max = {-FLT_MAX, -FLT_MAX, -FLT_MAX},
+  };
+
+  // Lines are told apart by the same prefixes obj_parse_model looks for
+  const char* end = text + size;
+  for (const char* p = text; p < end;) {
+    const char* line_end = memchr(p, '\n', end - p);
+    if (line_end is null) line_end = end;
+
+    if (line_end - p >= 2) {
+      if (p[0] is 'v' and p[1] is ' ') {
+        stats.vertices_count++;
+        add_vertex(&stats, p + 2, line_end);
+      } else if (p[0] is 'f' and p[1] is ' ') {
+        stats.faces_count++;
+      } else if (line_end - p >= 3 and p[0] is 'v' and p[1] is 'n' and p[2] is ' ') {
+        stats.normals_count++;
+      }
+    }
+    p = line_end + 1;
+  }
+
+  stats.hash = hash_content(text, size);
+  return stats;
+}
+
+bool obj_stats_scan(const char* path, ObjStats* out) {
+  MappedFile file;
+  if (not mapped_file_open(path, &file)) return false;
+  *out = obj_stats_from_text(file.data, file.size);
+  mapped_file_close(&file);
+  return true;
+}
@@ -0,0 +1,26 @@
+#ifndef OBJ_STATS_H_
+#define OBJ_STATS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// What a catalog needs to know about an OBJ, without building the model
+typedef struct ObjStats {
+  uint64_t vertices_count, normals_count, faces_count;
+  // Of the v lines, in file axes. min > max when there are none
+  float min[3], max[3];
+  uint64_t hash;  // of the file bytes, to find copies and changes
+} ObjStats;
+
+// One pass over the mapped file: counts v, vn and f lines and reads only the
+// three numbers of every v line, with no allocation per line
+bool obj_stats_scan(const char* path, ObjStats* out);
+// Same over text in memory, which need not be NUL-terminated
+ObjStats obj_stats_from_text(const char* text, size_t size);
+
+// Reads a number like strtof does, but never past end. Good to a few ulps,
+// which is plenty for a bounding box. Returns p when there is no number
+const char* obj_stats_parse_float(const char* p, const char* end, float* out);
+
+#endif // OBJ_STATS_H_
@@ -1,4 +1,5 @@
 #include "s21_matrix.h"
+#include "s21_quaternion.h"
 
 #include <math.h>
 #include "../util/prettify_c.h"
@@ -121,22 +122,9 @@ matrix_t s21_create_view_to_camera() {
     return result;
 }
 
+// Composed as quaternions, so only one matrix is ever built
 matrix_t s21_create_rotations_camera(double axz, double ayz, double axy) {
-    matrix_t xz = s21_create_rotation_matrix(axz, AXIS_X, AXIS_Z);
-    matrix_t yz = s21_create_rotation_matrix(ayz, AXIS_Y, AXIS_Z);
-    matrix_t xy = s21_create_rotation_matrix(axy, AXIS_X, AXIS_Y);
-
-    matrix_t a;
-    matrix_t b;
-    assert_m(s21_mult_matrix(&xz, &yz, &a) is OK);
-    assert_m(s21_mult_matrix(&a, &xy, &b) is OK);
-
-    s21_remove_matrix(&xz);
-    s21_remove_matrix(&yz);
-    s21_remove_matrix(&xy);
-    s21_remove_matrix(&a);
-
-    return b;
+    return s21_quat_to_matrix(s21_quat_from_rotations_camera(axz, ayz, axy));
 }
 
 void s21_matrix_print(const matrix_t* mat, OutStream os){
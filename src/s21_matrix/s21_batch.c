@@ -0,0 +1,93 @@
+#include <stddef.h>
+
+#include "s21_matrix.h"
+#include "s21_simd.h"
+
+#define BATCH_LANE_T double
+#define BATCH_LANES 1
+#define BATCH_PREFIX batch_scalar_
+#include "s21_batch_kernels.h"
+
+#ifdef S21_SIMD_X86
+typedef double batch_v4d __attribute__((vector_size(32)));
+
+#define BATCH_LANE_T batch_v4d
+#define BATCH_LANES 4
+#define BATCH_PREFIX batch_avx2_
+#define BATCH_TARGET S21_TARGET_AVX2
+#include "s21_batch_kernels.h"
+#endif
+
+typedef void (*batch_det_fn)(const double *a, size_t n, size_t begin,
+                             size_t end, double *result);
+typedef size_t (*batch_inverse_fn)(const double *a, size_t n, size_t begin,
+                                   size_t end, double *out);
+typedef void (*batch_mult_fn)(const double *a, const double *b, size_t n,
+                              size_t begin, size_t end, double *out);
+
+// Kernels of one lane type, indexed by size - 3
+typedef struct batch_kernels {
+  size_t lanes;
+  batch_det_fn det[2];
+  batch_inverse_fn inverse[2];
+  batch_mult_fn mult[2];
+} batch_kernels_t;
+
+static const batch_kernels_t ScalarKernels = {
+    .lanes = 1,
+    .det = {batch_scalar_det3, batch_scalar_det4},
+    .inverse = {batch_scalar_inverse3, batch_scalar_inverse4},
+    .mult = {batch_scalar_mult3, batch_scalar_mult4},
+};
+
+#ifdef S21_SIMD_X86
+static const batch_kernels_t Avx2Kernels = {
+    .lanes = 4,
+    .det = {batch_avx2_det3, batch_avx2_det4},
+    .inverse = {batch_avx2_inverse3, batch_avx2_inverse4},
+    .mult = {batch_avx2_mult3, batch_avx2_mult4},
+};
+#endif
+
+// SIMD kernels take [0, split), scalar ones finish the tail
+static const batch_kernels_t *batch_simd_kernels(size_t n, size_t *split) {
+  const batch_kernels_t *result = &ScalarKernels;
+#ifdef S21_SIMD_X86
+  if (s21_simd_has_avx2()) result = &Avx2Kernels;
+#endif
+  *split = n - n % result->lanes;
+  return result;
+}
+
+int s21_batch_determinant(const double *mats, int size, size_t n,
+                          double *result) {
+  if (mats == NULL || result == NULL || (size != 3 && size != 4)) return ERROR;
+
+  size_t split;
+  const batch_kernels_t *simd = batch_simd_kernels(n, &split);
+  simd->det[size - 3](mats, n, 0, split, result);
+  ScalarKernels.det[size - 3](mats, n, split, n, result);
+  return OK;
+}
+
+int s21_batch_inverse(const double *mats, int size, size_t n, double *result) {
+  if (mats == NULL || result == NULL || (size != 3 && size != 4)) return ERROR;
+
+  size_t split;
+  const batch_kernels_t *simd = batch_simd_kernels(n, &split);
+  size_t singular = simd->inverse[size - 3](mats, n, 0, split, result);
+  singular += ScalarKernels.inverse[size - 3](mats, n, split, n, result);
+  return singular == 0 ? OK : CALC_ERROR;
+}
+
+int s21_batch_mult(const double *a, const double *b, int size, size_t n,
+                   double *result) {
+  if (a == NULL || b == NULL || result == NULL || (size != 3 && size != 4))
+    return ERROR;
+
+  size_t split;
+  const batch_kernels_t *simd = batch_simd_kernels(n, &split);
+  simd->mult[size - 3](a, b, n, 0, split, result);
+  ScalarKernels.mult[size - 3](a, b, n, split, n, result);
+  return OK;
+}
@@ -0,0 +1,196 @@
+/**
+ * Template for the batched 3x3 and 4x4 kernels of s21_batch.c. It is included
+ * once per lane type, so the same source serves the scalar fallback and the
+ * SIMD version where one lane holds one matrix.
+ *
+ * Matrices are stored as SoA: element (r, c) of matrix i is at
+ * data[(r * size + c) * n + i]. Kernels process [begin, end) in steps of
+ * BATCH_LANES, the caller makes sure the range is a multiple of it.
+ */
+
+// input macro: BATCH_LANE_T - double or a GCC vector of doubles
+// input macro: BATCH_LANES - number of doubles in BATCH_LANE_T
+// input macro: BATCH_PREFIX - prefix of generated function names
+// optional input macro: BATCH_TARGET - function attributes of the kernels
+
+#include <string.h>
+
+#include "../util/prettify_c.h"
+
+#ifndef BATCH_TARGET
+#define BATCH_TARGET
+#endif
+
+#define BATCH_FN(name) CONCAT(BATCH_PREFIX, name)
+
+BATCH_TARGET static inline BATCH_LANE_T BATCH_FN(load)(const double *p) {
+  BATCH_LANE_T v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+BATCH_TARGET static inline void BATCH_FN(store)(double *p, BATCH_LANE_T v) {
+  memcpy(p, &v, sizeof(v));
+}
+
+BATCH_TARGET static inline void BATCH_FN(load_all)(const double *data, size_t n,
+                                                   size_t i, int count,
+                                                   BATCH_LANE_T *m) {
+  for (int k = 0; k < count; k++) m[k] = BATCH_FN(load)(data + k * n + i);
+}
+
+// Number of zero determinants among the lanes
+BATCH_TARGET static inline int BATCH_FN(count_zero)(BATCH_LANE_T det) {
+  double lanes[BATCH_LANES];
+  BATCH_FN(store)(lanes, det);
+  int count = 0;
+  for (int k = 0; k < BATCH_LANES; k++) count += lanes[k] == 0.0;
+  return count;
+}
+
+BATCH_TARGET static inline BATCH_LANE_T BATCH_FN(det3_of)(const BATCH_LANE_T *m) {
+  return m[0] * (m[4] * m[8] - m[5] * m[7]) -
+         m[1] * (m[3] * m[8] - m[5] * m[6]) +
+         m[2] * (m[3] * m[7] - m[4] * m[6]);
+}
+
+// 2x2 minors of the top and bottom row pairs, shared by det4 and inverse4
+#define BATCH_MINORS_4(m)                                                      \
+  BATCH_LANE_T s0 = m[0] * m[5] - m[4] * m[1];                                 \
+  BATCH_LANE_T s1 = m[0] * m[6] - m[4] * m[2];                                 \
+  BATCH_LANE_T s2 = m[0] * m[7] - m[4] * m[3];                                 \
+  BATCH_LANE_T s3 = m[1] * m[6] - m[5] * m[2];                                 \
+  BATCH_LANE_T s4 = m[1] * m[7] - m[5] * m[3];                                 \
+  BATCH_LANE_T s5 = m[2] * m[7] - m[6] * m[3];                                 \
+  BATCH_LANE_T c5 = m[10] * m[15] - m[14] * m[11];                             \
+  BATCH_LANE_T c4 = m[9] * m[15] - m[13] * m[11];                              \
+  BATCH_LANE_T c3 = m[9] * m[14] - m[13] * m[10];                              \
+  BATCH_LANE_T c2 = m[8] * m[15] - m[12] * m[11];                              \
+  BATCH_LANE_T c1 = m[8] * m[14] - m[12] * m[10];                              \
+  BATCH_LANE_T c0 = m[8] * m[13] - m[12] * m[9];                               \
+  BATCH_LANE_T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0
+
+BATCH_TARGET static void BATCH_FN(det3)(const double *a, size_t n, size_t begin,
+                                        size_t end, double *det) {
+  for (size_t i = begin; i < end; i += BATCH_LANES) {
+    BATCH_LANE_T m[9];
+    BATCH_FN(load_all)(a, n, i, 9, m);
+    BATCH_FN(store)(det + i, BATCH_FN(det3_of)(m));
+  }
+}
+
+BATCH_TARGET static void BATCH_FN(det4)(const double *a, size_t n, size_t begin,
+                                        size_t end, double *result) {
+  for (size_t i = begin; i < end; i += BATCH_LANES) {
+    BATCH_LANE_T m[16];
+    BATCH_FN(load_all)(a, n, i, 16, m);
+    BATCH_MINORS_4(m);
+    BATCH_FN(store)(result + i, det);
+  }
+}
+
+// Singular matrices come out as NaN: det / det is 1 for any other matrix and
+// 0 / 0 for them, so every element is multiplied by it. Returns how many
+// singular matrices were found.
+BATCH_TARGET static size_t BATCH_FN(inverse3)(const double *a, size_t n,
+                                              size_t begin, size_t end,
+                                              double *out) {
+  size_t singular = 0;
+  for (size_t i = begin; i < end; i += BATCH_LANES) {
+    BATCH_LANE_T m[9];
+    BATCH_FN(load_all)(a, n, i, 9, m);
+
+    BATCH_LANE_T r[9] = {
+        m[4] * m[8] - m[5] * m[7], m[2] * m[7] - m[1] * m[8],
+        m[1] * m[5] - m[2] * m[4], m[5] * m[6] - m[3] * m[8],
+        m[0] * m[8] - m[2] * m[6], m[2] * m[3] - m[0] * m[5],
+        m[3] * m[7] - m[4] * m[6], m[1] * m[6] - m[0] * m[7],
+        m[0] * m[4] - m[1] * m[3],
+    };
+    BATCH_LANE_T det = m[0] * r[0] + m[1] * r[3] + m[2] * r[6];
+    BATCH_LANE_T scale = (1.0 / det) * (det / det);
+
+    for (int k = 0; k < 9; k++) BATCH_FN(store)(out + k * n + i, r[k] * scale);
+    singular += BATCH_FN(count_zero)(det);
+  }
+  return singular;
+}
+
+BATCH_TARGET static size_t BATCH_FN(inverse4)(const double *a, size_t n,
+                                              size_t begin, size_t end,
+                                              double *out) {
+  size_t singular = 0;
+  for (size_t i = begin; i < end; i += BATCH_LANES) {
+    BATCH_LANE_T m[16];
+    BATCH_FN(load_all)(a, n, i, 16, m);
+    BATCH_MINORS_4(m);
+
+    BATCH_LANE_T r[16] = {
+        m[5] * c5 - m[6] * c4 + m[7] * c3,
+        -m[1] * c5 + m[2] * c4 - m[3] * c3,
+        m[13] * s5 - m[14] * s4 + m[15] * s3,
+        -m[9] * s5 + m[10] * s4 - m[11] * s3,
+
+        -m[4] * c5 + m[6] * c2 - m[7] * c1,
+        m[0] * c5 - m[2] * c2 + m[3] * c1,
+        -m[12] * s5 + m[14] * s2 - m[15] * s1,
+        m[8] * s5 - m[10] * s2 + m[11] * s1,
+
+        m[4] * c4 - m[5] * c2 + m[7] * c0,
+        -m[0] * c4 + m[1] * c2 - m[3] * c0,
+        m[12] * s4 - m[13] * s2 + m[15] * s0,
+        -m[8] * s4 + m[9] * s2 - m[11] * s0,
+
+        -m[4] * c3 + m[5] * c1 - m[6] * c0,
+        m[0] * c3 - m[1] * c1 + m[2] * c0,
+        -m[12] * s3 + m[13] * s1 - m[14] * s0,
+        m[8] * s3 - m[9] * s1 + m[10] * s0,
+    };
+    BATCH_LANE_T scale = (1.0 / det) * (det / det);
+
+    for (int k = 0; k < 16; k++)
+      BATCH_FN(store)(out + k * n + i, r[k] * scale);
+    singular += BATCH_FN(count_zero)(det);
+  }
+  return singular;
+}
+
+BATCH_TARGET static inline void BATCH_FN(mult_n)(const double *a,
+                                                const double *b, int size,
+                                                size_t n, size_t begin,
+                                                size_t end, double *out) {
+  for (size_t i = begin; i < end; i += BATCH_LANES) {
+    BATCH_LANE_T ma[16], mb[16];
+    BATCH_FN(load_all)(a, n, i, size * size, ma);
+    BATCH_FN(load_all)(b, n, i, size * size, mb);
+
+    for (int r = 0; r < size; r++) {
+      for (int c = 0; c < size; c++) {
+        BATCH_LANE_T sum = ma[r * size] * mb[c];
+        for (int k = 1; k < size; k++)
+          sum += ma[r * size + k] * mb[k * size + c];
+        BATCH_FN(store)(out + (r * size + c) * n + i, sum);
+      }
+    }
+  }
+}
+
+// Fixed sizes let the compiler unroll the products completely
+BATCH_TARGET static void BATCH_FN(mult3)(const double *a, const double *b,
+                                         size_t n, size_t begin, size_t end,
+                                         double *out) {
+  BATCH_FN(mult_n)(a, b, 3, n, begin, end, out);
+}
+
+BATCH_TARGET static void BATCH_FN(mult4)(const double *a, const double *b,
+                                         size_t n, size_t begin, size_t end,
+                                         double *out) {
+  BATCH_FN(mult_n)(a, b, 4, n, begin, end, out);
+}
+
+#undef BATCH_MINORS_4
+#undef BATCH_FN
+#undef BATCH_LANE_T
+#undef BATCH_LANES
+#undef BATCH_PREFIX
+#undef BATCH_TARGET
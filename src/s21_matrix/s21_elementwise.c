@@ -0,0 +1,175 @@
+#include <stddef.h>
+
+#include "s21_matrix.h"
+#include "s21_simd.h"
+
+#ifdef S21_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Tiles of the recursive transpose: 32 x 32 doubles of source and
+// destination together take 16 KB and stay in L1 while being swapped
+#define TRANSPOSE_TILE 32
+
+typedef void (*binary_kernel_t)(const double *a, const double *b, double *out,
+                                size_t n);
+typedef void (*scale_kernel_t)(const double *a, double number, double *out,
+                               size_t n);
+
+// Plain IEEE add, sub and mul per element, no FMA, so the SIMD kernels give
+// exactly the same bits as the scalar ones
+static void add_scalar(const double *a, const double *b, double *out,
+                       size_t n) {
+  for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+}
+
+static void sub_scalar(const double *a, const double *b, double *out,
+                       size_t n) {
+  for (size_t i = 0; i < n; i++) out[i] = a[i] - b[i];
+}
+
+static void scale_scalar(const double *a, double number, double *out,
+                         size_t n) {
+  for (size_t i = 0; i < n; i++) out[i] = a[i] * number;
+}
+
+#ifdef S21_SIMD_X86
+S21_TARGET_AVX2 static void add_avx2(const double *a, const double *b,
+                                     double *out, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i),
+                                            _mm256_loadu_pd(b + i)));
+  add_scalar(a + i, b + i, out + i, n - i);
+}
+
+S21_TARGET_AVX2 static void sub_avx2(const double *a, const double *b,
+                                     double *out, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(a + i),
+                                            _mm256_loadu_pd(b + i)));
+  sub_scalar(a + i, b + i, out + i, n - i);
+}
+
+S21_TARGET_AVX2 static void scale_avx2(const double *a, double number,
+                                       double *out, size_t n) {
+  __m256d factor = _mm256_set1_pd(number);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+  scale_scalar(a + i, number, out + i, n - i);
+}
+#endif
+
+// Matrices from s21_create_matrix are one flat block, anything else is
+// processed row by row
+static void apply_binary(binary_kernel_t kernel, const matrix_t *A,
+                         const matrix_t *B, matrix_t *result) {
+  if (s21_is_matrix_contiguous(A) && s21_is_matrix_contiguous(B)) {
+    kernel(A->matrix[0], B->matrix[0], result->matrix[0],
+           (size_t)A->rows * A->columns);
+  } else {
+    for (int i = 0; i < A->rows; i++)
+      kernel(A->matrix[i], B->matrix[i], result->matrix[i], A->columns);
+  }
+}
+
+static int s21_add_sub(matrix_t *A, matrix_t *B, matrix_t *result,
+                       binary_kernel_t scalar, binary_kernel_t simd) {
+  s21_nullify_matrix(result);
+  int ret_val = OK;
+
+  if (!s21_is_matrix_valid(A) || !s21_is_matrix_valid(B)) {
+    ret_val = ERROR;
+  } else if (A->rows != B->rows || A->columns != B->columns) {
+    ret_val = CALC_ERROR;
+  } else if ((ret_val = s21_create_matrix(A->rows, A->columns, result)) == OK) {
+    apply_binary(simd != NULL && s21_simd_has_avx2() ? simd : scalar, A, B,
+                 result);
+  }
+
+  return ret_val;
+}
+
+int s21_sum_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+#ifdef S21_SIMD_X86
+  return s21_add_sub(A, B, result, add_scalar, add_avx2);
+#else
+  return s21_add_sub(A, B, result, add_scalar, NULL);
+#endif
+}
+
+int s21_sub_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
+#ifdef S21_SIMD_X86
+  return s21_add_sub(A, B, result, sub_scalar, sub_avx2);
+#else
+  return s21_add_sub(A, B, result, sub_scalar, NULL);
+#endif
+}
+
+int s21_mult_number(matrix_t *A, double number, matrix_t *result) {
+  int ret_val = OK;
+  if (result == NULL) {
+    ret_val = ERROR;
+  } else {
+    s21_nullify_matrix(result);
+
+    if (!s21_is_matrix_valid(A)) {
+      ret_val = ERROR;
+    } else if ((ret_val = s21_create_matrix(A->rows, A->columns, result)) ==
+               OK) {
+      scale_kernel_t kernel = scale_scalar;
+#ifdef S21_SIMD_X86
+      if (s21_simd_has_avx2()) kernel = scale_avx2;
+#endif
+      if (s21_is_matrix_contiguous(A)) {
+        kernel(A->matrix[0], number, result->matrix[0],
+               (size_t)A->rows * A->columns);
+      } else {
+        for (int i = 0; i < A->rows; i++)
+          kernel(A->matrix[i], number, result->matrix[i], A->columns);
+      }
+    }
+  }
+
+  return ret_val;
+}
+
+// Cache-oblivious: halves the longer side until the block fits in a tile, so
+// both the reads and the strided writes stay within cache at every level
+static void transpose_block(double **src, double **dst, int row_begin,
+                            int row_end, int col_begin, int col_end) {
+  int rows = row_end - row_begin, columns = col_end - col_begin;
+
+  if (rows <= TRANSPOSE_TILE && columns <= TRANSPOSE_TILE) {
+    for (int i = row_begin; i < row_end; i++)
+      for (int j = col_begin; j < col_end; j++) dst[j][i] = src[i][j];
+  } else if (rows >= columns) {
+    int middle = row_begin + rows / 2;
+    transpose_block(src, dst, row_begin, middle, col_begin, col_end);
+    transpose_block(src, dst, middle, row_end, col_begin, col_end);
+  } else {
+    int middle = col_begin + columns / 2;
+    transpose_block(src, dst, row_begin, row_end, col_begin, middle);
+    transpose_block(src, dst, row_begin, row_end, middle, col_end);
+  }
+}
+
+int s21_transpose(matrix_t *A, matrix_t *result) {
+  int ret_val = OK;
+
+  if (result == NULL) {
+    ret_val = ERROR;
+  } else {
+    s21_nullify_matrix(result);
+    if (!s21_is_matrix_valid(A)) {
+      ret_val = ERROR;
+    } else if ((ret_val = s21_create_matrix(A->columns, A->rows, result)) ==
+               OK) {
+      transpose_block(A->matrix, result->matrix, 0, A->rows, 0, A->columns);
+    }
+  }
+
+  return ret_val;
+}
@@ -0,0 +1,26 @@
+#ifndef SRC_MATRIX_S21_FIXED_MATRICES_H_
+#define SRC_MATRIX_S21_FIXED_MATRICES_H_
+
+// Instantiations of s21_fixed_matrix.h used across the project
+
+#define MAT_ITEM_TYPE float
+#define MAT_ROWS 4
+#define MAT_COLS 4
+#include "s21_fixed_matrix.h"  // mat_float_4x4
+
+#define MAT_ITEM_TYPE float
+#define MAT_ROWS 3
+#define MAT_COLS 3
+#include "s21_fixed_matrix.h"  // mat_float_3x3
+
+#define MAT_ITEM_TYPE double
+#define MAT_ROWS 4
+#define MAT_COLS 4
+#include "s21_fixed_matrix.h"  // mat_double_4x4
+
+#define MAT_ITEM_TYPE double
+#define MAT_ROWS 3
+#define MAT_COLS 3
+#include "s21_fixed_matrix.h"  // mat_double_3x3
+
+#endif
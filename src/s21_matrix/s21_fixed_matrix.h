@@ -0,0 +1,130 @@
+/**
+ * This header-only template creates fixed-size matrices, for example
+ * mat_float_4x4 or mat_double_3x3. Dimensions are known at compile time,
+ * so there are no allocations and no bounds checks, and every operation is
+ * unrolled. Data is row-major and contiguous, which is exactly what
+ * glUniformMatrix4fv with GL_TRUE expects.
+ *
+ * Include once per instantiation, functions are static inline.
+ */
+
+// input macro: MAT_ITEM_TYPE - element type, float or double
+// input macro: MAT_ROWS - number of rows
+// input macro: MAT_COLS - number of columns
+
+#if !defined(MAT_ITEM_TYPE) || !defined(MAT_ROWS) || !defined(MAT_COLS)
+#warning MAT_ITEM_TYPE, MAT_ROWS or MAT_COLS is undefined, cannot construct matrix.
+#else
+#include <math.h>
+#include <stdbool.h>
+
+#include "../util/prettify_c.h"
+#include "s21_matrix.h"
+
+#define MAT_T \
+  CONCAT(CONCAT(mat_, MAT_ITEM_TYPE), CONCAT(_, CONCAT(CONCAT(MAT_ROWS, x), MAT_COLS)))
+#define MAT_FN(name) CONCAT(MAT_T, CONCAT(_, name))
+
+#define MAT_FOREACH(i, j)         \
+  _Pragma("GCC unroll 16")        \
+  for (int i = 0; i < MAT_ROWS; i++) \
+    _Pragma("GCC unroll 16")      \
+    for (int j = 0; j < MAT_COLS; j++)
+
+typedef struct MAT_T {
+  MAT_ITEM_TYPE m[MAT_ROWS][MAT_COLS];
+} MAT_T;
+
+static inline MAT_T MAT_FN(zero)() {
+  MAT_T result = {0};
+  return result;
+}
+
+// Pointer to the row-major data, for glUniformMatrix*fv and friends
+static inline const MAT_ITEM_TYPE* MAT_FN(data)(const MAT_T* a) {
+  return &a->m[0][0];
+}
+
+static inline MAT_T MAT_FN(from_matrix)(const matrix_t* a) {
+  assert_m(a->rows is MAT_ROWS and a->columns is MAT_COLS);
+
+  MAT_T result;
+  MAT_FOREACH(i, j) result.m[i][j] = (MAT_ITEM_TYPE)a->matrix[i][j];
+  return result;
+}
+
+static inline matrix_t MAT_FN(to_matrix)(const MAT_T* a) {
+  matrix_t result;
+  assert_m(s21_create_matrix(MAT_ROWS, MAT_COLS, &result) is OK);
+  MAT_FOREACH(i, j) result.matrix[i][j] = a->m[i][j];
+  return result;
+}
+
+static inline MAT_T MAT_FN(add)(const MAT_T* a, const MAT_T* b) {
+  MAT_T result;
+  MAT_FOREACH(i, j) result.m[i][j] = a->m[i][j] + b->m[i][j];
+  return result;
+}
+
+static inline MAT_T MAT_FN(sub)(const MAT_T* a, const MAT_T* b) {
+  MAT_T result;
+  MAT_FOREACH(i, j) result.m[i][j] = a->m[i][j] - b->m[i][j];
+  return result;
+}
+
+static inline MAT_T MAT_FN(scale)(const MAT_T* a, MAT_ITEM_TYPE number) {
+  MAT_T result;
+  MAT_FOREACH(i, j) result.m[i][j] = a->m[i][j] * number;
+  return result;
+}
+
+static inline bool MAT_FN(eq)(const MAT_T* a, const MAT_T* b, MAT_ITEM_TYPE eps) {
+  bool result = true;
+  MAT_FOREACH(i, j) result &= fabs((double)(a->m[i][j] - b->m[i][j])) < eps;
+  return result;
+}
+
+// out = a * in, in has MAT_COLS elements and out has MAT_ROWS
+static inline void MAT_FN(mult_vec)(const MAT_T* a, const MAT_ITEM_TYPE* in, MAT_ITEM_TYPE* out) {
+  _Pragma("GCC unroll 16")
+  for (int i = 0; i < MAT_ROWS; i++) {
+    MAT_ITEM_TYPE sum = 0;
+    _Pragma("GCC unroll 16")
+    for (int k = 0; k < MAT_COLS; k++) sum += a->m[i][k] * in[k];
+    out[i] = sum;
+  }
+}
+
+#if MAT_ROWS == MAT_COLS
+static inline MAT_T MAT_FN(identity)() {
+  MAT_T result;
+  MAT_FOREACH(i, j) result.m[i][j] = i == j ? 1 : 0;
+  return result;
+}
+
+static inline MAT_T MAT_FN(transpose)(const MAT_T* a) {
+  MAT_T result;
+  MAT_FOREACH(i, j) result.m[i][j] = a->m[j][i];
+  return result;
+}
+
+static inline MAT_T MAT_FN(mult)(const MAT_T* a, const MAT_T* b) {
+  MAT_T result;
+  MAT_FOREACH(i, j) {
+    MAT_ITEM_TYPE sum = 0;
+    _Pragma("GCC unroll 16")
+    for (int k = 0; k < MAT_COLS; k++) sum += a->m[i][k] * b->m[k][j];
+    result.m[i][j] = sum;
+  }
+  return result;
+}
+#endif
+
+#undef MAT_FOREACH
+#undef MAT_FN
+#undef MAT_T
+#endif
+
+#undef MAT_ITEM_TYPE
+#undef MAT_ROWS
+#undef MAT_COLS
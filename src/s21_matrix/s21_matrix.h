@@ -2,6 +2,7 @@
 #define SRC_S21_MATRIX_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "../util/better_io.h"
 
 #define SUCCESS 1
@@ -17,9 +18,14 @@ typedef struct matrix_struct {
   int columns;
 } matrix_t;
 
+typedef struct Arena Arena;
+
 // Main functions
 int s21_create_matrix(int rows, int columns, matrix_t *result);  // done+
 void s21_remove_matrix(matrix_t *A);                             // done+
+// Same layout as s21_create_matrix, but the memory belongs to the arena and
+// the matrix must not be passed to s21_remove_matrix
+int s21_create_matrix_in(Arena *arena, int rows, int columns, matrix_t *result);
 
 int s21_eq_matrix(matrix_t *A, matrix_t *B);  // done+
 
@@ -34,9 +40,25 @@ int s21_calc_complements(matrix_t *A, matrix_t *result);  // done+
 int s21_determinant(matrix_t *A, double *result);         // done+
 int s21_inverse_matrix(matrix_t *A, matrix_t *result);    // done+
 
+// Multiplies mats[0] * mats[1] * ... * mats[n - 1] in the cheapest order.
+// Diagonal, translation and affine operands are detected and multiplied with
+// specialized kernels. Intermediates never allocate for 4x4 chains.
+int s21_mult_chain(matrix_t **mats, int n, matrix_t *out);
+
+// Batches of n 3x3 or 4x4 matrices (size is 3 or 4) stored as SoA: element
+// (r, c) of matrix i is data[(r * size + c) * n + i], so one SIMD register
+// holds the same element of several matrices. Results use the same layout
+// and may overwrite the inputs.
+int s21_batch_determinant(const double *mats, int size, size_t n, double *result);
+// Singular matrices get NaN in every element, CALC_ERROR tells there were some
+int s21_batch_inverse(const double *mats, int size, size_t n, double *result);
+int s21_batch_mult(const double *a, const double *b, int size, size_t n, double *result);
+
 // Other very handy functions
 void s21_nullify_matrix(matrix_t *matrix);    // done
 bool s21_is_matrix_valid(const matrix_t *A);  // done
+// True when all rows follow each other in memory, as s21_create_matrix makes
+bool s21_is_matrix_contiguous(const matrix_t *A);
 // void s21_print_matrix(matrix_t *A, const char *double_format);  // done
 
 // 3D graphics stuff
@@ -59,6 +81,14 @@ FloatArray16 s21_matrix_to_farray(const matrix_t* m);
 matrix_t s21_create_rotation_matrix(double angle, int axis_from, int axis_into);
 matrix_t s21_create_rotations_camera(double axz, double ayz, double axy);
 
+// Transforms n points (x, y, z, 1) by a 4x4 matrix, dividing by w when the
+// last row is not (0, 0, 0, 1). Points are stride floats apart: 3 for packed
+// positions, 6 for the position + normal vertices of obj_model_to_mesh. Only
+// the first three floats of every point are written, in == out is allowed.
+int s21_transform_points(const matrix_t* mat, const float* in, float* out, size_t n, size_t stride);
+// Same for separate x, y and z arrays
+int s21_transform_points_soa(const matrix_t* mat, const float* const in[3], float* const out[3], size_t n);
+
 void s21_matrix_print(const matrix_t* mat, OutStream os);
 
 #endif
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../util/allocator.h"
 #include "s21_matrix.h"
 
 #define EPS 1e-7
@@ -13,7 +14,9 @@ void s21_nullify_matrix(matrix_t *matrix) {
   matrix->columns = 0;
 }
 
-int s21_create_matrix(int rows, int columns, matrix_t *result) {
+// Row pointers followed by the data, in one zeroed block from arena or calloc
+static int create_matrix(Arena *arena, int rows, int columns,
+                         matrix_t *result) {
   int ret_value = OK;
 
   if (result == NULL) {
@@ -27,7 +30,13 @@ int s21_create_matrix(int rows, int columns, matrix_t *result) {
     size_t pointers_size = rows * sizeof(double *);
 
     size_t total_size = data_size + pointers_size;
-    double **array = (double **)calloc(total_size, 1);
+    double **array = NULL;
+    if (arena == NULL) {
+      array = (double **)calloc(total_size, 1);
+    } else {
+      array = (double **)arena_alloc(arena, total_size);
+      memset(array, 0, total_size);
+    }
     double *data_ptr = (double *)(array + rows);
 
     if (array == NULL) {
@@ -44,6 +53,15 @@ int s21_create_matrix(int rows, int columns, matrix_t *result) {
   return ret_value;
 }
 
+int s21_create_matrix(int rows, int columns, matrix_t *result) {
+  return create_matrix(NULL, rows, columns, result);
+}
+
+int s21_create_matrix_in(Arena *arena, int rows, int columns,
+                         matrix_t *result) {
+  return create_matrix(arena, rows, columns, result);
+}
+
 void s21_remove_matrix(matrix_t *a) {
   if (s21_is_matrix_valid(a)) {
     free(a->matrix);
@@ -67,75 +85,6 @@ int s21_eq_matrix(matrix_t *A, matrix_t *B) {
   return result;
 }
 
-static int s21_add_sub(matrix_t *A, matrix_t *B, matrix_t *result,
-                       int operation) {
-  s21_nullify_matrix(result);
-  int ret_val = OK;
-
-  if (!s21_is_matrix_valid(A) || !s21_is_matrix_valid(B)) {
-    ret_val = ERROR;
-  } else if (A->rows != B->rows || A->columns != B->columns) {
-    ret_val = CALC_ERROR;
-  } else if ((ret_val = s21_create_matrix(A->rows, A->columns, result)) == OK) {
-    for (int i = 0; i < A->rows; i++)
-      for (int j = 0; j < A->columns; j++)
-        if (operation == 0)
-          result->matrix[i][j] = A->matrix[i][j] + B->matrix[i][j];
-        else
-          result->matrix[i][j] = A->matrix[i][j] - B->matrix[i][j];
-  }
-
-  return ret_val;
-}
-
-int s21_sum_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
-  return s21_add_sub(A, B, result, 0);
-}
-
-int s21_sub_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
-  return s21_add_sub(A, B, result, 1);
-}
-
-int s21_mult_number(matrix_t *A, double number, matrix_t *result) {
-  int ret_val = OK;
-  if (result == NULL) {
-    ret_val = ERROR;
-  } else {
-    s21_nullify_matrix(result);
-
-    if (!s21_is_matrix_valid(A)) {
-      ret_val = ERROR;
-    } else if ((ret_val = s21_create_matrix(A->rows, A->columns, result)) ==
-               OK) {
-      for (int i = 0; i < A->rows; i++)
-        for (int j = 0; j < A->columns; j++)
-          result->matrix[i][j] = A->matrix[i][j] * number;
-    }
-  }
-
-  return ret_val;
-}
-
-int s21_transpose(matrix_t *A, matrix_t *result) {
-  int ret_val = OK;
-
-  if (result == NULL) {
-    ret_val = ERROR;
-  } else {
-    s21_nullify_matrix(result);
-    if (!s21_is_matrix_valid(A)) {
-      ret_val = ERROR;
-    } else if ((ret_val = s21_create_matrix(A->columns, A->rows, result)) ==
-               OK) {
-      for (int i = 0; i < A->rows; i++)
-        for (int j = 0; j < A->columns; j++)
-          result->matrix[j][i] = A->matrix[i][j];
-    }
-  }
-
-  return ret_val;
-}
-
 int s21_mult_matrix(matrix_t *A, matrix_t *B, matrix_t *result) {
   int ret_val = OK;
 
@@ -198,4 +147,11 @@ int s21_inverse_matrix(matrix_t *A, matrix_t *result) {
 
 bool s21_is_matrix_valid(const matrix_t *A) {
   return A != NULL && A->matrix != NULL && A->rows > 0 && A->columns > 0;
+}
+
+bool s21_is_matrix_contiguous(const matrix_t *A) {
+  bool result = true;
+  for (int i = 1; i < A->rows && result; i++)
+    if (A->matrix[i] != A->matrix[0] + (size_t)i * A->columns) result = false;
+  return result;
 }
\ No newline at end of file
@@ -0,0 +1,413 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "s21_matrix.h"
+
+// Chains of up to this many matrices keep their DP tables on the stack
+#define CHAIN_STACK_LIMIT 16
+// Intermediate products up to this many doubles in total never touch the heap
+#define CHAIN_STACK_SCRATCH 512
+
+enum ChainKind {
+  KIND_GENERAL,
+  KIND_AFFINE,       // square, last row is (0, ..., 0, 1)
+  KIND_TRANSLATION,  // affine with identity linear part
+  KIND_DIAGONAL,
+};
+
+typedef struct chain_operand {
+  const double *data;  // row-major and contiguous
+  int rows;
+  int columns;
+  int kind;
+} chain_operand_t;
+
+typedef struct chain_ctx {
+  chain_operand_t *operands;
+  int *split;
+  int n;
+
+  double *scratch;
+  size_t scratch_top;
+} chain_ctx_t;
+
+// Looks at every element without branching on them: with n known at compile
+// time the whole scan unrolls into a few dozen compares, which is cheaper than
+// the mispredicted branches of an early exit.
+static inline int classify_block(const double *m, int n) {
+  bool diagonal = true, last_row = true, identity = true;
+#pragma GCC unroll 4
+  for (int i = 0; i < n; i++) {
+#pragma GCC unroll 4
+    for (int j = 0; j < n; j++) {
+      double v = m[i * n + j];
+      bool is_identity = v == (i == j ? 1.0 : 0.0);
+      diagonal &= i == j || v == 0.0;
+      if (i == n - 1)
+        last_row &= is_identity;
+      else if (j < n - 1)
+        identity &= is_identity;
+    }
+  }
+
+  int kind = KIND_GENERAL;
+  if (diagonal)
+    kind = KIND_DIAGONAL;
+  else if (last_row)
+    kind = identity ? KIND_TRANSLATION : KIND_AFFINE;
+  return kind;
+}
+
+static int classify(const double *m, int rows, int columns) {
+  int kind = KIND_GENERAL;
+  if (rows == 4 && columns == 4)
+    kind = classify_block(m, 4);
+  else if (rows == columns)
+    kind = classify_block(m, rows);
+  return kind;
+}
+
+// Structure of A * B that is known without looking at the product
+static int product_kind(const chain_operand_t *A, const chain_operand_t *B) {
+  bool square = A->rows == A->columns && B->rows == B->columns;
+  bool a_affine = A->kind == KIND_AFFINE || A->kind == KIND_TRANSLATION;
+  bool b_affine = B->kind == KIND_AFFINE || B->kind == KIND_TRANSLATION;
+
+  int kind = KIND_GENERAL;
+  if (!square)
+    kind = KIND_GENERAL;
+  else if (A->kind == B->kind)
+    kind = A->kind;
+  else if (a_affine && b_affine)
+    kind = KIND_AFFINE;
+  return kind;
+}
+
+// c = a * b for row-major blocks, a has a_stride doubles per row. Summation
+// over k goes in the same order as in s21_mult_matrix, so a single product
+// gives exactly the same result. Kernels call it with constant sizes for 4x4
+// operands, which lets the compiler unroll it completely.
+static inline void mult_block(const double *a, const double *b, double *c,
+                              int rows, int inner, int columns, int a_stride) {
+#pragma GCC unroll 4
+  for (int i = 0; i < rows; i++) {
+#pragma GCC unroll 4
+    for (int j = 0; j < columns; j++) {
+      double sum = 0.0;
+#pragma GCC unroll 4
+      for (int k = 0; k < inner; k++)
+        sum += a[i * a_stride + k] * b[k * columns + j];
+      c[i * columns + j] = sum;
+    }
+  }
+}
+
+static void mult_general(const chain_operand_t *A, const chain_operand_t *B,
+                         double *C) {
+  int rows = A->rows, inner = A->columns, columns = B->columns;
+  if (rows == 4 && inner == 4 && columns == 4)
+    mult_block(A->data, B->data, C, 4, 4, 4, 4);
+  else
+    mult_block(A->data, B->data, C, rows, inner, columns, inner);
+}
+
+static void mult_diagonal_left(const chain_operand_t *A,
+                               const chain_operand_t *B, double *C) {
+  int n = A->rows, columns = B->columns;
+  for (int i = 0; i < n; i++) {
+    double a = A->data[i * n + i];
+    for (int j = 0; j < columns; j++)
+      C[i * columns + j] = a * B->data[i * columns + j];
+  }
+}
+
+static void mult_diagonal_right(const chain_operand_t *A,
+                                const chain_operand_t *B, double *C) {
+  int rows = A->rows, n = B->columns;
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < n; j++)
+      C[i * n + j] = A->data[i * n + j] * B->data[j * n + j];
+}
+
+// T * B: every row but the last gets t_i times the last row of B added
+static void mult_translation_left(const chain_operand_t *A,
+                                  const chain_operand_t *B, double *C) {
+  int n = A->rows, columns = B->columns;
+  const double *last = B->data + (n - 1) * columns;
+  for (int i = 0; i < n - 1; i++) {
+    double t = A->data[i * n + n - 1];
+    for (int j = 0; j < columns; j++)
+      C[i * columns + j] = B->data[i * columns + j] + t * last[j];
+  }
+  memcpy(C + (n - 1) * columns, last, sizeof(double) * columns);
+}
+
+// A * T: only the last column changes, it becomes A * t + a_last
+static void mult_translation_right(const chain_operand_t *A,
+                                   const chain_operand_t *B, double *C) {
+  int rows = A->rows, n = B->columns;
+  for (int i = 0; i < rows; i++) {
+    const double *a_row = A->data + i * n;
+    double sum = 0.0;
+    for (int k = 0; k < n - 1; k++) sum += a_row[k] * B->data[k * n + n - 1];
+    memcpy(C + i * n, a_row, sizeof(double) * (n - 1));
+    C[i * n + n - 1] = sum + a_row[n - 1];
+  }
+}
+
+// Both operands keep (0, ..., 0, 1) as the last row, so does the product
+static void mult_affine(const chain_operand_t *A, const chain_operand_t *B,
+                        double *C) {
+  int n = A->rows;
+  if (n == 4)
+    mult_block(A->data, B->data, C, 3, 3, 4, 4);
+  else
+    mult_block(A->data, B->data, C, n - 1, n - 1, n, n);
+  for (int i = 0; i < n - 1; i++) C[i * n + n - 1] += A->data[i * n + n - 1];
+  for (int j = 0; j < n; j++) C[(n - 1) * n + j] = j == n - 1 ? 1.0 : 0.0;
+}
+
+static void mult_operands(const chain_operand_t *A, const chain_operand_t *B,
+                          double *C) {
+  bool a_affine = A->kind == KIND_AFFINE || A->kind == KIND_TRANSLATION;
+  bool b_affine = B->kind == KIND_AFFINE || B->kind == KIND_TRANSLATION;
+
+  if (A->kind == KIND_DIAGONAL)
+    mult_diagonal_left(A, B, C);
+  else if (B->kind == KIND_DIAGONAL)
+    mult_diagonal_right(A, B, C);
+  else if (A->kind == KIND_TRANSLATION)
+    mult_translation_left(A, B, C);
+  else if (B->kind == KIND_TRANSLATION)
+    mult_translation_right(A, B, C);
+  else if (a_affine && b_affine)
+    mult_affine(A, B, C);
+  else
+    mult_general(A, B, C);
+}
+
+// Multiplications done by mult_operands for the given shapes and kinds
+static long long mult_cost(const chain_operand_t *A, const chain_operand_t *B) {
+  long long rows = A->rows, inner = A->columns, columns = B->columns;
+  bool a_affine = A->kind == KIND_AFFINE || A->kind == KIND_TRANSLATION;
+  bool b_affine = B->kind == KIND_AFFINE || B->kind == KIND_TRANSLATION;
+
+  long long cost = rows * inner * columns;
+  if (A->kind == KIND_DIAGONAL || B->kind == KIND_DIAGONAL ||
+      A->kind == KIND_TRANSLATION)
+    cost = rows * columns;
+  else if (B->kind == KIND_TRANSLATION)
+    cost = rows * inner;
+  else if (a_affine && b_affine)
+    cost = (rows - 1) * (inner - 1) * columns;
+  return cost;
+}
+
+// Matrix-chain DP, with the classic rows * inner * columns cost replaced by
+// the cost of the kernel that would actually run. The kind of a subproduct
+// does not depend on its parenthesization, so it is tracked per (i, j).
+// split[i * n + j] is the k such that i..j is computed as (i..k) * (k+1..j).
+static void find_order(chain_operand_t *operands, int n, long long *cost,
+                       int *split, int *kind) {
+  for (int i = 0; i < n; i++) {
+    cost[i * n + i] = 0;
+    kind[i * n + i] = operands[i].kind;
+  }
+
+  for (int len = 2; len <= n; len++) {
+    for (int i = 0; i + len - 1 < n; i++) {
+      int j = i + len - 1;
+      cost[i * n + j] = -1;
+      for (int k = i; k < j; k++) {
+        chain_operand_t left = {.rows = operands[i].rows,
+                                .columns = operands[k].columns,
+                                .kind = kind[i * n + k]};
+        chain_operand_t right = {.rows = operands[k + 1].rows,
+                                 .columns = operands[j].columns,
+                                 .kind = kind[(k + 1) * n + j]};
+        long long c = cost[i * n + k] + cost[(k + 1) * n + j] +
+                      mult_cost(&left, &right);
+        if (cost[i * n + j] < 0 || c < cost[i * n + j]) {
+          cost[i * n + j] = c;
+          split[i * n + j] = k;
+          kind[i * n + j] = product_kind(&left, &right);
+        }
+      }
+    }
+  }
+}
+
+// Scratch is used as a stack: children of a node are released as soon as the
+// node itself is computed. Returns the peak size in doubles.
+static size_t scratch_peak(const chain_ctx_t *ctx, int i, int j) {
+  if (i == j) return 0;
+
+  int k = ctx->split[i * ctx->n + j];
+  size_t left = (size_t)ctx->operands[i].rows * ctx->operands[k].columns;
+  size_t right = (size_t)ctx->operands[k + 1].rows * ctx->operands[j].columns;
+  if (i == k) left = 0;
+  if (k + 1 == j) right = 0;
+
+  size_t peak_left = left + scratch_peak(ctx, i, k);
+  size_t peak_right = left + right + scratch_peak(ctx, k + 1, j);
+  return peak_left > peak_right ? peak_left : peak_right;
+}
+
+static chain_operand_t eval_chain(chain_ctx_t *ctx, int i, int j, double *dst);
+
+static chain_operand_t eval_child(chain_ctx_t *ctx, int i, int j) {
+  chain_operand_t result;
+  if (i == j) {
+    result = ctx->operands[i];
+  } else {
+    double *dst = ctx->scratch + ctx->scratch_top;
+    ctx->scratch_top += (size_t)ctx->operands[i].rows * ctx->operands[j].columns;
+    result = eval_chain(ctx, i, j, dst);
+  }
+  return result;
+}
+
+static chain_operand_t eval_chain(chain_ctx_t *ctx, int i, int j, double *dst) {
+  size_t mark = ctx->scratch_top;
+  int k = ctx->split[i * ctx->n + j];
+
+  chain_operand_t left = eval_child(ctx, i, k);
+  chain_operand_t right = eval_child(ctx, k + 1, j);
+  mult_operands(&left, &right, dst);
+  ctx->scratch_top = mark;
+
+  return (chain_operand_t){
+      .data = dst,
+      .rows = left.rows,
+      .columns = right.columns,
+      .kind = product_kind(&left, &right),
+  };
+}
+
+static int check_chain(matrix_t **mats, int n, matrix_t *out) {
+  int ret_val = OK;
+
+  if (mats == NULL || out == NULL || n <= 0) ret_val = ERROR;
+  for (int i = 0; i < n && ret_val == OK; i++)
+    if (!s21_is_matrix_valid(mats[i])) ret_val = ERROR;
+  for (int i = 0; i + 1 < n && ret_val == OK; i++)
+    if (mats[i]->columns != mats[i + 1]->rows) ret_val = CALC_ERROR;
+
+  return ret_val;
+}
+
+// Points operands at the data of mats and classifies them. Operands that were
+// not created by s21_create_matrix get copied into one block, which is
+// returned through copies and has to be freed by the caller.
+static int bind_operands(matrix_t **mats, int n, chain_operand_t *operands,
+                         double **copies) {
+  size_t copies_size = 0;
+  for (int i = 0; i < n; i++)
+    if (!s21_is_matrix_contiguous(mats[i]))
+      copies_size += (size_t)mats[i]->rows * mats[i]->columns;
+
+  *copies = NULL;
+  if (copies_size > 0) *copies = (double *)malloc(sizeof(double) * copies_size);
+  if (copies_size > 0 && *copies == NULL) return ERROR;
+
+  double *next_copy = *copies;
+  for (int i = 0; i < n; i++) {
+    const matrix_t *m = mats[i];
+    const double *data = m->matrix[0];
+    if (!s21_is_matrix_contiguous(m)) {
+      for (int r = 0; r < m->rows; r++)
+        memcpy(next_copy + (size_t)r * m->columns, m->matrix[r],
+               sizeof(double) * m->columns);
+      data = next_copy;
+      next_copy += (size_t)m->rows * m->columns;
+    }
+    operands[i] = (chain_operand_t){
+        .data = data,
+        .rows = m->rows,
+        .columns = m->columns,
+        .kind = classify(data, m->rows, m->columns),
+    };
+  }
+  return OK;
+}
+
+int s21_mult_chain(matrix_t **mats, int n, matrix_t *out) {
+  if (out != NULL) s21_nullify_matrix(out);
+  int ret_val = check_chain(mats, n, out);
+
+  if (ret_val == OK)
+    ret_val = s21_create_matrix(mats[0]->rows, mats[n - 1]->columns, out);
+
+  if (ret_val == OK && n == 1) {
+    for (int i = 0; i < out->rows; i++)
+      memcpy(out->matrix[i], mats[0]->matrix[i], sizeof(double) * out->columns);
+  } else if (ret_val == OK) {
+    long long cost_buf[CHAIN_STACK_LIMIT * CHAIN_STACK_LIMIT];
+    int split_buf[CHAIN_STACK_LIMIT * CHAIN_STACK_LIMIT];
+    int kind_buf[CHAIN_STACK_LIMIT * CHAIN_STACK_LIMIT];
+    chain_operand_t operands_buf[CHAIN_STACK_LIMIT];
+    double scratch_buf[CHAIN_STACK_SCRATCH];
+
+    long long *cost = cost_buf;
+    int *split = split_buf, *kind = kind_buf;
+    chain_operand_t *operands = operands_buf;
+    if (n > CHAIN_STACK_LIMIT) {
+      cost = (long long *)malloc(sizeof(long long) * n * n);
+      split = (int *)malloc(sizeof(int) * n * n);
+      kind = (int *)malloc(sizeof(int) * n * n);
+      operands = (chain_operand_t *)malloc(sizeof(chain_operand_t) * n);
+    }
+
+    chain_ctx_t ctx = {
+        .operands = operands,
+        .split = split,
+        .n = n,
+        .scratch = scratch_buf,
+        .scratch_top = 0,
+    };
+
+    double *copies = NULL;
+    if (cost == NULL || split == NULL || kind == NULL || operands == NULL)
+      ret_val = ERROR;
+    else
+      ret_val = bind_operands(mats, n, operands, &copies);
+
+    if (ret_val == OK) {
+      size_t largest = 0;
+      for (int i = 0; i < n; i++) {
+        if ((size_t)operands[i].rows > largest) largest = operands[i].rows;
+        if ((size_t)operands[i].columns > largest) largest = operands[i].columns;
+      }
+      if (n == 2)
+        split[1] = 0;
+      else
+        find_order(operands, n, cost, split, kind);
+
+      // At most n - 1 intermediates of at most largest^2 each are alive at
+      // once, so the exact peak only matters when that bound is large.
+      size_t peak = (size_t)(n - 1) * largest * largest;
+      if (peak > CHAIN_STACK_SCRATCH) peak = scratch_peak(&ctx, 0, n - 1);
+      if (peak > CHAIN_STACK_SCRATCH) {
+        ctx.scratch = (double *)malloc(sizeof(double) * peak);
+        if (ctx.scratch == NULL) ret_val = ERROR;
+      }
+    }
+
+    if (ret_val == OK)
+      eval_chain(&ctx, 0, n - 1, out->matrix[0]);
+    else
+      s21_remove_matrix(out);
+
+    free(copies);
+    if (ctx.scratch != scratch_buf) free(ctx.scratch);
+    if (n > CHAIN_STACK_LIMIT) {
+      free(cost);
+      free(split);
+      free(kind);
+      free(operands);
+    }
+  }
+
+  return ret_val;
+}
@@ -0,0 +1,111 @@
+#include "s21_quaternion.h"
+
+#include <math.h>
+#include "../util/prettify_c.h"
+
+// Cosine of the angle between the inputs, the dot product, above which
+// slerp falls back to normalized lerp: the angle is so small that
+// sin(theta) gets too small to divide by
+#define SLERP_LINEAR_THRESHOLD 0.9995
+
+quaternion_t s21_quat_identity() {
+    return (quaternion_t) {.w = 1.0, .x = 0.0, .y = 0.0, .z = 0.0};
+}
+
+quaternion_t s21_quat_from_rotation(double angle, int axis_from, int axis_into) {
+    quaternion_t result = s21_quat_identity();
+    if (axis_from is axis_into)
+        return result;
+
+    // Rotation in the plane (from, into) is a rotation around the third axis,
+    // positive when (from, into) goes in the X -> Y -> Z -> X order
+    int axis = 3 - axis_from - axis_into;
+    double sign = (axis_into - axis_from + 3) % 3 is 1 ? 1.0 : -1.0;
+    double half_sin = sign * sin(angle / 2.0);
+
+    result.w = cos(angle / 2.0);
+    if (axis is AXIS_X) result.x = half_sin;
+    if (axis is AXIS_Y) result.y = half_sin;
+    if (axis is AXIS_Z) result.z = half_sin;
+    return result;
+}
+
+quaternion_t s21_quat_from_rotations_camera(double axz, double ayz, double axy) {
+    quaternion_t xz = s21_quat_from_rotation(axz, AXIS_X, AXIS_Z);
+    quaternion_t yz = s21_quat_from_rotation(ayz, AXIS_Y, AXIS_Z);
+    quaternion_t xy = s21_quat_from_rotation(axy, AXIS_X, AXIS_Y);
+
+    return s21_quat_mult(s21_quat_mult(xz, yz), xy);
+}
+
+quaternion_t s21_quat_mult(quaternion_t a, quaternion_t b) {
+    return (quaternion_t) {
+        .w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        .x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        .y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        .z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+    };
+}
+
+quaternion_t s21_quat_normalize(quaternion_t q) {
+    double length = sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    if (length is 0.0)
+        return s21_quat_identity();
+
+    return (quaternion_t) {
+        .w = q.w / length,
+        .x = q.x / length,
+        .y = q.y / length,
+        .z = q.z / length,
+    };
+}
+
+quaternion_t s21_quat_slerp(quaternion_t a, quaternion_t b, double t) {
+    double dot = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+
+    // q and -q are the same rotation, pick the one that is closer to a
+    if (dot < 0.0) {
+        b = (quaternion_t) {.w = -b.w, .x = -b.x, .y = -b.y, .z = -b.z};
+        dot = -dot;
+    }
+
+    double weight_a = 1.0 - t;
+    double weight_b = t;
+    if (dot < SLERP_LINEAR_THRESHOLD) {
+        double theta = acos(dot);
+        double sin_theta = sin(theta);
+        weight_a = sin((1.0 - t) * theta) / sin_theta;
+        weight_b = sin(t * theta) / sin_theta;
+    }
+
+    quaternion_t result = {
+        .w = weight_a * a.w + weight_b * b.w,
+        .x = weight_a * a.x + weight_b * b.x,
+        .y = weight_a * a.y + weight_b * b.y,
+        .z = weight_a * a.z + weight_b * b.z,
+    };
+    return s21_quat_normalize(result);
+}
+
+matrix_t s21_quat_to_matrix(quaternion_t q) {
+    matrix_t result = s21_create_unit_matrix();
+    double** m = result.matrix;
+
+    double xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    double xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    double wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    m[0][0] = 1.0 - 2.0 * (yy + zz);
+    m[0][1] = 2.0 * (xy - wz);
+    m[0][2] = 2.0 * (xz + wy);
+
+    m[1][0] = 2.0 * (xy + wz);
+    m[1][1] = 1.0 - 2.0 * (xx + zz);
+    m[1][2] = 2.0 * (yz - wx);
+
+    m[2][0] = 2.0 * (xz - wy);
+    m[2][1] = 2.0 * (yz + wx);
+    m[2][2] = 1.0 - 2.0 * (xx + yy);
+
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef SRC_MATRIX_S21_QUATERNION_H_
+#define SRC_MATRIX_S21_QUATERNION_H_
+
+#include "s21_matrix.h"
+
+// Rotations are kept as unit quaternions and composed without building any
+// matrices. Conversion to matrix_t happens once, when the result is needed.
+typedef struct quaternion {
+  double w;
+  double x;
+  double y;
+  double z;
+} quaternion_t;
+
+quaternion_t s21_quat_identity();
+// Same rotation as s21_create_rotation_matrix(angle, axis_from, axis_into)
+quaternion_t s21_quat_from_rotation(double angle, int axis_from, int axis_into);
+// Same rotation as s21_create_rotations_camera(axz, ayz, axy)
+quaternion_t s21_quat_from_rotations_camera(double axz, double ayz, double axy);
+
+// a * b applies b first, like the matrix product
+quaternion_t s21_quat_mult(quaternion_t a, quaternion_t b);
+quaternion_t s21_quat_normalize(quaternion_t q);
+// Shortest-arc spherical interpolation, t = 0 gives a and t = 1 gives b
+quaternion_t s21_quat_slerp(quaternion_t a, quaternion_t b, double t);
+
+// 4x4 homogeneous rotation matrix of a unit quaternion
+matrix_t s21_quat_to_matrix(quaternion_t q);
+
+#endif
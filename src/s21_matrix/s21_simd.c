@@ -0,0 +1,14 @@
+#include "s21_simd.h"
+
+static bool ForceScalar = false;
+
+bool s21_simd_has_avx2(void) {
+  bool result = false;
+#ifdef S21_SIMD_X86
+  __builtin_cpu_init();
+  result = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+  return result && !ForceScalar;
+}
+
+void s21_simd_force_scalar(bool force) { ForceScalar = force; }
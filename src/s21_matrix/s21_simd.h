@@ -0,0 +1,19 @@
+#ifndef SRC_MATRIX_S21_SIMD_H_
+#define SRC_MATRIX_S21_SIMD_H_
+
+#include <stdbool.h>
+
+// Vectorized kernels are compiled with per-function target attributes, so the
+// library still builds for the baseline ISA and picks a kernel at runtime.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define S21_SIMD_X86 1
+#define S21_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+// True when AVX2 + FMA kernels may be used on this CPU
+bool s21_simd_has_avx2(void);
+// Makes every dispatching function take its scalar path. Used by tests to
+// check that both paths agree.
+void s21_simd_force_scalar(bool force);
+
+#endif
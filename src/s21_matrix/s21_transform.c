@@ -0,0 +1,182 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../util/jobs.h"
+#include "s21_matrix.h"
+#include "s21_simd.h"
+
+#ifdef S21_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Smaller batches are transformed on the calling thread, a job is not free
+#define TRANSFORM_POINTS_PER_CHUNK (1 << 16)
+
+typedef struct transform_args {
+  float m[4][4];
+  bool projective;  // last row is not (0, 0, 0, 1), divide by w
+
+  // Interleaved layout
+  const float *in;
+  float *out;
+  size_t stride;
+
+  // Separate x, y and z arrays
+  const float *in_soa[3];
+  float *out_soa[3];
+} transform_args_t;
+
+typedef void (*transform_kernel_t)(const transform_args_t *args, size_t begin,
+                                   size_t end);
+
+static void transform_scalar(const transform_args_t *args, float x, float y,
+                             float z, float *rx, float *ry, float *rz) {
+  const float(*m)[4] = args->m;
+  *rx = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+  *ry = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+  *rz = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+  if (args->projective) {
+    float w = m[3][0] * x + m[3][1] * y + m[3][2] * z + m[3][3];
+    *rx /= w;
+    *ry /= w;
+    *rz /= w;
+  }
+}
+
+static void transform_aos_scalar(const transform_args_t *args, size_t begin,
+                                 size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    const float *p = args->in + i * args->stride;
+    float *q = args->out + i * args->stride;
+    transform_scalar(args, p[0], p[1], p[2], &q[0], &q[1], &q[2]);
+  }
+}
+
+static void transform_soa_scalar(const transform_args_t *args, size_t begin,
+                                 size_t end) {
+  for (size_t i = begin; i < end; i++)
+    transform_scalar(args, args->in_soa[0][i], args->in_soa[1][i],
+                     args->in_soa[2][i], &args->out_soa[0][i],
+                     &args->out_soa[1][i], &args->out_soa[2][i]);
+}
+
+#ifdef S21_SIMD_X86
+// One point per 128-bit register: columns of the matrix are scaled by x, y
+// and z, so the four lanes end up holding (x', y', z', w'). Masked loads and
+// stores touch exactly three floats, the rest of the vertex stays intact.
+S21_TARGET_AVX2 static void transform_aos_avx2(const transform_args_t *args,
+                                               size_t begin, size_t end) {
+  const float(*m)[4] = args->m;
+  __m128 c0 = _mm_setr_ps(m[0][0], m[1][0], m[2][0], m[3][0]);
+  __m128 c1 = _mm_setr_ps(m[0][1], m[1][1], m[2][1], m[3][1]);
+  __m128 c2 = _mm_setr_ps(m[0][2], m[1][2], m[2][2], m[3][2]);
+  __m128 c3 = _mm_setr_ps(m[0][3], m[1][3], m[2][3], m[3][3]);
+  __m128i xyz = _mm_setr_epi32(-1, -1, -1, 0);
+
+  for (size_t i = begin; i < end; i++) {
+    const float *p = args->in + i * args->stride;
+    __m128 r = _mm_fmadd_ps(c0, _mm_broadcast_ss(p), c3);
+    r = _mm_fmadd_ps(c1, _mm_broadcast_ss(p + 1), r);
+    r = _mm_fmadd_ps(c2, _mm_broadcast_ss(p + 2), r);
+    if (args->projective)
+      r = _mm_div_ps(r, _mm_permute_ps(r, _MM_SHUFFLE(3, 3, 3, 3)));
+    _mm_maskstore_ps(args->out + i * args->stride, xyz, r);
+  }
+}
+
+// Eight points per iteration, one FMA chain per output coordinate
+S21_TARGET_AVX2 static void transform_soa_avx2(const transform_args_t *args,
+                                               size_t begin, size_t end) {
+  __m256 m[4][4];
+  for (int r = 0; r < 4; r++)
+    for (int c = 0; c < 4; c++) m[r][c] = _mm256_set1_ps(args->m[r][c]);
+
+  size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    __m256 x = _mm256_loadu_ps(args->in_soa[0] + i);
+    __m256 y = _mm256_loadu_ps(args->in_soa[1] + i);
+    __m256 z = _mm256_loadu_ps(args->in_soa[2] + i);
+
+    __m256 result[4];
+    for (int r = 0; r < (args->projective ? 4 : 3); r++) {
+      result[r] = _mm256_fmadd_ps(m[r][0], x, m[r][3]);
+      result[r] = _mm256_fmadd_ps(m[r][1], y, result[r]);
+      result[r] = _mm256_fmadd_ps(m[r][2], z, result[r]);
+    }
+    for (int r = 0; r < 3; r++) {
+      if (args->projective) result[r] = _mm256_div_ps(result[r], result[3]);
+      _mm256_storeu_ps(args->out_soa[r] + i, result[r]);
+    }
+  }
+  transform_soa_scalar(args, i, end);
+}
+#endif
+
+typedef struct transform_job {
+  transform_kernel_t kernel;
+  const transform_args_t *args;
+} transform_job_t;
+
+static void transform_job_run(void *ctx, size_t begin, size_t end) {
+  transform_job_t *job = (transform_job_t *)ctx;
+  job->kernel(job->args, begin, end);
+}
+
+// Chunks of [0, n) go to the shared job system, whatever it does not pick up
+// runs on the calling thread.
+static void transform_run(transform_kernel_t kernel,
+                          const transform_args_t *args, size_t n) {
+  transform_job_t job = {.kernel = kernel, .args = args};
+  parallel_for(0, n, TRANSFORM_POINTS_PER_CHUNK, transform_job_run, &job);
+}
+
+static int transform_args_init(const matrix_t *mat, transform_args_t *args) {
+  if (!s21_is_matrix_valid(mat) || mat->rows != 4 || mat->columns != 4)
+    return ERROR;
+
+  *args = (transform_args_t){0};
+  for (int r = 0; r < 4; r++)
+    for (int c = 0; c < 4; c++) args->m[r][c] = (float)mat->matrix[r][c];
+  args->projective = mat->matrix[3][0] != 0.0 || mat->matrix[3][1] != 0.0 ||
+                     mat->matrix[3][2] != 0.0 || mat->matrix[3][3] != 1.0;
+  return OK;
+}
+
+int s21_transform_points(const matrix_t *mat, const float *in, float *out,
+                         size_t n, size_t stride) {
+  transform_args_t args;
+  if (in == NULL || out == NULL || stride < 3) return ERROR;
+  if (transform_args_init(mat, &args) != OK) return ERROR;
+
+  args.in = in;
+  args.out = out;
+  args.stride = stride;
+
+  transform_kernel_t kernel = transform_aos_scalar;
+#ifdef S21_SIMD_X86
+  if (s21_simd_has_avx2()) kernel = transform_aos_avx2;
+#endif
+  transform_run(kernel, &args, n);
+  return OK;
+}
+
+int s21_transform_points_soa(const matrix_t *mat, const float *const in[3],
+                             float *const out[3], size_t n) {
+  transform_args_t args;
+  if (in == NULL || out == NULL) return ERROR;
+  for (int i = 0; i < 3; i++)
+    if (in[i] == NULL || out[i] == NULL) return ERROR;
+  if (transform_args_init(mat, &args) != OK) return ERROR;
+
+  for (int i = 0; i < 3; i++) {
+    args.in_soa[i] = in[i];
+    args.out_soa[i] = out[i];
+  }
+
+  transform_kernel_t kernel = transform_soa_scalar;
+#ifdef S21_SIMD_X86
+  if (s21_simd_has_avx2()) kernel = transform_soa_avx2;
+#endif
+  transform_run(kernel, &args, n);
+  return OK;
+}
@@ -1,6 +1,7 @@
 #include <check.h>
 #include <float.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -88,6 +89,34 @@ START_TEST(faces_test) {
   obj_model_free(mdl);
 }
 
+START_TEST(bad_lines_test) {
+  FILE *file = fopen("bad_lines_test.tmp.obj", "wb");
+  fputs("v 1 2\n"                 // too few coordinates
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+        "vn 0 x 1\nvn 0 0 1\n"
+        "f 1/2/3/4 2 3\n"          // too many slashes
+        "f 2 a 3\n"
+        "f 2 3\n"                  // too few corners
+        "f 2 3 9\n"                // past the last vertex
+        "f 2//3 3//2 4//2\n"       // past the last normal
+        "f -5 3 4\n"               // back past the first vertex
+        "f 2//2 3//2 -1//2\n",
+        file);
+  fclose(file);
+  ObjModel mdl = obj_parse_model("bad_lines_test.tmp.obj");
+  remove("bad_lines_test.tmp.obj");
+
+  // Bad vertices and normals keep their place
+  ck_assert_int_eq(mdl.vertices.length, 4);
+  ck_assert_float_eq(mdl.vertices.data[1].x, 0);
+  ck_assert_int_eq(mdl.normals.length, 2);
+  ck_assert_float_eq(mdl.normals.data[1].z, 1);
+  ck_assert_int_eq(mdl.bad_lines, 8);
+  ck_assert_int_eq(mdl.faces.length, 1);
+  ck_assert_int_eq(mdl.faces.data[0].indices.data[2].point, 4);
+  obj_model_free(mdl);
+}
+
 Suite *transformations_suite(void) {
   Suite *s;
   TCase *tc_core;
@@ -99,6 +128,7 @@ Suite *transformations_suite(void) {
   tcase_add_test(tc_core, vertices_test);
   tcase_add_test(tc_core, normals_test);
   tcase_add_test(tc_core, faces_test);
+  tcase_add_test(tc_core, bad_lines_test);
   suite_add_tcase(s, tc_core);
   return s;
 }
@@ -0,0 +1,159 @@
+#include <check.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../util/allocator.h"
+#include "../util/better_string.h"
+
+START_TEST(test_arena_alloc_reset) {
+  Arena arena = arena_create(256);
+
+  char *a = arena_alloc(&arena, 10);
+  char *b = arena_alloc(&arena, 10);
+  ck_assert_int_eq((uintptr_t)a % 16, 0);
+  ck_assert_int_eq((uintptr_t)b % 16, 0);
+  ck_assert_ptr_ne(a, b);
+
+  // Overflows the first chunk, then reset merges the chunks into one
+  for (int i = 0; i < 10; i++) memset(arena_alloc(&arena, 100), i, 100);
+  arena_reset(&arena);
+  char *first = arena_alloc(&arena, 1000);
+  memset(first, 1, 1000);
+  ck_assert_ptr_eq(arena_alloc(&arena, 100), first + 1008);
+
+  arena_free(arena);
+}
+END_TEST
+
+START_TEST(test_arena_realloc) {
+  Arena arena = arena_create(1024);
+
+  char *a = arena_alloc(&arena, 16);
+  strcpy(a, "grow in place");
+  ck_assert_ptr_eq(arena_realloc(&arena, a, 16, 64), a);
+
+  arena_alloc(&arena, 16);
+  char *moved = arena_realloc(&arena, a, 64, 128);
+  ck_assert_ptr_ne(moved, a);
+  ck_assert_str_eq(moved, "grow in place");
+
+  // Bigger than a chunk
+  char *big = arena_realloc(&arena, moved, 128, 4096);
+  ck_assert_str_eq(big, "grow in place");
+
+  arena_free(arena);
+}
+END_TEST
+
+START_TEST(test_arena_strings) {
+  Arena arena = arena_create(64);
+
+  str_t s = str_arena(&arena, "Vertices: %d | Indices: %d", 1234, 5678);
+  ck_assert_str_eq(s.string, "Vertices: 1234 | Indices: 5678");
+  ck_assert(!s.is_owned);
+  str_free(s);  // borrowed, does nothing
+
+  char long_text[300];
+  memset(long_text, 'x', sizeof(long_text) - 1);
+  long_text[sizeof(long_text) - 1] = '\0';
+  str_t long_s = str_arena(&arena, "%s!", long_text);
+  ck_assert_int_eq(strlen(long_s.string), 300);
+
+  arena_free(arena);
+}
+END_TEST
+
+START_TEST(test_arena_matrix) {
+  Arena arena = arena_create(1024);
+
+  matrix_t A, B, product;
+  ck_assert_int_eq(s21_create_matrix_in(&arena, 2, 3, &A), OK);
+  ck_assert_int_eq(s21_create_matrix_in(&arena, 3, 2, &B), OK);
+  ck_assert(s21_is_matrix_contiguous(&A));
+  ck_assert_double_eq(A.matrix[1][2], 0.0);
+
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 3; j++) {
+      A.matrix[i][j] = i + j;
+      B.matrix[j][i] = i - j;
+    }
+  ck_assert_int_eq(s21_mult_matrix(&A, &B, &product), OK);
+  ck_assert_double_eq(product.matrix[1][1], 1 * 1 + 2 * 0 + 3 * -1);
+  s21_remove_matrix(&product);
+
+  ck_assert_int_eq(s21_create_matrix_in(&arena, 0, 3, &A), ERROR);
+
+  arena_free(arena);
+}
+END_TEST
+
+START_TEST(test_allocator_tags) {
+  AllocStats before = my_allocator_stats(ALLOC_TAG_PARSER);
+  AllocTag old_tag = alloc_tag_set(ALLOC_TAG_PARSER);
+  char *a = MALLOC(100);
+  alloc_tag_set(old_tag);
+  a = REALLOC(a, 1000);
+  memset(a, 0, 1000);
+
+  AllocStats during = my_allocator_stats(ALLOC_TAG_PARSER);
+  FREE(a);
+  AllocStats after = my_allocator_stats(ALLOC_TAG_PARSER);
+
+#ifdef ALLOC_TRACKING
+  // Realloc keeps the tag of the original block
+  ck_assert_int_eq(during.live_bytes - before.live_bytes, 1000);
+  ck_assert(during.peak_bytes >= during.live_bytes);
+  ck_assert_int_eq(after.live_bytes, before.live_bytes);
+  ck_assert_int_eq(after.frees - before.frees, 2);
+#else
+  // Without tracking every tag reads as nothing at all
+  ck_assert_int_eq(before.allocs, 0);
+  ck_assert_int_eq(during.allocs, 0);
+  ck_assert_int_eq(after.live_bytes, 0);
+#endif
+}
+END_TEST
+
+START_TEST(test_huge_realloc) {
+  // Starts on the heap, crosses into a mapping, then grows the mapping
+  size_t sizes[] = {1000, HUGE_ALLOC_MAP_MIN / 2, HUGE_ALLOC_MAP_MIN * 3,
+                    HUGE_ALLOC_THP_MIN * 5};
+  int *data = null;
+  size_t filled = 0;
+  for (int s = 0; s < 4; s++) {
+    data = huge_realloc(data, sizes[s]);
+    ck_assert_ptr_nonnull(data);
+    ck_assert_int_eq((uintptr_t)data % 16, 0);
+    for (size_t i = 0; i < filled; i++) ck_assert_int_eq(data[i], (int)i);
+    for (filled = 0; filled < sizes[s] / sizeof(int); filled++)
+      data[filled] = (int)filled;
+  }
+
+  // Shrinking a mapping keeps the front
+  data = huge_realloc(data, HUGE_ALLOC_MAP_MIN * 2);
+  ck_assert_int_eq(data[HUGE_ALLOC_MAP_MIN / 2 - 1], HUGE_ALLOC_MAP_MIN / 2 - 1);
+  huge_free(data);
+  huge_free(huge_malloc(10));
+  huge_free(null);
+}
+END_TEST
+
+Suite *arena_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("arena");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_arena_alloc_reset);
+  tcase_add_test(tc_core, test_arena_realloc);
+  tcase_add_test(tc_core, test_arena_strings);
+  tcase_add_test(tc_core, test_arena_matrix);
+  tcase_add_test(tc_core, test_allocator_tags);
+  tcase_add_test(tc_core, test_huge_realloc);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
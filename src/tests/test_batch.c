@@ -0,0 +1,164 @@
+#include <check.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../s21_matrix/s21_simd.h"
+
+#define EPSILON 1e-9
+// Not a multiple of the SIMD width, so the scalar tail is covered too
+#define BATCH_COUNT 13
+
+static double test_element(size_t i, int k) {
+  return (double)((int)((i * 5 + k * 11 + i * k) % 19) - 9) * 0.5;
+}
+
+static double *create_batch(int size, size_t n, int seed) {
+  double *data = malloc(sizeof(double) * size * size * n);
+  for (size_t i = 0; i < n; i++)
+    for (int k = 0; k < size * size; k++)
+      data[k * n + i] = test_element(i + seed, k);
+  return data;
+}
+
+static matrix_t batch_get(const double *data, int size, size_t n, size_t i) {
+  matrix_t result;
+  s21_create_matrix(size, size, &result);
+  for (int r = 0; r < size; r++)
+    for (int c = 0; c < size; c++)
+      result.matrix[r][c] = data[(r * size + c) * n + i];
+  return result;
+}
+
+static void assert_batch_matches(const double *data, int size, size_t n,
+                                 size_t i, matrix_t *expected) {
+  for (int r = 0; r < size; r++)
+    for (int c = 0; c < size; c++)
+      ck_assert_double_eq_tol(data[(r * size + c) * n + i],
+                              expected->matrix[r][c], EPSILON);
+}
+
+START_TEST(test_batch_determinant) {
+  for (int size = 3; size <= 4; size++) {
+    for (int scalar = 0; scalar <= 1; scalar++) {
+      s21_simd_force_scalar(scalar);
+      double *mats = create_batch(size, BATCH_COUNT, 0);
+      double det[BATCH_COUNT];
+      ck_assert_int_eq(s21_batch_determinant(mats, size, BATCH_COUNT, det), OK);
+
+      for (size_t i = 0; i < BATCH_COUNT; i++) {
+        matrix_t A = batch_get(mats, size, BATCH_COUNT, i);
+        double expected = 0.0;
+        s21_determinant(&A, &expected);
+        ck_assert_double_eq_tol(det[i], expected, EPSILON);
+        s21_remove_matrix(&A);
+      }
+      free(mats);
+    }
+  }
+  s21_simd_force_scalar(false);
+}
+END_TEST
+
+START_TEST(test_batch_inverse) {
+  for (int size = 3; size <= 4; size++) {
+    for (int scalar = 0; scalar <= 1; scalar++) {
+      s21_simd_force_scalar(scalar);
+      double *mats = create_batch(size, BATCH_COUNT, 1);
+      // Make matrix 2 singular: its first row repeats the second one
+      for (int c = 0; c < size; c++)
+        mats[c * BATCH_COUNT + 2] = mats[(size + c) * BATCH_COUNT + 2];
+
+      double *inverse = create_batch(size, BATCH_COUNT, 0);
+      ck_assert_int_eq(s21_batch_inverse(mats, size, BATCH_COUNT, inverse),
+                       CALC_ERROR);
+
+      for (size_t i = 0; i < BATCH_COUNT; i++) {
+        matrix_t A = batch_get(mats, size, BATCH_COUNT, i), expected;
+        if (s21_inverse_matrix(&A, &expected) == OK) {
+          assert_batch_matches(inverse, size, BATCH_COUNT, i, &expected);
+          s21_remove_matrix(&expected);
+        } else {
+          for (int k = 0; k < size * size; k++)
+            ck_assert(isnan(inverse[k * BATCH_COUNT + i]));
+        }
+        s21_remove_matrix(&A);
+      }
+      free(mats);
+      free(inverse);
+    }
+  }
+  s21_simd_force_scalar(false);
+}
+END_TEST
+
+START_TEST(test_batch_inverse_in_place) {
+  double mats[] = {2, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  // Two diagonal matrices: diag(2, 1, 1) and diag(4, 2, 0.5)
+  mats[4 * 2 + 0] = 1, mats[4 * 2 + 1] = 2;
+  mats[8 * 2 + 0] = 1, mats[8 * 2 + 1] = 0.5;
+
+  ck_assert_int_eq(s21_batch_inverse(mats, 3, 2, mats), OK);
+  ck_assert_double_eq_tol(mats[0], 0.5, EPSILON);
+  ck_assert_double_eq_tol(mats[1], 0.25, EPSILON);
+  ck_assert_double_eq_tol(mats[4 * 2 + 1], 0.5, EPSILON);
+  ck_assert_double_eq_tol(mats[8 * 2 + 1], 2.0, EPSILON);
+}
+END_TEST
+
+START_TEST(test_batch_mult) {
+  for (int size = 3; size <= 4; size++) {
+    for (int scalar = 0; scalar <= 1; scalar++) {
+      s21_simd_force_scalar(scalar);
+      double *a = create_batch(size, BATCH_COUNT, 2);
+      double *b = create_batch(size, BATCH_COUNT, 3);
+      double *product = create_batch(size, BATCH_COUNT, 0);
+      ck_assert_int_eq(s21_batch_mult(a, b, size, BATCH_COUNT, product), OK);
+
+      for (size_t i = 0; i < BATCH_COUNT; i++) {
+        matrix_t A = batch_get(a, size, BATCH_COUNT, i);
+        matrix_t B = batch_get(b, size, BATCH_COUNT, i), expected;
+        s21_mult_matrix(&A, &B, &expected);
+        assert_batch_matches(product, size, BATCH_COUNT, i, &expected);
+        s21_remove_matrix(&A);
+        s21_remove_matrix(&B);
+        s21_remove_matrix(&expected);
+      }
+      free(a);
+      free(b);
+      free(product);
+    }
+  }
+  s21_simd_force_scalar(false);
+}
+END_TEST
+
+START_TEST(test_batch_invalid) {
+  double data[16] = {0};
+  ck_assert_int_eq(s21_batch_determinant(NULL, 3, 1, data), ERROR);
+  ck_assert_int_eq(s21_batch_determinant(data, 2, 1, data), ERROR);
+  ck_assert_int_eq(s21_batch_inverse(data, 5, 1, data), ERROR);
+  ck_assert_int_eq(s21_batch_inverse(data, 4, 1, NULL), ERROR);
+  ck_assert_int_eq(s21_batch_mult(data, NULL, 4, 1, data), ERROR);
+  ck_assert_int_eq(s21_batch_mult(data, data, 4, 0, data), OK);
+}
+END_TEST
+
+Suite *s21_batch_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("s21_batch");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_batch_determinant);
+  tcase_add_test(tc_core, test_batch_inverse);
+  tcase_add_test(tc_core, test_batch_inverse_in_place);
+  tcase_add_test(tc_core, test_batch_mult);
+  tcase_add_test(tc_core, test_batch_invalid);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,143 @@
+#define _POSIX_C_SOURCE 200809L  // fileno
+
+#include <check.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../util/better_io.h"
+#include "../util/better_io/fmt_number.h"
+#include "../util/prettify_c.h"
+
+static char *read_all(FILE *file) {
+  static char text[1 << 16];
+  rewind(file);
+  size_t length = fread(text, 1, sizeof(text) - 1, file);
+  text[length] = '\0';
+  return text;
+}
+
+static const char *shortest_double(double value) {
+  static char text[FMT_NUMBER_MAX + 1];
+  text[fmt_double_shortest(text, value)] = '\0';
+  return text;
+}
+
+static const char *shortest_float(float value) {
+  static char text[FMT_NUMBER_MAX + 1];
+  text[fmt_float_shortest(text, value)] = '\0';
+  return text;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+START_TEST(test_fmt_integers) {
+  char text[FMT_NUMBER_MAX + 1], expected[FMT_NUMBER_MAX + 1];
+  const long long values[] = {0, 7, -7, 10, 99, 100, -101, 123456789,
+                              LLONG_MAX, LLONG_MIN};
+  for (size_t i = 0; i < LEN(values); i++) {
+    text[fmt_i64(text, values[i])] = '\0';
+    sprintf(expected, "%lld", values[i]);
+    ck_assert_str_eq(text, expected);
+  }
+  text[fmt_u64(text, ULLONG_MAX)] = '\0';
+  ck_assert_str_eq(text, "18446744073709551615");
+}
+END_TEST
+
+START_TEST(test_fmt_shortest) {
+  ck_assert_str_eq(shortest_double(0.1), "0.1");
+  ck_assert_str_eq(shortest_double(1.0), "1");
+  ck_assert_str_eq(shortest_double(-0.0), "-0");
+  ck_assert_str_eq(shortest_double(123.456), "123.456");
+  ck_assert_str_eq(shortest_double(1e21), "1e21");
+  ck_assert_str_eq(shortest_double(1e-7), "1e-07");
+  ck_assert_str_eq(shortest_double(0.000025), "0.000025");
+  ck_assert_str_eq(shortest_double(5e-324), "5e-324");
+  ck_assert_str_eq(shortest_double(1.0 / 0.0), "inf");
+  ck_assert_str_eq(shortest_float(0.1f), "0.1");
+  ck_assert_str_eq(shortest_float(1.0f / 3), "0.33333334");
+  ck_assert_str_eq(shortest_float(3.4028235e38f), "3.4028235e38");
+
+  // Every bit pattern that is a number reads back to itself
+  uint64_t state = 88172645463325252ull;
+  for (int i = 0; i < 200000; i++) {
+    uint64_t bits = next_random(&state);
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    if (d == d and d - d == 0) ck_assert(strtod(shortest_double(d), null) == d);
+
+    uint32_t bits32 = (uint32_t)bits;
+    float f;
+    memcpy(&f, &bits32, sizeof(f));
+    if (f == f and f - f == 0) ck_assert(strtof(shortest_float(f), null) == f);
+  }
+}
+END_TEST
+
+START_TEST(test_x_sprintf_formats) {
+  FILE *file = tmpfile();
+  OutStream stream = outstream_from_file(file);
+  x_sprintf(stream, "%d|%i|%u|%ld|%lld|%5d|%-3d|%03d|%+d|% d|%.2f|%s|%$float|%$double",
+            -42, 7, 4000000000u, -1234567890123L, 9000000000000000000LL, 42,
+            1, 7, 5, 6, 3.14159, "text", 0.1f, 0.3);
+  fflush(file);
+  ck_assert_str_eq(read_all(file),
+                   "-42|7|4000000000|-1234567890123|9000000000000000000|   "
+                   "42|1  |007|+5| 6|3.14|text|0.1|0.3");
+  fclose(file);
+
+  // Longer than the stack buffer of put_format
+  file = tmpfile();
+  x_sprintf(outstream_from_file(file), "%.600f", 1.0);
+  fflush(file);
+  ck_assert_int_eq(strlen(read_all(file)), 602);
+  fclose(file);
+}
+END_TEST
+
+START_TEST(test_buffered_outstream) {
+  FILE *file = tmpfile();
+  // Small, so the text crosses the buffer and one piece skips it
+  BufferedOutStream buffered = buffered_outstream_create(fileno(file), 16);
+  OutStream stream = outstream_from_buffered(&buffered);
+
+  char big[40];
+  memset(big, 'b', sizeof(big) - 1);
+  big[sizeof(big) - 1] = '\0';
+  for (int i = 0; i < 10; i++) x_sprintf(stream, "line %d\n", i);
+  outstream_puts(big, stream);
+  outstream_putc('!', stream);
+  ck_assert(buffered_outstream_free(&buffered));
+
+  char expected[256] = "";
+  for (int i = 0; i < 10; i++) sprintf(expected + strlen(expected), "line %d\n", i);
+  strcat(expected, big);
+  strcat(expected, "!");
+  ck_assert_str_eq(read_all(file), expected);
+  fclose(file);
+}
+END_TEST
+
+Suite *better_io_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("better_io");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_fmt_integers);
+  tcase_add_test(tc_core, test_fmt_shortest);
+  tcase_add_test(tc_core, test_x_sprintf_formats);
+  tcase_add_test(tc_core, test_buffered_outstream);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
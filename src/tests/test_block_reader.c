@@ -0,0 +1,130 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../util/block_reader.h"
+#include "../util/block_stream.h"
+#include "../util/prettify_c.h"
+
+#define READER_PATH "block_reader_test.tmp"
+
+// Not a whole number of chunks, so the last one is short
+#define READER_FILE_SIZE (BLOCK_READER_QUEUE * BLOCK_READER_CHUNK_SIZE + 12345)
+
+static char *write_file(size_t size) {
+  char *data = malloc(size);
+  for (size_t i = 0; i < size; i++) data[i] = (char)(i * 7 + i / 4096);
+  FILE *file = fopen(READER_PATH, "wb");
+  fwrite(data, 1, size, file);
+  fclose(file);
+  return data;
+}
+
+// Every chunk lines up with the file, all but the last are full
+static void check_reads_back(BlockReaderKind kind, const char *expected, size_t size) {
+  BlockReader *reader = block_reader_open(READER_PATH, kind);
+  ck_assert_ptr_nonnull(reader);
+  size_t offset = 0;
+  const char *data;
+  size_t length;
+  while (block_reader_next(reader, &data, &length)) {
+    ck_assert_msg(offset + length <= size, "%s", block_reader_name(kind));
+    ck_assert(length is BLOCK_READER_CHUNK_SIZE or offset + length is size);
+    ck_assert_msg(memcmp(data, expected + offset, length) is 0, "%s at %zu",
+                  block_reader_name(kind), offset);
+    offset += length;
+  }
+  ck_assert_msg(offset is size, "%s", block_reader_name(kind));
+  ck_assert(not block_reader_failed(reader));
+  // Asking again past the end stays at the end
+  ck_assert(not block_reader_next(reader, &data, &length));
+  block_reader_close(reader);
+}
+
+START_TEST(test_block_reader_backends) {
+  char *expected = write_file(READER_FILE_SIZE);
+  for (BlockReaderKind kind = 0; kind < BLOCK_READER_KINDS; kind++) {
+    if (not block_reader_is_available(kind)) continue;
+    check_reads_back(kind, expected, READER_FILE_SIZE);
+
+    // Closed with chunks still being read
+    BlockReader *reader = block_reader_open(READER_PATH, kind);
+    const char *data;
+    size_t length;
+    ck_assert(block_reader_next(reader, &data, &length));
+    block_reader_close(reader);
+
+    ck_assert_ptr_null(block_reader_open("no_such_file.obj", kind));
+  }
+
+  // Not a regular file, its size says nothing of what there is to read
+  BlockReader *device = block_reader_open("/dev/null", BLOCK_READER_READ);
+  ck_assert_ptr_nonnull(device);
+  block_reader_close(device);
+  for (BlockReaderKind kind = BLOCK_READER_READ + 1; kind < BLOCK_READER_KINDS; kind++)
+    ck_assert_ptr_null(block_reader_open("/dev/null", kind));
+  free(expected);
+
+  // An empty file has no chunks
+  free(write_file(0));
+  for (BlockReaderKind kind = 0; kind < BLOCK_READER_KINDS; kind++) {
+    if (block_reader_is_available(kind)) check_reads_back(kind, null, 0);
+  }
+  remove(READER_PATH);
+}
+END_TEST
+
+START_TEST(test_block_reader_names) {
+  ck_assert(block_reader_is_available(BLOCK_READER_READ));
+  for (BlockReaderKind kind = 0; kind < BLOCK_READER_KINDS; kind++) {
+    BlockReaderKind parsed;
+    ck_assert(block_reader_parse_kind(block_reader_name(kind), &parsed));
+    ck_assert_int_eq(parsed, kind);
+  }
+  BlockReaderKind parsed;
+  ck_assert(not block_reader_parse_kind("fread", &parsed));
+}
+END_TEST
+
+// Streams read the same with every default, also one this system lacks
+START_TEST(test_block_reader_default_for_streams) {
+  size_t size = 3 * BLOCK_STREAM_BLOCK_SIZE / 2;
+  char *expected = write_file(size);
+  for (BlockReaderKind kind = 0; kind < BLOCK_READER_KINDS; kind++) {
+    block_reader_set_default(kind);
+    ck_assert_int_eq(block_reader_default(), kind);
+    BlockStream *stream = block_stream_open(READER_PATH);
+    ck_assert_ptr_nonnull(stream);
+    size_t offset = 0;
+    char *data;
+    size_t length;
+    while (block_stream_next(stream, &data, &length)) {
+      ck_assert(offset + length <= size);
+      ck_assert(memcmp(data, expected + offset, length) is 0);
+      offset += length;
+    }
+    ck_assert(offset is size);
+    block_stream_close(stream);
+  }
+  block_reader_set_default(BLOCK_READER_READ);
+  free(expected);
+  remove(READER_PATH);
+}
+END_TEST
+
+Suite *block_reader_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("block_reader");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_block_reader_backends);
+  tcase_add_test(tc_core, test_block_reader_names);
+  tcase_add_test(tc_core, test_block_reader_default_for_streams);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
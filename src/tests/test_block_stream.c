@@ -0,0 +1,190 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "../obj_parser/obj_parser.h"
+#include "../util/block_stream.h"
+#include "../util/prettify_c.h"
+
+#define STREAM_PATH "block_stream_test.tmp"
+#define STREAM_GZ_PATH "block_stream_test.tmp.gz"
+
+static void write_bytes(const char *path, const void *data, size_t size) {
+  FILE *file = fopen(path, "wb");
+  fwrite(data, 1, size, file);
+  fclose(file);
+}
+
+// Enough OBJ lines for several blocks, so some of them run across two
+static char *make_obj_text(size_t *length) {
+  size_t capacity = 3 * BLOCK_STREAM_BLOCK_SIZE;
+  char *text = malloc(capacity);
+  size_t size = 0;
+  int vertices = 0;
+  while (size + 100 < capacity) {
+    size += sprintf(text + size, "v %d.5 %d %d\n", vertices, -vertices, vertices % 7);
+    vertices++;
+    if (vertices % 3 is 0) size += sprintf(text + size, "f %d %d %d\n", vertices - 2, vertices - 1, vertices);
+  }
+  // The last line has no newline
+  size += sprintf(text + size, "vn 0 0 1");
+  *length = size;
+  return text;
+}
+
+// Everything the stream gives, in one buffer
+static char *read_all(const char *path, size_t *length, int *blocks, bool *failed) {
+  BlockStream *stream = block_stream_open(path);
+  ck_assert_ptr_nonnull(stream);
+  char *all = malloc(4 * BLOCK_STREAM_BLOCK_SIZE);
+  *length = 0;
+  *blocks = 0;
+  char *data;
+  size_t size;
+  while (block_stream_next(stream, &data, &size)) {
+    ck_assert(*length + size <= 4 * BLOCK_STREAM_BLOCK_SIZE);
+    memcpy(all + *length, data, size);
+    *length += size;
+    (*blocks)++;
+  }
+  *failed = block_stream_failed(stream);
+  block_stream_close(stream);
+  return all;
+}
+
+START_TEST(test_block_stream_plain) {
+  size_t length;
+  char *text = make_obj_text(&length);
+  write_bytes(STREAM_PATH, text, length);
+  ck_assert_int_eq(block_compression_detect(STREAM_PATH), BLOCK_COMPRESSION_NONE);
+
+  size_t read_length;
+  int blocks;
+  bool failed;
+  char *read = read_all(STREAM_PATH, &read_length, &blocks, &failed);
+  ck_assert(not failed);
+  ck_assert_int_eq(blocks, 3);
+  ck_assert_uint_eq(read_length, length);
+  ck_assert(memcmp(read, text, length) is 0);
+
+  // Closed before the end, the thread stops waiting for room
+  BlockStream *stream = block_stream_open(STREAM_PATH);
+  char *data;
+  size_t size;
+  ck_assert(block_stream_next(stream, &data, &size));
+  ck_assert_uint_eq(size, BLOCK_STREAM_BLOCK_SIZE);
+  block_stream_close(stream);
+
+  ck_assert_ptr_null(block_stream_open("no_such_file.obj"));
+  ck_assert(not block_stream_is_supported("no_such_file.obj"));
+  free(read);
+  free(text);
+  remove(STREAM_PATH);
+}
+END_TEST
+
+START_TEST(test_block_stream_gzip) {
+#ifdef HAVE_ZLIB
+  size_t length;
+  char *text = make_obj_text(&length);
+  // Two members in a row, like files joined with cat
+  size_t half = length / 2;
+  gzFile gz = gzopen(STREAM_GZ_PATH, "wb");
+  gzwrite(gz, text, (unsigned)half);
+  gzclose(gz);
+  gz = gzopen(STREAM_GZ_PATH, "ab");
+  gzwrite(gz, text + half, (unsigned)(length - half));
+  gzclose(gz);
+  ck_assert_int_eq(block_compression_detect(STREAM_GZ_PATH), BLOCK_COMPRESSION_GZIP);
+  ck_assert(block_stream_is_supported(STREAM_GZ_PATH));
+
+  size_t read_length;
+  int blocks;
+  bool failed;
+  char *read = read_all(STREAM_GZ_PATH, &read_length, &blocks, &failed);
+  ck_assert(not failed);
+  ck_assert_uint_eq(read_length, length);
+  ck_assert(memcmp(read, text, length) is 0);
+  free(read);
+
+  // The parser sees the same lines as in the plain file
+  write_bytes(STREAM_PATH, text, length);
+  ObjModel plain = obj_parse_model(STREAM_PATH);
+  ObjModel packed = obj_parse_model(STREAM_GZ_PATH);
+  ck_assert_uint_eq(packed.vertices.length, plain.vertices.length);
+  ck_assert_uint_eq(packed.faces.length, plain.faces.length);
+  ck_assert_uint_eq(packed.normals.length, 1);
+  ck_assert(not plain.is_truncated and not packed.is_truncated);
+  size_t plain_vertices = plain.vertices.length;
+  ck_assert(memcmp(packed.vertices.data, plain.vertices.data, plain.vertices.length * sizeof(Vertex)) is 0);
+  size_t last = plain.faces.length - 1;
+  ck_assert_int_eq(packed.faces.data[last].indices.data[2].point, plain.faces.data[last].indices.data[2].point);
+  obj_model_free(plain);
+  obj_model_free(packed);
+
+  // Cut short: what came before is right, the end is reported
+  FILE *file = fopen(STREAM_GZ_PATH, "rb");
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  rewind(file);
+  char *compressed = malloc(size);
+  ck_assert_int_eq(fread(compressed, 1, size, file), size);
+  fclose(file);
+  write_bytes(STREAM_GZ_PATH, compressed, size - 100);
+  read = read_all(STREAM_GZ_PATH, &read_length, &blocks, &failed);
+  ck_assert(failed);
+  ck_assert(read_length < length);
+  ck_assert(memcmp(read, text, read_length) is 0);
+  ObjModel cut = obj_parse_model(STREAM_GZ_PATH);
+  ck_assert(cut.is_truncated);
+  ck_assert(cut.vertices.length < plain_vertices);
+  obj_model_free(cut);
+
+  free(read);
+  free(compressed);
+  free(text);
+  remove(STREAM_PATH);
+  remove(STREAM_GZ_PATH);
+#endif
+}
+END_TEST
+
+START_TEST(test_block_stream_zstd_magic) {
+  const unsigned char frame[] = {0x28, 0xB5, 0x2F, 0xFD, 0xFF, 0xFF, 0xFF};
+  write_bytes(STREAM_PATH, frame, sizeof(frame));
+  ck_assert_int_eq(block_compression_detect(STREAM_PATH), BLOCK_COMPRESSION_ZSTD);
+#ifdef HAVE_ZSTD
+  size_t read_length;
+  int blocks;
+  bool failed;
+  char *read = read_all(STREAM_PATH, &read_length, &blocks, &failed);
+  ck_assert(failed);
+  free(read);
+#else
+  ck_assert(not block_stream_is_supported(STREAM_PATH));
+  ck_assert_ptr_null(block_stream_open(STREAM_PATH));
+#endif
+  remove(STREAM_PATH);
+}
+END_TEST
+
+Suite *block_stream_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("block_stream");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_block_stream_plain);
+  tcase_add_test(tc_core, test_block_stream_gzip);
+  tcase_add_test(tc_core, test_block_stream_zstd_magic);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
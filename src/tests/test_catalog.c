@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L  // rmdir
+
+#include <check.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../obj_parser/catalog.h"
+#include "../util/prettify_c.h"
+
+#define TEST_DIR "catalog_test_dir"
+#define INDEX_PATH "catalog_test.bin"
+
+static const char *const CUBE_TEXT =
+    "# cube\n"
+    "v -1 -2.5 0.125\n"
+    "v 1e1 2 3\n"
+    "vn 0 1 0\n"
+    "vt 0 0\n"
+    "f 1//1 2//1 1//1\n"
+    "f 1 2 1\n";
+
+static void write_file(const char *path, const char *text) {
+  FILE *file = fopen(path, "wb");
+  fputs(text, file);
+  fclose(file);
+}
+
+static void make_tree() {
+  mkdir(TEST_DIR, 0777);
+  mkdir(TEST_DIR "/Sub", 0777);
+  write_file(TEST_DIR "/cube.obj", CUBE_TEXT);
+  write_file(TEST_DIR "/Sub/Teapot.OBJ", "v 0 0 0\nv 1 1 1\nf 1 2 1\n");
+  write_file(TEST_DIR "/Sub/notes.txt", "v 5 5 5\n");
+}
+
+static void remove_tree() {
+  remove(TEST_DIR "/cube.obj");
+  remove(TEST_DIR "/Sub/Teapot.OBJ");
+  remove(TEST_DIR "/Sub/notes.txt");
+  rmdir(TEST_DIR "/Sub");
+  rmdir(TEST_DIR);
+  remove(INDEX_PATH);
+}
+
+START_TEST(test_obj_stats_counts) {
+  ObjStats stats = obj_stats_from_text(CUBE_TEXT, strlen(CUBE_TEXT));
+  ck_assert_int_eq(stats.vertices_count, 2);
+  ck_assert_int_eq(stats.normals_count, 1);
+  ck_assert_int_eq(stats.faces_count, 2);
+  ck_assert_float_eq(stats.min[0], -1);
+  ck_assert_float_eq(stats.min[1], -2.5f);
+  ck_assert_float_eq(stats.min[2], 0.125f);
+  ck_assert_float_eq(stats.max[0], 10);
+  ck_assert_float_eq(stats.max[1], 2);
+  ck_assert_float_eq(stats.max[2], 3);
+
+  // The last line may end without a newline, numbers end with the text
+  const char *cut = "v 1 2 3\nv 4 5 60";
+  ObjStats cut_stats = obj_stats_from_text(cut, strlen(cut) - 1);
+  ck_assert_int_eq(cut_stats.vertices_count, 2);
+  ck_assert_float_eq(cut_stats.max[1], 5);
+  ck_assert_float_eq(cut_stats.max[2], 6);
+
+  ObjStats same = obj_stats_from_text(CUBE_TEXT, strlen(CUBE_TEXT));
+  ObjStats other = obj_stats_from_text(CUBE_TEXT, strlen(CUBE_TEXT) - 1);
+  ck_assert(same.hash == stats.hash);
+  ck_assert(other.hash != stats.hash);
+}
+END_TEST
+
+START_TEST(test_catalog_scan_and_index) {
+  make_tree();
+  CatalogProgress progress = {0};
+  Catalog catalog = catalog_scan(null, TEST_DIR, &progress);
+
+  ck_assert_int_eq(catalog.entries.length, 2);
+  ck_assert_int_eq(progress.found, 2);
+  ck_assert_int_eq(progress.scanned, 2);
+  // Sorted by path
+  ck_assert_str_eq(catalog_path(&catalog, 0), TEST_DIR "/Sub/Teapot.OBJ");
+  ck_assert_str_eq(catalog_path(&catalog, 1), TEST_DIR "/cube.obj");
+  ck_assert_int_eq(catalog.entries.data[1].stats.vertices_count, 2);
+  ck_assert_int_eq(catalog.entries.data[1].size, strlen(CUBE_TEXT));
+
+  // A directory is not read as a file
+  ObjStats stats;
+  ck_assert(not obj_stats_scan(TEST_DIR, &stats));
+
+  ck_assert(catalog_save(&catalog, INDEX_PATH));
+  Catalog loaded;
+  ck_assert(catalog_load(INDEX_PATH, &loaded));
+  ck_assert_int_eq(loaded.entries.length, 2);
+  ck_assert_str_eq(catalog_path(&loaded, 1), TEST_DIR "/cube.obj");
+  ck_assert(memcmp(&loaded.entries.data[1].stats, &catalog.entries.data[1].stats, sizeof(ObjStats)) is 0);
+
+  // Nothing changed, nothing is read again
+  CatalogProgress again = {0};
+  Catalog rescanned = catalog_scan(&loaded, TEST_DIR, &again);
+  ck_assert_int_eq(again.to_scan, 0);
+  ck_assert_int_eq(rescanned.entries.data[1].stats.faces_count, 2);
+
+  // A changed file is read again, a removed one is dropped
+  write_file(TEST_DIR "/cube.obj", "v 0 0 0\n");
+  remove(TEST_DIR "/Sub/Teapot.OBJ");
+  Catalog changed = catalog_scan(&rescanned, TEST_DIR, &again);
+  ck_assert_int_eq(changed.entries.length, 1);
+  ck_assert_int_eq(again.to_scan, 1);
+  ck_assert_int_eq(changed.entries.data[0].stats.faces_count, 0);
+
+  catalog_free(changed);
+  catalog_free(rescanned);
+  catalog_free(loaded);
+  catalog_free(catalog);
+  remove_tree();
+}
+END_TEST
+
+START_TEST(test_catalog_search) {
+  make_tree();
+  Catalog catalog = catalog_scan(null, TEST_DIR, null);
+  vec_int found = vec_int_create();
+
+  catalog_search(&catalog, "", &found);
+  ck_assert_int_eq(found.length, 2);
+  catalog_search(&catalog, "TEAPOT", &found);
+  ck_assert_int_eq(found.length, 1);
+  ck_assert_int_eq(found.data[0], 0);
+  catalog_search(&catalog, " sub  pot ", &found);
+  ck_assert_int_eq(found.length, 1);
+  catalog_search(&catalog, "sub cube", &found);
+  ck_assert_int_eq(found.length, 0);
+
+  vec_int_free(found);
+  catalog_free(catalog);
+  remove_tree();
+}
+END_TEST
+
+START_TEST(test_catalog_bad_index) {
+  Catalog catalog;
+  ck_assert(not catalog_load("no_such_index.bin", &catalog));
+  ck_assert_int_eq(catalog.entries.length, 0);
+  catalog_free(catalog);
+
+  write_file(INDEX_PATH, CATALOG_MAGIC "garbage");
+  ck_assert(not catalog_load(INDEX_PATH, &catalog));
+  catalog_free(catalog);
+  remove(INDEX_PATH);
+}
+END_TEST
+
+Suite *catalog_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("catalog");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_obj_stats_counts);
+  tcase_add_test(tc_core, test_catalog_scan_and_index);
+  tcase_add_test(tc_core, test_catalog_search);
+  tcase_add_test(tc_core, test_catalog_bad_index);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,109 @@
+#include <check.h>
+#include <string.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../s21_matrix/s21_simd.h"
+
+static void fill_test_matrix(matrix_t *A, int rows, int columns, int seed) {
+  s21_create_matrix(rows, columns, A);
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < columns; j++)
+      A->matrix[i][j] = ((i * 31 + j * 17 + seed) % 97 - 48) / 7.0;
+}
+
+// Exact comparison: the flat kernels must not change a single bit
+static void assert_bits_eq(double a, double b) {
+  ck_assert_int_eq(memcmp(&a, &b, sizeof(double)), 0);
+}
+
+START_TEST(test_elementwise_bit_identical) {
+  // 37 * 53 is not a multiple of the SIMD width
+  matrix_t A, B;
+  fill_test_matrix(&A, 37, 53, 1);
+  fill_test_matrix(&B, 37, 53, 2);
+
+  for (int scalar = 0; scalar <= 1; scalar++) {
+    s21_simd_force_scalar(scalar);
+    matrix_t sum, diff, scaled;
+    ck_assert_int_eq(s21_sum_matrix(&A, &B, &sum), OK);
+    ck_assert_int_eq(s21_sub_matrix(&A, &B, &diff), OK);
+    ck_assert_int_eq(s21_mult_number(&A, 1.0 / 3.0, &scaled), OK);
+
+    for (int i = 0; i < A.rows; i++) {
+      for (int j = 0; j < A.columns; j++) {
+        assert_bits_eq(sum.matrix[i][j], A.matrix[i][j] + B.matrix[i][j]);
+        assert_bits_eq(diff.matrix[i][j], A.matrix[i][j] - B.matrix[i][j]);
+        assert_bits_eq(scaled.matrix[i][j], A.matrix[i][j] * (1.0 / 3.0));
+      }
+    }
+    s21_remove_matrix(&sum);
+    s21_remove_matrix(&diff);
+    s21_remove_matrix(&scaled);
+  }
+  s21_simd_force_scalar(false);
+
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+}
+END_TEST
+
+START_TEST(test_elementwise_noncontiguous) {
+  double row_0[] = {1, 2, 3, 4, 5};
+  double row_1[] = {6, 7, 8, 9, 10};
+  double *rows[] = {row_1, row_0};
+  matrix_t swapped = {.matrix = rows, .rows = 2, .columns = 5};
+  ck_assert_int_eq(s21_is_matrix_contiguous(&swapped), false);
+
+  matrix_t sum, scaled, transposed;
+  ck_assert_int_eq(s21_sum_matrix(&swapped, &swapped, &sum), OK);
+  ck_assert_int_eq(s21_mult_number(&swapped, -1.0, &scaled), OK);
+  ck_assert_int_eq(s21_transpose(&swapped, &transposed), OK);
+  ck_assert_int_eq(s21_is_matrix_contiguous(&sum), true);
+
+  ck_assert_double_eq(sum.matrix[0][4], 20);
+  ck_assert_double_eq(sum.matrix[1][0], 2);
+  ck_assert_double_eq(scaled.matrix[0][1], -7);
+  ck_assert_double_eq(transposed.matrix[4][1], 5);
+  ck_assert_double_eq(transposed.matrix[0][0], 6);
+
+  s21_remove_matrix(&sum);
+  s21_remove_matrix(&scaled);
+  s21_remove_matrix(&transposed);
+}
+END_TEST
+
+START_TEST(test_elementwise_transpose_shapes) {
+  int shapes[][2] = {{1, 100}, {100, 1}, {16, 16}, {17, 33}, {70, 45}};
+
+  for (int s = 0; s < 5; s++) {
+    matrix_t A, T;
+    fill_test_matrix(&A, shapes[s][0], shapes[s][1], s);
+    ck_assert_int_eq(s21_transpose(&A, &T), OK);
+    ck_assert_int_eq(T.rows, A.columns);
+    ck_assert_int_eq(T.columns, A.rows);
+
+    for (int i = 0; i < A.rows; i++)
+      for (int j = 0; j < A.columns; j++)
+        assert_bits_eq(T.matrix[j][i], A.matrix[i][j]);
+
+    s21_remove_matrix(&A);
+    s21_remove_matrix(&T);
+  }
+}
+END_TEST
+
+Suite *s21_elementwise_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("s21_elementwise");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_elementwise_bit_identical);
+  tcase_add_test(tc_core, test_elementwise_noncontiguous);
+  tcase_add_test(tc_core, test_elementwise_transpose_shapes);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
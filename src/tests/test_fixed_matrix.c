@@ -0,0 +1,99 @@
+#include <check.h>
+
+#include "../s21_matrix/s21_fixed_matrices.h"
+#include "../s21_matrix/s21_matrix.h"
+#include "test.h"
+
+#define MAT_ITEM_TYPE double
+#define MAT_ROWS 2
+#define MAT_COLS 3
+#include "../s21_matrix/s21_fixed_matrix.h"  // mat_double_2x3
+
+#define EPSILON 1e-6
+
+START_TEST(test_fixed_matrix_mult) {
+  matrix_t rotation = s21_create_rotations_camera(0.5, -0.25, 1.5);
+  matrix_t shift = s21_create_scaleshift_matrix(2.0, 3.0, 4.0, -1.0, 5.0, 0.5);
+  matrix_t expected;
+  s21_mult_matrix(&rotation, &shift, &expected);
+
+  mat_double_4x4 a = mat_double_4x4_from_matrix(&rotation);
+  mat_double_4x4 b = mat_double_4x4_from_matrix(&shift);
+  mat_double_4x4 product = mat_double_4x4_mult(&a, &b);
+  matrix_t result = mat_double_4x4_to_matrix(&product);
+  ck_assert_int_eq(s21_eq_matrix(&result, &expected), SUCCESS);
+
+  mat_float_4x4 fa = mat_float_4x4_from_matrix(&rotation);
+  mat_float_4x4 fb = mat_float_4x4_from_matrix(&shift);
+  mat_float_4x4 fproduct = mat_float_4x4_mult(&fa, &fb);
+  mat_float_4x4 fexpected = mat_float_4x4_from_matrix(&expected);
+  ck_assert(mat_float_4x4_eq(&fproduct, &fexpected, EPSILON));
+
+  s21_remove_matrix(&rotation);
+  s21_remove_matrix(&shift);
+  s21_remove_matrix(&expected);
+  s21_remove_matrix(&result);
+}
+END_TEST
+
+START_TEST(test_fixed_matrix_elementwise) {
+  double source[][3] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 10}};
+  matrix_t A;
+  s21_fill_matrix_from_local_array((double *)source, 3, 3, &A);
+
+  mat_float_3x3 a = mat_float_3x3_from_matrix(&A);
+  mat_float_3x3 identity = mat_float_3x3_identity();
+  mat_float_3x3 sum = mat_float_3x3_add(&a, &identity);
+  mat_float_3x3 diff = mat_float_3x3_sub(&sum, &a);
+  ck_assert(mat_float_3x3_eq(&diff, &identity, EPSILON));
+
+  mat_float_3x3 twice = mat_float_3x3_scale(&a, 2.0f);
+  ck_assert_float_eq(twice.m[2][2], 20.0f);
+
+  mat_float_3x3 transposed = mat_float_3x3_transpose(&a);
+  ck_assert_float_eq(transposed.m[0][2], 7.0f);
+  ck_assert_float_eq(transposed.m[2][0], 3.0f);
+
+  // Row-major and contiguous, as GL expects with transpose = GL_TRUE
+  const float *data = mat_float_3x3_data(&a);
+  ck_assert_float_eq(data[1], 2.0f);
+  ck_assert_float_eq(data[3], 4.0f);
+
+  mat_float_3x3 zero = mat_float_3x3_zero();
+  ck_assert(!mat_float_3x3_eq(&zero, &identity, EPSILON));
+
+  s21_remove_matrix(&A);
+}
+END_TEST
+
+START_TEST(test_fixed_matrix_rectangular) {
+  mat_double_2x3 a = {{{1, 2, 3}, {4, 5, 6}}};
+  double in[3] = {1, 0, -1};
+  double out[2];
+  mat_double_2x3_mult_vec(&a, in, out);
+  ck_assert_double_eq_tol(out[0], -2, EPSILON);
+  ck_assert_double_eq_tol(out[1], -2, EPSILON);
+
+  matrix_t converted = mat_double_2x3_to_matrix(&a);
+  ck_assert_int_eq(converted.rows, 2);
+  ck_assert_int_eq(converted.columns, 3);
+  ck_assert_double_eq(converted.matrix[1][2], 6);
+  s21_remove_matrix(&converted);
+}
+END_TEST
+
+Suite *s21_fixed_matrix_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("s21_fixed_matrix");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_fixed_matrix_mult);
+  tcase_add_test(tc_core, test_fixed_matrix_elementwise);
+  tcase_add_test(tc_core, test_fixed_matrix_rectangular);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
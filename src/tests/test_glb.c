@@ -0,0 +1,208 @@
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../obj_parser/glb.h"
+#include "../obj_parser/mesh_import.h"
+#include "../util/prettify_c.h"
+
+#define GLB_PATH "glb_test.tmp"
+
+// A tetrahedron, its normals and 16-bit triangles, one node moves it up by
+// 5 and scales it by 2
+static const char *const TETRAHEDRON_JSON =
+    "{\"asset\": {\"version\": \"2.0\"}, \"scene\": 0, \"scenes\": [{\"nodes\": [0]}],"
+    " \"nodes\": [{\"mesh\": 0, \"translation\": [0, 5, 0], \"scale\": [2, 2, 2]}],"
+    " \"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0, \"NORMAL\": 1}, \"indices\": 2}]}],"
+    " \"buffers\": [{\"byteLength\": 120}],"
+    " \"bufferViews\": [{\"buffer\": 0, \"byteLength\": 96}, {\"buffer\": 0, \"byteOffset\": 96, \"byteLength\": 24}],"
+    " \"accessors\": ["
+    "  {\"bufferView\": 0, \"componentType\": 5126, \"count\": 4, \"type\": \"VEC3\","
+    "   \"min\": [0, 0, 0], \"max\": [1, 1, 1]},"
+    "  {\"bufferView\": 0, \"byteOffset\": 48, \"componentType\": 5126, \"count\": 4, \"type\": \"VEC3\"},"
+    "  {\"bufferView\": 1, \"componentType\": 5123, \"count\": 12, \"type\": \"SCALAR\"}]}";
+
+static const float POSITIONS[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+static const float NORMALS[] = {-0.57735f, -0.57735f, -0.57735f, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+static const uint16_t INDICES[] = {0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3};
+
+static void put_u32(FILE *file, uint32_t value) {
+  for (int i = 0; i < 4; i++) fputc((value >> (8 * i)) & 0xFF, file);
+}
+
+static void write_glb(const char *json, const void *bin, size_t bin_size) {
+  size_t json_size = (strlen(json) + 3) / 4 * 4;
+  size_t padded_bin_size = (bin_size + 3) / 4 * 4;
+  FILE *file = fopen(GLB_PATH, "wb");
+  fwrite("glTF", 1, 4, file);
+  put_u32(file, 2);
+  put_u32(file, 12 + 8 + json_size + 8 + padded_bin_size);
+  put_u32(file, json_size);
+  fwrite("JSON", 1, 4, file);
+  fputs(json, file);
+  for (size_t i = strlen(json); i < json_size; i++) fputc(' ', file);
+  put_u32(file, padded_bin_size);
+  fwrite("BIN", 1, 4, file);
+  fwrite(bin, 1, bin_size, file);
+  for (size_t i = bin_size; i < padded_bin_size; i++) fputc(0, file);
+  fclose(file);
+}
+
+static void write_tetrahedron(const char *json) {
+  unsigned char bin[120];
+  memcpy(bin, POSITIONS, sizeof(POSITIONS));
+  memcpy(bin + 48, NORMALS, sizeof(NORMALS));
+  memcpy(bin + 96, INDICES, sizeof(INDICES));
+  write_glb(json, bin, sizeof(bin));
+}
+
+START_TEST(test_glb_gpu_ready) {
+  write_tetrahedron(TETRAHEDRON_JSON);
+  ck_assert_int_eq(mesh_file_detect(GLB_PATH), MESH_FILE_GLB);
+
+  GlbFile glb;
+  ck_assert(glb_open(GLB_PATH, &glb));
+  ck_assert_int_eq(glb.primitives.length, 1);
+  ck_assert(glb_is_gpu_ready(&glb));
+  const GlbPrimitive *primitive = &glb.primitives.data[0];
+  ck_assert_int_eq(primitive->indices.component_type, GLB_UNSIGNED_SHORT);
+  ck_assert_int_eq(glb_accessor_span(&primitive->positions), 48);
+  // Straight into the mapped file, no copies
+  ck_assert_ptr_eq(primitive->normals.data, primitive->positions.data + 48);
+  ck_assert_int_eq(glb_read_index(&primitive->indices, 2), 1);
+  FloatArray16 placement = glb_placement(primitive);
+
+  // The placed file positions are where the converted ones are
+  MeshData data;
+  ck_assert(mesh_import_glb(GLB_PATH, &data));
+  ck_assert_int_eq(data.vertices.length, 4 * MESH_DATA_STRIDE);
+  ck_assert_int_eq(data.indices.length, 12);
+  for (int i = 0; i < 4; i++) {
+    const float *vertex = data.vertices.data + i * MESH_DATA_STRIDE;
+    for (int r = 0; r < 3; r++) {
+      const float *row = placement.data + r * 4;
+      float placed = row[0] * POSITIONS[i * 3] + row[1] * POSITIONS[i * 3 + 1] + row[2] * POSITIONS[i * 3 + 2] + row[3];
+      ck_assert_float_eq_tol(vertex[r], placed, 1e-6);
+    }
+    // Uniform scale keeps the normals, in display axes
+    ck_assert_float_eq_tol(vertex[3], NORMALS[i * 3 + 2], 1e-5);
+    ck_assert_float_eq_tol(vertex[4], NORMALS[i * 3], 1e-5);
+  }
+  // File (0, 1, 0) scaled and lifted to y = 7, on the floor at display z 2
+  ck_assert_float_eq_tol(data.vertices.data[2 * MESH_DATA_STRIDE + 2], 2, 1e-6);
+  for (int i = 0; i < 12; i++) ck_assert_int_eq(data.indices.data[i], INDICES[i]);
+
+  mesh_data_free(data);
+  glb_close(&glb);
+  remove(GLB_PATH);
+}
+END_TEST
+
+// A triangle in the file xy plane twice, through a mirroring parent node:
+// 8-bit indices, then none, and lines that are skipped
+START_TEST(test_glb_converted) {
+  const char *json =
+      "{\"scenes\": [{\"nodes\": [0]}],"
+      " \"nodes\": [{\"children\": [1], \"matrix\": [-1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1]}, {\"mesh\": 0}],"
+      " \"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}, \"indices\": 1},"
+      "  {\"attributes\": {\"POSITION\": 0}, \"mode\": 1}, {\"attributes\": {\"POSITION\": 0}}]}],"
+      " \"buffers\": [{\"byteLength\": 40}],"
+      " \"bufferViews\": [{\"buffer\": 0, \"byteLength\": 36}, {\"buffer\": 0, \"byteOffset\": 36, \"byteLength\": 3}],"
+      " \"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+      "  {\"bufferView\": 1, \"componentType\": 5121, \"count\": 3, \"type\": \"SCALAR\"}]}";
+  unsigned char bin[39];
+  const float positions[] = {0, 0, 0, 1, 0, 0, 0, 1, 0};
+  memcpy(bin, positions, sizeof(positions));
+  bin[36] = 0;
+  bin[37] = 1;
+  bin[38] = 2;
+  write_glb(json, bin, sizeof(bin));
+
+  GlbFile glb;
+  ck_assert(glb_open(GLB_PATH, &glb));
+  ck_assert_int_eq(glb.primitives.length, 2);
+  ck_assert(not glb_is_gpu_ready(&glb));
+  glb_close(&glb);
+
+  MeshData data;
+  ck_assert(mesh_import_glb(GLB_PATH, &data));
+  ck_assert_int_eq(data.vertices.length, 6 * MESH_DATA_STRIDE);
+  // The mirror swaps two corners of every triangle
+  const int expected[] = {0, 2, 1, 3, 5, 4};
+  ck_assert_int_eq(data.indices.length, 6);
+  for (int i = 0; i < 6; i++) ck_assert_int_eq(data.indices.data[i], expected[i]);
+  for (int i = 0; i < 6; i++) {
+    const float *vertex = data.vertices.data + i * MESH_DATA_STRIDE;
+    // File x is display y, mirrored
+    ck_assert_float_eq(vertex[1], -positions[(i % 3) * 3]);
+    // Computed normals still face file +z, display +x
+    ck_assert_float_eq_tol(vertex[3], 1, 1e-6);
+    ck_assert_float_eq_tol(vertex[4], 0, 1e-6);
+  }
+
+  mesh_data_free(data);
+  remove(GLB_PATH);
+}
+END_TEST
+
+START_TEST(test_glb_rejects_bad_files) {
+  GlbFile glb;
+  MeshData data;
+
+  // An index past the vertices
+  char json[2048];
+  write_tetrahedron(TETRAHEDRON_JSON);
+  FILE *file = fopen(GLB_PATH, "r+b");
+  fseek(file, 12 + 8 + (strlen(TETRAHEDRON_JSON) + 3) / 4 * 4 + 8 + 96, SEEK_SET);
+  fputc(9, file);
+  fclose(file);
+  ck_assert(not glb_open(GLB_PATH, &glb));
+  ck_assert(not mesh_import_glb(GLB_PATH, &data));
+
+  // Buffers in other files are not read
+  strcpy(json, TETRAHEDRON_JSON);
+  char *buffer = strstr(json, "{\"byteLength\": 120}");
+  memcpy(buffer, "{\"uri\": \"a.bin\"   }", 19);
+  write_tetrahedron(json);
+  ck_assert(not glb_open(GLB_PATH, &glb));
+
+  // An accessor running past its view
+  strcpy(json, TETRAHEDRON_JSON);
+  memcpy(strstr(json, "\"count\": 12"), "\"count\": 13", 11);
+  write_tetrahedron(json);
+  ck_assert(not glb_open(GLB_PATH, &glb));
+
+  // A node that is its own child
+  strcpy(json, TETRAHEDRON_JSON);
+  memcpy(strstr(json, "\"scale\": [2, 2, 2]"), "\"children\": [0]   ", 18);
+  write_tetrahedron(json);
+  ck_assert(not glb_open(GLB_PATH, &glb));
+
+  // glTF 1.0
+  write_tetrahedron(TETRAHEDRON_JSON);
+  file = fopen(GLB_PATH, "r+b");
+  fseek(file, 4, SEEK_SET);
+  fputc(1, file);
+  fclose(file);
+  ck_assert_int_eq(mesh_file_detect(GLB_PATH), MESH_FILE_GLB);
+  ck_assert(not glb_open(GLB_PATH, &glb));
+  remove(GLB_PATH);
+}
+END_TEST
+
+Suite *glb_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("glb");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_glb_gpu_ready);
+  tcase_add_test(tc_core, test_glb_converted);
+  tcase_add_test(tc_core, test_glb_rejects_bad_files);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
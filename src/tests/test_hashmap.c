@@ -0,0 +1,158 @@
+#include <check.h>
+#include <stdlib.h>
+
+#include "../util/allocator.h"
+
+#define HASHMAP_K int
+#define HASHMAP_V int
+#define HASHMAP_MAKE_STATIC
+#include "../util/hashmap.h"
+
+// Groups of 100 keys share a home slot, so they probe a lot
+static uint64_t clustering_hash(int key) { return key / 100; }
+
+#define HASHMAP_K int
+#define HASHMAP_V int
+#define HASHMAP_NAME map_colliding
+#define HASHMAP_HASH clustering_hash
+#define HASHMAP_MAKE_STATIC
+#include "../util/hashmap.h"
+
+typedef char *str;
+static int FreedStrings = 0;
+static void str_destroy(str s) {
+  FreedStrings++;
+  free(s);
+}
+static bool str_eq(str a, str b) { return strcmp(a, b) is 0; }
+static uint64_t str_hash(str s) { return hash_str(s); }
+
+#define HASHMAP_K str
+#define HASHMAP_V int
+#define HASHMAP_HASH str_hash
+#define HASHMAP_EQ str_eq
+#define HASHMAP_KEY_DESTRUCTOR str_destroy
+#define HASHMAP_MAKE_STATIC
+#include "../util/hashmap.h"
+
+static str str_copy(const char *text) {
+  str s = malloc(strlen(text) + 1);
+  strcpy(s, text);
+  return s;
+}
+
+START_TEST(test_hashmap_insert_get_remove) {
+  map_int_int map = map_int_int_create();
+  ck_assert_ptr_null(map_int_int_get(&map, 1));
+  ck_assert(not map_int_int_remove(&map, 1));
+
+  for (int i = 0; i < 10000; i++) ck_assert(map_int_int_insert(&map, i, i * 2));
+  ck_assert_int_eq(map.length, 10000);
+  ck_assert(not map_int_int_insert(&map, 77, -1));
+  ck_assert_int_eq(map.length, 10000);
+  ck_assert_int_eq(*map_int_int_get(&map, 77), -1);
+
+  for (int i = 0; i < 10000; i += 2) ck_assert(map_int_int_remove(&map, i));
+  ck_assert_int_eq(map.length, 5000);
+  for (int i = 0; i < 10000; i++) {
+    int *value = map_int_int_get(&map, i);
+    if (i % 2 is 0) {
+      ck_assert_ptr_null(value);
+    } else {
+      ck_assert_ptr_nonnull(value);
+      ck_assert_int_eq(*value, i is 77 ? -1 : i * 2);
+    }
+  }
+
+  size_t iter = 0, count = 0;
+  for (map_int_int_Entry *e; (e = map_int_int_next(&map, &iter));) {
+    ck_assert_int_eq(e->key % 2, 1);
+    count++;
+  }
+  ck_assert_int_eq(count, 5000);
+  map_int_int_free(map);
+}
+END_TEST
+
+START_TEST(test_hashmap_reserve_insert_n) {
+  int keys[1000], values[1000];
+  for (int i = 0; i < 1000; i++) {
+    keys[i] = i * 7919;
+    values[i] = i;
+  }
+
+  map_int_int map = map_int_int_with_capacity(1000);
+  size_t capacity = map.capacity;
+  map_int_int_Entry *entries = map.entries;
+  map_int_int_insert_n(&map, keys, values, 1000);
+  // Reserved up front, so nothing was rehashed
+  ck_assert_int_eq(map.capacity, capacity);
+  ck_assert_ptr_eq(map.entries, entries);
+  ck_assert_int_eq(map.length, 1000);
+  ck_assert_int_eq(*map_int_int_get(&map, 999 * 7919), 999);
+
+  map_int_int_clear(&map);
+  ck_assert_int_eq(map.length, 0);
+  ck_assert_ptr_null(map_int_int_get(&map, 7919));
+  map_int_int_free(map);
+}
+END_TEST
+
+START_TEST(test_hashmap_collisions) {
+  // Overlapping clusters may need probe distances past 255, which makes the
+  // table grow. Removal must keep the rest of a cluster reachable
+  map_colliding map = map_colliding_create();
+  for (int i = 0; i < 3000; i++) map_colliding_insert(&map, i, -i);
+  ck_assert_int_eq(map.length, 3000);
+  for (int i = 0; i < 3000; i += 3) map_colliding_remove(&map, i);
+  for (int i = 0; i < 3000; i++) {
+    int *value = map_colliding_get(&map, i);
+    if (i % 3 is 0)
+      ck_assert_ptr_null(value);
+    else
+      ck_assert_int_eq(*value, -i);
+  }
+  map_colliding_free(map);
+}
+END_TEST
+
+START_TEST(test_hashmap_dedup_strings) {
+  const char *words[] = {"cube", "sphere", "cube", "teapot", "sphere", "cube"};
+  map_str_int map = map_str_int_create();
+  FreedStrings = 0;
+
+  int next_id = 0, ids[6];
+  for (int i = 0; i < 6; i++) {
+    bool inserted;
+    ids[i] = *map_str_int_get_or_insert(&map, str_copy(words[i]), next_id,
+                                        &inserted);
+    if (inserted) next_id++;
+  }
+
+  ck_assert_int_eq(next_id, 3);
+  ck_assert_int_eq(ids[2], ids[0]);
+  ck_assert_int_eq(ids[4], ids[1]);
+  ck_assert_int_eq(ids[3], 2);
+  // Duplicate keys were destroyed right away, the rest with the map
+  ck_assert_int_eq(FreedStrings, 3);
+  map_str_int_free(map);
+  ck_assert_int_eq(FreedStrings, 6);
+}
+END_TEST
+
+Suite *hashmap_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("hashmap");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_hashmap_insert_get_remove);
+  tcase_add_test(tc_core, test_hashmap_reserve_insert_n);
+  tcase_add_test(tc_core, test_hashmap_collisions);
+  tcase_add_test(tc_core, test_hashmap_dedup_strings);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,196 @@
+#include <check.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "../util/allocator.h"
+#include "../util/jobs.h"
+#include "../util/prettify_c.h"
+
+#define RANGE_LENGTH 100000
+
+static void add_range(void *ctx, size_t begin, size_t end) {
+  atomic_long *sum = ctx;
+  long local = 0;
+  for (size_t i = begin; i < end; i++) local += (long)i;
+  atomic_fetch_add(sum, local);
+}
+
+static void mark_range(void *ctx, size_t begin, size_t end) {
+  atomic_int *marks = ctx;
+  for (size_t i = begin; i < end; i++) atomic_fetch_add(&marks[i], 1);
+}
+
+static void increment(void *ctx) { atomic_fetch_add((atomic_long *)ctx, 1); }
+
+typedef struct Stage {
+  atomic_long *done;  // jobs of the previous stage that finished
+  long expected;
+  atomic_long *mismatches;
+  atomic_long *self;
+} Stage;
+
+static void run_stage(void *ctx) {
+  Stage *stage = ctx;
+  if (atomic_load(stage->done) is_not stage->expected)
+    atomic_fetch_add(stage->mismatches, 1);
+  atomic_fetch_add(stage->self, 1);
+}
+
+// Counts jobs that run under another allocation tag than ALLOC_TAG_MESH
+static void check_tag(void *ctx) {
+  if (alloc_tag_get() is_not ALLOC_TAG_MESH) atomic_fetch_add((atomic_long *)ctx, 1);
+}
+
+static void check_tag_range(void *ctx, size_t begin, size_t end) {
+  unused(begin);
+  unused(end);
+  check_tag(ctx);
+}
+
+// Submits more jobs from inside a job
+static void spawn_children(void *ctx) {
+  for (int i = 0; i < 10; i++) jobs_submit(increment, ctx, null);
+}
+
+START_TEST(test_jobs_parallel_for) {
+  jobs_init(4);
+  ck_assert_int_eq(jobs_worker_count(), 4);
+
+  atomic_long sum = 0;
+  parallel_for(0, RANGE_LENGTH, 0, add_range, &sum);
+  ck_assert(atomic_load(&sum) == (long)RANGE_LENGTH * (RANGE_LENGTH - 1) / 2);
+
+  // Every index exactly once, also for a grain that does not divide the range
+  atomic_int *marks = calloc(RANGE_LENGTH, sizeof(atomic_int));
+  parallel_for(10, RANGE_LENGTH, 333, mark_range, marks);
+  for (size_t i = 0; i < RANGE_LENGTH; i++)
+    ck_assert_int_eq(atomic_load(&marks[i]), i < 10 ? 0 : 1);
+  free(marks);
+
+  // Empty ranges do not call fn
+  parallel_for(5, 5, 1, mark_range, null);
+  jobs_shutdown();
+  ck_assert_int_eq(jobs_worker_count(), 0);
+}
+END_TEST
+
+START_TEST(test_jobs_counter_wait) {
+  jobs_init(3);
+  atomic_long count = 0;
+  JobCounter counter = {0};
+  for (int i = 0; i < 1000; i++) jobs_submit(increment, &count, &counter);
+  jobs_wait(&counter);
+  ck_assert_int_eq(atomic_load(&count), 1000);
+  ck_assert_int_eq(atomic_load(&counter.pending), 0);
+  jobs_shutdown();
+}
+END_TEST
+
+START_TEST(test_jobs_dependencies) {
+  jobs_init(4);
+  atomic_long first_done = 0, second_done = 0, mismatches = 0;
+  JobCounter first = {0}, second = {0};
+
+  // The second stage is submitted while the first one is still running, or
+  // already done, both must work
+  Stage first_stage = {&second_done, 0, &mismatches, &first_done};
+  Stage second_stage = {&first_done, 200, &mismatches, &second_done};
+  for (int i = 0; i < 200; i++) jobs_submit(run_stage, &first_stage, &first);
+  for (int i = 0; i < 50; i++)
+    jobs_submit_after(&first, run_stage, &second_stage, &second);
+  jobs_wait(&second);
+
+  ck_assert_int_eq(atomic_load(&first_done), 200);
+  ck_assert_int_eq(atomic_load(&second_done), 50);
+  ck_assert_int_eq(atomic_load(&mismatches), 0);
+
+  // A finished dependency queues the job right away
+  JobCounter third = {0};
+  jobs_submit_after(&first, increment, &second_done, &third);
+  jobs_wait(&third);
+  ck_assert_int_eq(atomic_load(&second_done), 51);
+  jobs_shutdown();
+}
+END_TEST
+
+START_TEST(test_jobs_nested_and_stats) {
+  jobs_init(2);
+  jobs_stats_reset();
+  atomic_long count = 0;
+  JobCounter counter = {0};
+  for (int i = 0; i < 100; i++) jobs_submit(spawn_children, &count, &counter);
+  jobs_wait(&counter);
+  // Children are not counted, so wait for them on shutdown
+  jobs_shutdown();
+  ck_assert_int_eq(atomic_load(&count), 1000);
+
+  JobStats stats = jobs_stats();
+  ck_assert(stats.jobs == 1100);
+  ck_assert(stats.steals >= 0);
+  ck_assert(stats.idle_secs >= 0);
+}
+END_TEST
+
+START_TEST(test_jobs_inline) {
+  // Without workers everything runs on the calling thread, right away
+  ck_assert_int_eq(jobs_worker_count(), 0);
+  atomic_long count = 0;
+  JobCounter counter = {0};
+  jobs_submit(increment, &count, &counter);
+  ck_assert_int_eq(atomic_load(&count), 1);
+  jobs_submit_after(&counter, increment, &count, null);
+  ck_assert_int_eq(atomic_load(&count), 2);
+  jobs_wait(&counter);
+
+  atomic_long sum = 0;
+  parallel_for(0, 100, 7, add_range, &sum);
+  ck_assert_int_eq(atomic_load(&sum), 4950);
+
+  // Zero workers is valid too, jobs_wait runs the queue
+  jobs_init(0);
+  jobs_submit(increment, &count, &counter);
+  jobs_wait(&counter);
+  ck_assert_int_eq(atomic_load(&count), 3);
+  jobs_shutdown();
+}
+END_TEST
+
+// Jobs allocate under the tag of whoever submitted them, which keeps it
+START_TEST(test_jobs_alloc_tag) {
+  AllocTag old_tag = alloc_tag_set(ALLOC_TAG_MESH);
+  atomic_long wrong_tags = 0;
+  JobCounter counter = {0};
+  for (int workers = 0; workers <= 2; workers += 2) {
+    if (workers > 0) jobs_init(workers);
+    for (int i = 0; i < 100; i++) jobs_submit(check_tag, &wrong_tags, &counter);
+    ck_assert_int_eq(alloc_tag_get(), ALLOC_TAG_MESH);
+    jobs_submit_after(&counter, check_tag, &wrong_tags, null);
+    ck_assert_int_eq(alloc_tag_get(), ALLOC_TAG_MESH);
+    jobs_wait(&counter);
+    parallel_for(0, RANGE_LENGTH, 100, check_tag_range, &wrong_tags);
+    ck_assert_int_eq(alloc_tag_get(), ALLOC_TAG_MESH);
+    if (workers > 0) jobs_shutdown();
+  }
+  ck_assert_int_eq(atomic_load(&wrong_tags), 0);
+  alloc_tag_set(old_tag);
+}
+END_TEST
+
+Suite *jobs_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("jobs");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_jobs_parallel_for);
+  tcase_add_test(tc_core, test_jobs_counter_wait);
+  tcase_add_test(tc_core, test_jobs_dependencies);
+  tcase_add_test(tc_core, test_jobs_nested_and_stats);
+  tcase_add_test(tc_core, test_jobs_inline);
+  tcase_add_test(tc_core, test_jobs_alloc_tag);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
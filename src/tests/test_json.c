@@ -0,0 +1,96 @@
+#include <check.h>
+#include <string.h>
+
+#include "../util/json.h"
+#include "../util/prettify_c.h"
+
+static bool parse(const char *text, Json *out) {
+  return json_parse(text, strlen(text), out);
+}
+
+START_TEST(test_json_lookups) {
+  const char *text =
+      "{\"name\": \"cube\", \"count\": 12, \"scale\": [1, -2.5e1, 3],\n"
+      " \"nested\": {\"list\": [[], {}, null], \"flag\": true}, \"last\": false}";
+  Json json;
+  ck_assert(parse(text, &json));
+
+  ck_assert(json_string_is(&json, json_get(&json, 0, "name"), "cube"));
+  ck_assert(not json_string_is(&json, json_get(&json, 0, "name"), "cub"));
+  ck_assert_double_eq(json_number(&json, json_get(&json, 0, "count"), -1), 12);
+
+  int scale = json_get(&json, 0, "scale");
+  ck_assert_int_eq(json_length(&json, scale), 3);
+  ck_assert_double_eq(json_number(&json, json_at(&json, scale, 1), 0), -25);
+  ck_assert_double_eq(json_number(&json, json_at(&json, scale, 2), 0), 3);
+  ck_assert_int_eq(json_at(&json, scale, 3), -1);
+
+  // Keys after nested values are found past them
+  int nested = json_get(&json, 0, "nested");
+  int list = json_get(&json, nested, "list");
+  ck_assert_int_eq(json_length(&json, list), 3);
+  ck_assert_int_eq(json.tokens.data[json_at(&json, list, 1)].type, JSON_OBJECT);
+  ck_assert_int_eq(json.tokens.data[json_at(&json, list, 2)].type, JSON_NULL);
+  ck_assert(json_bool(&json, json_get(&json, nested, "flag"), false));
+  ck_assert(not json_bool(&json, json_get(&json, 0, "last"), true));
+
+  // Missing keys and wrong types fall through the chain
+  ck_assert_int_eq(json_get(&json, 0, "missing"), -1);
+  ck_assert_int_eq(json_get(&json, scale, "name"), -1);
+  ck_assert_int_eq(json_at(&json, json_get(&json, 0, "missing"), 0), -1);
+  ck_assert_double_eq(json_number(&json, json_get(&json, 0, "name"), 7), 7);
+  ck_assert(json_bool(&json, -1, true));
+  json_free(json);
+}
+END_TEST
+
+START_TEST(test_json_padding_and_escapes) {
+  // glTF pads with spaces, C strings end with a NUL
+  const char text[] = "{\"a\\\"b\": \"x\\\\\"}    ";
+  Json json;
+  ck_assert(json_parse(text, sizeof(text), &json));
+  int value = json_get(&json, 0, "a\\\"b");
+  ck_assert_int_eq(json.tokens.data[value].type, JSON_STRING);
+  ck_assert_int_eq(json.tokens.data[value].length, 3);
+  json_free(json);
+}
+END_TEST
+
+START_TEST(test_json_rejects_bad_text) {
+  const char *bad[] = {
+      "", "{", "[1, 2", "{\"a\" 1}", "{\"a\": 1,}", "[1] 2", "\"open", "{1: 2}", "tru", "[1 2]",
+  };
+  for (size_t i = 0; i < LEN(bad); i++) {
+    Json json;
+    ck_assert_msg(not parse(bad[i], &json), "%s", bad[i]);
+    ck_assert_int_eq(json.tokens.length, 0);
+    json_free(json);
+  }
+
+  // Too deep to walk recursively
+  char deep[200];
+  memset(deep, '[', 100);
+  memset(deep + 100, ']', 100);
+  Json json;
+  ck_assert(not json_parse(deep, sizeof(deep), &json));
+  json_free(json);
+  ck_assert(json_parse(deep + 50, 100, &json));
+  json_free(json);
+}
+END_TEST
+
+Suite *json_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("json");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_json_lookups);
+  tcase_add_test(tc_core, test_json_padding_and_escapes);
+  tcase_add_test(tc_core, test_json_rejects_bad_text);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
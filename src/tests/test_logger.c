@@ -0,0 +1,97 @@
+#include <check.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../util/logger.h"
+#include "../util/prettify_c.h"
+
+#define PRODUCERS 4
+#define MESSAGES_PER_PRODUCER 2000
+
+static int count_lines(FILE *file, const char *needle) {
+  char line[LOG_RECORD_SIZE * 2];
+  int count = 0;
+  rewind(file);
+  while (fgets(line, sizeof(line), file))
+    if (strstr(line, needle)) count++;
+  return count;
+}
+
+static void *produce(void *arg) {
+  int id = (int)(size_t)arg;
+  for (int i = 0; i < MESSAGES_PER_PRODUCER; i++)
+    log_info("producer %d message %d", id, i);
+  return null;
+}
+
+START_TEST(test_logger_levels_and_parts) {
+  FILE *out = tmpfile();
+  logger_init(out);
+  debug("first half, ");
+  debugc("second half");
+  debugc("\n");
+  log_warn("%d %s", 42, "warned");
+  logger_shutdown();
+
+  ck_assert_int_eq(count_lines(out, "LOG ("), 1);
+  ck_assert_int_eq(count_lines(out, "first half, second half"), 1);
+  ck_assert_int_eq(count_lines(out, "WARN ("), 1);
+  ck_assert_int_eq(count_lines(out, "42 warned"), 1);
+  fclose(out);
+}
+END_TEST
+
+START_TEST(test_logger_many_producers) {
+  FILE *out = tmpfile();
+  logger_init(out);
+
+  pthread_t threads[PRODUCERS];
+  for (int t = 0; t < PRODUCERS; t++)
+    pthread_create(&threads[t], null, produce, (void *)(size_t)t);
+  for (int t = 0; t < PRODUCERS; t++) pthread_join(threads[t], null);
+  long dropped = logger_dropped();
+  logger_shutdown();
+
+  // Nothing is lost without being counted, nothing is torn
+  int written = count_lines(out, "INFO (");
+  ck_assert_int_eq(written + dropped, PRODUCERS * MESSAGES_PER_PRODUCER);
+  ck_assert_int_eq(count_lines(out, "producer"), written);
+  fclose(out);
+}
+END_TEST
+
+START_TEST(test_logger_long_message) {
+  FILE *out = tmpfile();
+  char long_text[LOG_RECORD_SIZE * 2];
+  memset(long_text, 'x', sizeof(long_text) - 1);
+  long_text[sizeof(long_text) - 1] = '\0';
+
+  logger_init(out);
+  log_error("%s", long_text);
+  logger_flush();
+  long length = ftell(out);
+  logger_shutdown();
+
+  // Cut to one record, still a whole line
+  ck_assert_int_eq(length, LOG_RECORD_SIZE);
+  ck_assert_int_eq(count_lines(out, "xxx...\n"), 1);
+  fclose(out);
+}
+END_TEST
+
+Suite *logger_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("logger");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_logger_levels_and_parts);
+  tcase_add_test(tc_core, test_logger_many_producers);
+  tcase_add_test(tc_core, test_logger_long_message);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
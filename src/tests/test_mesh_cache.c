@@ -0,0 +1,114 @@
+#include <check.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../obj_parser/mesh_cache.h"
+#include "../util/prettify_c.h"
+
+#define CACHE_PATH "mesh_cache_test.mesh"
+
+static MeshData make_mesh(size_t vertices_count) {
+  MeshData data = {vec_float_create(), vec_int_create()};
+  for (size_t i = 0; i < vertices_count * MESH_DATA_STRIDE; i++)
+    vec_float_push(&data.vertices, (float)i * 0.25f);
+  for (size_t i = 0; i + 2 < vertices_count; i++) {
+    int triangle[] = {(int)i, (int)i + 1, (int)i + 2};
+    vec_int_push_n(&data.indices, triangle, 3);
+  }
+  return data;
+}
+
+static void patch_file(const char *path, long offset, const void *bytes, size_t size) {
+  FILE *file = fopen(path, "r+b");
+  fseek(file, offset, SEEK_SET);
+  fwrite(bytes, 1, size, file);
+  fclose(file);
+}
+
+START_TEST(test_mesh_cache_round_trip) {
+  MeshData data = make_mesh(1000);
+  ck_assert(mesh_cache_write(&data, CACHE_PATH));
+  ck_assert(mesh_cache_is_cache(CACHE_PATH));
+
+  MeshCacheView view;
+  ck_assert(mesh_cache_map(CACHE_PATH, &view));
+  ck_assert_int_eq(view.floats_count, data.vertices.length);
+  ck_assert_int_eq(view.indices_count, data.indices.length);
+  ck_assert_int_eq((size_t)view.vertices % 64, 0);
+  ck_assert_int_eq((size_t)view.indices % 64, 0);
+  mesh_cache_unmap(&view);
+
+  MeshData read;
+  ck_assert(mesh_cache_read(CACHE_PATH, &read));
+  ck_assert_int_eq(read.vertices.length, data.vertices.length);
+  ck_assert_int_eq(read.indices.length, data.indices.length);
+  ck_assert(memcmp(read.vertices.data, data.vertices.data, data.vertices.length * sizeof(float)) is 0);
+  ck_assert(memcmp(read.indices.data, data.indices.data, data.indices.length * sizeof(int)) is 0);
+
+  mesh_data_free(read);
+  mesh_data_free(data);
+  remove(CACHE_PATH);
+}
+END_TEST
+
+START_TEST(test_mesh_cache_empty) {
+  MeshData data = make_mesh(0);
+  ck_assert(mesh_cache_write(&data, CACHE_PATH));
+  MeshData read;
+  ck_assert(mesh_cache_read(CACHE_PATH, &read));
+  ck_assert_int_eq(read.vertices.length, 0);
+  ck_assert_int_eq(read.indices.length, 0);
+  mesh_data_free(read);
+  mesh_data_free(data);
+  remove(CACHE_PATH);
+}
+END_TEST
+
+START_TEST(test_mesh_cache_rejects_bad_files) {
+  MeshData data = make_mesh(10), read;
+  ck_assert(not mesh_cache_read("no_such_file.mesh", &read));
+
+  // Not a cache at all
+  FILE *file = fopen(CACHE_PATH, "wb");
+  fputs("v 1 2 3\n", file);
+  fclose(file);
+  ck_assert(not mesh_cache_is_cache(CACHE_PATH));
+  ck_assert(not mesh_cache_read(CACHE_PATH, &read));
+
+  // Index out of range
+  ck_assert(mesh_cache_write(&data, CACHE_PATH));
+  MeshCacheView view;
+  ck_assert(mesh_cache_map(CACHE_PATH, &view));
+  long indices_offset = (long)((const char *)view.indices - view.file.data);
+  mesh_cache_unmap(&view);
+  int bad_index = 10;
+  patch_file(CACHE_PATH, indices_offset, &bad_index, sizeof(bad_index));
+  ck_assert(not mesh_cache_read(CACHE_PATH, &read));
+
+  // Counts larger than the file
+  ck_assert(mesh_cache_write(&data, CACHE_PATH));
+  uint64_t floats_count = 6000;
+  patch_file(CACHE_PATH, offsetof(MeshCacheHeader, floats_count), &floats_count, sizeof(floats_count));
+  ck_assert(not mesh_cache_read(CACHE_PATH, &read));
+
+  mesh_data_free(data);
+  remove(CACHE_PATH);
+}
+END_TEST
+
+Suite *mesh_cache_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("mesh_cache");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_mesh_cache_round_trip);
+  tcase_add_test(tc_core, test_mesh_cache_empty);
+  tcase_add_test(tc_core, test_mesh_cache_rejects_bad_files);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
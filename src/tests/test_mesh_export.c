@@ -0,0 +1,145 @@
+#include <check.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../obj_parser/mesh_export.h"
+#include "../util/prettify_c.h"
+
+#define EXPORT_PATH "mesh_export_test.tmp"
+
+// A tetrahedron in display axes (file z, x, y), normals pointing outwards
+static MeshData make_tetrahedron() {
+  const float vertices[] = {
+      0, 0, 0, -1, -1, -1,  //
+      1, 0, 0, 1, 0, 0,     //
+      0, 1, 0, 0, 1, 0,     //
+      0, 0, 1, 0, 0, 1,     //
+  };
+  const int indices[] = {0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3};
+
+  MeshData data = {vec_float_with_capacity(LEN(vertices)),
+                   vec_int_with_capacity(LEN(indices))};
+  vec_float_push_n(&data.vertices, vertices, LEN(vertices));
+  vec_int_push_n(&data.indices, indices, LEN(indices));
+  return data;
+}
+
+static long file_size(const char *path, unsigned char *head, size_t head_size) {
+  FILE *file = fopen(path, "rb");
+  if (file is null) return -1;
+  size_t read = fread(head, 1, head_size, file);
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fclose(file);
+  return read is head_size ? size : -1;
+}
+
+START_TEST(test_export_obj_round_trip) {
+  MeshData data = make_tetrahedron();
+  matrix_t shift = s21_create_shift_matrix(1, 2, 3);
+  ck_assert(mesh_export(&data, &shift, MESH_EXPORT_OBJ, EXPORT_PATH));
+
+  ObjModel model = obj_parse_model(EXPORT_PATH);
+  ck_assert_int_eq(model.vertices.length, 4);
+  ck_assert_int_eq(model.normals.length, 4);
+  ck_assert_int_eq(model.faces.length, 4);
+  for (size_t i = 0; i < 4; i++) {
+    const float *v = data.vertices.data + i * MESH_DATA_STRIDE;
+    // Display (1, 2, 3) is file (2, 3, 1)
+    ck_assert_float_eq(model.vertices.data[i].x, v[1] + 2);
+    ck_assert_float_eq(model.vertices.data[i].y, v[2] + 3);
+    ck_assert_float_eq(model.vertices.data[i].z, v[0] + 1);
+  }
+  // Normals are unit length and not moved by the shift
+  ck_assert_float_eq_tol(model.normals.data[0].x, -0.57735f, 1e-5);
+  ck_assert_float_eq(model.normals.data[1].z, 1);
+  for (size_t f = 0; f < 4; f++) {
+    const Face *face = &model.faces.data[f];
+    ck_assert_int_eq(face->indices.length, 3);
+    for (size_t i = 0; i < 3; i++) {
+      ck_assert_int_eq(face->indices.data[i].point, data.indices.data[f * 3 + i] + 1);
+      ck_assert_int_eq(face->indices.data[i].normal, face->indices.data[i].point);
+    }
+  }
+
+  obj_model_free(model);
+  s21_remove_matrix(&shift);
+  mesh_data_free(data);
+  remove(EXPORT_PATH);
+}
+END_TEST
+
+START_TEST(test_export_obj_mirrored) {
+  MeshData data = make_tetrahedron();
+  matrix_t mirror = s21_create_scale_matrix(-1, 1, 1);
+  ck_assert(mesh_export(&data, &mirror, MESH_EXPORT_OBJ, EXPORT_PATH));
+
+  ObjModel model = obj_parse_model(EXPORT_PATH);
+  ck_assert_int_eq(model.faces.length, 4);
+  // Display x is file z, the winding is reversed to keep faces outwards
+  ck_assert_float_eq(model.vertices.data[1].z, -1);
+  ck_assert_float_eq(model.normals.data[1].z, -1);
+  const Face *face = &model.faces.data[0];
+  ck_assert_int_eq(face->indices.data[0].point, 1);
+  ck_assert_int_eq(face->indices.data[1].point, 2);
+  ck_assert_int_eq(face->indices.data[2].point, 3);
+
+  obj_model_free(model);
+  s21_remove_matrix(&mirror);
+  mesh_data_free(data);
+  remove(EXPORT_PATH);
+}
+END_TEST
+
+START_TEST(test_export_binary) {
+  MeshData data = make_tetrahedron();
+  unsigned char head[84];
+
+  ck_assert(mesh_export(&data, null, MESH_EXPORT_PLY, EXPORT_PATH));
+  long size = file_size(EXPORT_PATH, head, 4);
+  ck_assert(memcmp(head, "ply\n", 4) is 0);
+  FILE *file = fopen(EXPORT_PATH, "rb");
+  char line[128];
+  long header_size = 0;
+  while (fgets(line, sizeof(line), file)) {
+    header_size += strlen(line);
+    if (strcmp(line, "end_header\n") is 0) break;
+  }
+  fclose(file);
+  ck_assert_int_eq(size, header_size + 4 * 24 + 4 * 13);
+
+  ck_assert(mesh_export(&data, null, MESH_EXPORT_STL, EXPORT_PATH));
+  ck_assert_int_eq(file_size(EXPORT_PATH, head, sizeof(head)), 84 + 4 * 50);
+  ck_assert_int_eq(head[80], 4);
+  ck_assert_int_eq(head[81] | head[82] | head[83], 0);
+
+  mesh_data_free(data);
+  remove(EXPORT_PATH);
+}
+END_TEST
+
+START_TEST(test_export_bad_indices) {
+  MeshData data = make_tetrahedron();
+  data.indices.data[5] = 4;
+  ck_assert(not mesh_export(&data, null, MESH_EXPORT_STL, EXPORT_PATH));
+  mesh_data_free(data);
+}
+END_TEST
+
+Suite *mesh_export_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("mesh_export");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_export_obj_round_trip);
+  tcase_add_test(tc_core, test_export_obj_mirrored);
+  tcase_add_test(tc_core, test_export_binary);
+  tcase_add_test(tc_core, test_export_bad_indices);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,221 @@
+#include <check.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../obj_parser/mesh_export.h"
+#include "../obj_parser/mesh_import.h"
+#include "../util/prettify_c.h"
+
+#define IMPORT_PATH "mesh_import_test.tmp"
+
+// A tetrahedron in display axes (file z, x, y) standing on z = 0
+static MeshData make_tetrahedron() {
+  const float vertices[] = {
+      0, 0, 0, -1, -1, -1,  //
+      1, 0, 0, 1, 0, 0,     //
+      0, 1, 0, 0, 1, 0,     //
+      0, 0, 1, 0, 0, 1,     //
+  };
+  const int indices[] = {0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3};
+
+  MeshData data = {vec_float_with_capacity(LEN(vertices)),
+                   vec_int_with_capacity(LEN(indices))};
+  vec_float_push_n(&data.vertices, vertices, LEN(vertices));
+  vec_int_push_n(&data.indices, indices, LEN(indices));
+  return data;
+}
+
+static void write_bytes(const char *path, const void *data, size_t size) {
+  FILE *file = fopen(path, "wb");
+  fwrite(data, 1, size, file);
+  fclose(file);
+}
+
+START_TEST(test_import_ply_round_trip) {
+  MeshData data = make_tetrahedron();
+  ck_assert(mesh_export(&data, null, MESH_EXPORT_PLY, IMPORT_PATH));
+  ck_assert_int_eq(mesh_file_detect(IMPORT_PATH), MESH_FILE_PLY);
+
+  MeshData loaded;
+  ck_assert(mesh_import_ply(IMPORT_PATH, &loaded));
+  ck_assert_int_eq(loaded.vertices.length, data.vertices.length);
+  ck_assert_int_eq(loaded.indices.length, data.indices.length);
+  for (size_t i = 0; i < 4; i++) {
+    const float *a = data.vertices.data + i * MESH_DATA_STRIDE;
+    const float *b = loaded.vertices.data + i * MESH_DATA_STRIDE;
+    for (int j = 0; j < 3; j++) ck_assert_float_eq(b[j], a[j]);
+  }
+  // Normals were normalized on export
+  ck_assert_float_eq_tol(loaded.vertices.data[3], -0.57735f, 1e-5);
+  ck_assert_float_eq(loaded.vertices.data[MESH_DATA_STRIDE + 3], 1);
+  for (size_t i = 0; i < data.indices.length; i++)
+    ck_assert_int_eq(loaded.indices.data[i], data.indices.data[i]);
+
+  mesh_data_free(loaded);
+  mesh_data_free(data);
+  remove(IMPORT_PATH);
+}
+END_TEST
+
+START_TEST(test_import_stl_round_trip) {
+  MeshData data = make_tetrahedron();
+  ck_assert(mesh_export(&data, null, MESH_EXPORT_STL, IMPORT_PATH));
+  ck_assert_int_eq(mesh_file_detect(IMPORT_PATH), MESH_FILE_STL);
+
+  MeshData loaded;
+  ck_assert(mesh_import_stl(IMPORT_PATH, &loaded));
+  // Every triangle has its own vertices
+  ck_assert_int_eq(loaded.vertices.length, 12 * MESH_DATA_STRIDE);
+  ck_assert_int_eq(loaded.indices.length, 12);
+  for (size_t i = 0; i < 12; i++) {
+    ck_assert_int_eq(loaded.indices.data[i], i);
+    const float *a = data.vertices.data + data.indices.data[i] * MESH_DATA_STRIDE;
+    const float *b = loaded.vertices.data + i * MESH_DATA_STRIDE;
+    for (int j = 0; j < 3; j++) ck_assert_float_eq(b[j], a[j]);
+  }
+  // The face 0 2 1 lies in the display plane z = 0 and faces down
+  ck_assert_float_eq_tol(loaded.vertices.data[5], -1, 1e-6);
+
+  mesh_data_free(loaded);
+  mesh_data_free(data);
+  remove(IMPORT_PATH);
+}
+END_TEST
+
+// Big-endian doubles, a quad, no normals, and elements to skip around them
+START_TEST(test_import_ply_general) {
+  const char header[] =
+      "ply\r\n"
+      "format binary_big_endian 1.0\r\n"
+      "comment made by hand\r\n"
+      "element material 1\r\n"
+      "property list uchar uchar name\r\n"
+      "element vertex 4\r\n"
+      "property double x\r\n"
+      "property uchar red\r\n"
+      "property double y\r\n"
+      "property double z\r\n"
+      "element face 1\r\n"
+      "property uchar flags\r\n"
+      "property list uchar ushort vertex_index\r\n"
+      "end_header\r\n";
+  unsigned char body[256];
+  size_t size = 0;
+  body[size++] = 2;  // material: a list of 2
+  body[size++] = 'a';
+  body[size++] = 'b';
+  const double positions[4][3] = {{0, 5, 0}, {1, 5, 0}, {1, 6, 0}, {0, 6, 0}};
+  for (int v = 0; v < 4; v++) {
+    for (int j = 0; j < 3; j++) {
+      unsigned char bytes[8];
+      memcpy(bytes, &positions[v][j], 8);
+      for (int b = 7; b >= 0; b--) body[size++] = bytes[b];
+      if (j is 0) body[size++] = 255;  // red
+    }
+  }
+  body[size++] = 0;  // flags
+  body[size++] = 4;
+  for (int i = 0; i < 4; i++) {
+    body[size++] = 0;
+    body[size++] = (unsigned char)i;
+  }
+
+  unsigned char file[512];
+  memcpy(file, header, sizeof(header) - 1);
+  memcpy(file + sizeof(header) - 1, body, size);
+  write_bytes(IMPORT_PATH, file, sizeof(header) - 1 + size);
+  ck_assert_int_eq(mesh_file_detect(IMPORT_PATH), MESH_FILE_PLY);
+
+  MeshData loaded;
+  ck_assert(mesh_import_ply(IMPORT_PATH, &loaded));
+  ck_assert_int_eq(loaded.vertices.length, 4 * MESH_DATA_STRIDE);
+  // Fan triangulation
+  const int expected[] = {0, 1, 2, 0, 2, 3};
+  ck_assert_int_eq(loaded.indices.length, 6);
+  for (int i = 0; i < 6; i++) ck_assert_int_eq(loaded.indices.data[i], expected[i]);
+  // File (1, 6, 0) is display (0, 1, 6), lowered to the floor by 5
+  const float *v2 = loaded.vertices.data + 2 * MESH_DATA_STRIDE;
+  ck_assert_float_eq(v2[0], 0);
+  ck_assert_float_eq(v2[1], 1);
+  ck_assert_float_eq(v2[2], 1);
+  // Computed from the face: file +z is display +x
+  ck_assert_float_eq_tol(v2[3], 1, 1e-6);
+  ck_assert_float_eq_tol(v2[4], 0, 1e-6);
+
+  mesh_data_free(loaded);
+
+  // Cut off in the middle of the faces
+  write_bytes(IMPORT_PATH, file, sizeof(header) - 1 + size - 3);
+  ck_assert(not mesh_import_ply(IMPORT_PATH, &loaded));
+  remove(IMPORT_PATH);
+}
+END_TEST
+
+START_TEST(test_import_rejects_bad_files) {
+  const char ascii[] =
+      "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\n"
+      "property float y\nproperty float z\nend_header\n0 0 0\n";
+  write_bytes(IMPORT_PATH, ascii, sizeof(ascii) - 1);
+  MeshData loaded;
+  ck_assert(not mesh_import_ply(IMPORT_PATH, &loaded));
+
+  // An index past the vertices
+  const char header[] =
+      "ply\nformat binary_little_endian 1.0\nelement vertex 1\nproperty float x\n"
+      "property float y\nproperty float z\nelement face 1\n"
+      "property list uchar int vertex_indices\nend_header\n";
+  unsigned char file[256] = {0};
+  memcpy(file, header, sizeof(header) - 1);
+  size_t size = sizeof(header) - 1 + 12;
+  file[size] = 3;
+  file[size + 5] = 7;
+  write_bytes(IMPORT_PATH, file, size + 13);
+  ck_assert(not mesh_import_ply(IMPORT_PATH, &loaded));
+
+  // Counts far past what the file holds fail before anything is allocated
+  const char *huge_counts[] = {
+      "ply\nformat binary_little_endian 1.0\nelement vertex 2000000000\n"
+      "property float x\nproperty float y\nproperty float z\nend_header\n",
+      "ply\nformat binary_little_endian 1.0\nelement vertex 1\nproperty float x\n"
+      "property float y\nproperty float z\nelement face 2147483648\n"
+      "property list uchar int vertex_indices\nend_header\n",
+  };
+  for (size_t i = 0; i < LEN(huge_counts); i++) {
+    size_t length = strlen(huge_counts[i]);
+    memset(file, 0, sizeof(file));
+    memcpy(file, huge_counts[i], length);
+    write_bytes(IMPORT_PATH, file, length + 12 + 13);
+    ck_assert(not mesh_import_ply(IMPORT_PATH, &loaded));
+  }
+
+  // An STL shorter than its triangle count says
+  unsigned char stl[84 + 50] = {0};
+  stl[80] = 2;
+  write_bytes(IMPORT_PATH, stl, sizeof(stl));
+  ck_assert_int_eq(mesh_file_detect(IMPORT_PATH), MESH_FILE_OBJ);
+  ck_assert(not mesh_import_stl(IMPORT_PATH, &loaded));
+
+  write_bytes(IMPORT_PATH, "v 1 2 3\n", 8);
+  ck_assert_int_eq(mesh_file_detect(IMPORT_PATH), MESH_FILE_OBJ);
+  ck_assert_int_eq(mesh_file_detect("no_such_file.ply"), MESH_FILE_OBJ);
+  remove(IMPORT_PATH);
+}
+END_TEST
+
+Suite *mesh_import_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("mesh_import");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_import_ply_round_trip);
+  tcase_add_test(tc_core, test_import_stl_round_trip);
+  tcase_add_test(tc_core, test_import_ply_general);
+  tcase_add_test(tc_core, test_import_rejects_bad_files);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,144 @@
+#include <check.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../util/prettify_c.h"
+#include "test.h"
+
+static void mult_pairwise(matrix_t **mats, int n, matrix_t *result) {
+  matrix_t acc;
+  ck_assert_int_eq(s21_mult_number(mats[0], 1.0, &acc), OK);
+  for (int i = 1; i < n; i++) {
+    matrix_t next;
+    ck_assert_int_eq(s21_mult_matrix(&acc, mats[i], &next), OK);
+    s21_remove_matrix(&acc);
+    acc = next;
+  }
+  *result = acc;
+}
+
+START_TEST(test_mult_chain_rectangular) {
+  double source_a[][3] = {{1, 2, 3}, {4, 5, 6}};
+  double source_b[][1] = {{1}, {-1}, {2}};
+  double source_c[][4] = {{0.5, 1, -2, 3}};
+
+  matrix_t A, B, C, result, expected;
+  s21_fill_matrix_from_local_array((double *)source_a, 2, 3, &A);
+  s21_fill_matrix_from_local_array((double *)source_b, 3, 1, &B);
+  s21_fill_matrix_from_local_array((double *)source_c, 1, 4, &C);
+
+  matrix_t *chain[] = {&A, &B, &C};
+  ck_assert_int_eq(s21_mult_chain(chain, 3, &result), OK);
+  ck_assert_int_eq(result.rows, 2);
+  ck_assert_int_eq(result.columns, 4);
+
+  mult_pairwise(chain, 3, &expected);
+  ck_assert_int_eq(s21_eq_matrix(&result, &expected), SUCCESS);
+
+  s21_remove_matrix(&A);
+  s21_remove_matrix(&B);
+  s21_remove_matrix(&C);
+  s21_remove_matrix(&result);
+  s21_remove_matrix(&expected);
+}
+END_TEST
+
+START_TEST(test_mult_chain_transforms) {
+  matrix_t proj = s21_create_perspective_matrix(1.5, 0.1, 2000.0, 1.3);
+  matrix_t view = s21_create_view_to_camera();
+  matrix_t rot = s21_create_rotations_camera(0.3, -1.2, 2.5);
+  matrix_t shift = s21_create_shift_matrix(1.0, -2.0, 3.5);
+  matrix_t scale = s21_create_scale_matrix(2.0, 0.5, -1.0);
+
+  matrix_t *chain[] = {&proj, &view, &rot, &shift, &scale};
+  matrix_t result, expected;
+  ck_assert_int_eq(s21_mult_chain(chain, LEN(chain), &result), OK);
+  mult_pairwise(chain, LEN(chain), &expected);
+  ck_assert_int_eq(s21_eq_matrix(&result, &expected), SUCCESS);
+
+  for (int i = 0; i < (int)LEN(chain); i++) s21_remove_matrix(chain[i]);
+  s21_remove_matrix(&result);
+  s21_remove_matrix(&expected);
+}
+END_TEST
+
+START_TEST(test_mult_chain_long) {
+  matrix_t mats[20];
+  matrix_t *chain[20];
+  for (int i = 0; i < 20; i++) {
+    int rows = 2 + i % 3, columns = 2 + (i + 1) % 3;
+    s21_create_matrix(rows, columns, &mats[i]);
+    for (int r = 0; r < rows; r++)
+      for (int c = 0; c < columns; c++)
+        mats[i].matrix[r][c] = ((i + r * 3 + c * 7) % 5 - 2) * 0.5;
+    chain[i] = &mats[i];
+  }
+
+  matrix_t result, expected;
+  ck_assert_int_eq(s21_mult_chain(chain, 20, &result), OK);
+  mult_pairwise(chain, 20, &expected);
+  ck_assert_int_eq(s21_eq_matrix(&result, &expected), SUCCESS);
+
+  for (int i = 0; i < 20; i++) s21_remove_matrix(&mats[i]);
+  s21_remove_matrix(&result);
+  s21_remove_matrix(&expected);
+}
+END_TEST
+
+START_TEST(test_mult_chain_single_and_noncontiguous) {
+  double row_0[] = {1, 2};
+  double row_1[] = {3, 4};
+  double *rows[] = {row_1, row_0};
+  matrix_t swapped = {.matrix = rows, .rows = 2, .columns = 2};
+  matrix_t shift = s21_create_shift_matrix(1, 2, 3);
+
+  matrix_t result;
+  matrix_t *single[] = {&swapped};
+  ck_assert_int_eq(s21_mult_chain(single, 1, &result), OK);
+  ck_assert_double_eq(result.matrix[0][0], 3);
+  ck_assert_double_eq(result.matrix[1][1], 2);
+  s21_remove_matrix(&result);
+
+  matrix_t *pair[] = {&swapped, &swapped};
+  ck_assert_int_eq(s21_mult_chain(pair, 2, &result), OK);
+  ck_assert_double_eq(result.matrix[0][0], 13);
+  ck_assert_double_eq(result.matrix[0][1], 20);
+  ck_assert_double_eq(result.matrix[1][0], 5);
+  ck_assert_double_eq(result.matrix[1][1], 8);
+  s21_remove_matrix(&result);
+
+  matrix_t *mismatch[] = {&swapped, &shift};
+  ck_assert_int_eq(s21_mult_chain(mismatch, 2, &result), CALC_ERROR);
+  ck_assert_ptr_null(result.matrix);
+  s21_remove_matrix(&shift);
+}
+END_TEST
+
+START_TEST(test_mult_chain_invalid) {
+  matrix_t A, result;
+  s21_nullify_matrix(&A);
+  matrix_t *chain[] = {&A};
+
+  ck_assert_int_eq(s21_mult_chain(chain, 1, &result), ERROR);
+  ck_assert_int_eq(s21_mult_chain(chain, 0, &result), ERROR);
+  ck_assert_int_eq(s21_mult_chain(NULL, 1, &result), ERROR);
+  ck_assert_int_eq(s21_mult_chain(chain, 1, NULL), ERROR);
+}
+END_TEST
+
+Suite *s21_mult_chain_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("s21_mult_chain");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_mult_chain_rectangular);
+  tcase_add_test(tc_core, test_mult_chain_transforms);
+  tcase_add_test(tc_core, test_mult_chain_long);
+  tcase_add_test(tc_core, test_mult_chain_single_and_noncontiguous);
+  tcase_add_test(tc_core, test_mult_chain_invalid);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,269 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "../obj_parser/obj_check.h"
+#include "../util/prettify_c.h"
+
+#define CHECK_PATH "obj_check_test.tmp.obj"
+#define CHECK_GZ_PATH "obj_check_test.tmp.obj.gz"
+
+// Every face sees every edge of the tetrahedron twice
+#define TETRAHEDRON \
+  "v 0 0 0\n" \
+  "v 1 0 0\n" \
+  "v 0 1 0\n" \
+  "v 0 0 1\n" \
+  "f 1 3 2\n" \
+  "f 1 2 4\n" \
+  "f 2 3 4\n" \
+  "f 3 1 4\n"
+
+static ObjCheck check_text(const char *text, size_t edge_budget) {
+  FILE *file = fopen(CHECK_PATH, "wb");
+  fputs(text, file);
+  fclose(file);
+  ObjCheck check;
+  ck_assert(obj_check_file(CHECK_PATH, edge_budget, &check));
+  remove(CHECK_PATH);
+  return check;
+}
+
+START_TEST(test_obj_check_closed) {
+  ObjCheck check = check_text("# a closed surface\n" TETRAHEDRON "vn 0 0 1\nvt 0.5 0.5\n",
+                              OBJ_CHECK_EDGE_BUDGET);
+  ck_assert_uint_eq(check.vertices_count, 4);
+  ck_assert_uint_eq(check.normals_count, 1);
+  ck_assert_uint_eq(check.texture_coords_count, 1);
+  ck_assert_uint_eq(check.faces_count, 4);
+  ck_assert_uint_eq(check.triangles_count, 4);
+  ck_assert_uint_eq(check.edges_count, 6);
+  ck_assert_uint_eq(check.boundary_edges, 0);
+  ck_assert_uint_eq(check.non_manifold_edges, 0);
+  for (int i = 0; i < 3; i++) {
+    ck_assert_float_eq(check.min[i], 0);
+    ck_assert_float_eq(check.max[i], 1);
+  }
+  ck_assert(not check.has_spilled_edges);
+  ck_assert(not check.is_truncated);
+  ck_assert(check.text_bytes > 0 and check.text_bytes is check.file_bytes);
+  ck_assert(check.parsed_bytes > 0 and check.mesh_bytes > 0);
+  ck_assert(not obj_check_has_problems(&check));
+}
+END_TEST
+
+START_TEST(test_obj_check_non_manifold) {
+  // Three triangles on the edge 1-2
+  ObjCheck check = check_text(
+      "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 -1 0\nv 0 0 1\n"
+      "f 1 2 3\nf 2 1 4\nf 1 2 5\n",
+      OBJ_CHECK_EDGE_BUDGET);
+  ck_assert_uint_eq(check.edges_count, 7);
+  ck_assert_uint_eq(check.non_manifold_edges, 1);
+  ck_assert_uint_eq(check.boundary_edges, 6);
+  ck_assert(obj_check_has_problems(&check));
+
+  // A lone quad is open all round, which is no problem
+  check = check_text("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n", OBJ_CHECK_EDGE_BUDGET);
+  ck_assert_uint_eq(check.triangles_count, 2);
+  ck_assert_uint_eq(check.edges_count, 4);
+  ck_assert_uint_eq(check.boundary_edges, 4);
+  ck_assert(not obj_check_has_problems(&check));
+}
+END_TEST
+
+START_TEST(test_obj_check_degenerate) {
+  ObjCheck check = check_text(
+      "v 0 0 0\nv 1 0 0\nv 2 0 0\nv 0 1 0\n"
+      "f 1 2 1\n"       // one vertex twice
+      "f 1 2 3\n"       // on one line
+      "f 1 2\n"         // too few corners
+      "f 1/1/1 2//1 4\n"
+      "vt 0 0\nvn 0 0 1\n",
+      OBJ_CHECK_EDGE_BUDGET);
+  ck_assert_uint_eq(check.faces_count, 4);
+  ck_assert_uint_eq(check.degenerate_faces, 3);
+  ck_assert_uint_eq(check.out_of_range_indices, 0);
+  ck_assert_uint_eq(check.bad_lines, 0);
+  ck_assert(obj_check_has_problems(&check));
+}
+END_TEST
+
+START_TEST(test_obj_check_out_of_range) {
+  ObjCheck check = check_text(
+      "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+      "f 0 1 2\n"        // OBJ counts from 1
+      "f -1 -2 -4\n"     // one back too far
+      "f 1 2 9\n"        // past the end of the file
+      "f 1 2 4\n"        // a line that comes later
+      "f 1/2 2 3\n"      // a texture coordinate there is none of
+      "f 1 2 99999999999999999999\n"
+      "f 1 2 -99999999999999999999\n"
+      "v 0 0 1\n",
+      OBJ_CHECK_EDGE_BUDGET);
+  ck_assert_uint_eq(check.out_of_range_indices, 6);
+  ck_assert_uint_eq(check.degenerate_faces, 0);
+  ck_assert(obj_check_has_problems(&check));
+
+  check = check_text("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\n", OBJ_CHECK_EDGE_BUDGET);
+  ck_assert_uint_eq(check.out_of_range_indices, 0);
+  ck_assert(not obj_check_has_problems(&check));
+}
+END_TEST
+
+START_TEST(test_obj_check_bad_lines) {
+  ObjCheck check = check_text(
+      "v 0 0 zero\nv 1 0 0\nv 0 1 0\n"
+      "vn 0 x 1\nvt x\n"
+      "f 1 2 3\n"
+      "f 2 a 3\n",
+      OBJ_CHECK_EDGE_BUDGET);
+  // The bad vertex still counts, so face 1 2 3 points where it should
+  ck_assert_uint_eq(check.vertices_count, 3);
+  ck_assert_uint_eq(check.bad_lines, 4);
+  ck_assert_uint_eq(check.out_of_range_indices, 0);
+  ck_assert_float_eq(check.min[0], 0);
+  ck_assert_float_eq(check.max[0], 1);
+  ck_assert(obj_check_has_problems(&check));
+
+  // Too large for a float, kept out of the bounds
+  check = check_text("v 1e39 0 0\nv 1 2 3\nv 0 -1e40 0\n", OBJ_CHECK_EDGE_BUDGET);
+  ck_assert_uint_eq(check.vertices_count, 3);
+  ck_assert_uint_eq(check.bad_lines, 2);
+  ck_assert_float_eq(check.max[0], 1);
+  ck_assert_float_eq(check.min[1], 2);
+  ck_assert(obj_check_has_problems(&check));
+
+  check = check_text("v 1e39 0 0\n", OBJ_CHECK_EDGE_BUDGET);
+  ck_assert(check.min[0] > check.max[0]);
+}
+END_TEST
+
+// A grid of quads large enough to spill with a tiny budget, counted the
+// same either way
+START_TEST(test_obj_check_spilled_edges) {
+  const int side = 300;
+  size_t capacity = (size_t)side * side * 64;
+  char *text = malloc(capacity);
+  size_t size = 0;
+  for (int y = 0; y < side; y++)
+    for (int x = 0; x < side; x++) size += sprintf(text + size, "v %d %d 0\n", x, y);
+  for (int y = 0; y + 1 < side; y++) {
+    for (int x = 0; x + 1 < side; x++) {
+      int a = y * side + x + 1;
+      size += sprintf(text + size, "f %d %d %d %d\n", a, a + 1, a + side + 1, a + side);
+    }
+  }
+  // And a third face on an inner edge
+  size += sprintf(text + size, "f %d %d %d\n", side + 1, side + 2, side * side);
+  ck_assert(size < capacity);
+
+  ObjCheck in_memory = check_text(text, OBJ_CHECK_EDGE_BUDGET);
+  ObjCheck spilled = check_text(text, 4096);
+  free(text);
+
+  uint64_t quads = (uint64_t)(side - 1) * (side - 1);
+  ck_assert_uint_eq(in_memory.edges_count, 2 * quads + 2 * (side - 1) + 2);
+  ck_assert_uint_eq(in_memory.boundary_edges, 4 * (side - 1) + 2);
+  ck_assert_uint_eq(in_memory.non_manifold_edges, 1);
+  ck_assert(not in_memory.has_spilled_edges);
+  ck_assert(spilled.has_spilled_edges);
+  ck_assert_uint_eq(spilled.edges_count, in_memory.edges_count);
+  ck_assert_uint_eq(spilled.boundary_edges, in_memory.boundary_edges);
+  ck_assert_uint_eq(spilled.non_manifold_edges, in_memory.non_manifold_edges);
+  ck_assert(spilled.peak_bytes < in_memory.peak_bytes);
+}
+END_TEST
+
+// Past the positions the budget keeps, faces are not tested for area
+START_TEST(test_obj_check_position_budget) {
+  const int count = 1000;
+  char *text = malloc(count * 32 + 64);
+  size_t size = 0;
+  for (int i = 0; i < count; i++) size += sprintf(text + size, "v %d 0 0\n", i);
+  size += sprintf(text + size, "f 1 2 3\nf %d %d %d\n", count - 2, count - 1, count);
+
+  ObjCheck all = check_text(text, OBJ_CHECK_EDGE_BUDGET);
+  ObjCheck some = check_text(text, 4096);
+  free(text);
+  ck_assert_uint_eq(all.degenerate_faces, 2);
+  ck_assert(not all.has_unchecked_areas);
+  ck_assert_uint_eq(some.degenerate_faces, 1);
+  ck_assert(some.has_unchecked_areas);
+  ck_assert(some.peak_bytes < all.peak_bytes);
+  ck_assert_float_eq(some.max[0], count - 1);
+}
+END_TEST
+
+// More indices to later lines than are held in memory, all counted
+START_TEST(test_obj_check_many_forward) {
+  const int faces = 40000;
+  char *text = malloc(faces * 2 * 16 + 64);
+  size_t size = 0;
+  for (int i = 0; i < faces; i++) size += sprintf(text + size, "f 1 2 3\nf 3 4 9\n");
+  size += sprintf(text + size, "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\n");
+
+  ObjCheck check = check_text(text, OBJ_CHECK_EDGE_BUDGET);
+  free(text);
+  ck_assert_uint_eq(check.faces_count, 2 * faces);
+  ck_assert_uint_eq(check.out_of_range_indices, faces);
+}
+END_TEST
+
+START_TEST(test_obj_check_gzip) {
+#ifdef HAVE_ZLIB
+  gzFile gz = gzopen(CHECK_GZ_PATH, "wb");
+  gzputs(gz, TETRAHEDRON);
+  gzclose(gz);
+  ObjCheck check;
+  ck_assert(obj_check_file(CHECK_GZ_PATH, OBJ_CHECK_EDGE_BUDGET, &check));
+  ck_assert_uint_eq(check.faces_count, 4);
+  ck_assert_uint_eq(check.edges_count, 6);
+  ck_assert_uint_eq(check.text_bytes, strlen(TETRAHEDRON));
+  ck_assert(check.file_bytes is_not check.text_bytes);
+  ck_assert(not obj_check_has_problems(&check));
+
+  // Cut short, what came before is still counted
+  char data[256];
+  FILE *file = fopen(CHECK_GZ_PATH, "rb");
+  size_t length = fread(data, 1, sizeof(data), file);
+  fclose(file);
+  file = fopen(CHECK_GZ_PATH, "wb");
+  fwrite(data, 1, length - 10, file);
+  fclose(file);
+  ck_assert(obj_check_file(CHECK_GZ_PATH, OBJ_CHECK_EDGE_BUDGET, &check));
+  ck_assert(check.is_truncated);
+  ck_assert(obj_check_has_problems(&check));
+  remove(CHECK_GZ_PATH);
+#endif
+  ObjCheck missing;
+  ck_assert(not obj_check_file("no_such_file.obj", OBJ_CHECK_EDGE_BUDGET, &missing));
+}
+END_TEST
+
+Suite *obj_check_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("obj_check");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_obj_check_closed);
+  tcase_add_test(tc_core, test_obj_check_non_manifold);
+  tcase_add_test(tc_core, test_obj_check_degenerate);
+  tcase_add_test(tc_core, test_obj_check_out_of_range);
+  tcase_add_test(tc_core, test_obj_check_bad_lines);
+  tcase_add_test(tc_core, test_obj_check_spilled_edges);
+  tcase_add_test(tc_core, test_obj_check_position_budget);
+  tcase_add_test(tc_core, test_obj_check_many_forward);
+  tcase_add_test(tc_core, test_obj_check_gzip);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,126 @@
+#include <check.h>
+#include <math.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../s21_matrix/s21_quaternion.h"
+#include "../util/prettify_c.h"
+
+#define EPSILON 1e-9
+#undef M_PI
+#define M_PI 3.14159265358979323846264338327950288
+
+static void assert_matrices_near(matrix_t *A, matrix_t *B) {
+  ck_assert_int_eq(A->rows, B->rows);
+  ck_assert_int_eq(A->columns, B->columns);
+  for (int i = 0; i < A->rows; i++)
+    for (int j = 0; j < A->columns; j++)
+      ck_assert_double_eq_tol(A->matrix[i][j], B->matrix[i][j], EPSILON);
+}
+
+START_TEST(test_quat_from_rotation) {
+  int planes[][2] = {{AXIS_X, AXIS_Y}, {AXIS_Y, AXIS_X}, {AXIS_Y, AXIS_Z},
+                     {AXIS_Z, AXIS_Y}, {AXIS_X, AXIS_Z}, {AXIS_Z, AXIS_X}};
+
+  for (int i = 0; i < (int)LEN(planes); i++) {
+    matrix_t expected = s21_create_rotation_matrix(0.7, planes[i][0], planes[i][1]);
+    matrix_t result = s21_quat_to_matrix(
+        s21_quat_from_rotation(0.7, planes[i][0], planes[i][1]));
+
+    assert_matrices_near(&result, &expected);
+    s21_remove_matrix(&expected);
+    s21_remove_matrix(&result);
+  }
+}
+END_TEST
+
+START_TEST(test_quat_rotations_camera) {
+  double angles[][3] = {{0.3, -1.2, 2.5}, {M_PI, M_PI, M_PI}, {0, 0, 0}};
+
+  for (int i = 0; i < (int)LEN(angles); i++) {
+    matrix_t xz = s21_create_rotation_matrix(angles[i][0], AXIS_X, AXIS_Z);
+    matrix_t yz = s21_create_rotation_matrix(angles[i][1], AXIS_Y, AXIS_Z);
+    matrix_t xy = s21_create_rotation_matrix(angles[i][2], AXIS_X, AXIS_Y);
+    matrix_t a, expected;
+    s21_mult_matrix(&xz, &yz, &a);
+    s21_mult_matrix(&a, &xy, &expected);
+
+    matrix_t result = s21_create_rotations_camera(angles[i][0], angles[i][1],
+                                                  angles[i][2]);
+    assert_matrices_near(&result, &expected);
+
+    s21_remove_matrix(&xz);
+    s21_remove_matrix(&yz);
+    s21_remove_matrix(&xy);
+    s21_remove_matrix(&a);
+    s21_remove_matrix(&expected);
+    s21_remove_matrix(&result);
+  }
+}
+END_TEST
+
+START_TEST(test_quat_mult_and_normalize) {
+  quaternion_t q = s21_quat_from_rotation(1.1, AXIS_Y, AXIS_Z);
+  quaternion_t r = s21_quat_mult(q, s21_quat_identity());
+  ck_assert_double_eq_tol(r.w, q.w, EPSILON);
+  ck_assert_double_eq_tol(r.x, q.x, EPSILON);
+
+  // Rotating by an angle and back gives identity
+  quaternion_t back = s21_quat_from_rotation(-1.1, AXIS_Y, AXIS_Z);
+  r = s21_quat_mult(q, back);
+  ck_assert_double_eq_tol(r.w, 1.0, EPSILON);
+  ck_assert_double_eq_tol(r.x, 0.0, EPSILON);
+
+  quaternion_t n = s21_quat_normalize((quaternion_t){.w = 2, .x = 0, .y = 0, .z = 2});
+  ck_assert_double_eq_tol(n.w, sqrt(0.5), EPSILON);
+  ck_assert_double_eq_tol(n.z, sqrt(0.5), EPSILON);
+
+  n = s21_quat_normalize((quaternion_t){0});
+  ck_assert_double_eq(n.w, 1.0);
+}
+END_TEST
+
+START_TEST(test_quat_slerp) {
+  quaternion_t a = s21_quat_from_rotation(0.0, AXIS_X, AXIS_Y);
+  quaternion_t b = s21_quat_from_rotation(M_PI / 2.0, AXIS_X, AXIS_Y);
+
+  quaternion_t start = s21_quat_slerp(a, b, 0.0);
+  quaternion_t end = s21_quat_slerp(a, b, 1.0);
+  ck_assert_double_eq_tol(start.w, a.w, EPSILON);
+  ck_assert_double_eq_tol(end.w, b.w, EPSILON);
+  ck_assert_double_eq_tol(end.z, b.z, EPSILON);
+
+  quaternion_t expected = s21_quat_from_rotation(M_PI / 4.0, AXIS_X, AXIS_Y);
+  quaternion_t middle = s21_quat_slerp(a, b, 0.5);
+  ck_assert_double_eq_tol(middle.w, expected.w, EPSILON);
+  ck_assert_double_eq_tol(middle.z, expected.z, EPSILON);
+
+  // -b is the same rotation as b, the shorter arc must still be taken
+  quaternion_t negated = {.w = -b.w, .x = -b.x, .y = -b.y, .z = -b.z};
+  middle = s21_quat_slerp(a, negated, 0.5);
+  ck_assert_double_eq_tol(middle.w, expected.w, EPSILON);
+  ck_assert_double_eq_tol(middle.z, expected.z, EPSILON);
+
+  // Nearly equal inputs go through the linear fallback
+  quaternion_t close = s21_quat_from_rotation(1e-4, AXIS_X, AXIS_Y);
+  middle = s21_quat_slerp(a, close, 0.5);
+  expected = s21_quat_from_rotation(0.5e-4, AXIS_X, AXIS_Y);
+  ck_assert_double_eq_tol(middle.z, expected.z, EPSILON);
+}
+END_TEST
+
+Suite *s21_quaternion_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("s21_quaternion");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_quat_from_rotation);
+  tcase_add_test(tc_core, test_quat_rotations_camera);
+  tcase_add_test(tc_core, test_quat_mult_and_normalize);
+  tcase_add_test(tc_core, test_quat_slerp);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,171 @@
+#include <check.h>
+#include <stdlib.h>
+
+#include "../s21_matrix/s21_matrix.h"
+#include "../s21_matrix/s21_simd.h"
+#include "../util/prettify_c.h"
+
+#define EPSILON 1e-3
+
+// Reference result through s21_mult_matrix with a 4x1 column
+static void transform_reference(matrix_t *mat, float x, float y, float z,
+                                double result[3]) {
+  matrix_t point, product;
+  s21_create_matrix(4, 1, &point);
+  point.matrix[0][0] = x;
+  point.matrix[1][0] = y;
+  point.matrix[2][0] = z;
+  point.matrix[3][0] = 1.0;
+  s21_mult_matrix(mat, &point, &product);
+
+  double w = product.matrix[3][0];
+  for (int i = 0; i < 3; i++) result[i] = product.matrix[i][0] / w;
+  s21_remove_matrix(&point);
+  s21_remove_matrix(&product);
+}
+
+static matrix_t create_test_transform(bool projective) {
+  matrix_t rotation = s21_create_rotations_camera(0.4, -0.9, 1.7);
+  matrix_t shift = s21_create_scaleshift_matrix(2.0, 0.5, -1.5, 3.0, -4.0, 5.0);
+  matrix_t result;
+  s21_mult_matrix(&rotation, &shift, &result);
+  if (projective) {
+    result.matrix[3][2] = -0.25;
+    result.matrix[3][3] = 2.0;
+  }
+  s21_remove_matrix(&rotation);
+  s21_remove_matrix(&shift);
+  return result;
+}
+
+static float test_coordinate(size_t i, int axis) {
+  return (float)((int)((i * 7 + axis * 13) % 41) - 20) * 0.25f;
+}
+
+static void check_aos(size_t n, size_t stride, bool projective) {
+  matrix_t mat = create_test_transform(projective);
+  float *in = malloc(sizeof(float) * n * stride);
+  float *out = malloc(sizeof(float) * n * stride);
+  for (size_t i = 0; i < n * stride; i++) in[i] = out[i] = -7.0f;
+  for (size_t i = 0; i < n; i++)
+    for (int axis = 0; axis < 3; axis++)
+      in[i * stride + axis] = test_coordinate(i, axis);
+
+  for (int scalar = 0; scalar <= 1; scalar++) {
+    s21_simd_force_scalar(scalar);
+    ck_assert_int_eq(s21_transform_points(&mat, in, out, n, stride), OK);
+
+    for (size_t i = 0; i < n; i += 1 + n / 64) {
+      double expected[3];
+      transform_reference(&mat, in[i * stride], in[i * stride + 1],
+                          in[i * stride + 2], expected);
+      for (int axis = 0; axis < 3; axis++)
+        ck_assert_double_eq_tol(out[i * stride + axis], expected[axis], EPSILON);
+      // Everything after xyz is left as it was
+      for (size_t k = 3; k < stride; k++)
+        ck_assert_float_eq(out[i * stride + k], -7.0f);
+    }
+  }
+  s21_simd_force_scalar(false);
+
+  free(in);
+  free(out);
+  s21_remove_matrix(&mat);
+}
+
+START_TEST(test_transform_points_aos) {
+  check_aos(1, 3, false);
+  check_aos(37, 3, false);
+  check_aos(37, 6, false);
+  check_aos(37, 6, true);
+}
+END_TEST
+
+START_TEST(test_transform_points_in_place) {
+  matrix_t mat = s21_create_shift_matrix(1.0, 2.0, 3.0);
+  float vertices[] = {0, 0, 0, 9, 9, 9, 1, 1, 1, 9, 9, 9};
+
+  ck_assert_int_eq(s21_transform_points(&mat, vertices, vertices, 2, 6), OK);
+  float expected[] = {1, 2, 3, 9, 9, 9, 2, 3, 4, 9, 9, 9};
+  for (int i = 0; i < (int)LEN(vertices); i++)
+    ck_assert_float_eq(vertices[i], expected[i]);
+  s21_remove_matrix(&mat);
+}
+END_TEST
+
+START_TEST(test_transform_points_soa) {
+  size_t n = 1003;
+  matrix_t mat = create_test_transform(true);
+  float *in[3], *out[3];
+  for (int axis = 0; axis < 3; axis++) {
+    in[axis] = malloc(sizeof(float) * n);
+    out[axis] = malloc(sizeof(float) * n);
+    for (size_t i = 0; i < n; i++) in[axis][i] = test_coordinate(i, axis);
+  }
+
+  for (int scalar = 0; scalar <= 1; scalar++) {
+    s21_simd_force_scalar(scalar);
+    ck_assert_int_eq(
+        s21_transform_points_soa(&mat, (const float *const *)in, out, n), OK);
+    for (size_t i = 0; i < n; i++) {
+      double expected[3];
+      transform_reference(&mat, in[0][i], in[1][i], in[2][i], expected);
+      for (int axis = 0; axis < 3; axis++)
+        ck_assert_double_eq_tol(out[axis][i], expected[axis], EPSILON);
+    }
+  }
+  s21_simd_force_scalar(false);
+
+  for (int axis = 0; axis < 3; axis++) {
+    free(in[axis]);
+    free(out[axis]);
+  }
+  s21_remove_matrix(&mat);
+}
+END_TEST
+
+START_TEST(test_transform_points_large) {
+  // Big enough to be split between threads on multicore machines
+  check_aos(300000, 6, false);
+}
+END_TEST
+
+START_TEST(test_transform_points_invalid) {
+  matrix_t wrong_size, empty;
+  s21_create_matrix(3, 3, &wrong_size);
+  s21_nullify_matrix(&empty);
+  float point[3] = {0};
+  float *soa[3] = {point, point, NULL};
+
+  ck_assert_int_eq(s21_transform_points(&wrong_size, point, point, 1, 3), ERROR);
+  ck_assert_int_eq(s21_transform_points(&empty, point, point, 1, 3), ERROR);
+
+  matrix_t mat = s21_create_unit_matrix();
+  ck_assert_int_eq(s21_transform_points(&mat, point, point, 1, 2), ERROR);
+  ck_assert_int_eq(s21_transform_points(&mat, NULL, point, 1, 3), ERROR);
+  ck_assert_int_eq(s21_transform_points(&mat, point, point, 0, 3), OK);
+  ck_assert_int_eq(
+      s21_transform_points_soa(&mat, (const float *const *)soa, soa, 1), ERROR);
+
+  s21_remove_matrix(&wrong_size);
+  s21_remove_matrix(&mat);
+}
+END_TEST
+
+Suite *s21_transform_points_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("s21_transform_points");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_transform_points_aos);
+  tcase_add_test(tc_core, test_transform_points_in_place);
+  tcase_add_test(tc_core, test_transform_points_soa);
+  tcase_add_test(tc_core, test_transform_points_large);
+  tcase_add_test(tc_core, test_transform_points_invalid);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -0,0 +1,134 @@
+#include <check.h>
+#include <limits.h>
+
+#include "../util/common_vecs.h"
+
+typedef int Counted;
+static int DestroyedCount = 0;
+static void counted_destroy(Counted item) { DestroyedCount += item; }
+
+#define VECTOR_H Counted
+#include "../util/vector.h"
+#define VECTOR_C Counted
+#define VECTOR_ITEM_DESTRUCTOR counted_destroy
+#include "../util/vector.h"
+
+START_TEST(test_vector_reserve) {
+  vec_int v = vec_int_create();
+  vec_int_reserve(&v, 100);
+  ck_assert_int_eq(v.length, 0);
+  ck_assert_int_eq(v.capacity, 100);
+
+  int* data = v.data;
+  for (int i = 0; i < 100; i++) vec_int_push(&v, i);
+  ck_assert_ptr_eq(v.data, data);
+
+  // Never shrinks
+  vec_int_reserve(&v, 10);
+  ck_assert_int_eq(v.capacity, 100);
+  vec_int_free(v);
+}
+END_TEST
+
+START_TEST(test_vector_push_n) {
+  vec_int v = vec_int_create();
+  vec_int_push(&v, -1);
+
+  int items[1000];
+  for (int i = 0; i < 1000; i++) items[i] = i;
+  vec_int_push_n(&v, items, 1000);
+  vec_int_push_n(&v, items, 0);
+  vec_int_push_n(&v, items + 10, 3);
+
+  ck_assert_int_eq(v.length, 1004);
+  ck_assert(v.capacity >= v.length);
+  ck_assert_int_eq(v.data[0], -1);
+  ck_assert_int_eq(v.data[1], 0);
+  ck_assert_int_eq(v.data[1000], 999);
+  ck_assert_int_eq(v.data[1001], 10);
+  ck_assert_int_eq(v.data[1003], 12);
+  vec_int_free(v);
+}
+END_TEST
+
+START_TEST(test_vector_resize_uninit) {
+  vec_float v = vec_float_create();
+  vec_float_resize_uninit(&v, 30);
+  ck_assert_int_eq(v.length, 30);
+  for (int i = 0; i < 30; i++) v.data[i] = i * 0.5f;
+
+  vec_float_resize_uninit(&v, 5);
+  ck_assert_int_eq(v.length, 5);
+  ck_assert_int_eq(v.capacity, 30);
+  ck_assert_float_eq(v.data[4], 2.0f);
+  vec_float_free(v);
+
+  // Shrinking runs the destructor of dropped items only
+  vec_Counted counted = vec_Counted_create();
+  Counted items[] = {1, 10, 100, 1000};
+  vec_Counted_push_n(&counted, items, 4);
+  DestroyedCount = 0;
+  vec_Counted_resize_uninit(&counted, 2);
+  ck_assert_int_eq(DestroyedCount, 1100);
+  vec_Counted_free(counted);
+  ck_assert_int_eq(DestroyedCount, 1111);
+}
+END_TEST
+
+START_TEST(test_vector_shrink_to_fit) {
+  vec_int v = vec_int_with_capacity(64);
+  for (int i = 0; i < 10; i++) vec_int_push(&v, i * i);
+  vec_int_shrink_to_fit(&v);
+  ck_assert_int_eq(v.capacity, 10);
+  ck_assert_int_eq(v.data[9], 81);
+
+  v.length = 0;
+  vec_int_shrink_to_fit(&v);
+  ck_assert_ptr_null(v.data);
+  ck_assert_int_eq(v.capacity, 0);
+
+  vec_int_push(&v, 7);
+  ck_assert_int_eq(v.data[0], 7);
+  vec_int_free(v);
+}
+END_TEST
+
+START_TEST(test_vector_size_t_length) {
+  // Grows past INT_MAX items. Only the pages written to are touched, the
+  // rest of the 2 GB is never backed by memory
+  if (sizeof(size_t) < 8) return;
+  const size_t past_int = (size_t)INT_MAX + 1;
+  vec_char v = vec_char_create();
+  vec_char_reserve(&v, past_int + 64);
+  vec_char_resize_uninit(&v, past_int);
+  v.data[0] = 'a';
+  v.data[past_int - 1] = 'z';
+  vec_char_push_n(&v, "bc", 2);
+  ck_assert(v.length == past_int + 2);
+  ck_assert(v.capacity == past_int + 64);
+  ck_assert_int_eq(vec_char_at(&v, past_int - 1), 'z');
+  ck_assert_int_eq(vec_char_at(&v, past_int), 'b');
+  ck_assert_int_eq(vec_char_popget(&v), 'c');
+  ck_assert(v.length == past_int + 1);
+  ck_assert_int_eq(v.data[0], 'a');
+  vec_char_free(v);
+}
+END_TEST
+
+Suite *vector_suite(void) {
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("vector");
+
+  tc_core = tcase_create("Core");
+
+  tcase_add_test(tc_core, test_vector_reserve);
+  tcase_add_test(tc_core, test_vector_push_n);
+  tcase_add_test(tc_core, test_vector_resize_uninit);
+  tcase_add_test(tc_core, test_vector_shrink_to_fit);
+  tcase_add_test(tc_core, test_vector_size_t_length);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
@@ -18,6 +18,27 @@ Suite *s21_inverse_matrix_suite(void);
 Suite *s21_transpose_suite(void);
 Suite *s21_calc_complements_suite(void);
 Suite *s21_determinant_suite(void);
+Suite *s21_mult_chain_suite(void);
+Suite *s21_quaternion_suite(void);
+Suite *s21_transform_points_suite(void);
+Suite *s21_batch_suite(void);
+Suite *s21_fixed_matrix_suite(void);
+Suite *s21_elementwise_suite(void);
+Suite *arena_suite(void);
+Suite *vector_suite(void);
+Suite *hashmap_suite(void);
+Suite *jobs_suite(void);
+Suite *logger_suite(void);
+Suite *better_io_suite(void);
+Suite *mesh_export_suite(void);
+Suite *mesh_cache_suite(void);
+Suite *catalog_suite(void);
+Suite *mesh_import_suite(void);
+Suite *json_suite(void);
+Suite *glb_suite(void);
+Suite *block_stream_suite(void);
+Suite *block_reader_suite(void);
+Suite *obj_check_suite(void);
 
 int main(void) {
   const SuiteFn suites[] = {s21_remove_matrix_suite, s21_create_matrix_suite,
@@ -25,7 +46,17 @@ int main(void) {
                             s21_matrix_mult_suite_2, s21_mult_number_suite,
                             s21_eq_matrix_suite,     s21_inverse_matrix_suite,
                             s21_transpose_suite,     s21_calc_complements_suite,
-                            s21_determinant_suite};
+                            s21_determinant_suite,   s21_mult_chain_suite,
+                            s21_quaternion_suite,    s21_transform_points_suite,
+                            s21_batch_suite,         s21_fixed_matrix_suite,
+                            s21_elementwise_suite,   arena_suite,
+                            vector_suite,            hashmap_suite,
+                            jobs_suite,              logger_suite,
+                            better_io_suite,         mesh_export_suite,
+                            mesh_cache_suite,        catalog_suite,
+                            mesh_import_suite,       json_suite,
+                            glb_suite,               block_stream_suite,
+                            block_reader_suite,      obj_check_suite};
   int suites_len = sizeof(suites) / sizeof(suites[0]);
 
   SRunner *sr = srunner_create(NULL);
@@ -0,0 +1,276 @@
+// 3dviewer-convert: OBJ files to binary mesh caches the viewer loads without
+// parsing. Needs neither GLFW nor a display, so it runs on build machines.
+//
+//   3dviewer-convert [-j threads] [-o out_dir] [-f] [-r reader] <file.obj | dir>...
+//
+// Directories are searched recursively for .obj files, also gzip or zstd
+// compressed as .obj.gz and .obj.zst. Every cache is written next to its
+// OBJ as .mesh, or under out_dir keeping the path below the directory
+// argument. Caches newer than their OBJ are skipped unless -f is given, and
+// a file with lines that can not be parsed, or one that ends early, fails
+// instead of being cached, as do inputs that would share one cache. -r
+// picks how the files are read: read, mmap or io_uring (see
+// util/block_reader.h). Files are converted in parallel, one job each; a
+// progress line is printed as every file is done and a throughput summary
+// at the end.
+
+#define _POSIX_C_SOURCE 200809L  // strdup
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../obj_parser/mesh_cache.h"
+#include "../obj_parser/mesh_data.h"
+#include "../obj_parser/obj_parser.h"
+#include "../util/block_reader.h"
+#include "../util/block_stream.h"
+#include "../util/cur_time.h"
+#include "../util/dir_walk.h"
+#include "../util/jobs.h"
+#include "../util/prettify_c.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define make_dir(path) mkdir(path)
+#else
+#define make_dir(path) mkdir(path, 0777)
+#endif
+
+typedef enum TaskResult {
+  TASK_CONVERTED,
+  TASK_SKIPPED,
+  TASK_FAILED,
+} TaskResult;
+
+typedef struct ConvertTask {
+  char *input, *output;
+  long input_size;
+  size_t bad_lines;
+  bool is_truncated;
+  TaskResult result;
+} ConvertTask;
+
+#define VECTOR_ITEM_TYPE ConvertTask
+#define VECTOR_IMPLEMENTATION
+#include "../util/vector.h"  // vec_ConvertTask
+
+typedef struct Options {
+  int threads;  // 0 for one per CPU
+  const char *out_dir;
+  bool force;
+} Options;
+
+static Options Opts = {0};
+static atomic_int Done = 0;
+static int TasksCount = 0;
+
+static char *join_path(const char *dir, const char *name) {
+  size_t dir_length = strlen(dir);
+  bool slash = dir_length > 0 and dir[dir_length - 1] is_not '/';
+  char *path = malloc(dir_length + slash + strlen(name) + 1);
+  assert_alloc(path);
+  sprintf(path, "%s%s%s", dir, slash ? "/" : "", name);
+  return path;
+}
+
+// "a/b/model.obj" or "a/b/model.obj.gz" -> "a/b/model.mesh"
+static char *cache_path(const char *relative, const char *base_dir) {
+  char *path = base_dir ? join_path(base_dir, relative) : strdup(relative);
+  assert_alloc(path);
+  size_t length = strlen(path) - obj_path_extension_length(path);
+  path = realloc(path, length + sizeof("." MESH_CACHE_EXTENSION));
+  assert_alloc(path);
+  strcpy(path + length, "." MESH_CACHE_EXTENSION);
+  return path;
+}
+
+static void add_task(vec_ConvertTask *tasks, const char *input, const char *relative) {
+  ConvertTask task = {.input = strdup(input)};
+  assert_alloc(task.input);
+  task.output = cache_path(Opts.out_dir ? relative : input, Opts.out_dir);
+  vec_ConvertTask_push(tasks, task);
+}
+
+static void collect_file(void *ctx, const char *path, const char *relative,
+                         const FileInfo *info) {
+  unused(info);
+  if (obj_path_extension_length(path) > 0) add_task(ctx, path, relative);
+}
+
+static int compare_outputs(const void *a, const void *b) {
+  return strcmp((*(const ConvertTask *const *)a)->output, (*(const ConvertTask *const *)b)->output);
+}
+
+// model.obj next to model.obj.gz, or the same name under two directories
+// with -o, would be written to one cache, and which of them ends up there
+// depends on timing. All of them fail instead. Returns how many
+static int reject_duplicate_outputs(vec_ConvertTask *tasks) {
+  ConvertTask **sorted = malloc(tasks->length * sizeof(*sorted) + 1);
+  assert_alloc(sorted);
+  for (size_t i = 0; i < tasks->length; i++) sorted[i] = &tasks->data[i];
+  qsort(sorted, tasks->length, sizeof(*sorted), compare_outputs);
+
+  int rejected = 0;
+  for (size_t i = 1; i < tasks->length; i++) {
+    if (compare_outputs(&sorted[i - 1], &sorted[i]) is_not 0) continue;
+    fprintf(stderr, "%s and %s would both be converted to %s, skipping both\n",
+            sorted[i - 1]->input, sorted[i]->input, sorted[i]->output);
+    rejected += sorted[i - 1]->result is_not TASK_FAILED;
+    rejected += sorted[i]->result is_not TASK_FAILED;
+    sorted[i - 1]->result = sorted[i]->result = TASK_FAILED;
+  }
+  free(sorted);
+  return rejected;
+}
+
+// Creates every missing directory of path but the last component
+static void make_parent_dirs(const char *path) {
+  char *copy = strdup(path);
+  assert_alloc(copy);
+  for (char *slash = strchr(copy + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+    *slash = '\0';
+    make_dir(copy);
+    *slash = '/';
+  }
+  free(copy);
+}
+
+// Down to nanoseconds where the system keeps them, an OBJ saved in the same
+// second as its cache still counts as newer
+static bool is_up_to_date(const ConvertTask *task) {
+  FileInfo in, out;
+  return file_info(task->input, &in) and file_info(task->output, &out) and
+         out.mtime_ns >= in.mtime_ns;
+}
+
+static void convert_job(void *ctx) {
+  ConvertTask *task = ctx;
+  double start = wall_time_secs();
+  // obj_parse_model panics on a file it can not open
+  bool can_open = block_stream_is_supported(task->input);
+  FileInfo info;
+
+  if (not Opts.force and is_up_to_date(task)) {
+    task->result = TASK_SKIPPED;
+  } else if (not can_open or not file_info(task->input, &info)) {
+    task->result = TASK_FAILED;
+  } else {
+    task->input_size = (long)info.size;
+    ObjModel model = obj_parse_model(task->input);
+    // A cache of part of the model would be taken as up to date next time
+    task->bad_lines = model.bad_lines;
+    task->is_truncated = model.is_truncated;
+    if (model.bad_lines > 0 or model.is_truncated) {
+      task->result = TASK_FAILED;
+    } else {
+      MeshData data = obj_model_to_mesh_data(&model);
+      if (Opts.out_dir) make_parent_dirs(task->output);
+      task->result = mesh_cache_write(&data, task->output) ? TASK_CONVERTED : TASK_FAILED;
+      mesh_data_free(data);
+    }
+    obj_model_free(model);
+  }
+
+  int done = atomic_fetch_add(&Done, 1) + 1;
+  double secs = wall_time_secs() - start;
+  if (task->result is TASK_CONVERTED)
+    printf("[%d/%d] %s -> %s, %.1f MB in %.2fs\n", done, TasksCount, task->input,
+           task->output, task->input_size / 1e6, secs);
+  else if (task->result is TASK_FAILED and task->is_truncated)
+    fprintf(stderr, "[%d/%d] %s: ends early or is corrupt, not converted\n", done, TasksCount,
+            task->input);
+  else if (task->result is TASK_FAILED and task->bad_lines > 0)
+    fprintf(stderr, "[%d/%d] %s: %zu bad lines, not converted\n", done, TasksCount,
+            task->input, task->bad_lines);
+  else if (task->result is TASK_FAILED)
+    fprintf(stderr, "[%d/%d] %s: cannot convert to %s\n", done, TasksCount,
+            task->input, task->output);
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [-j threads] [-o out_dir] [-f] [-r reader] <file.obj | dir>...\n"
+          "  -j  threads to convert with, one per CPU by default\n"
+          "  -o  directory for the ." MESH_CACHE_EXTENSION " files, next to the inputs by default\n"
+          "  -f  convert even when the cache is newer than its OBJ\n"
+          "  -r  read, mmap or io_uring, how the files are read, read by default\n",
+          name);
+}
+
+int main(int argc, char **argv) {
+  vec_ConvertTask tasks = vec_ConvertTask_create();
+  int arg = 1;
+
+  for (; arg < argc and argv[arg][0] is '-'; arg++) {
+    if (strcmp(argv[arg], "-f") is 0) {
+      Opts.force = true;
+    } else if (strcmp(argv[arg], "-j") is 0 and arg + 1 < argc) {
+      Opts.threads = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-o") is 0 and arg + 1 < argc) {
+      Opts.out_dir = argv[++arg];
+    } else if (strcmp(argv[arg], "-r") is 0 and arg + 1 < argc) {
+      BlockReaderKind kind;
+      if (not block_reader_parse_kind(argv[++arg], &kind)) {
+        usage(argv[0]);
+        return 2;
+      }
+      if (not block_reader_is_available(kind))
+        fprintf(stderr, "%s is not available here, reading with read\n", argv[arg]);
+      block_reader_set_default(kind);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (arg is argc) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  for (; arg < argc; arg++) {
+    FileInfo info;
+    if (not file_info(argv[arg], &info)) {
+      fprintf(stderr, "Cannot open %s: %s\n", argv[arg], strerror(errno));
+    } else if (info.is_dir) {
+      if (not dir_walk(argv[arg], collect_file, &tasks))
+        fprintf(stderr, "Cannot open directory %s: %s\n", argv[arg], strerror(errno));
+    } else if (obj_path_extension_length(argv[arg]) is 0) {
+      fprintf(stderr, "Not an .obj file: %s\n", argv[arg]);
+    } else {
+      const char *name = strrchr(argv[arg], '/');
+      add_task(&tasks, argv[arg], name ? name + 1 : argv[arg]);
+    }
+  }
+  // Rejected tasks are left failed and never submitted
+  TasksCount = (int)tasks.length - reject_duplicate_outputs(&tasks);
+
+  // The calling thread converts too, while it waits
+  jobs_init(Opts.threads > 0 ? Opts.threads - 1 : -1);
+  double start = wall_time_secs();
+  JobCounter counter = {0};
+  for (size_t i = 0; i < tasks.length; i++)
+    if (tasks.data[i].result is_not TASK_FAILED) jobs_submit(convert_job, &tasks.data[i], &counter);
+  jobs_wait(&counter);
+  double secs = wall_time_secs() - start;
+  jobs_shutdown();
+
+  int counts[3] = {0};
+  double megabytes = 0;
+  for (size_t i = 0; i < tasks.length; i++) {
+    counts[tasks.data[i].result]++;
+    megabytes += tasks.data[i].input_size / 1e6;
+    free(tasks.data[i].input);
+    free(tasks.data[i].output);
+  }
+  size_t tasks_found = tasks.length;
+  vec_ConvertTask_free(tasks);
+
+  printf("%d converted, %d up to date, %d failed in %.2fs: %.1f MB of OBJ, %.1f MB/s, %.1f files/s\n",
+         counts[TASK_CONVERTED], counts[TASK_SKIPPED], counts[TASK_FAILED], secs,
+         megabytes, secs > 0 ? megabytes / secs : 0, secs > 0 ? counts[TASK_CONVERTED] / secs : 0);
+  return counts[TASK_FAILED] > 0 or tasks_found is 0 ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+// 3dviewer-stats: counts, bounds and problems of OBJ files, for checking
+// models in bulk on machines with no display. Needs neither GLFW nor GL.
+//
+//   3dviewer-stats [-j threads] [-m edge_mb] [-r reader] [-s] [--json] <file.obj | dir>...
+//
+// Directories are searched recursively for .obj, .obj.gz and .obj.zst
+// files. Every file is read once as a stream (see obj_parser/obj_check.h),
+// so a file of several GB needs at most edge_mb of edges and as much again of
+// vertex positions in memory per thread, never its text. Files are checked in
+// parallel and reported in the order they were found, as text or as a
+// JSON array. The exit code is 1 if a file can not be read, or with -s if
+// any file has a problem: bad lines, degenerate faces, out of range indices,
+// non-manifold edges or an early end.
+
+#define _POSIX_C_SOURCE 200809L  // strdup
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../obj_parser/obj_check.h"
+#include "../obj_parser/obj_parser.h"
+#include "../util/block_reader.h"
+#include "../util/cur_time.h"
+#include "../util/dir_walk.h"
+#include "../util/jobs.h"
+#include "../util/prettify_c.h"
+
+typedef struct StatsTask {
+  char *path;
+  bool is_read;
+  ObjCheck check;
+} StatsTask;
+
+#define VECTOR_ITEM_TYPE StatsTask
+#define VECTOR_IMPLEMENTATION
+#include "../util/vector.h"  // vec_StatsTask
+
+typedef struct Options {
+  int threads;  // 0 for one per CPU
+  size_t edge_budget;
+  bool is_strict, is_json;
+} Options;
+
+static Options Opts = {.edge_budget = OBJ_CHECK_EDGE_BUDGET};
+
+static void add_task(vec_StatsTask *tasks, const char *path) {
+  StatsTask task = {.path = strdup(path)};
+  assert_alloc(task.path);
+  vec_StatsTask_push(tasks, task);
+}
+
+static void collect_file(void *ctx, const char *path, const char *relative,
+                         const FileInfo *info) {
+  unused(relative);
+  unused(info);
+  if (obj_path_extension_length(path) > 0) add_task(ctx, path);
+}
+
+static void stats_job(void *ctx) {
+  StatsTask *task = ctx;
+  task->is_read = obj_check_file(task->path, Opts.edge_budget, &task->check);
+}
+
+static void print_text(const StatsTask *task) {
+  if (not task->is_read) {
+    printf("%s: cannot read\n", task->path);
+    return;
+  }
+  const ObjCheck *c = &task->check;
+  printf("%s%s\n", task->path, c->is_truncated ? " (ends early or is corrupt)" : "");
+  printf("  vertices %llu, texture coords %llu, normals %llu, faces %llu (%llu triangles)\n",
+         (unsigned long long)c->vertices_count, (unsigned long long)c->texture_coords_count,
+         (unsigned long long)c->normals_count, (unsigned long long)c->faces_count,
+         (unsigned long long)c->triangles_count);
+  if (c->min[0] <= c->max[0])
+    printf("  bounds [%g %g %g] .. [%g %g %g]\n", c->min[0], c->min[1], c->min[2], c->max[0],
+           c->max[1], c->max[2]);
+  printf("  bad lines %llu, degenerate faces %llu, out of range indices %llu\n",
+         (unsigned long long)c->bad_lines, (unsigned long long)c->degenerate_faces,
+         (unsigned long long)c->out_of_range_indices);
+  printf("  edges %llu, boundary %llu, non-manifold %llu\n", (unsigned long long)c->edges_count,
+         (unsigned long long)c->boundary_edges, (unsigned long long)c->non_manifold_edges);
+  printf("  memory: file %.1f MB, text %.1f MB, parsed %.1f MB, mesh %.1f MB, check %.1f MB%s%s\n",
+         c->file_bytes / 1e6, c->text_bytes / 1e6, c->parsed_bytes / 1e6, c->mesh_bytes / 1e6,
+         c->peak_bytes / 1e6, c->has_spilled_edges ? " (edges spilled to disk)" : "",
+         c->has_unchecked_areas ? " (areas of some faces not checked)" : "");
+}
+
+static void print_json_string(const char *text) {
+  putchar('"');
+  for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+    if (*c is '"' or *c is '\\')
+      printf("\\%c", *c);
+    else if (*c < 0x20)
+      printf("\\u%04x", *c);
+    else
+      putchar(*c);
+  }
+  putchar('"');
+}
+
+static void print_json(const StatsTask *task, bool is_last) {
+  printf("  {\"path\": ");
+  print_json_string(task->path);
+  if (not task->is_read) {
+    printf(", \"read\": false}%s\n", is_last ? "" : ",");
+    return;
+  }
+  const ObjCheck *c = &task->check;
+  printf(", \"read\": true, \"truncated\": %s,\n", c->is_truncated ? "true" : "false");
+  printf("   \"vertices\": %llu, \"texture_coords\": %llu, \"normals\": %llu, \"faces\": %llu, "
+         "\"triangles\": %llu,\n",
+         (unsigned long long)c->vertices_count, (unsigned long long)c->texture_coords_count,
+         (unsigned long long)c->normals_count, (unsigned long long)c->faces_count,
+         (unsigned long long)c->triangles_count);
+  // JSON has no inf or nan, bounds are left out until a vertex sets them
+  if (c->min[0] <= c->max[0])
+    printf("   \"min\": [%.9g, %.9g, %.9g], \"max\": [%.9g, %.9g, %.9g],\n", c->min[0], c->min[1],
+           c->min[2], c->max[0], c->max[1], c->max[2]);
+  printf("   \"bad_lines\": %llu, \"degenerate_faces\": %llu, \"out_of_range_indices\": %llu,\n",
+         (unsigned long long)c->bad_lines, (unsigned long long)c->degenerate_faces,
+         (unsigned long long)c->out_of_range_indices);
+  printf("   \"edges\": %llu, \"boundary_edges\": %llu, \"non_manifold_edges\": %llu,\n",
+         (unsigned long long)c->edges_count, (unsigned long long)c->boundary_edges,
+         (unsigned long long)c->non_manifold_edges);
+  printf("   \"file_bytes\": %llu, \"text_bytes\": %llu, \"parsed_bytes\": %llu, "
+         "\"mesh_bytes\": %llu, \"check_peak_bytes\": %llu, \"edges_spilled\": %s, "
+         "\"areas_unchecked\": %s}%s\n",
+         (unsigned long long)c->file_bytes, (unsigned long long)c->text_bytes,
+         (unsigned long long)c->parsed_bytes, (unsigned long long)c->mesh_bytes,
+         (unsigned long long)c->peak_bytes, c->has_spilled_edges ? "true" : "false",
+         c->has_unchecked_areas ? "true" : "false", is_last ? "" : ",");
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [-j threads] [-m edge_mb] [-r reader] [-s] [--json] <file.obj | dir>...\n"
+          "  -j      threads to check with, one per CPU by default\n"
+          "  -m      MB of edges kept in memory per thread, more go to temporary files, and of\n"
+          "          vertex positions for the area test, %d by default\n"
+          "  -r      read, mmap or io_uring, how the files are read, read by default\n"
+          "  -s      exit with 1 if any file has a problem\n"
+          "  --json  print a JSON array instead of text\n",
+          name, (int)(OBJ_CHECK_EDGE_BUDGET >> 20));
+}
+
+int main(int argc, char **argv) {
+  vec_StatsTask tasks = vec_StatsTask_create();
+  int arg = 1;
+
+  for (; arg < argc and argv[arg][0] is '-'; arg++) {
+    if (strcmp(argv[arg], "-s") is 0) {
+      Opts.is_strict = true;
+    } else if (strcmp(argv[arg], "--json") is 0) {
+      Opts.is_json = true;
+    } else if (strcmp(argv[arg], "-j") is 0 and arg + 1 < argc) {
+      Opts.threads = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-m") is 0 and arg + 1 < argc) {
+      Opts.edge_budget = (size_t)atol(argv[++arg]) << 20;
+    } else if (strcmp(argv[arg], "-r") is 0 and arg + 1 < argc) {
+      BlockReaderKind kind;
+      if (not block_reader_parse_kind(argv[++arg], &kind)) {
+        usage(argv[0]);
+        return 2;
+      }
+      if (not block_reader_is_available(kind))
+        fprintf(stderr, "%s is not available here, reading with read\n", argv[arg]);
+      block_reader_set_default(kind);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (arg is argc) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  for (; arg < argc; arg++) {
+    FileInfo info;
+    if (not file_info(argv[arg], &info)) {
+      fprintf(stderr, "Cannot open %s: %s\n", argv[arg], strerror(errno));
+    } else if (info.is_dir) {
+      if (not dir_walk(argv[arg], collect_file, &tasks))
+        fprintf(stderr, "Cannot open directory %s: %s\n", argv[arg], strerror(errno));
+    } else if (obj_path_extension_length(argv[arg]) is 0) {
+      fprintf(stderr, "Not an .obj file: %s\n", argv[arg]);
+    } else {
+      add_task(&tasks, argv[arg]);
+    }
+  }
+
+  // The calling thread checks too, while it waits
+  jobs_init(Opts.threads > 0 ? Opts.threads - 1 : -1);
+  double start = wall_time_secs();
+  JobCounter counter = {0};
+  for (size_t i = 0; i < tasks.length; i++) jobs_submit(stats_job, &tasks.data[i], &counter);
+  jobs_wait(&counter);
+  double secs = wall_time_secs() - start;
+  jobs_shutdown();
+
+  int unread = 0, with_problems = 0;
+  double megabytes = 0;
+  if (Opts.is_json) printf("[\n");
+  for (size_t i = 0; i < tasks.length; i++) {
+    StatsTask *task = &tasks.data[i];
+    if (Opts.is_json)
+      print_json(task, i + 1 is tasks.length);
+    else
+      print_text(task);
+    unread += not task->is_read;
+    with_problems += task->is_read and obj_check_has_problems(&task->check);
+    megabytes += task->is_read ? task->check.file_bytes / 1e6 : 0;
+    free(task->path);
+  }
+  if (Opts.is_json) printf("]\n");
+  fprintf(stderr, "%zu files, %d with problems, %d unreadable in %.2fs: %.1f MB, %.1f MB/s\n",
+          tasks.length, with_problems, unread, secs, megabytes, secs > 0 ? megabytes / secs : 0);
+  vec_StatsTask_free(tasks);
+
+  return unread > 0 or tasks.length is 0 or (Opts.is_strict and with_problems > 0) ? 1 : 0;
+}
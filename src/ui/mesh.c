@@ -39,6 +39,11 @@ void mesh_set_vertex_data(Mesh* this, void* data, int length, GLenum usage) {
   glBufferData(GL_ARRAY_BUFFER, length, data, usage);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
+void mesh_set_vertex_subdata(Mesh* this, const void* data, int offset, int length) {
+  glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+  glBufferSubData(GL_ARRAY_BUFFER, offset, length, data);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 void mesh_set_indices(Mesh* this, void* data, int length, int indices_count,
                       GLenum usage, GLenum index_type) {
   this->index_type = index_type;
@@ -83,4 +88,12 @@ void mesh_bind_consecutive_attribs(Mesh this, int start_id, MeshAttrib* attribs,
     ptr += attribs[i].element_size * attribs[i].elements_count;
 #pragma GCC diagnostic pop
   }
+}
+
+void mesh_bind_attrib(Mesh this, int id, MeshAttrib attrib, int stride,
+                      size_t offset) {
+  mesh_bind(this);
+  glEnableVertexAttribArray(id);
+  glVertexAttribPointer(id, attrib.elements_count, attrib.element_type,
+                        GL_FALSE, stride, (const void*)offset);
 }
\ No newline at end of file
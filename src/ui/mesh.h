@@ -18,6 +18,8 @@ void mesh_bind(Mesh);
 void mesh_unbind();
 
 void mesh_set_vertex_data(Mesh*, void* data, int length, GLenum usage);
+// Fills part of a buffer mesh_set_vertex_data made with null data
+void mesh_set_vertex_subdata(Mesh*, const void* data, int offset, int length);
 void mesh_set_indices(Mesh*, void* data, int length, int indices_count,
                       GLenum usage, GLenum index_type);
 void mesh_set_indices_int_tuples(Mesh*, int* data, int len, GLenum usage);
@@ -32,5 +34,8 @@ typedef struct MeshAttrib {
 } MeshAttrib;
 void mesh_bind_consecutive_attribs(Mesh, int start_id, MeshAttrib* attribs,
                                    int count);
+// One attribute at any stride and offset, for data laid out by someone else
+void mesh_bind_attrib(Mesh, int id, MeshAttrib attrib, int stride,
+                      size_t offset);
 
 #endif  // SRC_UTIL_MESH_H_
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "mesh_lru.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "../util/allocator.h"
+#include "../util/prettify_c.h"
+
+#define VECTOR_C MeshLruEntry
+#include "../util/vector.h"
+
+size_t cached_mesh_bytes(const CachedMesh* model) {
+    size_t gpu = (size_t)model->vertices_count * MESH_DATA_STRIDE * sizeof(float) +
+                 (size_t)model->mesh.indices_count * sizeof(int);
+    size_t cpu = model->has_data ?
+                 model->data.vertices.length * sizeof(float) + model->data.indices.length * sizeof(int) : 0;
+    return gpu + cpu;
+}
+
+void cached_mesh_free(CachedMesh model) {
+    mesh_delete(model.mesh);
+    if (model.has_data) mesh_data_free(model.data);
+}
+
+MeshLru mesh_lru_create(size_t budget_bytes, int max_count, bool keeps_data) {
+    return (MeshLru) {
+        .entries = vec_MeshLruEntry_create(),
+        .budget_bytes = budget_bytes,
+        .max_count = max_count,
+        .keeps_data = keeps_data,
+        .clock = 0,
+        .stats = {0},
+    };
+}
+
+static void delete_entry(MeshLru* lru, size_t i) {
+    MeshLruEntry entry = vec_MeshLruEntry_extract_fast(&lru->entries, i);
+    lru->stats.bytes -= entry.bytes;
+    lru->stats.count--;
+    cached_mesh_free(entry.model);
+    FREE(entry.path);
+}
+
+void mesh_lru_free(MeshLru* lru) {
+    while (lru->entries.length > 0) delete_entry(lru, lru->entries.length - 1);
+    vec_MeshLruEntry_free(lru->entries);
+}
+
+static void evict_over_limits(MeshLru* lru) {
+    while (lru->entries.length > 0 and
+           (lru->stats.bytes > lru->budget_bytes or lru->stats.count > lru->max_count)) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < lru->entries.length; i++)
+            if (lru->entries.data[i].last_used < lru->entries.data[oldest].last_used) oldest = i;
+        delete_entry(lru, oldest);
+        lru->stats.evictions++;
+    }
+}
+
+static void drop_data(MeshLru* lru, MeshLruEntry* entry) {
+    if (not entry->model.has_data) return;
+    mesh_data_free(entry->model.data);
+    entry->model.has_data = false;
+    lru->stats.bytes -= entry->bytes;
+    entry->bytes = cached_mesh_bytes(&entry->model);
+    lru->stats.bytes += entry->bytes;
+}
+
+void mesh_lru_set_limits(MeshLru* lru, size_t budget_bytes, int max_count, bool keeps_data) {
+    if (lru->keeps_data and not keeps_data)
+        for (size_t i = 0; i < lru->entries.length; i++) drop_data(lru, &lru->entries.data[i]);
+    lru->budget_bytes = budget_bytes;
+    lru->max_count = max_count;
+    lru->keeps_data = keeps_data;
+    evict_over_limits(lru);
+}
+
+bool mesh_lru_take(MeshLru* lru, const char* path, CachedMesh* out) {
+    for (size_t i = 0; i < lru->entries.length; i++) {
+        MeshLruEntry* entry = &lru->entries.data[i];
+        if (strcmp(entry->path, path) is_not 0) continue;
+
+        FileInfo now;
+        bool is_same_file = file_info(path, &now) and now.size is entry->model.file.size and
+                            now.mtime_ns is entry->model.file.mtime_ns;
+        if (not is_same_file) break;
+
+        *out = entry->model;
+        lru->stats.bytes -= entry->bytes;
+        lru->stats.count--;
+        FREE(entry->path);
+        vec_MeshLruEntry_delete_fast(&lru->entries, i);
+        lru->stats.hits++;
+        return true;
+    }
+
+    // At most one entry per path, and a stale one is of no use
+    for (size_t i = 0; i < lru->entries.length; i++) {
+        if (strcmp(lru->entries.data[i].path, path) is 0) {
+            delete_entry(lru, i);
+            break;
+        }
+    }
+    lru->stats.misses++;
+    return false;
+}
+
+void mesh_lru_put(MeshLru* lru, const char* path, CachedMesh model) {
+    AllocTag old_tag = alloc_tag_set(ALLOC_TAG_MESH);
+    if (model.has_data and not lru->keeps_data) {
+        mesh_data_free(model.data);
+        model.has_data = false;
+    }
+
+    size_t length = strlen(path);
+    MeshLruEntry entry = {
+        .path = MALLOC(length + 1),
+        .model = model,
+        .bytes = cached_mesh_bytes(&model),
+        .last_used = ++lru->clock,
+    };
+    assert_alloc(entry.path);
+    memcpy(entry.path, path, length + 1);
+
+    vec_MeshLruEntry_push(&lru->entries, entry);
+    lru->stats.bytes += entry.bytes;
+    lru->stats.count++;
+    // Older models go first, then this one if it alone is over the budget
+    evict_over_limits(lru);
+    alloc_tag_set(old_tag);
+}
@@ -0,0 +1,76 @@
+#ifndef UI_MESH_LRU_
+#define UI_MESH_LRU_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mesh.h"
+#include "../obj_parser/mesh_data.h"
+#include "../s21_matrix/s21_matrix.h"
+#include "../util/dir_walk.h"
+
+/**
+ * Models shown recently and switched away from, kept on the GPU so showing
+ * one again skips reading, parsing and uploading it. Entries are keyed by the
+ * path and by the size and mtime the file had when it was loaded, so a model
+ * saved again in the meantime is loaded anew. The least recently used entries
+ * are deleted once there are more than max_count of them or they take more
+ * than budget_bytes.
+ *
+ * The model on screen is not in the cache: it is taken out on a hit and put
+ * back when another one replaces it, so nothing is owned twice. max_count is
+ * small, a linear search beats hashing the path.
+ */
+
+typedef struct CachedMesh {
+    Mesh mesh;
+    MeshData data;  // what mesh was made from, empty unless has_data
+    bool has_data;
+    int vertices_count;
+    FileInfo file;
+    // Takes mesh to display axes: identity for meshes made from MeshData,
+    // glb_placement for GLB uploaded as stored
+    FloatArray16 placement;
+} CachedMesh;
+
+typedef struct MeshLruEntry {
+    char* path;
+    CachedMesh model;
+    size_t bytes;  // on the GPU, and in data
+    unsigned long last_used;
+} MeshLruEntry;
+
+#define VECTOR_H MeshLruEntry
+#include "../util/vector.h"  // vec_MeshLruEntry
+
+typedef struct MeshLruStats {
+    long hits, misses, evictions;
+    size_t bytes;
+    int count;
+} MeshLruStats;
+
+typedef struct MeshLru {
+    vec_MeshLruEntry entries;
+    size_t budget_bytes;
+    int max_count;
+    bool keeps_data;  // CPU copies too, or only the meshes
+    unsigned long clock;
+    MeshLruStats stats;
+} MeshLru;
+
+MeshLru mesh_lru_create(size_t budget_bytes, int max_count, bool keeps_data);
+void mesh_lru_free(MeshLru* lru);
+
+// Evicts whatever the new limits do not leave room for
+void mesh_lru_set_limits(MeshLru* lru, size_t budget_bytes, int max_count, bool keeps_data);
+
+// Takes the model of path out of the cache, false on a miss. A stale entry,
+// for a file that changed since, is deleted and counts as a miss
+bool mesh_lru_take(MeshLru* lru, const char* path, CachedMesh* out);
+// The cache owns model afterwards, it may be deleted right away if it does
+// not fit
+void mesh_lru_put(MeshLru* lru, const char* path, CachedMesh model);
+
+size_t cached_mesh_bytes(const CachedMesh* model);
+void cached_mesh_free(CachedMesh model);
+
+#endif //UI_MESH_LRU_
@@ -4,10 +4,6 @@
 static Mesh create_skybox_mesh();
 
 Skybox skybox_create() {
-    matrix_t unit = s21_create_unit_matrix();
-    FloatArray16 arr = s21_matrix_to_farray(&unit);
-    s21_remove_matrix(&unit);
-
     const char* paths[] = {
       "assets/img/sky/up.jpg",
       "assets/img/sky/dn.jpg",
@@ -21,14 +17,14 @@ Skybox skybox_create() {
         .skybox_mesh = create_skybox_mesh(),
         .shader = gl_program_from_2_paths("assets/shaders/skybox.vert", "assets/shaders/skybox.frag"),
         .textures = texture_array_load_clamp(paths, LEN(paths)),
-        .object_mat = arr,
+        .object_mat = mat_float_4x4_identity(),
     };
 }
 
 void skybox_draw(const Skybox* sky, FloatArray16 skybox_viewproj) {
     glUseProgram(sky->shader.program);
     glUniformMatrix4fv(glGetUniformLocation(sky->shader.program, "u_vp"), 1, GL_TRUE, skybox_viewproj.data);
-    glUniformMatrix4fv(glGetUniformLocation(sky->shader.program, "u_object"), 1, GL_TRUE, sky->object_mat.data);
+    glUniformMatrix4fv(glGetUniformLocation(sky->shader.program, "u_object"), 1, GL_TRUE, mat_float_4x4_data(&sky->object_mat));
     glUniform2f(glGetUniformLocation(sky->shader.program, "u_texture_scale"), 1.0, 1.0);
 
     glActiveTexture(GL_TEXTURE0);
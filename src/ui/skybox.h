@@ -5,13 +5,14 @@
 #include "shader_loader.h"
 #include "mesh.h"
 #include "../s21_matrix/s21_matrix.h"
+#include "../s21_matrix/s21_fixed_matrices.h"
 
 typedef struct Skybox {
     Mesh skybox_mesh;
     GlProgram shader;
     TextureArray textures;
 
-    FloatArray16 object_mat;
+    mat_float_4x4 object_mat;
 } Skybox;
 
 Skybox skybox_create();
@@ -1,6 +1,8 @@
 #include "texture.h"
 #include <stb_image.h>
 
+#include "../util/allocator.h"
+#include "../util/jobs.h"
 #include "../util/prettify_c.h"
 
 static Texture texture_load_common(const char* path, GLenum wrap);
@@ -32,7 +34,9 @@ static GLenum format_by_channels(int channels) {
 static Texture texture_load_common(const char* path, GLenum wrap) {
     int x, y, channels;
     GLuint tex;
+    AllocTag old_tag = alloc_tag_set(ALLOC_TAG_TEXTURE);
     unsigned char *data = stbi_load(path, &x, &y, &channels, 0);
+    alloc_tag_set(old_tag);
 
     if (!data) panic("texture_load: Failed to load image: %s", path);
 
@@ -56,6 +60,7 @@ static Texture texture_load_common(const char* path, GLenum wrap) {
 
 typedef struct StbImage {
     unsigned char* bytes;
+    int width, height, channels;
 } StbImage;
 
 void stb_image_data_free(StbImage image) {
@@ -63,30 +68,47 @@ void stb_image_data_free(StbImage image) {
 }
 
 #define VECTOR_ITEM_TYPE StbImage
+#define VECTOR_ITEM_DESTRUCTOR stb_image_data_free
 #define VECTOR_IMPLEMENTATION
 #include "../util/vector.h"
 
 
+typedef struct DecodeJob {
+    const char** paths;
+    StbImage* images;
+} DecodeJob;
+
+static void decode_images(void* ctx, size_t begin, size_t end) {
+    DecodeJob* job = ctx;
+    for (size_t i = begin; i < end; i++) {
+        StbImage* image = &job->images[i];
+        image->bytes = stbi_load(job->paths[i], &image->width, &image->height, &image->channels, 0);
+    }
+}
+
 TextureArray texture_array_load_clamp(const char* paths[], int count) {
+    AllocTag old_tag = alloc_tag_set(ALLOC_TAG_TEXTURE);
     vec_StbImage images = vec_StbImage_with_capacity(count);
-    int width, height, channels;
+    vec_StbImage_resize_uninit(&images, count);
+
+    // Decoding dominates, every image is a job of its own
+    DecodeJob job = {paths, images.data};
+    parallel_for(0, count, 1, decode_images, &job);
+    alloc_tag_set(old_tag);
 
+    int width = images.data[0].width;
+    int height = images.data[0].height;
+    int channels = images.data[0].channels;
     for (int i = 0; i < count; i++) {
-        int local_width, local_height, local_channels;
-        unsigned char *data = stbi_load(paths[i], &local_width, &local_height, &local_channels, 0);
+        StbImage image = images.data[i];
+        if (!image.bytes) panic("texture_array_load: Failed to load image: %s", paths[i]);
 
-        if (i > 0 and (local_width != width or local_height != height or local_channels != channels))
+        if (image.width != width or image.height != height or image.channels != channels)
             panic(
                 "All images in TextureArray must have the same size and channels count. "
                 "Bad image id: %d. Total WHC: %d %d %d. Image WHC: %d %d %d",
-                i, width, height, channels, local_width, local_height, local_channels
+                i, width, height, channels, image.width, image.height, image.channels
             );
-
-        width = local_width;
-        height = local_height;
-        channels = local_channels;
-
-        vec_StbImage_push(&images, (StbImage) {data});
     }
 
 
@@ -1,113 +1,489 @@
+#ifdef __linux__
+// mremap and MAP_ANONYMOUS
+#define _GNU_SOURCE
+#endif
+
 #include "allocator.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "prettify_c.h"
 
-#undef VECTOR_MALLOC_FN
-#undef VECTOR_FREE_FN
-#undef VECTOR_REALLOC_FN
-#define VECTOR_C MemRegion
-#include "vector.h"
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
-// static vec_MemRegion regions = {.data = null, .capacity = 0, .length = 0};
+#define ARENA_ALIGN 16
+#define FRAME_ARENA_CHUNK_SIZE (64 * 1024)
 
-void my_allocator_free() {
-  return;
+struct ArenaChunk {
+  ArenaChunk* next;
+  size_t capacity;
+  size_t used;
+  _Alignas(ARENA_ALIGN) unsigned char data[];
+};
 
-  /*
-    for (int i = 0; i < regions.length; i++) {
-      debugln("Non freed allocation at %p for %d bytes. Freeing forcibly...",
-              regions.data[i].ptr, (int)regions.data[i].size);
-      free(regions.data[i].ptr);
-    }
-    vec_MemRegion_free(regions);
-    regions = vec_MemRegion_create();
-  */
+#ifndef NDEBUG
+#include <stdatomic.h>
+// Job workers and the logger thread allocate too, only the count matters
+static atomic_long HeapAllocs = 0;
+static long LastFrameHeapAllocs = 0;
+#define COUNT_HEAP_ALLOC() atomic_fetch_add_explicit(&HeapAllocs, 1, memory_order_relaxed)
+#else
+#define COUNT_HEAP_ALLOC()
+#endif
+
+#ifdef ALLOC_TRACKING
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define ALLOC_MAGIC 0xA110CA7Eu
+#define DUMP_MAX_BLOCKS 64
+
+typedef struct AllocHeader {
+  size_t size;
+  uint32_t tag;
+  uint32_t magic;
+#if ALLOC_TRACKING >= 2
+  struct AllocHeader *prev, *next;
+#endif
+} AllocHeader;
+
+// Keeps user memory aligned the way malloc aligns it
+#define HEADER_SIZE ((sizeof(AllocHeader) + 15) / 16 * 16)
+#define HEADER_OF(mem) ((AllocHeader*)((char*)(mem)-HEADER_SIZE))
+#define MEMORY_OF(header) ((void*)((char*)(header) + HEADER_SIZE))
+
+typedef struct AtomicStats {
+  atomic_size_t live_bytes, peak_bytes;
+  atomic_long allocs, frees;
+} AtomicStats;
+
+// Last one holds the totals
+static AtomicStats Stats[ALLOC_TAG_COUNT + 1];
+
+#if ALLOC_TRACKING >= 2
+static AllocHeader* LiveBlocks = null;
+static pthread_mutex_t LiveBlocksLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#endif
+
+static _Thread_local AllocTag CurrentTag = ALLOC_TAG_OTHER;
+
+static const char* const TAG_NAMES[ALLOC_TAG_COUNT + 1] = {
+    "other", "parser", "mesh", "texture", "ui", "total",
+};
+
+AllocTag alloc_tag_set(AllocTag tag) {
+  AllocTag old = CurrentTag;
+  CurrentTag = tag;
+  return old;
+}
+
+AllocTag alloc_tag_get() { return CurrentTag; }
+
+const char* alloc_tag_name(AllocTag tag) { return TAG_NAMES[tag]; }
+
+#ifdef ALLOC_TRACKING
+static void stats_add(AtomicStats* stats, size_t size) {
+  size_t live = atomic_fetch_add_explicit(&stats->live_bytes, size,
+                                          memory_order_relaxed) + size;
+  size_t peak = atomic_load_explicit(&stats->peak_bytes, memory_order_relaxed);
+  while (live > peak and not atomic_compare_exchange_weak_explicit(
+                             &stats->peak_bytes, &peak, live,
+                             memory_order_relaxed, memory_order_relaxed)) {
+  }
+}
+
+static void stats_sub(AtomicStats* stats, size_t size) {
+  atomic_fetch_sub_explicit(&stats->live_bytes, size, memory_order_relaxed);
+}
+
+static void track_alloc(AllocHeader* header) {
+  stats_add(&Stats[header->tag], header->size);
+  stats_add(&Stats[ALLOC_TAG_COUNT], header->size);
+  atomic_fetch_add_explicit(&Stats[header->tag].allocs, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&Stats[ALLOC_TAG_COUNT].allocs, 1,
+                            memory_order_relaxed);
+
+#if ALLOC_TRACKING >= 2
+  pthread_mutex_lock(&LiveBlocksLock);
+  header->prev = null;
+  header->next = LiveBlocks;
+  if (LiveBlocks) LiveBlocks->prev = header;
+  LiveBlocks = header;
+  pthread_mutex_unlock(&LiveBlocksLock);
+#endif
 }
 
+static void track_free(AllocHeader* header) {
+  if (header->magic is_not ALLOC_MAGIC)
+    panic("FREE of %p which was not allocated by MALLOC", MEMORY_OF(header));
+
+  stats_sub(&Stats[header->tag], header->size);
+  stats_sub(&Stats[ALLOC_TAG_COUNT], header->size);
+  atomic_fetch_add_explicit(&Stats[header->tag].frees, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&Stats[ALLOC_TAG_COUNT].frees, 1,
+                            memory_order_relaxed);
+
+#if ALLOC_TRACKING >= 2
+  pthread_mutex_lock(&LiveBlocksLock);
+  if (header->prev)
+    header->prev->next = header->next;
+  else
+    LiveBlocks = header->next;
+  if (header->next) header->next->prev = header->prev;
+  pthread_mutex_unlock(&LiveBlocksLock);
+#endif
+}
+#endif
+
 void* my_malloc(size_t size) {
-  return malloc(size);
+  COUNT_HEAP_ALLOC();
+#ifdef ALLOC_TRACKING
+  AllocHeader* header = (AllocHeader*)malloc(HEADER_SIZE + size);
+  if (header is null) return null;
 
-  /*
-    MemRegion r = {
-        .ptr = malloc(size),
-        .size = size,
-    };
-    vec_MemRegion_push(&regions, r);
-    // debugln("Alloc for %ld at %p", (long)r.size, r.ptr);
-    return r.ptr;
-  */
+  header->size = size;
+  header->tag = CurrentTag;
+  header->magic = ALLOC_MAGIC;
+  track_alloc(header);
+  return MEMORY_OF(header);
+#else
+  return malloc(size);
+#endif
 }
 
 void* my_realloc(void* mem, size_t size) {
+#ifdef ALLOC_TRACKING
+  if (mem is null) return my_malloc(size);
+  COUNT_HEAP_ALLOC();
+
+  // Untracked while it may move, the tag stays the same
+  AllocHeader* header = HEADER_OF(mem);
+  track_free(header);
+  AllocHeader* moved = (AllocHeader*)realloc(header, HEADER_SIZE + size);
+  if (moved is null) {
+    track_alloc(header);
+    return null;
+  }
+
+  moved->size = size;
+  track_alloc(moved);
+  return MEMORY_OF(moved);
+#else
+  COUNT_HEAP_ALLOC();
   return realloc(mem, size);
+#endif
+}
+
+void my_free(void* mem) {
+  if (mem is null) return;
+#ifdef ALLOC_TRACKING
+  AllocHeader* header = HEADER_OF(mem);
+  track_free(header);
+  header->magic = 0;
+  free(header);
+#else
+  free(mem);
+#endif
+}
+
+AllocStats my_allocator_stats(AllocTag tag) {
+#ifdef ALLOC_TRACKING
+  const AtomicStats* stats = &Stats[tag];
+  return (AllocStats){
+      .live_bytes = atomic_load_explicit(&stats->live_bytes, memory_order_relaxed),
+      .peak_bytes = atomic_load_explicit(&stats->peak_bytes, memory_order_relaxed),
+      .allocs = atomic_load_explicit(&stats->allocs, memory_order_relaxed),
+      .frees = atomic_load_explicit(&stats->frees, memory_order_relaxed),
+  };
+#else
+  unused(tag);
+  return (AllocStats){0};
+#endif
+}
+
+void my_allocator_dump_short() {
+#ifdef ALLOC_TRACKING
+  printf("%-8s %14s %14s %12s %12s\n", "tag", "live MB", "peak MB", "allocs",
+         "frees");
+  for (int tag = 0; tag <= ALLOC_TAG_COUNT; tag++) {
+    AllocStats stats = my_allocator_stats(tag);
+    printf("%-8s %14.3f %14.3f %12ld %12ld\n", TAG_NAMES[tag],
+           stats.live_bytes / 1048576.0, stats.peak_bytes / 1048576.0,
+           stats.allocs, stats.frees);
+  }
+#else
+  debugln("Allocation tracking is off, build with ALLOC_TRACKING=1 to get it");
+#endif
+}
+
+void my_allocator_dump() {
+#if defined(ALLOC_TRACKING) && ALLOC_TRACKING >= 2
+  pthread_mutex_lock(&LiveBlocksLock);
+  int count = 0;
+  for (AllocHeader* h = LiveBlocks; h is_not null; h = h->next, count++)
+    if (count < DUMP_MAX_BLOCKS)
+      printf("%p | %8zu bytes | %s\n", MEMORY_OF(h), h->size, TAG_NAMES[h->tag]);
+  pthread_mutex_unlock(&LiveBlocksLock);
+
+  if (count > DUMP_MAX_BLOCKS)
+    printf("... and %d more live blocks\n", count - DUMP_MAX_BLOCKS);
+#else
+  debugln("Listing live blocks needs ALLOC_TRACKING=2");
+#endif
+}
+
+void my_allocator_free() {
+#if defined(ALLOC_TRACKING) && ALLOC_TRACKING >= 2
+  AllocStats total = my_allocator_stats(ALLOC_TAG_COUNT);
+  if (total.allocs is_not total.frees) {
+    debugln("%ld blocks (%ld bytes) were never freed:",
+            total.allocs - total.frees, (long)total.live_bytes);
+    my_allocator_dump();
+  }
+#endif
+}
+
+#ifdef __linux__
+// Precedes every huge block. size is the usable size: what was asked for when
+// the block came from my_malloc, the whole mapping minus the header otherwise
+typedef struct HugeHeader {
+  size_t size;
+  uint16_t is_mapped;
+  uint16_t tag;
+  uint32_t magic;
+} HugeHeader;
+
+#define HUGE_MAGIC 0x4B16B10Cu
+#define HUGE_HEADER_OF(mem) ((HugeHeader*)(mem)-1)
+#define HUGE_MAPPED_LEN(header) (sizeof(HugeHeader) + (header)->size)
+
+static size_t page_round(size_t size) {
+  static size_t page_size = 0;
+  if (page_size is 0) page_size = (size_t)sysconf(_SC_PAGESIZE);
+  return (size + page_size - 1) / page_size * page_size;
+}
 
-  /*
-    if (mem) {
-      for (int i = 0; i < regions.length; i++) {
-        if (regions.data[i].ptr == mem) {
-          void* new_mem = realloc(mem, size);
-          // debugln("Realloc %p with %ld bytes into %p with %ld bytes",
-          // regions.data[i].ptr, (long)regions.data[i].size, new_mem,
-          // (long)size);
-          regions.data[i].ptr = new_mem;
-          regions.data[i].size = size;
-          return new_mem;
-        }
-      }
-
-      panic("Unknown realloc pointer: %p", mem);
+static void huge_track(const HugeHeader* header, bool add) {
+#ifdef ALLOC_TRACKING
+  AtomicStats* stats[] = {&Stats[header->tag], &Stats[ALLOC_TAG_COUNT]};
+  for (int i = 0; i < 2; i++) {
+    if (add) {
+      stats_add(stats[i], HUGE_MAPPED_LEN(header));
+      atomic_fetch_add_explicit(&stats[i]->allocs, 1, memory_order_relaxed);
     } else {
-      return my_malloc(size);
+      stats_sub(stats[i], HUGE_MAPPED_LEN(header));
+      atomic_fetch_add_explicit(&stats[i]->frees, 1, memory_order_relaxed);
     }
-  */
+  }
+#else
+  unused(header);
+  unused(add);
+#endif
 }
-void my_free(void* mem) {
-  return free(mem);
-
-  /*
-    if (not mem) return;
-
-    for (int i = 0; i < regions.length; i++) {
-      if (regions.data[i].ptr == mem) {
-        // debugln("Free of %p", mem);
-        free(mem);
-        vec_MemRegion_delete_fast(&regions, i);
-        return;
-      }
+
+static void huge_advise(HugeHeader* header) {
+  // Only a hint, fails harmlessly when THP is disabled
+  if (HUGE_MAPPED_LEN(header) >= HUGE_ALLOC_THP_MIN)
+    madvise(header, HUGE_MAPPED_LEN(header), MADV_HUGEPAGE);
+}
+
+static HugeHeader* huge_map(size_t size) {
+  size_t mapped = page_round(sizeof(HugeHeader) + size);
+  HugeHeader* header = (HugeHeader*)mmap(null, mapped, PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (header is MAP_FAILED) return null;
+
+  COUNT_HEAP_ALLOC();
+  *header = (HugeHeader){
+      .size = mapped - sizeof(HugeHeader),
+      .is_mapped = true,
+      .tag = CurrentTag,
+      .magic = HUGE_MAGIC,
+  };
+  huge_advise(header);
+  huge_track(header, true);
+  return header;
+}
+
+static HugeHeader* huge_header_checked(void* mem, const char* fn) {
+  HugeHeader* header = HUGE_HEADER_OF(mem);
+  if (header->magic is_not HUGE_MAGIC)
+    panic("%s of %p which was not allocated by huge_malloc", fn, mem);
+  return header;
+}
+
+void* huge_malloc(size_t size) {
+  HugeHeader* header;
+  if (sizeof(HugeHeader) + size >= HUGE_ALLOC_MAP_MIN) {
+    header = huge_map(size);
+  } else {
+    header = (HugeHeader*)my_malloc(sizeof(HugeHeader) + size);
+    if (header)
+      *header = (HugeHeader){.size = size, .is_mapped = false, .magic = HUGE_MAGIC};
+  }
+  return header ? header + 1 : null;
+}
+
+void* huge_realloc(void* mem, size_t size) {
+  if (mem is null) return huge_malloc(size);
+  HugeHeader* header = huge_header_checked(mem, "huge_realloc");
+
+  if (not header->is_mapped) {
+    if (sizeof(HugeHeader) + size < HUGE_ALLOC_MAP_MIN) {
+      header = (HugeHeader*)my_realloc(header, sizeof(HugeHeader) + size);
+      if (header is null) return null;
+      header->size = size;
+      return header + 1;
     }
 
-    debugln("Unknown free pointer: %p", mem);
-    free(mem);
-  */
+    // The one copy a huge block ever makes, of less than HUGE_ALLOC_MAP_MIN
+    HugeHeader* mapped = huge_map(size);
+    if (mapped is null) return null;
+    memcpy(mapped + 1, mem, header->size);
+    header->magic = 0;
+    my_free(header);
+    return mapped + 1;
+  }
+
+  size_t old_len = HUGE_MAPPED_LEN(header);
+  size_t new_len = page_round(sizeof(HugeHeader) + size);
+  if (new_len is old_len) return mem;
+
+  huge_track(header, false);
+  HugeHeader* moved =
+      (HugeHeader*)mremap(header, old_len, new_len, MREMAP_MAYMOVE);
+  if (moved is MAP_FAILED) {
+    huge_track(header, true);
+    return null;
+  }
+
+  COUNT_HEAP_ALLOC();
+  moved->size = new_len - sizeof(HugeHeader);
+  huge_advise(moved);
+  huge_track(moved, true);
+  return moved + 1;
 }
 
-void my_allocator_dump() {
-  return;
+void huge_free(void* mem) {
+  if (mem is null) return;
+  HugeHeader* header = huge_header_checked(mem, "huge_free");
+  header->magic = 0;
 
-  /*
-    debugln("Allocator has %d active memory regions (cap %d):", regions.length,
-            regions.capacity);
+  if (header->is_mapped) {
+    huge_track(header, false);
+    munmap(header, HUGE_MAPPED_LEN(header));
+  } else {
+    my_free(header);
+  }
+}
+#else
+void* huge_malloc(size_t size) { return my_malloc(size); }
+void* huge_realloc(void* mem, size_t size) { return my_realloc(mem, size); }
+void huge_free(void* mem) { my_free(mem); }
+#endif
+
+static size_t arena_align(size_t size) {
+  return (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+static ArenaChunk* arena_chunk_create(size_t capacity, ArenaChunk* next) {
+  ArenaChunk* chunk = (ArenaChunk*)my_malloc(sizeof(ArenaChunk) + capacity);
+  assert_alloc(chunk);
+  chunk->next = next;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  return chunk;
+}
+
+Arena arena_create(size_t chunk_size) {
+  return (Arena){
+      .chunks = null,
+      .chunk_size = arena_align(chunk_size),
+  };
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+  size = arena_align(size);
+  ArenaChunk* chunk = arena->chunks;
+
+  if (chunk is null or chunk->used + size > chunk->capacity) {
+    size_t capacity = size > arena->chunk_size ? size : arena->chunk_size;
+    chunk = arena_chunk_create(capacity, chunk);
+    arena->chunks = chunk;
+  }
+
+  void* result = chunk->data + chunk->used;
+  chunk->used += size;
+  return result;
+}
 
-    for (int i = 0; i < regions.length; i++) {
-      debugc("Ptr: %p | Size: %d\n", regions.data[i].ptr,
-             (int)regions.data[i].size);
+void* arena_realloc(Arena* arena, void* mem, size_t old_size, size_t new_size) {
+  if (mem is null) return arena_alloc(arena, new_size);
+
+  ArenaChunk* chunk = arena->chunks;
+  old_size = arena_align(old_size);
+  new_size = arena_align(new_size);
+  bool is_last = (unsigned char*)mem + old_size is chunk->data + chunk->used;
+
+  void* result = mem;
+  if (is_last and chunk->used - old_size + new_size <= chunk->capacity) {
+    chunk->used = chunk->used - old_size + new_size;
+  } else if (new_size > old_size) {
+    result = arena_alloc(arena, new_size);
+    memcpy(result, mem, old_size);
+  }
+  return result;
+}
+
+void arena_reset(Arena* arena) {
+  ArenaChunk* chunk = arena->chunks;
+  if (chunk is null) return;
+
+  if (chunk->next is_not null) {
+    size_t total = 0;
+    while (chunk is_not null) {
+      ArenaChunk* next = chunk->next;
+      total += chunk->capacity;
+      my_free(chunk);
+      chunk = next;
     }
+    arena->chunks = arena_chunk_create(total, null);
+  }
 
-    debugln("Allocator dump done");
-  */
+  arena->chunks->used = 0;
 }
 
-void my_allocator_dump_short() {
-  return;
-  /*
-    size_t sum_size = 0;
+void arena_free(Arena arena) {
+  ArenaChunk* chunk = arena.chunks;
+  while (chunk is_not null) {
+    ArenaChunk* next = chunk->next;
+    my_free(chunk);
+    chunk = next;
+  }
+}
+
+static Arena FrameArena = {.chunks = null, .chunk_size = FRAME_ARENA_CHUNK_SIZE};
 
-    for (int i = 0; i < regions.length; i++) sum_size += regions.data[i].size;
+Arena* frame_arena() { return &FrameArena; }
 
-    debugln(
-        "Allocator has %d(/%d) active memory regions for the total size of %ld",
-        regions.length, regions.capacity, (long)sum_size);
-  */
-}
\ No newline at end of file
+void frame_arena_reset() {
+  arena_reset(&FrameArena);
+#ifndef NDEBUG
+  LastFrameHeapAllocs = atomic_exchange_explicit(&HeapAllocs, 0, memory_order_relaxed);
+#endif
+}
+
+long my_allocator_frame_allocs() {
+#ifndef NDEBUG
+  return LastFrameHeapAllocs;
+#else
+  return -1;
+#endif
+}
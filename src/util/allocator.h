@@ -4,31 +4,106 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-typedef struct MemRegion {
-  void* ptr;
-  size_t size;
-} MemRegion;
-
-#define VECTOR_H MemRegion
-#include "vector.h"
-
 #undef VECTOR_MALLOC_FN
 #undef VECTOR_REALLOC_FN
 #undef VECTOR_FREE_FN
+#undef HASHMAP_MALLOC_FN
+#undef HASHMAP_FREE_FN
+
+/**
+ * Allocation tracking is chosen at compile time with ALLOC_TRACKING:
+ *   undefined - MALLOC, REALLOC and FREE go straight to the libc
+ *   1 - every block gets a 16 byte header with its size and tag, and per-tag
+ *       counters are updated with relaxed atomics. Cheap enough to leave on.
+ *   2 - headers are also linked into a list of live blocks, so
+ *       my_allocator_dump can list them. Takes a lock per call.
+ * Memory from MALLOC and REALLOC must be released with FREE.
+ */
+
+// Which subsystem an allocation belongs to
+typedef enum AllocTag {
+  ALLOC_TAG_OTHER,
+  ALLOC_TAG_PARSER,
+  ALLOC_TAG_MESH,
+  ALLOC_TAG_TEXTURE,
+  ALLOC_TAG_UI,
+  ALLOC_TAG_COUNT,
+} AllocTag;
+
+typedef struct AllocStats {
+  size_t live_bytes, peak_bytes;
+  long allocs, frees;
+} AllocStats;
 
 void* my_malloc(size_t size);
 void* my_realloc(void* mem, size_t size);
 void my_free(void* mem);
 
+// Sets the tag of this thread's following allocations, returns the old one
+// so the caller can put it back
+AllocTag alloc_tag_set(AllocTag tag);
+// The tag of this thread's following allocations
+AllocTag alloc_tag_get();
+const char* alloc_tag_name(AllocTag tag);
+// ALLOC_TAG_COUNT gives the totals. All zeros without ALLOC_TRACKING
+AllocStats my_allocator_stats(AllocTag tag);
+
+// Lists live blocks, needs ALLOC_TRACKING=2
 void my_allocator_dump();
+// Reports blocks that are still alive at exit, needs ALLOC_TRACKING=2
 void my_allocator_free();
+// Live and peak bytes and counts per tag
 void my_allocator_dump_short();
 
+// Allocator for arrays that may grow to gigabytes, like model vertices and
+// indices. Small blocks come from MALLOC. Once a block reaches
+// HUGE_ALLOC_MAP_MIN it is moved to its own anonymous mapping, and from then on
+// huge_realloc grows it with mremap, which moves page table entries instead of
+// copying, so growth never holds two copies of the data. Mappings from
+// HUGE_ALLOC_THP_MIN up are advised to use transparent huge pages. Off Linux
+// these are plain MALLOC, REALLOC and FREE. Memory from huge_malloc and
+// huge_realloc must be released with huge_free.
+#define HUGE_ALLOC_MAP_MIN (1 << 20)
+#define HUGE_ALLOC_THP_MIN (2 << 20)
+
+void* huge_malloc(size_t size);
+void* huge_realloc(void* mem, size_t size);
+void huge_free(void* mem);
+
+// Linear allocator for short-lived data: allocation is a pointer bump, and
+// nothing is freed until arena_reset releases everything at once
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct Arena {
+  ArenaChunk* chunks;  // newest first, only the newest one is allocated from
+  size_t chunk_size;
+} Arena;
+
+Arena arena_create(size_t chunk_size);
+void* arena_alloc(Arena* arena, size_t size);
+// Grows the latest allocation in place when it fits, otherwise copies it
+void* arena_realloc(Arena* arena, void* mem, size_t old_size, size_t new_size);
+// If the arena overflowed into several chunks they are merged into one, so
+// after a couple of resets the same workload needs no heap allocations
+void arena_reset(Arena* arena);
+void arena_free(Arena arena);
+
+// Arena for data that lives until the end of the current frame
+Arena* frame_arena();
+// Called at the top of every frame
+void frame_arena_reset();
+
+// Heap allocations made by MALLOC, REALLOC and arenas during the previous
+// frame. Counted only in debug builds (without NDEBUG), otherwise -1
+long my_allocator_frame_allocs();
+
 #define MALLOC my_malloc
 #define REALLOC my_realloc
 #define FREE my_free
 #define VECTOR_MALLOC_FN my_malloc
 #define VECTOR_REALLOC_FN my_realloc
 #define VECTOR_FREE_FN my_free
+#define HASHMAP_MALLOC_FN my_malloc
+#define HASHMAP_FREE_FN my_free
 
 #endif  // SRC_UTIL_ALLOCATOR_H_
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "fmt_number.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "../prettify_c.h"
+
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+int fmt_u64(char* out, uint64_t value) {
+  char digits[20];
+  char* p = digits + sizeof(digits);
+
+  while (value >= 100) {
+    unsigned pair = (unsigned)(value % 100);
+    value /= 100;
+    p -= 2;
+    memcpy(p, DIGIT_PAIRS + pair * 2, 2);
+  }
+  if (value >= 10) {
+    p -= 2;
+    memcpy(p, DIGIT_PAIRS + value * 2, 2);
+  } else {
+    *--p = (char)('0' + value);
+  }
+
+  int length = (int)(digits + sizeof(digits) - p);
+  memcpy(out, p, length);
+  return length;
+}
+
+int fmt_i64(char* out, int64_t value) {
+  if (value >= 0) return fmt_u64(out, (uint64_t)value);
+  out[0] = '-';
+  return 1 + fmt_u64(out + 1, 0 - (uint64_t)value);
+}
+
+// ===== Grisu2, after Florian Loitsch, "Printing Floating-Point Numbers
+// Quickly and Accurately with Integers", 2010
+
+// f * 2^e
+typedef struct DiyFp {
+  uint64_t f;
+  int e;
+} DiyFp;
+
+static DiyFp diy_mul(DiyFp x, DiyFp y) {
+  const uint64_t mask = 0xFFFFFFFFu;
+  uint64_t a = x.f >> 32, b = x.f & mask, c = y.f >> 32, d = y.f & mask;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t middle = (bd >> 32) + (ad & mask) + (bc & mask);
+  middle += 1u << 31;  // rounds the dropped low half
+  return (DiyFp){ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64};
+}
+
+static DiyFp diy_normalize(DiyFp x) {
+  int shift = __builtin_clzll(x.f);
+  return (DiyFp){x.f << shift, x.e - shift};
+}
+
+// Normalized 10^k for k = -348, -340, ..., 340
+static const DiyFp CACHED_POWERS[] = {
+    {0xfa8fd5a0081c0288ull, -1220}, {0xbaaee17fa23ebf76ull, -1193}, {0x8b16fb203055ac76ull, -1166},
+    {0xcf42894a5dce35eaull, -1140}, {0x9a6bb0aa55653b2dull, -1113}, {0xe61acf033d1a45dfull, -1087},
+    {0xab70fe17c79ac6caull, -1060}, {0xff77b1fcbebcdc4full, -1034}, {0xbe5691ef416bd60cull, -1007},
+    {0x8dd01fad907ffc3cull, -980}, {0xd3515c2831559a83ull, -954}, {0x9d71ac8fada6c9b5ull, -927},
+    {0xea9c227723ee8bcbull, -901}, {0xaecc49914078536dull, -874}, {0x823c12795db6ce57ull, -847},
+    {0xc21094364dfb5637ull, -821}, {0x9096ea6f3848984full, -794}, {0xd77485cb25823ac7ull, -768},
+    {0xa086cfcd97bf97f4ull, -741}, {0xef340a98172aace5ull, -715}, {0xb23867fb2a35b28eull, -688},
+    {0x84c8d4dfd2c63f3bull, -661}, {0xc5dd44271ad3cdbaull, -635}, {0x936b9fcebb25c996ull, -608},
+    {0xdbac6c247d62a584ull, -582}, {0xa3ab66580d5fdaf6ull, -555}, {0xf3e2f893dec3f126ull, -529},
+    {0xb5b5ada8aaff80b8ull, -502}, {0x87625f056c7c4a8bull, -475}, {0xc9bcff6034c13053ull, -449},
+    {0x964e858c91ba2655ull, -422}, {0xdff9772470297ebdull, -396}, {0xa6dfbd9fb8e5b88full, -369},
+    {0xf8a95fcf88747d94ull, -343}, {0xb94470938fa89bcfull, -316}, {0x8a08f0f8bf0f156bull, -289},
+    {0xcdb02555653131b6ull, -263}, {0x993fe2c6d07b7facull, -236}, {0xe45c10c42a2b3b06ull, -210},
+    {0xaa242499697392d3ull, -183}, {0xfd87b5f28300ca0eull, -157}, {0xbce5086492111aebull, -130},
+    {0x8cbccc096f5088ccull, -103}, {0xd1b71758e219652cull, -77}, {0x9c40000000000000ull, -50},
+    {0xe8d4a51000000000ull, -24}, {0xad78ebc5ac620000ull, 3}, {0x813f3978f8940984ull, 30},
+    {0xc097ce7bc90715b3ull, 56}, {0x8f7e32ce7bea5c70ull, 83}, {0xd5d238a4abe98068ull, 109},
+    {0x9f4f2726179a2245ull, 136}, {0xed63a231d4c4fb27ull, 162}, {0xb0de65388cc8ada8ull, 189},
+    {0x83c7088e1aab65dbull, 216}, {0xc45d1df942711d9aull, 242}, {0x924d692ca61be758ull, 269},
+    {0xda01ee641a708deaull, 295}, {0xa26da3999aef774aull, 322}, {0xf209787bb47d6b85ull, 348},
+    {0xb454e4a179dd1877ull, 375}, {0x865b86925b9bc5c2ull, 402}, {0xc83553c5c8965d3dull, 428},
+    {0x952ab45cfa97a0b3ull, 455}, {0xde469fbd99a05fe3ull, 481}, {0xa59bc234db398c25ull, 508},
+    {0xf6c69a72a3989f5cull, 534}, {0xb7dcbf5354e9beceull, 561}, {0x88fcf317f22241e2ull, 588},
+    {0xcc20ce9bd35c78a5ull, 614}, {0x98165af37b2153dfull, 641}, {0xe2a0b5dc971f303aull, 667},
+    {0xa8d9d1535ce3b396ull, 694}, {0xfb9b7cd9a4a7443cull, 720}, {0xbb764c4ca7a44410ull, 747},
+    {0x8bab8eefb6409c1aull, 774}, {0xd01fef10a657842cull, 800}, {0x9b10a4e5e9913129ull, 827},
+    {0xe7109bfba19c0c9dull, 853}, {0xac2820d9623bf429ull, 880}, {0x80444b5e7aa7cf85ull, 907},
+    {0xbf21e44003acdd2dull, 933}, {0x8e679c2f5e44ff8full, 960}, {0xd433179d9c8cb841ull, 986},
+    {0x9e19db92b4e31ba9ull, 1013}, {0xeb96bf6ebadf77d9ull, 1039}, {0xaf87023b9bf0ee6bull, 1066},
+};
+#define CACHED_POWERS_MIN_EXP10 -348
+#define CACHED_POWERS_STEP 8
+
+// Picks a power that brings e into [-60, -32], returns its decimal exponent
+// negated in k
+static DiyFp cached_power(int e, int* k) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;  // log10(2)
+  int ik = (int)dk;
+  if (dk - ik > 0.0) ik++;
+
+  unsigned index = (unsigned)((ik >> 3) + 1);
+  *k = -(CACHED_POWERS_MIN_EXP10 + (int)index * CACHED_POWERS_STEP);
+  return CACHED_POWERS[index];
+}
+
+static const uint64_t POW10[] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+static int decimal_length32(uint32_t n) {
+  int length = 1;
+  while (length < 10 and n >= POW10[length]) length++;
+  return length;
+}
+
+// Moves the last digit towards w while that stays inside the interval
+static void grisu_round(char* digits, int length, uint64_t delta, uint64_t rest,
+                        uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest < wp_w and delta - rest >= ten_kappa and
+         (rest + ten_kappa < wp_w or wp_w - rest > rest + ten_kappa - wp_w)) {
+    digits[length - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+static int digit_gen(DiyFp w, DiyFp mp, uint64_t delta, char* digits, int* k) {
+  const DiyFp one = {1ull << -mp.e, mp.e};
+  const uint64_t wp_w = mp.f - w.f;
+  uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+  uint64_t p2 = mp.f & (one.f - 1);
+  int kappa = decimal_length32(p1);
+  int length = 0;
+
+  while (kappa > 0) {
+    uint32_t pow = (uint32_t)POW10[kappa - 1];
+    uint32_t d = p1 / pow;
+    p1 %= pow;
+    if (d or length) digits[length++] = (char)('0' + d);
+    kappa--;
+
+    uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      grisu_round(digits, length, delta, rest, POW10[kappa] << -one.e, wp_w);
+      return length;
+    }
+  }
+
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char d = (char)(p2 >> -one.e);
+    if (d or length) digits[length++] = (char)('0' + d);
+    p2 &= one.f - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      grisu_round(digits, length, delta, p2, one.f, wp_w * POW10[-kappa]);
+      return length;
+    }
+  }
+}
+
+// v is significand * 2^exponent with the hidden bit set, the neighbours of v
+// are half an ulp away, or a quarter below when v is a power of two
+static int grisu2(DiyFp v, bool lower_closer, char* digits, int* k) {
+  DiyFp plus = diy_normalize((DiyFp){(v.f << 1) + 1, v.e - 1});
+  DiyFp minus = lower_closer ? (DiyFp){(v.f << 2) - 1, v.e - 2}
+                             : (DiyFp){(v.f << 1) - 1, v.e - 1};
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  DiyFp c_mk = cached_power(plus.e, k);
+  DiyFp w = diy_mul(diy_normalize(v), c_mk);
+  DiyFp wp = diy_mul(plus, c_mk);
+  DiyFp wm = diy_mul(minus, c_mk);
+  // The products are off by up to an ulp, stay inside for sure
+  wm.f++;
+  wp.f--;
+  return digit_gen(w, wp, wp.f - wm.f, digits, k);
+}
+
+static int put_exponent(char* out, int exp10) {
+  int length = 0;
+  out[length++] = 'e';
+  if (exp10 < 0) {
+    out[length++] = '-';
+    exp10 = -exp10;
+  }
+  if (exp10 < 10) out[length++] = '0';  // like printf, at least two digits
+  return length + fmt_u64(out + length, (uint64_t)exp10);
+}
+
+// value = digits * 10^k, placed as plain decimal or with an exponent
+static int place_digits(char* out, const char* digits, int length, int k) {
+  int point = length + k;  // digits before the decimal point
+
+  if (length <= point and point <= 21) {
+    memcpy(out, digits, length);
+    memset(out + length, '0', point - length);
+    return point;
+  }
+  if (0 < point and point <= 21) {
+    memcpy(out, digits, point);
+    out[point] = '.';
+    memcpy(out + point + 1, digits + point, length - point);
+    return length + 1;
+  }
+  if (-6 < point and point <= 0) {
+    out[0] = '0';
+    out[1] = '.';
+    memset(out + 2, '0', -point);
+    memcpy(out + 2 - point, digits, length);
+    return 2 - point + length;
+  }
+
+  int written = 0;
+  out[written++] = digits[0];
+  if (length > 1) {
+    out[written++] = '.';
+    memcpy(out + written, digits + 1, length - 1);
+    written += length - 1;
+  }
+  return written + put_exponent(out + written, point - 1);
+}
+
+static int put_special(char* out, bool negative, bool is_nan, bool is_zero) {
+  int length = 0;
+  if (negative and not is_nan) out[length++] = '-';
+  const char* text = is_nan ? "nan" : is_zero ? "0" : "inf";
+  memcpy(out + length, text, strlen(text));
+  return length + (int)strlen(text);
+}
+
+int fmt_double_shortest(char* out, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bool negative = bits >> 63;
+  int exponent = (int)((bits >> 52) & 0x7FF);
+  uint64_t significand = bits & ((1ull << 52) - 1);
+
+  if (exponent is 0x7FF or (exponent is 0 and significand is 0))
+    return put_special(out, negative, significand is_not 0, exponent is 0);
+
+  DiyFp v = exponent is 0
+                ? (DiyFp){significand, 1 - 1075}
+                : (DiyFp){significand | (1ull << 52), exponent - 1075};
+  bool lower_closer = significand is 0 and exponent > 1;
+
+  char digits[20];
+  int k;
+  int length = grisu2(v, lower_closer, digits, &k);
+  int sign = negative;
+  if (negative) out[0] = '-';
+  return sign + place_digits(out + sign, digits, length, k);
+}
+
+int fmt_float_shortest(char* out, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bool negative = bits >> 31;
+  int exponent = (int)((bits >> 23) & 0xFF);
+  uint32_t significand = bits & ((1u << 23) - 1);
+
+  if (exponent is 0xFF or (exponent is 0 and significand is 0))
+    return put_special(out, negative, significand is_not 0, exponent is 0);
+
+  DiyFp v = exponent is 0 ? (DiyFp){significand, 1 - 150}
+                          : (DiyFp){significand | (1u << 23), exponent - 150};
+  bool lower_closer = significand is 0 and exponent > 1;
+
+  char digits[20];
+  int k;
+  int length = grisu2(v, lower_closer, digits, &k);
+  int sign = negative;
+  if (negative) out[0] = '-';
+  return sign + place_digits(out + sign, digits, length, k);
+}
+
+int fmt_double_fixed(char* out, double value, int precision) {
+#ifdef __SIZEOF_INT128__
+  typedef unsigned __int128 u128;
+  if (precision < 0 or precision > FMT_FIXED_MAX_PRECISION) return -1;
+
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bool negative = bits >> 63;
+  int exponent = (int)((bits >> 52) & 0x7FF);
+  uint64_t significand = bits & ((1ull << 52) - 1);
+  if (exponent is 0x7FF) return -1;
+  if (exponent is_not 0) significand |= 1ull << 52;
+  int e = (exponent is 0 ? 1 : exponent) - 1075;  // value = significand * 2^e
+
+  const uint64_t scale = POW10[precision];
+  uint64_t int_part, frac_part;
+  if (e >= 0) {
+    if (e > 10) return -1;  // may not fit 64 bits
+    int_part = significand << e;
+    frac_part = 0;
+  } else {
+    // value * 10^precision is below 2^83, its rounding is decided exactly by
+    // the bits shifted out
+    u128 scaled = (u128)significand * scale;
+    int shift = -e;
+    u128 q = 0;
+    if (shift < 128) {
+      q = scaled >> shift;
+      u128 rest = scaled - (q << shift);
+      u128 half = (u128)1 << (shift - 1);
+      if (rest > half or (rest == half and (q & 1))) q++;
+    }
+    if (q >> 64) return -1;
+    int_part = (uint64_t)q / scale;
+    frac_part = (uint64_t)q % scale;
+  }
+
+  int length = 0;
+  if (negative) out[length++] = '-';
+  length += fmt_u64(out + length, int_part);
+  if (precision > 0) {
+    out[length++] = '.';
+    char frac[FMT_NUMBER_MAX];
+    int frac_length = fmt_u64(frac, frac_part);
+    memset(out + length, '0', precision - frac_length);
+    memcpy(out + length + precision - frac_length, frac, frac_length);
+    length += precision;
+  }
+  return length;
+#else
+  unused(out);
+  unused(value);
+  unused(precision);
+  return -1;
+#endif
+}
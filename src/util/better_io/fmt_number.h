@@ -0,0 +1,32 @@
+#ifndef SRC_UTIL_FMT_NUMBER_H_
+#define SRC_UTIL_FMT_NUMBER_H_
+
+#include <stdint.h>
+
+/**
+ * Number to text without printf. Integers are written two digits at a time
+ * from a table. Floating point numbers get the shortest digits that read back
+ * to the same value (Grisu2), so 0.1f is "0.1" instead of "0.100000" or
+ * "0.100000001". Exponents from -6 to 20 are written out, others as
+ * 1.5e-07 style. Nothing is NUL-terminated, every function returns the
+ * number of chars written.
+ */
+
+// Enough for any of the functions below
+#define FMT_NUMBER_MAX 32
+
+int fmt_u64(char* out, uint64_t value);
+int fmt_i64(char* out, int64_t value);
+int fmt_double_shortest(char* out, double value);
+// Shortest digits that read back to the same float, fewer than for a double
+int fmt_float_shortest(char* out, float value);
+
+#define FMT_FIXED_MAX_PRECISION 9
+
+// Same text as printf("%.*f", precision, value), rounded exactly like it.
+// Returns -1 when it can not: precision above FMT_FIXED_MAX_PRECISION, nan,
+// inf, |value| * 10^precision that rounds to 2^64 or more (so with any
+// precision |value| of 2^63 and more), or a compiler without 128-bit integers
+int fmt_double_fixed(char* out, double value, int precision);
+
+#endif  // SRC_UTIL_FMT_NUMBER_H_
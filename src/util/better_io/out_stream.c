@@ -1,8 +1,12 @@
 #include "out_stream.h"
 
+#include <errno.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
+#include "../allocator.h"
 #include "../better_string/str_t.h"
 #include "../prettify_c.h"
 
@@ -28,8 +32,7 @@ str_t outstream_description(OutStream this) {
 static int putc_file(FILE* this, int c) { return putc(c, this); }
 static int puts_file(FILE* this, const char* str) { return fputs(str, this); }
 static int put_slice_file(FILE* this, const char* str, size_t length) {
-  fprintf(this, "%.*s", (int)length, str);
-  return '\n';
+  return fwrite(str, 1, length, this) is length ? '\n' : EOF;
 }
 static size_t get_size_vtable(FILE* this) {
   unused(this);
@@ -137,4 +140,81 @@ OutStream outstream_from_buffer(BufferOutStream* b) {
       .description = (void*)description_buf};
 
   return (OutStream){.data = b, .vtable = &BUFFER_VTABLE};
-}
\ No newline at end of file
+}
+
+BufferedOutStream buffered_outstream_create(int fd, size_t capacity) {
+  if (capacity is 0) capacity = BUFFERED_OUTSTREAM_DEFAULT_CAPACITY;
+  char* buffer = (char*)MALLOC(capacity);
+  assert_alloc(buffer);
+  return (BufferedOutStream){
+      .fd = fd, .buffer = buffer, .length = 0, .capacity = capacity};
+}
+
+static void write_all(BufferedOutStream* this, const char* data,
+                      size_t length) {
+  while (length > 0 and not this->failed) {
+    ssize_t written = write(this->fd, data, length);
+    if (written < 0) {
+      if (errno is EINTR) continue;
+      this->failed = true;
+    } else {
+      data += written;
+      length -= (size_t)written;
+    }
+  }
+}
+
+bool buffered_outstream_flush(BufferedOutStream* this) {
+  write_all(this, this->buffer, this->length);
+  this->length = 0;
+  return not this->failed;
+}
+
+bool buffered_outstream_free(BufferedOutStream* this) {
+  bool ok = buffered_outstream_flush(this);
+  FREE(this->buffer);
+  *this = (BufferedOutStream){.fd = this->fd, .failed = this->failed};
+  return ok;
+}
+
+static int put_slice_buffered(BufferedOutStream* this, const char* str,
+                              size_t length) {
+  if (length > this->capacity - this->length) {
+    buffered_outstream_flush(this);
+    // Would not fit anyway, skips the copy
+    if (length >= this->capacity) {
+      write_all(this, str, length);
+      return this->failed ? EOF : '\n';
+    }
+  }
+  memcpy(this->buffer + this->length, str, length);
+  this->length += length;
+  return this->failed ? EOF : '\n';
+}
+static int putc_buffered(BufferedOutStream* this, int c) {
+  if (this->length is this->capacity) buffered_outstream_flush(this);
+  this->buffer[this->length++] = (char)c;
+  return this->failed ? EOF : c;
+}
+static int puts_buffered(BufferedOutStream* this, const char* str) {
+  return put_slice_buffered(this, str, strlen(str));
+}
+static size_t get_size_buffered(BufferedOutStream* this) {
+  unused(this);
+  return SIZE_MAX;
+}
+static str_t description_buffered(BufferedOutStream* this) {
+  unused(this);
+  return str_literal("BufferedOutStream");
+}
+
+OutStream outstream_from_buffered(BufferedOutStream* b) {
+  static const OutStreamVtable BUFFERED_VTABLE = {
+      .putc = (void*)putc_buffered,
+      .puts = (void*)puts_buffered,
+      .put_slice = (void*)put_slice_buffered,
+      .get_available_size = (void*)get_size_buffered,
+      .description = (void*)description_buffered};
+
+  return (OutStream){.data = b, .vtable = &BUFFERED_VTABLE};
+}
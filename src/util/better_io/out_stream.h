@@ -2,6 +2,7 @@
 #define SRC_UTIL_OUT_STREAM_H_
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -43,4 +44,22 @@ typedef struct BufferOutStream {
 } BufferOutStream;
 OutStream outstream_from_buffer(BufferOutStream* b);
 
+#define BUFFERED_OUTSTREAM_DEFAULT_CAPACITY (1 << 20)
+
+// Collects output in memory and passes it to the file descriptor in large
+// write() calls, instead of a stdio call per piece of every format
+typedef struct BufferedOutStream {
+  int fd;
+  char* buffer;
+  size_t length, capacity;
+  bool failed;  // a write failed, everything after it is dropped
+} BufferedOutStream;
+// capacity 0 means BUFFERED_OUTSTREAM_DEFAULT_CAPACITY
+BufferedOutStream buffered_outstream_create(int fd, size_t capacity);
+OutStream outstream_from_buffered(BufferedOutStream* b);
+// Returns false if any write so far failed
+bool buffered_outstream_flush(BufferedOutStream* b);
+// Flushes and frees the buffer, the descriptor stays open
+bool buffered_outstream_free(BufferedOutStream* b);
+
 #endif  // SRC_UTIL_OUT_STREAM_H_
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include "../better_string.h"
 #include "../prettify_c.h"
+#include "fmt_number.h"
 
 void x_printf(const char* format, ...) {
   va_list list;
@@ -67,6 +68,7 @@ typedef struct Specificator {
   const char* length_mod;
   int symbols_count;
   bool flag_minus, flag_plus, flag_space, flag_zero, flag_hash;
+  bool has_precision;  // precision is 0 without one, %f means %.6f then
 } Specificator;
 
 static Specificator parse_specificator(const char* str);
@@ -80,14 +82,73 @@ static void put_bool_fmt(OutStream stream, Specificator spec,
                          const char* format, VaListWrap* list,
                          int* total_written);
 
-#define BUFFER_SIZE 1024 * 64
-#define FORMAT_BUF_SIZE 2048
+// Most formats fit, longer output is allocated
+#define BUFFER_SIZE 512
+#define FORMAT_BUF_SIZE 64
 #define MIN(a, b) ((a) < (b)) ? (a) : (b)
+
+static bool has_no_flags(Specificator info) {
+  return info.width is 0 and not info.flag_minus and not info.flag_plus and
+         not info.flag_space and not info.flag_zero and not info.flag_hash;
+}
+
+// Plain %d, %i and %u with an optional l or ll, no flags, width or precision
+static bool is_plain_integer(Specificator info) {
+  return (info.type is 'd' or info.type is 'i' or info.type is 'u') and
+         has_no_flags(info) and not info.has_precision and
+         (info.length_mod[0] is '\0' or strcmp(info.length_mod, "l") is 0 or
+          strcmp(info.length_mod, "ll") is 0);
+}
+
+static void put_plain_integer(OutStream stream, Specificator info,
+                              VaListWrap* list, int* total_written) {
+  char digits[FMT_NUMBER_MAX];
+  int length;
+  bool is_long = info.length_mod[0] is 'l' and info.length_mod[1] is '\0';
+  bool is_long_long = info.length_mod[0] is 'l' and info.length_mod[1] is 'l';
+
+  if (info.type is 'u') {
+    unsigned long long value =
+        is_long_long ? va_arg(list->list, unsigned long long)
+        : is_long    ? va_arg(list->list, unsigned long)
+                     : va_arg(list->list, unsigned);
+    length = fmt_u64(digits, value);
+  } else {
+    long long value = is_long_long ? va_arg(list->list, long long)
+                      : is_long    ? va_arg(list->list, long)
+                                   : va_arg(list->list, int);
+    length = fmt_i64(digits, value);
+  }
+
+  outstream_put_slice(digits, length, stream);
+  (*total_written) += length;
+}
+
+// %f and %.Nf without flags or width, printed without snprintf
+static bool is_plain_fixed(Specificator info) {
+  return has_no_flags(info) and info.precision <= FMT_FIXED_MAX_PRECISION;
+}
+
+// snprintf into buffer, or into a malloc'ed string when it does not fit, like
+// %.300f of a large double
+static char* format_arg(char buffer[BUFFER_SIZE], const char* format, ...) {
+  va_list args, args_copy;
+  va_start(args, format);
+  va_copy(args_copy, args);
+  char* output = buffer;
+  int length = vsnprintf(buffer, BUFFER_SIZE, format, args);
+  if (length >= BUFFER_SIZE) {
+    output = (char*)malloc(length + 1);
+    assert_alloc(output);
+    vsnprintf(output, length + 1, format, args_copy);
+  }
+  va_end(args_copy);
+  va_end(args);
+  return output;
+}
+
 static const char* put_format(OutStream stream, const char* format,
                               VaListWrap* list, int* total_written) {
-  unused(stream);
-  unused(format);
-  unused(list);
   Specificator info = parse_specificator(format + 1);
 
   if (info.type is 's') {
@@ -102,29 +163,41 @@ static const char* put_format(OutStream stream, const char* format,
     return format + 1;
   } else if (info.type is 0) {
     return format + 1;
+  } else if (is_plain_integer(info)) {
+    put_plain_integer(stream, info, list, total_written);
   } else {
-    char buffer[BUFFER_SIZE] = {'\0'};
-    assert_m(info.symbols_count <
-             (FORMAT_BUF_SIZE - 1)) char format_buf[BUFFER_SIZE] = {'\0'};
-    strncpy(format_buf, format, info.symbols_count + 1);
+    // Not zero-filled, snprintf terminates the string
+    char buffer[BUFFER_SIZE];
+    char* output = buffer;
+    assert_m(info.symbols_count < (FORMAT_BUF_SIZE - 1));
+    char format_buf[FORMAT_BUF_SIZE];
+    memcpy(format_buf, format, info.symbols_count + 1);
+    format_buf[info.symbols_count + 1] = '\0';
 
     if (info.type is 'f') {
-      if (strcmp(info.length_mod, "l") is 0 or strcmp(info.length_mod, "") is 0)
-        sprintf(buffer, format_buf, va_arg(list->list, double));
-      else
+      if (strcmp(info.length_mod, "l") is 0 or strcmp(info.length_mod, "") is 0) {
+        double value = va_arg(list->list, double);
+        int length = is_plain_fixed(info)
+                         ? fmt_double_fixed(buffer, value,
+                                            info.has_precision ? info.precision : 6)
+                         : -1;
+        if (length >= 0)
+          buffer[length] = '\0';
+        else
+          output = format_arg(buffer, format_buf, value);
+      } else
         panic("Unsupported format: %%%s%c", info.length_mod, info.type);
     } else if (info.type is 'c') {
-      sprintf(buffer, format_buf, va_arg(list->list, int));
+      output = format_arg(buffer, format_buf, va_arg(list->list, int));
     } else if (info.type is 'p') {
-      void* ptr = va_arg(list->list, void*);
-      sprintf(buffer, format_buf, ptr);
+      output = format_arg(buffer, format_buf, va_arg(list->list, void*));
     } else if (info.type is 'd' or info.type is 'i' or info.type is 'u') {
       if (strcmp(info.length_mod, "l") is 0)
-        sprintf(buffer, format_buf, va_arg(list->list, long));
+        output = format_arg(buffer, format_buf, va_arg(list->list, long));
       else if (strcmp(info.length_mod, "ll") is 0)
-        sprintf(buffer, format_buf, va_arg(list->list, long long));
+        output = format_arg(buffer, format_buf, va_arg(list->list, long long));
       else if (strcmp(info.length_mod, "") is 0) {
-        sprintf(buffer, format_buf, va_arg(list->list, int));
+        output = format_arg(buffer, format_buf, va_arg(list->list, int));
       } else
         panic("Unsupported format: %%%s%c", info.length_mod, info.type);
     } else {
@@ -132,8 +205,10 @@ static const char* put_format(OutStream stream, const char* format,
             info.type);
     }
 
-    outstream_puts(buffer, stream);
-    (*total_written) += strlen(buffer);
+    size_t length = strlen(output);
+    outstream_put_slice(output, length, stream);
+    (*total_written) += length;
+    if (output is_not buffer) free(output);
   }
 
   return format + 1 + (info.symbols_count is 0 ? 1 : info.symbols_count);
@@ -211,8 +286,6 @@ static Specificator parse_specificator(const char* str) {
                        0,
                        0};
 
-  size_t len = strlen(str);
-
   size_t i = 0;
   // if (str[i] is 'r') {
   // spec.is_array = true;
@@ -220,14 +293,13 @@ static Specificator parse_specificator(const char* str) {
   // }
 
   // Flags
-  for (; i < len; i++) {
-    if (strchr("-", str[i]) != NULL) {
+  for (; str[i] != '\0'; i++) {
+    if (str[i] == '-') {
       spec.flag_minus = true;
     } else if (str[i] == '+') {
-      spec.flag_plus = false;
+      spec.flag_plus = true;
+    } else if (str[i] == ' ') {
       spec.flag_space = true;
-    } else if (str[i] == ' ' && !spec.flag_plus) {
-      spec.flag_space = false;
     } else if (str[i] == '0' && spec.width == 0) {
       spec.flag_zero = 1;
     } else if (str[i] == '#') {
@@ -239,7 +311,7 @@ static Specificator parse_specificator(const char* str) {
 
   // Width
   int read_width = 0;
-  while (i < len and str[i] >= '0' and str[i] <= '9') {
+  while (str[i] >= '0' and str[i] <= '9') {
     read_width = read_width * 10 + (str[i] - '0');
     i++;
   }
@@ -252,8 +324,9 @@ static Specificator parse_specificator(const char* str) {
   // Precision
   int read_prec = 0;
   if (str[i] is '.') {
+    spec.has_precision = true;
     i++;
-    while (i < len and str[i] >= '0' and str[i] <= '9') {
+    while (str[i] >= '0' and str[i] <= '9') {
       read_prec = read_prec * 10 + (str[i] - '0');
       i++;
     }
@@ -264,9 +337,10 @@ static Specificator parse_specificator(const char* str) {
   }
   spec.precision = read_prec;
 
-  // Size
+  // Size, most formats have none
   const char* const sizes[] = {"ll", "hh", "h", "l", "j", "z", "t", "L", "r"};
-  for (int s = 0; s < (int)LEN(sizes); s++) {
+  bool may_have_size = str[i] is_not '\0' and strchr("hljztLr", str[i]);
+  for (int s = 0; may_have_size and s < (int)LEN(sizes); s++) {
     if (strncmp(str + i, sizes[s], strlen(sizes[s])) is 0) {
       spec.length_mod = sizes[s];
       i += strlen(sizes[s]);
@@ -275,13 +349,9 @@ static Specificator parse_specificator(const char* str) {
   }
 
   // Type
-  const char allspec[] = "bdiouxXfFeEgGaAcsSpn%";
-  for (int s = 0; s < (int)strlen(allspec); s++) {
-    if (str[i] is allspec[s]) {
-      spec.type = str[i];
-      i++;
-      break;
-    }
+  if (str[i] is_not '\0' and strchr("bdiouxXfFeEgGaAcsSpn%", str[i])) {
+    spec.type = str[i];
+    i++;
   }
 
   spec.symbols_count = i;
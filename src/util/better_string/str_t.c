@@ -10,18 +10,39 @@
 #include "string_stream.h"
 
 str_t str_literal(const char* literal) { return (str_t){literal, false}; }
-str_t str_owned(const char* format, ...) {
-  va_list list;
-  va_start(list, format);
-
-  StringStream builder = string_stream_create();
+static str_t str_vformat(StringStream builder, const char* format,
+                         va_list list) {
   OutStream os = string_stream_stream(&builder);
 
   VaListWrap wrap;
   va_copy(wrap.list, list);
   x_vprintf(os, format, wrap);
-  str_t result = string_stream_to_str_t(builder);
+  return string_stream_to_str_t(builder);
+}
+
+str_t str_owned(const char* format, ...) {
+  va_list list;
+  va_start(list, format);
+  str_t result = str_vformat(string_stream_create(), format, list);
+  va_end(list);
+
+  return result;
+}
+
+str_t str_arena(Arena* arena, const char* format, ...) {
+  va_list list;
+  va_start(list, format);
+  str_t result = str_vformat(string_stream_create_in(arena), format, list);
+  va_end(list);
 
+  return result;
+}
+
+str_t str_frame(const char* format, ...) {
+  va_list list;
+  va_start(list, format);
+  str_t result =
+      str_vformat(string_stream_create_in(frame_arena()), format, list);
   va_end(list);
 
   return result;
@@ -5,9 +5,15 @@
 
 #include "str_t_raw.h"
 
+typedef struct Arena Arena;
+
 str_t str_literal(const char* literal);
 str_t str_borrow(const str_t* from);
 str_t str_owned(const char* format, ...);
+// Formatted in the arena, the result is borrowed and lives as long as it
+str_t str_arena(Arena* arena, const char* format, ...);
+// str_arena in the frame arena, valid until the next frame starts
+str_t str_frame(const char* format, ...);
 str_t str_raw_owned(char* text);
 str_t str_clone(const str_t* source);
 void str_free(str_t s);
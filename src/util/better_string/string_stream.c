@@ -9,13 +9,25 @@
 #define BUFFER_EXTRA_CAP 128
 #define CHAR_REALLOC_COEF 4 / 3
 
-void string_stream_free(StringStream this) { free(this.buffer); }
+void string_stream_free(StringStream this) {
+  if (this.arena is null) FREE(this.buffer);
+}
 
 StringStream string_stream_create() {
   return (StringStream){
       .buffer = null,
       .capacity = 0,
       .length = 0,
+      .arena = null,
+  };
+}
+
+StringStream string_stream_create_in(Arena* arena) {
+  return (StringStream){
+      .buffer = null,
+      .capacity = 0,
+      .length = 0,
+      .arena = arena,
   };
 }
 
@@ -29,6 +41,7 @@ StringStream string_stream_clone(const StringStream* source) {
         .buffer = buffer,
         .capacity = new_cap,
         .length = source->length,
+        .arena = null,
     };
   } else {
     return (*source);  // No data in hold, can just copy by value
@@ -44,7 +57,11 @@ void string_stream_print(const StringStream* tthis, OutStream out) {
 static void ss_realloc(StringStream* this, size_t add_size) {
   size_t new_cap =
       this->capacity * CHAR_REALLOC_COEF + add_size + BUFFER_EXTRA_CAP;
-  this->buffer = (char*)REALLOC(this->buffer, new_cap);
+  if (this->arena)
+    this->buffer = (char*)arena_realloc(this->arena, this->buffer,
+                                        this->capacity, new_cap);
+  else
+    this->buffer = (char*)REALLOC(this->buffer, new_cap);
   assert_alloc(this->buffer);
   this->capacity = new_cap;
 }
@@ -100,5 +117,6 @@ char* string_stream_collect(StringStream tthis) {
 }
 
 str_t string_stream_to_str_t(StringStream tthis) {
-  return str_raw_owned(string_stream_collect(tthis));
+  char* string = string_stream_collect(tthis);
+  return tthis.arena ? str_literal(string) : str_raw_owned(string);
 }
\ No newline at end of file
@@ -5,14 +5,19 @@
 
 #include "../better_io.h"
 
+typedef struct Arena Arena;
+
 typedef struct StringStream {
   char* buffer;
   size_t capacity;
   size_t length;
+  Arena* arena;  // null for heap buffers
 } StringStream;
 
 void string_stream_free(StringStream tthis);
 StringStream string_stream_create();
+// Buffer lives in the arena, str_t made from it is borrowed
+StringStream string_stream_create_in(Arena* arena);
 StringStream string_stream_clone(const StringStream* source);
 void string_stream_print(const StringStream* tthis, OutStream out);
 
@@ -0,0 +1,424 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE  // syscall
+
+#include "block_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#include "allocator.h"
+#include "prettify_c.h"
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+// Buffers handed to read() start on a page, which some file systems need
+// for their fastest path
+#define BLOCK_READER_ALIGNMENT 4096
+
+static const char* const KIND_NAMES[] = {"read", "mmap", "io_uring"};
+
+static atomic_int DefaultKind = BLOCK_READER_READ;
+
+#ifdef HAVE_IO_URING
+// The parts of a ring that liburing would keep, set up by hand so that the
+// library is not needed
+typedef struct Uring {
+  int fd;
+  void *sq_ring, *cq_ring;
+  size_t sq_ring_size, cq_ring_size;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  unsigned *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_cqe* cqes;
+} Uring;
+#endif
+
+struct BlockReader {
+  BlockReaderKind kind;
+  int fd;
+  long long size;
+  bool has_failed;
+
+  // read: the buffer chunks are read into
+  char* buffer;
+
+  // mmap: the whole file, and where the next chunk starts
+  char* map;
+  long long offset;
+
+#ifdef HAVE_IO_URING
+  // io_uring: buffer i holds the chunk at offsets[i] once results[i] is
+  // set. Buffers are handed out in turn from current, each one is queued
+  // again for next_offset as soon as the caller is done with it
+  Uring ring;
+  char* buffers[BLOCK_READER_QUEUE];
+  long long offsets[BLOCK_READER_QUEUE];
+  int results[BLOCK_READER_QUEUE];
+  int current, in_flight;
+  long long next_offset;
+  bool is_holding;
+#endif
+};
+
+#define RESULT_PENDING INT32_MIN
+
+// Bytes left from offset, up to a chunk
+static long long chunk_length(const BlockReader* reader, long long offset) {
+  long long left = reader->size - offset;
+  return left < BLOCK_READER_CHUNK_SIZE ? left : BLOCK_READER_CHUNK_SIZE;
+}
+
+const char* block_reader_name(BlockReaderKind kind) {
+  return kind >= 0 and kind < BLOCK_READER_KINDS ? KIND_NAMES[kind] : "unknown";
+}
+
+bool block_reader_parse_kind(const char* name, BlockReaderKind* out_kind) {
+  for (BlockReaderKind kind = 0; kind < BLOCK_READER_KINDS; kind++) {
+    if (strcmp(name, KIND_NAMES[kind]) is 0) {
+      *out_kind = kind;
+      return true;
+    }
+  }
+  return false;
+}
+
+void block_reader_set_default(BlockReaderKind kind) {
+  atomic_store(&DefaultKind, kind);
+}
+
+BlockReaderKind block_reader_default(void) {
+  return atomic_load(&DefaultKind);
+}
+
+// ---------------------------------------------------------------- io_uring
+
+#ifdef HAVE_IO_URING
+static bool uring_init(Uring* ring, unsigned entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (ring->fd < 0) return false;
+
+  ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  // Newer kernels put both rings in one mapping
+  bool is_single = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (is_single) {
+    if (ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+    ring->cq_ring_size = ring->sq_ring_size;
+  }
+  ring->sq_ring = mmap(null, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+  ring->cq_ring = is_single ? ring->sq_ring
+                            : mmap(null, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = mmap(null, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring->fd, IORING_OFF_SQES);
+  if (ring->sq_ring is MAP_FAILED or ring->cq_ring is MAP_FAILED or ring->sqes is MAP_FAILED) {
+    if (ring->sqes is_not MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+    if (not is_single and ring->cq_ring is_not MAP_FAILED) munmap(ring->cq_ring, ring->cq_ring_size);
+    if (ring->sq_ring is_not MAP_FAILED) munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+    return false;
+  }
+
+  char* sq = ring->sq_ring;
+  ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+  char* cq = ring->cq_ring;
+  ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+  ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+  return true;
+}
+
+static void uring_free(Uring* ring) {
+  munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring is_not ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+  munmap(ring->sq_ring, ring->sq_ring_size);
+  close(ring->fd);
+}
+
+static bool uring_submit_read(Uring* ring, int fd, char* buffer, unsigned length,
+                              long long offset, unsigned long long user_data) {
+  unsigned tail = *ring->sq_tail;
+  unsigned index = tail & *ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = fd;
+  sqe->addr = (unsigned long long)(uintptr_t)buffer;
+  sqe->len = length;
+  sqe->off = (unsigned long long)offset;
+  sqe->user_data = user_data;
+  ring->sq_array[index] = index;
+  // The kernel must see the entry before the new tail
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  long submitted;
+  do {
+    submitted = syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, null, 0);
+  } while (submitted < 0 and errno is EINTR);
+  return submitted is 1;
+}
+
+// Blocks for at least one completion, false if waiting failed
+static bool uring_wait(Uring* ring) {
+  long status = syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, null, 0);
+  return status >= 0 or errno is EINTR;
+}
+
+// Takes one completion if there is any
+static bool uring_pop(Uring* ring, struct io_uring_cqe* out) {
+  unsigned head = *ring->cq_head;
+  if (head is __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) return false;
+  *out = ring->cqes[head & *ring->cq_mask];
+  __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static bool uring_queue(BlockReader* reader, int index) {
+  if (reader->next_offset >= reader->size) return false;
+  long long length = chunk_length(reader, reader->next_offset);
+  reader->offsets[index] = reader->next_offset;
+  reader->results[index] = RESULT_PENDING;
+  if (not uring_submit_read(&reader->ring, reader->fd, reader->buffers[index], (unsigned)length,
+                            reader->next_offset, (unsigned long long)index)) {
+    reader->offsets[index] = -1;
+    reader->has_failed = true;
+    return false;
+  }
+  reader->next_offset += length;
+  reader->in_flight++;
+  return true;
+}
+
+static bool uring_open(BlockReader* reader) {
+  if (not uring_init(&reader->ring, BLOCK_READER_QUEUE)) return false;
+  for (int i = 0; i < BLOCK_READER_QUEUE; i++) {
+    reader->buffers[i] = null;
+    reader->offsets[i] = -1;
+  }
+  for (int i = 0; i < BLOCK_READER_QUEUE; i++) {
+    if (posix_memalign((void**)&reader->buffers[i], BLOCK_READER_ALIGNMENT, BLOCK_READER_CHUNK_SIZE))
+      panic("Out of memory");
+  }
+  // The queue starts full, further reads go out as chunks are given back
+  for (int i = 0; i < BLOCK_READER_QUEUE; i++) uring_queue(reader, i);
+  return true;
+}
+
+static bool uring_next(BlockReader* reader, const char** data, size_t* length) {
+  if (reader->is_holding) {
+    reader->is_holding = false;
+    int done = reader->current;
+    reader->offsets[done] = -1;
+    reader->current = (done + 1) % BLOCK_READER_QUEUE;
+    uring_queue(reader, done);
+  }
+  int index = reader->current;
+  if (reader->has_failed or reader->offsets[index] < 0) return false;
+
+  while (reader->results[index] is RESULT_PENDING) {
+    struct io_uring_cqe cqe;
+    if (uring_pop(&reader->ring, &cqe)) {
+      reader->results[cqe.user_data] = cqe.res;
+      reader->in_flight--;
+    } else if (not uring_wait(&reader->ring)) {
+      reader->has_failed = true;
+      return false;
+    }
+  }
+
+  // A short read is finished here, the reads after it are at fixed offsets
+  long long offset = reader->offsets[index];
+  long long expected = chunk_length(reader, offset);
+  long long got = reader->results[index];
+  while (got >= 0 and got < expected) {
+    ssize_t more = pread(reader->fd, reader->buffers[index] + got, expected - got, offset + got);
+    if (more < 0 and errno is EINTR) continue;
+    if (more <= 0) break;
+    got += more;
+  }
+  if (got is_not expected) {
+    reader->has_failed = true;
+    return false;
+  }
+  *data = reader->buffers[index];
+  *length = (size_t)got;
+  reader->is_holding = true;
+  return true;
+}
+
+// The kernel may still be writing into the buffers until every read is back
+static void uring_close(BlockReader* reader) {
+  while (reader->in_flight > 0) {
+    struct io_uring_cqe cqe;
+    if (uring_pop(&reader->ring, &cqe))
+      reader->in_flight--;
+    else if (not uring_wait(&reader->ring))
+      break;
+  }
+  uring_free(&reader->ring);
+  for (int i = 0; i < BLOCK_READER_QUEUE; i++) free(reader->buffers[i]);
+}
+#endif
+
+// ---------------------------------------------------------------- Backends
+
+bool block_reader_is_available(BlockReaderKind kind) {
+  switch (kind) {
+    case BLOCK_READER_READ: return true;
+#ifndef _WIN32
+    case BLOCK_READER_MMAP: return true;
+#endif
+#ifdef HAVE_IO_URING
+    case BLOCK_READER_IO_URING: {
+      // Kernels may be too old, or have io_uring turned off
+      Uring ring;
+      if (not uring_init(&ring, 1)) return false;
+      uring_free(&ring);
+      return true;
+    }
+#endif
+    default: return false;
+  }
+}
+
+static bool read_open(BlockReader* reader) {
+#ifndef _WIN32
+  posix_fadvise(reader->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  if (posix_memalign((void**)&reader->buffer, BLOCK_READER_ALIGNMENT, BLOCK_READER_CHUNK_SIZE))
+    panic("Out of memory");
+#else
+  reader->buffer = malloc(BLOCK_READER_CHUNK_SIZE);
+  assert_alloc(reader->buffer);
+#endif
+  return true;
+}
+
+static bool read_next(BlockReader* reader, const char** data, size_t* length) {
+  size_t filled = 0;
+  while (filled < BLOCK_READER_CHUNK_SIZE) {
+    ssize_t got = read(reader->fd, reader->buffer + filled, BLOCK_READER_CHUNK_SIZE - filled);
+    if (got < 0 and errno is EINTR) continue;
+    if (got < 0) reader->has_failed = true;
+    if (got <= 0) break;
+    filled += (size_t)got;
+  }
+  *data = reader->buffer;
+  *length = filled;
+  return filled > 0;
+}
+
+#ifndef _WIN32
+static bool mmap_open(BlockReader* reader) {
+  // Nothing to map in an empty file, mmap refuses a zero length
+  if (reader->size is 0) return true;
+  reader->map = mmap(null, (size_t)reader->size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+  if (reader->map is MAP_FAILED) {
+    reader->map = null;
+    return false;
+  }
+  posix_madvise(reader->map, (size_t)reader->size, POSIX_MADV_SEQUENTIAL);
+  return true;
+}
+
+static bool mmap_next(BlockReader* reader, const char** data, size_t* length) {
+  if (reader->offset >= reader->size) return false;
+  *data = reader->map + reader->offset;
+  *length = (size_t)chunk_length(reader, reader->offset);
+  reader->offset += *length;
+  return true;
+}
+#endif
+
+BlockReader* block_reader_open(const char* path, BlockReaderKind kind) {
+  int fd = open(path, O_RDONLY | O_BINARY);
+  if (fd < 0) return null;
+  // mmap and io_uring read as much as the size says, which is 0 for a pipe
+  // or a device, only read goes on to the end of those
+  struct stat info;
+  if (fstat(fd, &info) is_not 0 or (kind is_not BLOCK_READER_READ and not S_ISREG(info.st_mode))) {
+    close(fd);
+    return null;
+  }
+
+  BlockReader* reader = MALLOC(sizeof(BlockReader));
+  assert_alloc(reader);
+  memset(reader, 0, sizeof(*reader));
+  reader->kind = kind;
+  reader->fd = fd;
+  reader->size = (long long)info.st_size;
+
+  bool is_open = false;
+  switch (kind) {
+    case BLOCK_READER_READ: is_open = read_open(reader); break;
+#ifndef _WIN32
+    case BLOCK_READER_MMAP: is_open = mmap_open(reader); break;
+#endif
+#ifdef HAVE_IO_URING
+    case BLOCK_READER_IO_URING: is_open = uring_open(reader); break;
+#endif
+    default: break;
+  }
+  if (not is_open) {
+    close(fd);
+    FREE(reader);
+    return null;
+  }
+  return reader;
+}
+
+bool block_reader_next(BlockReader* reader, const char** data, size_t* length) {
+  switch (reader->kind) {
+#ifndef _WIN32
+    case BLOCK_READER_MMAP: return mmap_next(reader, data, length);
+#endif
+#ifdef HAVE_IO_URING
+    case BLOCK_READER_IO_URING: return uring_next(reader, data, length);
+#endif
+    default: return read_next(reader, data, length);
+  }
+}
+
+bool block_reader_failed(const BlockReader* reader) {
+  return reader->has_failed;
+}
+
+void block_reader_close(BlockReader* reader) {
+  if (reader is null) return;
+  switch (reader->kind) {
+#ifndef _WIN32
+    case BLOCK_READER_MMAP:
+      if (reader->map) munmap(reader->map, (size_t)reader->size);
+      break;
+#endif
+#ifdef HAVE_IO_URING
+    case BLOCK_READER_IO_URING: uring_close(reader); break;
+#endif
+    default: free(reader->buffer); break;
+  }
+  close(reader->fd);
+  FREE(reader);
+}
@@ -0,0 +1,55 @@
+#ifndef SRC_UTIL_BLOCK_READER_H_
+#define SRC_UTIL_BLOCK_READER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Reads a file front to back in chunks, with one of several system
+ * interfaces behind the same calls. Which one is fastest depends on where
+ * the file is: local NVMe, a network mount, or already in the page cache.
+ *  - read: read() into an aligned buffer, the kernel told the access is
+ *    sequential with posix_fadvise
+ *  - mmap: the file mapped whole, advised as sequential, chunks are
+ *    slices of the mapping and no bytes are copied
+ *  - io_uring: BLOCK_READER_QUEUE reads kept queued ahead of the one being
+ *    handed out, so the device always has work. Needs HAVE_IO_URING and a
+ *    kernel that allows it
+ * block_stream reads every model through here, with the default kind.
+ */
+
+#define BLOCK_READER_CHUNK_SIZE (1 << 20)
+#define BLOCK_READER_QUEUE 4
+
+typedef enum BlockReaderKind {
+  BLOCK_READER_READ,
+  BLOCK_READER_MMAP,
+  BLOCK_READER_IO_URING,
+  BLOCK_READER_KINDS,
+} BlockReaderKind;
+
+typedef struct BlockReader BlockReader;
+
+const char* block_reader_name(BlockReaderKind kind);
+// The inverse of block_reader_name, false for an unknown name
+bool block_reader_parse_kind(const char* name, BlockReaderKind* out_kind);
+// Whether this build and system can use kind at all
+bool block_reader_is_available(BlockReaderKind kind);
+
+// What block_stream_open reads with, BLOCK_READER_READ at first. Shared by
+// all threads
+void block_reader_set_default(BlockReaderKind kind);
+BlockReaderKind block_reader_default(void);
+
+// null if the file can not be opened or kind is not available. Only read
+// opens what is not a regular file, like a pipe
+BlockReader* block_reader_open(const char* path, BlockReaderKind kind);
+// Gives the next chunk, false at the end. The chunk is read only and stays
+// valid until the next call. Chunks are at most BLOCK_READER_CHUNK_SIZE
+// long, shorter ones only at the end
+bool block_reader_next(BlockReader* reader, const char** data, size_t* length);
+// After block_reader_next returned false: a read failed before the end
+bool block_reader_failed(const BlockReader* reader);
+void block_reader_close(BlockReader* reader);
+
+#endif  // SRC_UTIL_BLOCK_READER_H_
@@ -0,0 +1,366 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "block_stream.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "allocator.h"
+#include "block_reader.h"
+#include "common_vecs.h"
+#include "prettify_c.h"
+
+static const unsigned char GZIP_MAGIC[] = {0x1F, 0x8B};
+static const unsigned char ZSTD_MAGIC[] = {0x28, 0xB5, 0x2F, 0xFD};
+
+typedef struct Block {
+  char* data;
+  size_t length;
+} Block;
+
+struct BlockStream {
+  BlockReader* reader;
+  BlockCompression compression;
+  // What is left of the chunk the reader gave last
+  const char* input;
+  size_t input_length;
+#ifdef HAVE_ZLIB
+  z_stream zlib;
+  bool is_member_done;  // a gzip file may be several members in a row
+#endif
+#ifdef HAVE_ZSTD
+  ZSTD_DStream* zstd;
+  ZSTD_inBuffer zstd_input;
+  size_t zstd_hint;  // 0 once a frame is complete
+#endif
+
+  // Blocks from taken up to filled hold data, the consumer owns the one at
+  // taken while is_holding. Both only grow, the ring index is % BLOCKS
+  Block blocks[BLOCK_STREAM_BLOCKS];
+  size_t filled, taken;
+  bool is_holding;
+  bool is_done, has_failed, is_closing;
+  bool has_thread;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+};
+
+BlockCompression block_compression_detect(const char* path) {
+  unsigned char head[4];
+  FILE* file = fopen(path, "rb");
+  if (file is null) return BLOCK_COMPRESSION_NONE;
+  size_t length = fread(head, 1, sizeof(head), file);
+  fclose(file);
+
+  if (length >= sizeof(GZIP_MAGIC) and memcmp(head, GZIP_MAGIC, sizeof(GZIP_MAGIC)) is 0)
+    return BLOCK_COMPRESSION_GZIP;
+  if (length >= sizeof(ZSTD_MAGIC) and memcmp(head, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) is 0)
+    return BLOCK_COMPRESSION_ZSTD;
+  return BLOCK_COMPRESSION_NONE;
+}
+
+bool block_stream_is_supported(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file is null) return false;
+  fclose(file);
+
+  switch (block_compression_detect(path)) {
+#ifdef HAVE_ZLIB
+    case BLOCK_COMPRESSION_GZIP: return true;
+#endif
+#ifdef HAVE_ZSTD
+    case BLOCK_COMPRESSION_ZSTD: return true;
+#endif
+    case BLOCK_COMPRESSION_NONE: return true;
+    default: return false;
+  }
+}
+
+// ---------------------------------------------------------------- Decoding
+
+// Every fill_* function fills out completely unless the data ends, then the
+// stream is over
+
+// Takes up to capacity bytes of the file as they are read, false at its end
+static bool take_input(BlockStream* stream, const char** data, size_t* length, size_t capacity) {
+  if (stream->input_length is 0 and
+      not block_reader_next(stream->reader, &stream->input, &stream->input_length))
+    return false;
+  *data = stream->input;
+  *length = stream->input_length < capacity ? stream->input_length : capacity;
+  stream->input += *length;
+  stream->input_length -= *length;
+  return true;
+}
+
+static size_t fill_plain(BlockStream* stream, char* out, size_t capacity, bool* failed) {
+  size_t filled = 0;
+  const char* data;
+  size_t length;
+  while (filled < capacity and take_input(stream, &data, &length, capacity - filled)) {
+    memcpy(out + filled, data, length);
+    filled += length;
+  }
+  *failed = block_reader_failed(stream->reader);
+  return filled;
+}
+
+#ifdef HAVE_ZLIB
+static size_t fill_gzip(BlockStream* stream, char* out, size_t capacity, bool* failed) {
+  z_stream* z = &stream->zlib;
+  z->next_out = (Bytef*)out;
+  z->avail_out = (uInt)capacity;
+
+  while (z->avail_out > 0) {
+    bool is_eof = false;
+    if (z->avail_in is 0) {
+      const char* data;
+      size_t length;
+      is_eof = not take_input(stream, &data, &length, BLOCK_STREAM_BLOCK_SIZE);
+      z->next_in = is_eof ? null : (Bytef*)data;
+      z->avail_in = is_eof ? 0 : (uInt)length;
+    }
+
+    // Output held back from the last call comes out even without input
+    uInt avail_out = z->avail_out;
+    int status = inflate(z, Z_NO_FLUSH);
+    if (status is Z_STREAM_END) {
+      stream->is_member_done = true;
+      inflateReset(z);
+    } else if (status is Z_OK) {
+      stream->is_member_done = false;
+    } else if (status is_not Z_BUF_ERROR) {
+      *failed = true;
+      break;
+    }
+    if (is_eof and z->avail_out is avail_out) {
+      *failed = block_reader_failed(stream->reader) or not stream->is_member_done;
+      break;
+    }
+  }
+  return capacity - z->avail_out;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static size_t fill_zstd(BlockStream* stream, char* out, size_t capacity, bool* failed) {
+  ZSTD_outBuffer output = {out, capacity, 0};
+  ZSTD_inBuffer* input = &stream->zstd_input;
+
+  while (output.pos < output.size) {
+    bool is_eof = false;
+    if (input->pos is input->size) {
+      const char* data;
+      size_t length;
+      is_eof = not take_input(stream, &data, &length, BLOCK_STREAM_BLOCK_SIZE);
+      *input = (ZSTD_inBuffer) {data, is_eof ? 0 : length, 0};
+    }
+
+    size_t before = output.pos;
+    size_t hint = ZSTD_decompressStream(stream->zstd, &output, input);
+    if (ZSTD_isError(hint)) {
+      *failed = true;
+      break;
+    }
+    // Past the last frame an empty call asks for the next header, which is
+    // not a frame left unfinished
+    if (not is_eof or output.pos > before) stream->zstd_hint = hint;
+    if (is_eof and output.pos is before) {
+      *failed = block_reader_failed(stream->reader) or stream->zstd_hint is_not 0;
+      break;
+    }
+  }
+  return output.pos;
+}
+#endif
+
+static size_t fill(BlockStream* stream, char* out, bool* failed) {
+  *failed = false;
+  switch (stream->compression) {
+#ifdef HAVE_ZLIB
+    case BLOCK_COMPRESSION_GZIP: return fill_gzip(stream, out, BLOCK_STREAM_BLOCK_SIZE, failed);
+#endif
+#ifdef HAVE_ZSTD
+    case BLOCK_COMPRESSION_ZSTD: return fill_zstd(stream, out, BLOCK_STREAM_BLOCK_SIZE, failed);
+#endif
+    default: return fill_plain(stream, out, BLOCK_STREAM_BLOCK_SIZE, failed);
+  }
+}
+
+// ---------------------------------------------------------------- Ring
+
+// Fills the next free block and publishes it. False once the stream is over
+// or closing
+static bool produce_block(BlockStream* stream) {
+  pthread_mutex_lock(&stream->lock);
+  while (stream->filled - stream->taken >= BLOCK_STREAM_BLOCKS and not stream->is_closing)
+    pthread_cond_wait(&stream->changed, &stream->lock);
+  Block* block = &stream->blocks[stream->filled % BLOCK_STREAM_BLOCKS];
+  bool is_closing = stream->is_closing;
+  pthread_mutex_unlock(&stream->lock);
+  if (is_closing) return false;
+
+  // The block is free, nobody else touches it until it is published
+  bool failed;
+  block->length = fill(stream, block->data, &failed);
+  bool is_over = failed or block->length < BLOCK_STREAM_BLOCK_SIZE;
+
+  pthread_mutex_lock(&stream->lock);
+  if (block->length > 0) stream->filled++;
+  stream->is_done = is_over;
+  stream->has_failed = failed;
+  pthread_cond_broadcast(&stream->changed);
+  pthread_mutex_unlock(&stream->lock);
+  return not is_over;
+}
+
+static void* produce_main(void* arg) {
+  BlockStream* stream = arg;
+  while (produce_block(stream)) {
+  }
+  return null;
+}
+
+static bool start_decoder(BlockStream* stream) {
+  switch (stream->compression) {
+#ifdef HAVE_ZLIB
+    case BLOCK_COMPRESSION_GZIP:
+      stream->is_member_done = false;
+      // 16: gzip headers, not zlib ones
+      return inflateInit2(&stream->zlib, 16 + MAX_WBITS) is Z_OK;
+#endif
+#ifdef HAVE_ZSTD
+    case BLOCK_COMPRESSION_ZSTD:
+      stream->zstd = ZSTD_createDStream();
+      stream->zstd_input = (ZSTD_inBuffer) {null, 0, 0};
+      stream->zstd_hint = 1;
+      return stream->zstd is_not null;
+#endif
+    case BLOCK_COMPRESSION_NONE: return true;
+    default: return false;
+  }
+}
+
+static void stop_decoder(BlockStream* stream) {
+  unused(stream);
+#ifdef HAVE_ZLIB
+  if (stream->compression is BLOCK_COMPRESSION_GZIP) inflateEnd(&stream->zlib);
+#endif
+#ifdef HAVE_ZSTD
+  if (stream->compression is BLOCK_COMPRESSION_ZSTD) ZSTD_freeDStream(stream->zstd);
+#endif
+}
+
+BlockStream* block_stream_open(const char* path) {
+  if (not block_stream_is_supported(path)) return null;
+  BlockStream* stream = MALLOC(sizeof(BlockStream));
+  assert_alloc(stream);
+  memset(stream, 0, sizeof(*stream));
+
+  stream->compression = block_compression_detect(path);
+  // The default reader may not work on this system or for this file
+  stream->reader = block_reader_open(path, block_reader_default());
+  if (stream->reader is null) stream->reader = block_reader_open(path, BLOCK_READER_READ);
+  for (int i = 0; i < BLOCK_STREAM_BLOCKS; i++) {
+    stream->blocks[i].data = MALLOC(BLOCK_STREAM_BLOCK_SIZE);
+    assert_alloc(stream->blocks[i].data);
+  }
+  if (stream->reader is null or not start_decoder(stream)) {
+    block_reader_close(stream->reader);
+    for (int i = 0; i < BLOCK_STREAM_BLOCKS; i++) FREE(stream->blocks[i].data);
+    FREE(stream);
+    return null;
+  }
+
+  pthread_mutex_init(&stream->lock, null);
+  pthread_cond_init(&stream->changed, null);
+  stream->has_thread = pthread_create(&stream->thread, null, produce_main, stream) is 0;
+  return stream;
+}
+
+bool block_stream_next(BlockStream* stream, char** data, size_t* length) {
+  pthread_mutex_lock(&stream->lock);
+  if (stream->is_holding) {
+    stream->taken++;
+    stream->is_holding = false;
+    pthread_cond_broadcast(&stream->changed);
+  }
+  pthread_mutex_unlock(&stream->lock);
+  // Without the thread the block is filled here, when asked for
+  if (not stream->has_thread and not stream->is_done) produce_block(stream);
+
+  pthread_mutex_lock(&stream->lock);
+  while (stream->filled is stream->taken and not stream->is_done)
+    pthread_cond_wait(&stream->changed, &stream->lock);
+  bool has_block = stream->filled > stream->taken;
+  if (has_block) {
+    Block* block = &stream->blocks[stream->taken % BLOCK_STREAM_BLOCKS];
+    *data = block->data;
+    *length = block->length;
+    stream->is_holding = true;
+  }
+  pthread_mutex_unlock(&stream->lock);
+  return has_block;
+}
+
+// Written before the producer published the end, which the caller has seen
+bool block_stream_failed(const BlockStream* stream) {
+  return stream->has_failed;
+}
+
+bool block_stream_for_each_line(BlockStream* stream, block_line_fn_t on_line, void* ctx) {
+  // A line that runs into the next block is put together here
+  vec_char carry = vec_char_create();
+  char* block;
+  size_t length;
+  while (block_stream_next(stream, &block, &length)) {
+    char* line = block;
+    char* end = block + length;
+    char* newline;
+    while ((newline = memchr(line, '\n', end - line))) {
+      *newline = '\0';
+      if (carry.length is 0) {
+        on_line(ctx, line, newline - line);
+      } else {
+        vec_char_push_n(&carry, line, newline - line + 1);
+        on_line(ctx, carry.data, carry.length - 1);
+        carry.length = 0;
+      }
+      line = newline + 1;
+    }
+    vec_char_push_n(&carry, line, end - line);
+  }
+  if (carry.length > 0) {
+    vec_char_push(&carry, '\0');
+    on_line(ctx, carry.data, carry.length - 1);
+  }
+  vec_char_free(carry);
+  return not block_stream_failed(stream);
+}
+
+void block_stream_close(BlockStream* stream) {
+  if (stream is null) return;
+  if (stream->has_thread) {
+    pthread_mutex_lock(&stream->lock);
+    stream->is_closing = true;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+    pthread_join(stream->thread, null);
+  }
+  pthread_mutex_destroy(&stream->lock);
+  pthread_cond_destroy(&stream->changed);
+
+  stop_decoder(stream);
+  block_reader_close(stream->reader);
+  for (int i = 0; i < BLOCK_STREAM_BLOCKS; i++) FREE(stream->blocks[i].data);
+  FREE(stream);
+}
@@ -0,0 +1,54 @@
+#ifndef SRC_UTIL_BLOCK_STREAM_H_
+#define SRC_UTIL_BLOCK_STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Sequential reader of a whole file in large blocks. gzip and zstd files are
+ * told by their first bytes and decompressed on the fly, so a compressed
+ * model needs no temporary file. A background thread reads and decompresses
+ * into a ring of blocks while the caller works on the ones before, so the
+ * two overlap. If the thread can not be started every block is filled on
+ * the calling thread instead. The file itself is read by a block_reader of
+ * the default kind, or with plain read() where that kind fails to open it.
+ *
+ * gzip needs the build with HAVE_ZLIB, zstd with HAVE_ZSTD, the Makefile
+ * turns them on when the libraries are installed.
+ */
+
+#define BLOCK_STREAM_BLOCK_SIZE (1 << 20)
+#define BLOCK_STREAM_BLOCKS 4
+
+typedef enum BlockCompression {
+  BLOCK_COMPRESSION_NONE,
+  BLOCK_COMPRESSION_GZIP,
+  BLOCK_COMPRESSION_ZSTD,
+} BlockCompression;
+
+typedef struct BlockStream BlockStream;
+
+// By the first bytes, NONE for a file that can not be read
+BlockCompression block_compression_detect(const char* path);
+// False if the file can not be opened, or is compressed in a format this
+// build does not decompress
+bool block_stream_is_supported(const char* path);
+
+// null where block_stream_is_supported is false
+BlockStream* block_stream_open(const char* path);
+// Gives the next block, false at the end. The block may be written to and
+// stays valid until the next call
+bool block_stream_next(BlockStream* stream, char** data, size_t* length);
+// After block_stream_next returned false: the file ended early or the
+// compressed data is corrupt. The blocks given out before that were correct
+bool block_stream_failed(const BlockStream* stream);
+void block_stream_close(BlockStream* stream);
+
+typedef void (*block_line_fn_t)(void* ctx, char* line, size_t length);
+// Calls on_line with every line left in the stream, '\n' replaced by a NUL
+// in place, the last one also without a '\n'. Lines are cut out of the
+// blocks where they are, only one running into the next block is copied.
+// Returns false where block_stream_failed would be true
+bool block_stream_for_each_line(BlockStream* stream, block_line_fn_t on_line, void* ctx);
+
+#endif  // SRC_UTIL_BLOCK_STREAM_H_
@@ -12,10 +12,13 @@
 #define VECTOR_C double
 #include "../util/vector.h"
 
+// Mesh vertices and indices, which can take gigabytes
 #define VECTOR_C float
+#define VECTOR_HUGE_ALLOC
 #include "../util/vector.h"
 
 #define VECTOR_C int
+#define VECTOR_HUGE_ALLOC
 #include "../util/vector.h"
 
 #define VECTOR_C Bool
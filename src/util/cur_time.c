@@ -16,4 +16,10 @@ double current_time_secs() {
   }
 
   return ((double)(now - Start)) / CLOCKS_PER_SEC;
-}
\ No newline at end of file
+}
+
+double wall_time_secs() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -1,6 +1,9 @@
 #ifndef UTIL_CUR_TIME_H_
 #define UTIL_CUR_TIME_H_
 
+// Processor time of the whole process, summed over its threads
 double current_time_secs();
+// Real time, for measuring work that runs on several threads
+double wall_time_secs();
 
-#endif // UTIL_CUR_TIME_H_
\ No newline at end of file
+#endif // UTIL_CUR_TIME_H_
@@ -0,0 +1,93 @@
+#define _POSIX_C_SOURCE 200809L  // lstat
+
+#include "dir_walk.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "allocator.h"
+#include "prettify_c.h"
+
+#if defined(__APPLE__)
+#define MTIME_NSEC(st) ((st).st_mtimespec.tv_nsec)
+#elif defined(_WIN32)
+#define MTIME_NSEC(st) 0L
+#define lstat stat
+#define S_ISLNK(mode) 0
+#else
+#define MTIME_NSEC(st) ((st).st_mtim.tv_nsec)
+#endif
+
+static FileInfo info_from_stat(const struct stat* st) {
+  return (FileInfo){
+      .size = (uint64_t)st->st_size,
+      .mtime_ns = (int64_t)st->st_mtime * 1000000000 + MTIME_NSEC(*st),
+      .is_dir = S_ISDIR(st->st_mode),
+  };
+}
+
+bool file_info(const char* path, FileInfo* out) {
+  struct stat st;
+  if (stat(path, &st) is_not 0) return false;
+  *out = info_from_stat(&st);
+  return true;
+}
+
+static char* join_path(const char* dir, const char* name) {
+  size_t dir_length = strlen(dir);
+  bool slash = dir_length > 0 and dir[dir_length - 1] is_not '/';
+  char* path = MALLOC(dir_length + slash + strlen(name) + 1);
+  assert_alloc(path);
+  memcpy(path, dir, dir_length);
+  if (slash) path[dir_length++] = '/';
+  strcpy(path + dir_length, name);
+  return path;
+}
+
+static bool walk(const char* dir, const char* relative, DirWalkFn visit,
+                 void* ctx) {
+  DIR* handle = opendir(dir);
+  if (handle is null) return false;
+
+  struct dirent* entry;
+  while ((entry = readdir(handle))) {
+    if (strcmp(entry->d_name, ".") is 0 or strcmp(entry->d_name, "..") is 0)
+      continue;
+    char* path = join_path(dir, entry->d_name);
+    char* sub_relative = join_path(relative, entry->d_name);
+
+    struct stat st;
+    bool ok = lstat(path, &st) is 0;
+    if (ok and S_ISDIR(st.st_mode)) {
+      walk(path, sub_relative, visit, ctx);
+    } else {
+      // A link to a file counts as the file
+      if (ok and S_ISLNK(st.st_mode)) ok = stat(path, &st) is 0;
+      if (ok and S_ISREG(st.st_mode)) {
+        FileInfo info = info_from_stat(&st);
+        visit(ctx, path, sub_relative, &info);
+      }
+    }
+    FREE(sub_relative);
+    FREE(path);
+  }
+  closedir(handle);
+  return true;
+}
+
+bool dir_walk(const char* root, DirWalkFn visit, void* ctx) {
+  return walk(root, "", visit, ctx);
+}
+
+bool path_has_extension(const char* path, const char* extension) {
+  size_t length = strlen(path), ext_length = strlen(extension);
+  if (length < ext_length) return false;
+  const char* end = path + length - ext_length;
+  for (size_t i = 0; i < ext_length; i++)
+    if (tolower((unsigned char)end[i]) is_not tolower((unsigned char)extension[i]))
+      return false;
+  return true;
+}
@@ -0,0 +1,28 @@
+#ifndef SRC_UTIL_DIR_WALK_H_
+#define SRC_UTIL_DIR_WALK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct FileInfo {
+  uint64_t size;
+  int64_t mtime_ns;  // nanoseconds where the system keeps them
+  bool is_dir;
+} FileInfo;
+
+// Follows symlinks. False if path does not exist
+bool file_info(const char* path, FileInfo* out);
+
+// path is root joined with relative, the path below root
+typedef void (*DirWalkFn)(void* ctx, const char* path, const char* relative,
+                          const FileInfo* info);
+
+// Calls visit for every file below root, recursively, in no particular
+// order. Symlinks to directories are not followed, so links can not loop.
+// False if root is not a directory that can be opened
+bool dir_walk(const char* root, DirWalkFn visit, void* ctx);
+
+// Case-insensitive, extension with the dot: ".obj"
+bool path_has_extension(const char* path, const char* extension);
+
+#endif  // SRC_UTIL_DIR_WALK_H_
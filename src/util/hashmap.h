@@ -0,0 +1,400 @@
+/**
+ * This header-only library allows to create template hash maps in c, the same
+ * way vector.h creates vectors. Open addressing with linear probing and Robin
+ * Hood displacement: all entries live in one array, so there is no allocation
+ * per entry, and lookups stop as soon as they pass the probe distance the key
+ * would have had.
+ *
+ * Usage:
+ *   #define HASHMAP_K int
+ *   #define HASHMAP_V float
+ *   #include "hashmap.h"   // map_int_float, with header and implementation
+ *
+ * Included with neither of them it only gives the hash functions, hash_u64,
+ * hash_bytes and the others.
+ */
+
+// input macro: HASHMAP_K - key type, a single identifier (typedef it if not)
+// input macro: HASHMAP_V - value type, a single identifier
+// input macro: HASHMAP_NAME - name of the map type, map_K_V by default
+// input macro: HASHMAP_HASH - uint64_t function(K), hashes the key bytes by
+// default, so keys with padding or pointers need their own
+// input macro: HASHMAP_EQ - bool function(K, K), compares the key bytes by
+// default
+// input macro: HASHMAP_KEY_DESTRUCTOR, HASHMAP_VALUE_DESTRUCTOR - void
+// functions that accept the object, optional
+// input macro: HASHMAP_MALLOC_FN, HASHMAP_FREE_FN - optional
+// input macro: HASHMAP_MAKE_STATIC - define to make all functions static inline,
+// so the ones a file does not call do not warn
+// input macro: HASHMAP_NO_HEADERS, HASHMAP_NO_IMPLEMENTATION - to put the
+// header and the implementation in different files
+
+#ifndef SRC_UTIL_HASHMAP_COMMON_
+#define SRC_UTIL_HASHMAP_COMMON_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Entries per capacity, as a fraction of 8. Robin Hood keeps probes short
+// even at this load
+#define HASHMAP_MAX_LOAD_8THS 7
+// Probe distances are stored in a byte, 0 meaning an empty slot. A table
+// that reaches this distance grows, which only happens with a bad hash
+#define HASHMAP_MAX_DIST 255
+
+// splitmix64 finalizer: every input bit affects every output bit
+static inline uint64_t hash_u64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+static inline uint64_t hash_bytes(const void* data, size_t size) {
+  const unsigned char* bytes = (const unsigned char*)data;
+  uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+  for (; size >= 8; size -= 8, bytes += 8) {
+    uint64_t word;
+    memcpy(&word, bytes, 8);
+    hash = hash_u64(hash ^ word);
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, bytes, size);
+  return hash_u64(hash ^ tail);
+}
+
+static inline uint64_t hash_str(const char* str) {
+  return hash_bytes(str, strlen(str));
+}
+
+#endif  // SRC_UTIL_HASHMAP_COMMON_
+
+#if !defined(HASHMAP_K) && !defined(HASHMAP_V)
+// Only the hash functions above were wanted
+#elif !defined(HASHMAP_K) || !defined(HASHMAP_V)
+#warning HASHMAP_K or HASHMAP_V is undefined, cannot construct hash map.
+#else
+
+#ifndef HASHMAP_MALLOC_FN
+#include <stdlib.h>
+#define HASHMAP_MALLOC_FN malloc
+#endif
+
+#ifndef HASHMAP_FREE_FN
+#include <stdlib.h>
+#define HASHMAP_FREE_FN free
+#endif
+
+#ifdef HASHMAP_MAKE_STATIC
+#define MAP_STATIC_PREFIX static inline
+#else
+#define MAP_STATIC_PREFIX
+#endif
+
+#include "prettify_c.h"
+
+#ifdef HASHMAP_NAME
+#define MAP_T HASHMAP_NAME
+#else
+#define MAP_T CONCAT(CONCAT(map_, HASHMAP_K), CONCAT(_, HASHMAP_V))
+#endif
+#define MAP_ENTRY_T CONCAT(MAP_T, _Entry)
+#define K_T HASHMAP_K
+#define V_T HASHMAP_V
+
+#define MAP_CREATE CONCAT(MAP_T, _create)
+#define MAP_WITH_CAPACITY CONCAT(MAP_T, _with_capacity)
+#define MAP_RESERVE CONCAT(MAP_T, _reserve)
+#define MAP_GET CONCAT(MAP_T, _get)
+#define MAP_INSERT CONCAT(MAP_T, _insert)
+#define MAP_INSERT_N CONCAT(MAP_T, _insert_n)
+#define MAP_GET_OR_INSERT CONCAT(MAP_T, _get_or_insert)
+#define MAP_REMOVE CONCAT(MAP_T, _remove)
+#define MAP_NEXT CONCAT(MAP_T, _next)
+#define MAP_CLEAR CONCAT(MAP_T, _clear)
+#define MAP_FREE CONCAT(MAP_T, _free)
+#define MAP_HASH_KEY CONCAT(MAP_T, _hash_key)
+#define MAP_KEYS_EQ CONCAT(MAP_T, _keys_eq)
+#define MAP_ALLOC_TABLE CONCAT(MAP_T, _alloc_table)
+#define MAP_PLACE CONCAT(MAP_T, _place)
+#define MAP_FIND CONCAT(MAP_T, _find)
+#define MAP_REHASH CONCAT(MAP_T, _rehash)
+
+#ifndef HASHMAP_NO_HEADERS
+typedef struct {
+  K_T key;
+  V_T value;
+} MAP_ENTRY_T;
+
+typedef struct {
+  MAP_ENTRY_T* entries;
+  // Probe distance + 1 of every slot, 0 if the slot is empty. Lives in the
+  // same allocation as entries
+  uint8_t* dists;
+  size_t length;
+  size_t capacity;  // 0 or a power of two
+} MAP_T;
+
+MAP_STATIC_PREFIX MAP_T MAP_CREATE();
+MAP_STATIC_PREFIX MAP_T MAP_WITH_CAPACITY(size_t count);
+// Makes room for count entries in total, so inserting up to it does not rehash
+MAP_STATIC_PREFIX void MAP_RESERVE(MAP_T* map, size_t count);
+// Returns null if the key is absent. The pointer is valid until the next
+// insertion or removal
+MAP_STATIC_PREFIX V_T* MAP_GET(const MAP_T* map, K_T key);
+// The map takes both. If the key was present its old value is destroyed and
+// the passed key is, returns false then
+MAP_STATIC_PREFIX bool MAP_INSERT(MAP_T* map, K_T key, V_T value);
+MAP_STATIC_PREFIX void MAP_INSERT_N(MAP_T* map, const K_T* keys,
+                                    const V_T* values, size_t count);
+// Inserts value only if the key is absent, which is what deduplication needs.
+// Otherwise the passed key and value are destroyed. inserted may be null
+MAP_STATIC_PREFIX V_T* MAP_GET_OR_INSERT(MAP_T* map, K_T key, V_T value,
+                                         bool* inserted);
+MAP_STATIC_PREFIX bool MAP_REMOVE(MAP_T* map, K_T key);
+// Iteration: start with *iter = 0, returns null after the last entry
+MAP_STATIC_PREFIX MAP_ENTRY_T* MAP_NEXT(const MAP_T* map, size_t* iter);
+MAP_STATIC_PREFIX void MAP_CLEAR(MAP_T* map);
+MAP_STATIC_PREFIX void MAP_FREE(MAP_T map);
+#endif
+
+#ifndef HASHMAP_NO_IMPLEMENTATION
+static inline uint64_t MAP_HASH_KEY(K_T key) {
+#ifdef HASHMAP_HASH
+  return hash_u64(HASHMAP_HASH(key));
+#else
+  return hash_bytes(&key, sizeof(key));
+#endif
+}
+
+static inline bool MAP_KEYS_EQ(K_T a, K_T b) {
+#ifdef HASHMAP_EQ
+  return HASHMAP_EQ(a, b);
+#else
+  return memcmp(&a, &b, sizeof(K_T)) is 0;
+#endif
+}
+
+static void MAP_ALLOC_TABLE(MAP_T* map, size_t capacity) {
+  map->entries = (MAP_ENTRY_T*)HASHMAP_MALLOC_FN(
+      (sizeof(MAP_ENTRY_T) + sizeof(uint8_t)) * capacity);
+  assert_alloc(map->entries);
+  map->dists = (uint8_t*)(map->entries + capacity);
+  memset(map->dists, 0, capacity);
+  map->capacity = capacity;
+}
+
+MAP_STATIC_PREFIX MAP_T MAP_CREATE() {
+  return (MAP_T){
+      .entries = null,
+      .dists = null,
+      .length = 0,
+      .capacity = 0,
+  };
+}
+
+MAP_STATIC_PREFIX MAP_T MAP_WITH_CAPACITY(size_t count) {
+  MAP_T map = MAP_CREATE();
+  MAP_RESERVE(&map, count);
+  return map;
+}
+
+static MAP_ENTRY_T* MAP_PLACE(MAP_T* map, MAP_ENTRY_T entry);
+
+static MAP_ENTRY_T* MAP_FIND(const MAP_T* map, K_T key) {
+  if (map->length is 0) return null;
+
+  size_t mask = map->capacity - 1;
+  size_t i = MAP_HASH_KEY(key) & mask;
+  // An entry of this key would have displaced anything closer to its home
+  for (unsigned dist = 1; map->dists[i] >= dist; dist++) {
+    if (map->dists[i] is dist and MAP_KEYS_EQ(map->entries[i].key, key))
+      return &map->entries[i];
+    i = (i + 1) & mask;
+  }
+  return null;
+}
+
+// Moves every entry to a new table of the given capacity
+static void MAP_REHASH(MAP_T* map, size_t capacity) {
+  MAP_T old = *map;
+  MAP_ALLOC_TABLE(map, capacity);
+  map->length = 0;
+
+  for (size_t i = 0; i < old.capacity; i++)
+    if (old.dists[i] is_not 0) MAP_PLACE(map, old.entries[i]);
+
+  if (old.entries) HASHMAP_FREE_FN(old.entries);
+}
+
+MAP_STATIC_PREFIX void MAP_RESERVE(MAP_T* map, size_t count) {
+  size_t capacity = map->capacity ? map->capacity : 8;
+  while (count * 8 > capacity * HASHMAP_MAX_LOAD_8THS) capacity *= 2;
+  if (capacity > map->capacity) MAP_REHASH(map, capacity);
+}
+
+// Puts an entry whose key is known to be absent, returns where it ended up
+static MAP_ENTRY_T* MAP_PLACE(MAP_T* map, MAP_ENTRY_T entry) {
+  MAP_RESERVE(map, map->length + 1);
+
+  MAP_ENTRY_T* placed = null;
+  size_t mask = map->capacity - 1;
+  size_t i = MAP_HASH_KEY(entry.key) & mask;
+  unsigned dist = 1;
+
+  while (map->dists[i] is_not 0) {
+    // Robin Hood: the entry that is further from its home keeps the slot
+    if (map->dists[i] < dist) {
+      MAP_ENTRY_T tmp_entry = map->entries[i];
+      uint8_t tmp_dist = map->dists[i];
+      map->entries[i] = entry;
+      map->dists[i] = (uint8_t)dist;
+      if (placed is null) placed = &map->entries[i];
+      entry = tmp_entry;
+      dist = tmp_dist;
+    }
+
+    i = (i + 1) & mask;
+    dist++;
+    if (dist is HASHMAP_MAX_DIST) {
+      // Growing spreads different homes apart, but cannot split keys that
+      // hash the same
+      if (map->capacity > map->length * 64)
+        panic("%s: over %d keys share a hash, HASHMAP_HASH is too weak",
+              STR(MAP_T), HASHMAP_MAX_DIST);
+
+      // The new entry may already sit in the table or still be carried
+      K_T key = placed ? placed->key : entry.key;
+      MAP_REHASH(map, map->capacity * 2);
+      MAP_PLACE(map, entry);
+      return MAP_FIND(map, key);
+    }
+  }
+
+  map->entries[i] = entry;
+  map->dists[i] = (uint8_t)dist;
+  map->length++;
+  return placed ? placed : &map->entries[i];
+}
+
+MAP_STATIC_PREFIX V_T* MAP_GET(const MAP_T* map, K_T key) {
+  MAP_ENTRY_T* entry = MAP_FIND(map, key);
+  return entry ? &entry->value : null;
+}
+
+MAP_STATIC_PREFIX bool MAP_INSERT(MAP_T* map, K_T key, V_T value) {
+  MAP_ENTRY_T* entry = MAP_FIND(map, key);
+  if (entry is null) {
+    MAP_PLACE(map, (MAP_ENTRY_T){.key = key, .value = value});
+    return true;
+  }
+
+#ifdef HASHMAP_KEY_DESTRUCTOR
+  HASHMAP_KEY_DESTRUCTOR(key);
+#endif
+#ifdef HASHMAP_VALUE_DESTRUCTOR
+  HASHMAP_VALUE_DESTRUCTOR(entry->value);
+#endif
+  entry->value = value;
+  return false;
+}
+
+MAP_STATIC_PREFIX void MAP_INSERT_N(MAP_T* map, const K_T* keys,
+                                    const V_T* values, size_t count) {
+  MAP_RESERVE(map, map->length + count);
+  for (size_t i = 0; i < count; i++) MAP_INSERT(map, keys[i], values[i]);
+}
+
+MAP_STATIC_PREFIX V_T* MAP_GET_OR_INSERT(MAP_T* map, K_T key, V_T value,
+                                         bool* inserted) {
+  MAP_ENTRY_T* entry = MAP_FIND(map, key);
+  if (inserted) *inserted = entry is null;
+
+  if (entry is null)
+    return &MAP_PLACE(map, (MAP_ENTRY_T){.key = key, .value = value})->value;
+
+#ifdef HASHMAP_KEY_DESTRUCTOR
+  HASHMAP_KEY_DESTRUCTOR(key);
+#endif
+#ifdef HASHMAP_VALUE_DESTRUCTOR
+  HASHMAP_VALUE_DESTRUCTOR(value);
+#endif
+  return &entry->value;
+}
+
+MAP_STATIC_PREFIX bool MAP_REMOVE(MAP_T* map, K_T key) {
+  MAP_ENTRY_T* entry = MAP_FIND(map, key);
+  if (entry is null) return false;
+
+#ifdef HASHMAP_KEY_DESTRUCTOR
+  HASHMAP_KEY_DESTRUCTOR(entry->key);
+#endif
+#ifdef HASHMAP_VALUE_DESTRUCTOR
+  HASHMAP_VALUE_DESTRUCTOR(entry->value);
+#endif
+
+  // Backward shift instead of tombstones: every following entry that is not
+  // at its home moves one slot closer to it
+  size_t mask = map->capacity - 1;
+  size_t i = (size_t)(entry - map->entries);
+  size_t next = (i + 1) & mask;
+  while (map->dists[next] > 1) {
+    map->entries[i] = map->entries[next];
+    map->dists[i] = map->dists[next] - 1;
+    i = next;
+    next = (next + 1) & mask;
+  }
+  map->dists[i] = 0;
+  map->length--;
+  return true;
+}
+
+MAP_STATIC_PREFIX MAP_ENTRY_T* MAP_NEXT(const MAP_T* map, size_t* iter) {
+  for (; *iter < map->capacity; (*iter)++)
+    if (map->dists[*iter] is_not 0) return &map->entries[(*iter)++];
+  return null;
+}
+
+MAP_STATIC_PREFIX void MAP_CLEAR(MAP_T* map) {
+#if defined(HASHMAP_KEY_DESTRUCTOR) || defined(HASHMAP_VALUE_DESTRUCTOR)
+  for (size_t i = 0; i < map->capacity; i++) {
+    if (map->dists[i] is 0) continue;
+#ifdef HASHMAP_KEY_DESTRUCTOR
+    HASHMAP_KEY_DESTRUCTOR(map->entries[i].key);
+#endif
+#ifdef HASHMAP_VALUE_DESTRUCTOR
+    HASHMAP_VALUE_DESTRUCTOR(map->entries[i].value);
+#endif
+  }
+#endif
+  if (map->capacity) memset(map->dists, 0, map->capacity);
+  map->length = 0;
+}
+
+MAP_STATIC_PREFIX void MAP_FREE(MAP_T map) {
+  MAP_CLEAR(&map);
+  if (map.entries) HASHMAP_FREE_FN(map.entries);
+}
+#endif
+
+#endif
+
+#undef HASHMAP_K
+#undef HASHMAP_V
+#undef HASHMAP_NAME
+#undef HASHMAP_HASH
+#undef HASHMAP_EQ
+#undef HASHMAP_KEY_DESTRUCTOR
+#undef HASHMAP_VALUE_DESTRUCTOR
+#undef HASHMAP_MAKE_STATIC
+#undef HASHMAP_NO_HEADERS
+#undef HASHMAP_NO_IMPLEMENTATION
+#undef MAP_STATIC_PREFIX
+#undef MAP_T
+#undef MAP_ENTRY_T
+#undef K_T
+#undef V_T
@@ -0,0 +1,390 @@
+#include "jobs.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "allocator.h"
+#include "prettify_c.h"
+
+#define JOBS_MAX_WORKERS 64
+#define DEQUE_INITIAL_CAPACITY 64
+// Chunks per thread when parallel_for picks the grain, so a slow chunk can be
+// balanced by stealing the others
+#define PARALLEL_FOR_CHUNKS_PER_THREAD 4
+
+typedef struct Job {
+  job_fn_t fn;
+  void* ctx;
+  JobCounter* counter;
+  AllocTag tag;
+} Job;
+
+// Ring buffer, top is the oldest job. A mutex per deque instead of a
+// lock-free Chase-Lev deque: jobs here are coarse, so the lock is never hot
+typedef struct Deque {
+  pthread_mutex_t lock;
+  Job* jobs;
+  size_t capacity;  // a power of two
+  size_t top, bottom;
+  atomic_long size;  // read without the lock to skip empty deques
+
+  atomic_long executed, steals, idle_ns;
+} Deque;
+
+typedef struct Deferred {
+  JobCounter* dependency;
+  Job job;
+} Deferred;
+
+#define VECTOR_ITEM_TYPE Deferred
+#define VECTOR_IMPLEMENTATION
+#include "vector.h"
+
+// Deques[WorkerCount] is the shared queue of threads that are not workers
+static Deque Deques[JOBS_MAX_WORKERS + 1];
+static pthread_t Workers[JOBS_MAX_WORKERS];
+static int WorkerCount = 0;
+static atomic_bool Running = false;
+static atomic_bool Stopping = false;
+
+// Sleeping workers wait for QueuedJobs to become positive
+static atomic_long QueuedJobs = 0;
+static atomic_int Sleepers = 0;
+static pthread_mutex_t SleepLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t WakeUp = PTHREAD_COND_INITIALIZER;
+
+// Jobs whose dependency has not finished yet
+static vec_Deferred DeferredJobs = {0};
+static atomic_long DeferredCount = 0;
+static pthread_mutex_t DeferredLock = PTHREAD_MUTEX_INITIALIZER;
+
+// -1 on threads that are not workers
+static _Thread_local int WorkerIndex = -1;
+static _Thread_local unsigned StealSeed = 1;
+
+static long now_ns() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int cpu_count() {
+#ifdef WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  long count = info.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return count > 0 ? (int)count : 1;
+}
+
+static void deque_init(Deque* deque) {
+  pthread_mutex_init(&deque->lock, null);
+  deque->jobs = (Job*)MALLOC(sizeof(Job) * DEQUE_INITIAL_CAPACITY);
+  assert_alloc(deque->jobs);
+  deque->capacity = DEQUE_INITIAL_CAPACITY;
+  deque->top = deque->bottom = 0;
+  atomic_store(&deque->size, 0);
+}
+
+static void deque_free(Deque* deque) {
+  pthread_mutex_destroy(&deque->lock);
+  FREE(deque->jobs);
+  deque->jobs = null;
+}
+
+static void deque_push(Deque* deque, Job job) {
+  pthread_mutex_lock(&deque->lock);
+  size_t size = deque->bottom - deque->top;
+  if (size is deque->capacity) {
+    Job* grown = (Job*)MALLOC(sizeof(Job) * deque->capacity * 2);
+    assert_alloc(grown);
+    for (size_t i = 0; i < size; i++)
+      grown[i] = deque->jobs[(deque->top + i) & (deque->capacity - 1)];
+    FREE(deque->jobs);
+    deque->jobs = grown;
+    deque->capacity *= 2;
+    deque->top = 0;
+    deque->bottom = size;
+  }
+  deque->jobs[deque->bottom++ & (deque->capacity - 1)] = job;
+  atomic_fetch_add(&deque->size, 1);
+  pthread_mutex_unlock(&deque->lock);
+}
+
+// The owner takes the newest job, thieves the oldest
+static bool deque_take(Deque* deque, bool newest, Job* job) {
+  if (atomic_load_explicit(&deque->size, memory_order_relaxed) is 0)
+    return false;
+
+  pthread_mutex_lock(&deque->lock);
+  bool found = deque->bottom is_not deque->top;
+  if (found) {
+    size_t i = newest ? --deque->bottom : deque->top++;
+    *job = deque->jobs[i & (deque->capacity - 1)];
+    atomic_fetch_sub(&deque->size, 1);
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+static bool find_job(Job* job) {
+  Deque* shared = &Deques[WorkerCount];
+  bool found = false;
+
+  if (WorkerIndex >= 0) {
+    found = deque_take(&Deques[WorkerIndex], true, job);
+  }
+  if (not found) found = deque_take(shared, false, job);
+
+  // Starts at a random victim, so thieves do not all hit the same deque
+  StealSeed = StealSeed * 1103515245u + 12345u;
+  for (int i = 0; i < WorkerCount and not found; i++) {
+    int victim = (int)((StealSeed >> 16) + i) % WorkerCount;
+    if (victim is WorkerIndex) continue;
+    found = deque_take(&Deques[victim], false, job);
+    if (found and WorkerIndex >= 0)
+      atomic_fetch_add_explicit(&Deques[WorkerIndex].steals, 1,
+                                memory_order_relaxed);
+  }
+
+  if (found) atomic_fetch_sub(&QueuedJobs, 1);
+  return found;
+}
+
+static void enqueue(Job job);
+
+static void release_dependents(JobCounter* counter) {
+  if (atomic_load(&DeferredCount) is 0) return;
+
+  pthread_mutex_lock(&DeferredLock);
+  for (size_t i = 0; i < DeferredJobs.length;) {
+    if (DeferredJobs.data[i].dependency is counter) {
+      enqueue(vec_Deferred_extract_fast(&DeferredJobs, i).job);
+      atomic_fetch_sub(&DeferredCount, 1);
+    } else {
+      i++;
+    }
+  }
+  pthread_mutex_unlock(&DeferredLock);
+}
+
+static void run_job(Job job) {
+  AllocTag old_tag = alloc_tag_set(job.tag);
+  job.fn(job.ctx);
+  alloc_tag_set(old_tag);
+
+  int stats_index = WorkerIndex >= 0 ? WorkerIndex : WorkerCount;
+  atomic_fetch_add_explicit(&Deques[stats_index].executed, 1,
+                            memory_order_relaxed);
+
+  if (job.counter and atomic_fetch_sub(&job.counter->pending, 1) is 1)
+    release_dependents(job.counter);
+}
+
+static void enqueue(Job job) {
+  if (not atomic_load(&Running)) {
+    run_job(job);
+    return;
+  }
+
+  deque_push(&Deques[WorkerIndex >= 0 ? WorkerIndex : WorkerCount], job);
+  atomic_fetch_add(&QueuedJobs, 1);
+
+  // Sleepers is raised before a worker checks QueuedJobs, so one of the two
+  // sides always sees the other
+  if (atomic_load(&Sleepers) > 0) {
+    pthread_mutex_lock(&SleepLock);
+    pthread_cond_signal(&WakeUp);
+    pthread_mutex_unlock(&SleepLock);
+  }
+}
+
+static void* worker_main(void* arg) {
+  WorkerIndex = (int)(size_t)arg;
+  StealSeed = (unsigned)WorkerIndex * 2654435761u + 1;
+  Deque* self = &Deques[WorkerIndex];
+
+  while (not atomic_load(&Stopping)) {
+    Job job;
+    if (find_job(&job)) {
+      run_job(job);
+      continue;
+    }
+
+    long idle_start = now_ns();
+    pthread_mutex_lock(&SleepLock);
+    atomic_fetch_add(&Sleepers, 1);
+    while (atomic_load(&QueuedJobs) <= 0 and not atomic_load(&Stopping))
+      pthread_cond_wait(&WakeUp, &SleepLock);
+    atomic_fetch_sub(&Sleepers, 1);
+    pthread_mutex_unlock(&SleepLock);
+    atomic_fetch_add_explicit(&self->idle_ns, now_ns() - idle_start,
+                              memory_order_relaxed);
+  }
+  return null;
+}
+
+static void stop_workers(int started) {
+  atomic_store(&Stopping, true);
+  pthread_mutex_lock(&SleepLock);
+  pthread_cond_broadcast(&WakeUp);
+  pthread_mutex_unlock(&SleepLock);
+  for (int i = 0; i < started; i++) pthread_join(Workers[i], null);
+}
+
+void jobs_init(int workers) {
+  if (atomic_load(&Running)) return;
+  if (workers < 0) workers = cpu_count() - 1;
+  if (workers > JOBS_MAX_WORKERS) workers = JOBS_MAX_WORKERS;
+
+  for (;;) {
+    WorkerCount = workers;
+    for (int i = 0; i <= WorkerCount; i++) deque_init(&Deques[i]);
+    jobs_stats_reset();
+    atomic_store(&Stopping, false);
+
+    int started = 0;
+    while (started < workers and
+           pthread_create(&Workers[started], null, worker_main, (void*)(size_t)started) is 0)
+      started++;
+    if (started is workers) break;
+
+    // Running workers read WorkerCount to find the shared queue, so it can
+    // not shrink under them. Nothing is queued yet: they are stopped and
+    // everything is set up again for as many as could start
+    debugln("jobs_init: started %d of %d workers", started, workers);
+    stop_workers(started);
+    for (int i = 0; i <= WorkerCount; i++) deque_free(&Deques[i]);
+    workers = started;
+  }
+  atomic_store(&Running, true);
+}
+
+void jobs_shutdown() {
+  if (not atomic_load(&Running)) return;
+
+  stop_workers(WorkerCount);
+
+  // Whatever is left runs inline from now on
+  atomic_store(&Running, false);
+  Job job;
+  while (find_job(&job)) run_job(job);
+
+  for (int i = 0; i <= WorkerCount; i++) deque_free(&Deques[i]);
+  vec_Deferred_free(DeferredJobs);
+  DeferredJobs = (vec_Deferred){0};
+  WorkerCount = 0;
+  atomic_store(&QueuedJobs, 0);
+}
+
+int jobs_worker_count() { return atomic_load(&Running) ? WorkerCount : 0; }
+
+void jobs_submit(job_fn_t fn, void* ctx, JobCounter* counter) {
+  if (counter) atomic_fetch_add(&counter->pending, 1);
+  enqueue((Job){.fn = fn, .ctx = ctx, .counter = counter, .tag = alloc_tag_get()});
+}
+
+void jobs_submit_after(JobCounter* dependency, job_fn_t fn, void* ctx,
+                       JobCounter* counter) {
+  if (counter) atomic_fetch_add(&counter->pending, 1);
+  Job job = {.fn = fn, .ctx = ctx, .counter = counter, .tag = alloc_tag_get()};
+
+  // Raised before pending is read: a job finishing concurrently either sees
+  // it and takes the lock, or finished before pending is read here
+  atomic_fetch_add(&DeferredCount, 1);
+  pthread_mutex_lock(&DeferredLock);
+  bool ready = atomic_load(&dependency->pending) is 0;
+  if (not ready)
+    vec_Deferred_push(&DeferredJobs, (Deferred){.dependency = dependency, .job = job});
+  pthread_mutex_unlock(&DeferredLock);
+
+  if (ready) {
+    atomic_fetch_sub(&DeferredCount, 1);
+    enqueue(job);
+  }
+}
+
+void jobs_wait(JobCounter* counter) {
+  while (atomic_load(&counter->pending) > 0) {
+    Job job;
+    if (atomic_load(&Running) and find_job(&job))
+      run_job(job);
+    else
+      sched_yield();
+  }
+}
+
+typedef struct RangeChunk {
+  job_range_fn_t fn;
+  void* ctx;
+  size_t begin, end;
+} RangeChunk;
+
+static void range_chunk_run(void* arg) {
+  RangeChunk* chunk = (RangeChunk*)arg;
+  chunk->fn(chunk->ctx, chunk->begin, chunk->end);
+}
+
+void parallel_for(size_t begin, size_t end, size_t grain, job_range_fn_t fn,
+                  void* ctx) {
+  if (end <= begin) return;
+
+  size_t count = end - begin;
+  size_t threads = (size_t)jobs_worker_count() + 1;
+  if (grain is 0) grain = count / (threads * PARALLEL_FOR_CHUNKS_PER_THREAD);
+  if (grain is 0) grain = 1;
+
+  size_t chunks_count = (count + grain - 1) / grain;
+  if (threads is 1 or chunks_count is 1) {
+    fn(ctx, begin, end);
+    return;
+  }
+
+  RangeChunk* chunks = (RangeChunk*)MALLOC(sizeof(RangeChunk) * chunks_count);
+  assert_alloc(chunks);
+  JobCounter counter = {0};
+  // The first chunk runs here, the rest are up for grabs
+  for (size_t c = chunks_count - 1; c < chunks_count; c--) {
+    chunks[c] = (RangeChunk){
+        .fn = fn,
+        .ctx = ctx,
+        .begin = begin + c * grain,
+        .end = c + 1 is chunks_count ? end : begin + (c + 1) * grain,
+    };
+    if (c > 0) jobs_submit(range_chunk_run, &chunks[c], &counter);
+  }
+  range_chunk_run(&chunks[0]);
+  jobs_wait(&counter);
+  FREE(chunks);
+}
+
+JobStats jobs_stats() {
+  JobStats stats = {.workers = jobs_worker_count()};
+  long idle_ns = 0;
+  // All of them, the counts outlive jobs_shutdown until the next jobs_init
+  for (int i = 0; i <= JOBS_MAX_WORKERS; i++) {
+    stats.jobs += atomic_load_explicit(&Deques[i].executed, memory_order_relaxed);
+    stats.steals += atomic_load_explicit(&Deques[i].steals, memory_order_relaxed);
+    idle_ns += atomic_load_explicit(&Deques[i].idle_ns, memory_order_relaxed);
+  }
+  stats.idle_secs = idle_ns * 1e-9;
+  return stats;
+}
+
+void jobs_stats_reset() {
+  for (int i = 0; i <= JOBS_MAX_WORKERS; i++) {
+    atomic_store_explicit(&Deques[i].executed, 0, memory_order_relaxed);
+    atomic_store_explicit(&Deques[i].steals, 0, memory_order_relaxed);
+    atomic_store_explicit(&Deques[i].idle_ns, 0, memory_order_relaxed);
+  }
+}
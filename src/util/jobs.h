@@ -0,0 +1,59 @@
+#ifndef SRC_UTIL_JOBS_H_
+#define SRC_UTIL_JOBS_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/**
+ * Work-stealing job system shared by the whole application. Every worker owns
+ * a deque: it pushes and pops its own jobs at the bottom, so the newest and
+ * most cache-warm job runs first, and idle workers steal the oldest jobs from
+ * the top of the others. Threads that are not workers submit to a shared
+ * queue. jobs_wait runs jobs while it waits, so waiting never deadlocks, even
+ * without workers.
+ *
+ * Before jobs_init and after jobs_shutdown every job runs inline on the
+ * submitting thread, so library code can use the system unconditionally.
+ * Jobs run with the allocation tag that was current when they were submitted.
+ */
+
+typedef void (*job_fn_t)(void* ctx);
+typedef void (*job_range_fn_t)(void* ctx, size_t begin, size_t end);
+
+// Number of submitted jobs that have not finished yet. Zero-initialize it:
+// JobCounter counter = {0};
+typedef struct JobCounter {
+  atomic_long pending;
+} JobCounter;
+
+typedef struct JobStats {
+  int workers;
+  long jobs;         // executed, by workers and by waiting threads
+  long steals;       // jobs a worker took from another worker's deque
+  double idle_secs;  // summed over workers, asleep for lack of jobs
+} JobStats;
+
+// Starts the workers. A negative count means one per CPU but the calling one
+void jobs_init(int workers);
+// Waits for the workers to exit. Submitted jobs must have been waited for
+void jobs_shutdown();
+int jobs_worker_count();
+
+// counter may be null if nobody waits for the job
+void jobs_submit(job_fn_t fn, void* ctx, JobCounter* counter);
+// Queues the job once dependency drops to zero, counter counts it right away
+void jobs_submit_after(JobCounter* dependency, job_fn_t fn, void* ctx,
+                       JobCounter* counter);
+// Runs queued jobs until counter drops to zero
+void jobs_wait(JobCounter* counter);
+
+// Calls fn on consecutive chunks of [begin, end) of at least grain indices,
+// in parallel, and returns when all of them are done. grain 0 picks a few
+// chunks per thread
+void parallel_for(size_t begin, size_t end, size_t grain, job_range_fn_t fn,
+                  void* ctx);
+
+JobStats jobs_stats();
+void jobs_stats_reset();
+
+#endif  // SRC_UTIL_JOBS_H_
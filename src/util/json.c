@@ -0,0 +1,188 @@
+#include "json.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prettify_c.h"
+
+#define VECTOR_C JsonToken
+#include "vector.h"
+
+// Deeper documents are refused, so a hostile file can not exhaust the stack
+#define JSON_MAX_DEPTH 64
+#define JSON_NUMBER_MAX 64
+
+typedef struct JsonParser {
+  const char* text;
+  int position, length;
+  vec_JsonToken* tokens;
+} JsonParser;
+
+static bool parse_value(JsonParser* p, int depth);
+
+static void skip_spaces(JsonParser* p) {
+  while (p->position < p->length) {
+    char c = p->text[p->position];
+    if (c is_not ' ' and c is_not '\t' and c is_not '\n' and c is_not '\r') break;
+    p->position++;
+  }
+}
+
+static char peek(JsonParser* p) {
+  return p->position < p->length ? p->text[p->position] : '\0';
+}
+
+static int push_token(JsonParser* p, JsonType type, int start, int length) {
+  JsonToken token = {.type = type, .start = start, .length = length, .children = 0, .next = 0};
+  vec_JsonToken_push(p->tokens, token);
+  return (int)p->tokens->length - 1;
+}
+
+static bool parse_string(JsonParser* p) {
+  int start = ++p->position;
+  for (; p->position < p->length; p->position++) {
+    char c = p->text[p->position];
+    if (c is '\\') {
+      p->position++;
+    } else if (c is '"') {
+      int index = push_token(p, JSON_STRING, start, p->position - start);
+      p->tokens->data[index].next = index + 1;
+      p->position++;
+      return true;
+    } else if ((unsigned char)c < 0x20) {
+      return false;
+    }
+  }
+  return false;
+}
+
+static bool parse_literal(JsonParser* p, const char* literal, JsonType type) {
+  int length = (int)strlen(literal);
+  if (p->length - p->position < length or memcmp(p->text + p->position, literal, length) is_not 0) return false;
+  int index = push_token(p, type, p->position, length);
+  p->tokens->data[index].next = index + 1;
+  p->position += length;
+  return true;
+}
+
+static bool parse_number(JsonParser* p) {
+  int start = p->position;
+  while (p->position < p->length and p->text[p->position] and strchr("+-.eE0123456789", p->text[p->position]))
+    p->position++;
+  if (p->position is start) return false;
+  int index = push_token(p, JSON_NUMBER, start, p->position - start);
+  p->tokens->data[index].next = index + 1;
+  return true;
+}
+
+// Arrays and objects: items, or key: value pairs, between open and close
+static bool parse_compound(JsonParser* p, int depth, bool is_object) {
+  if (depth >= JSON_MAX_DEPTH) return false;
+  char close = is_object ? '}' : ']';
+  int index = push_token(p, is_object ? JSON_OBJECT : JSON_ARRAY, p->position, 0);
+  p->position++;
+
+  skip_spaces(p);
+  if (peek(p) is close) {
+    p->position++;
+  } else {
+    for (;;) {
+      if (is_object) {
+        skip_spaces(p);
+        if (peek(p) is_not '"' or not parse_string(p)) return false;
+        skip_spaces(p);
+        if (peek(p) is_not ':') return false;
+        p->position++;
+      }
+      if (not parse_value(p, depth + 1)) return false;
+      p->tokens->data[index].children++;
+
+      skip_spaces(p);
+      char c = peek(p);
+      p->position++;
+      if (c is close) break;
+      if (c is_not ',') return false;
+    }
+  }
+
+  JsonToken* token = &p->tokens->data[index];
+  token->length = p->position - token->start;
+  token->next = (int)p->tokens->length;
+  return true;
+}
+
+static bool parse_value(JsonParser* p, int depth) {
+  skip_spaces(p);
+  switch (peek(p)) {
+    case '{': return parse_compound(p, depth, true);
+    case '[': return parse_compound(p, depth, false);
+    case '"': return parse_string(p);
+    case 't': return parse_literal(p, "true", JSON_BOOL);
+    case 'f': return parse_literal(p, "false", JSON_BOOL);
+    case 'n': return parse_literal(p, "null", JSON_NULL);
+    default: return parse_number(p);
+  }
+}
+
+bool json_parse(const char* text, size_t length, Json* out) {
+  *out = (Json) {.text = text, .tokens = vec_JsonToken_create()};
+  JsonParser parser = {.text = text, .position = 0, .length = (int)length, .tokens = &out->tokens};
+  bool ok = length < (size_t)INT_MAX and parse_value(&parser, 0);
+  skip_spaces(&parser);
+  // glTF pads its JSON chunk with spaces, a NUL ends a C string early
+  ok = ok and (parser.position is parser.length or text[parser.position] is '\0');
+  if (not ok) out->tokens.length = 0;
+  return ok;
+}
+
+void json_free(Json json) {
+  vec_JsonToken_free(json.tokens);
+}
+
+int json_get(const Json* json, int object, const char* key) {
+  if (object < 0 or json->tokens.data[object].type is_not JSON_OBJECT) return -1;
+  int token = object + 1;
+  for (int i = 0; i < json->tokens.data[object].children; i++) {
+    if (json_string_is(json, token, key)) return token + 1;
+    token = json->tokens.data[token + 1].next;
+  }
+  return -1;
+}
+
+int json_at(const Json* json, int array, int i) {
+  if (array < 0 or json->tokens.data[array].type is_not JSON_ARRAY) return -1;
+  if (i < 0 or i >= json->tokens.data[array].children) return -1;
+  int token = array + 1;
+  while (i-- > 0) token = json->tokens.data[token].next;
+  return token;
+}
+
+int json_length(const Json* json, int array) {
+  if (array < 0 or json->tokens.data[array].type is_not JSON_ARRAY) return 0;
+  return json->tokens.data[array].children;
+}
+
+double json_number(const Json* json, int token, double fallback) {
+  if (token < 0 or json->tokens.data[token].type is_not JSON_NUMBER) return fallback;
+  // The text is not terminated after the number
+  char buffer[JSON_NUMBER_MAX];
+  const JsonToken* t = &json->tokens.data[token];
+  if (t->length >= JSON_NUMBER_MAX) return fallback;
+  memcpy(buffer, json->text + t->start, t->length);
+  buffer[t->length] = '\0';
+  char* end;
+  double value = strtod(buffer, &end);
+  return *end is '\0' ? value : fallback;
+}
+
+bool json_bool(const Json* json, int token, bool fallback) {
+  if (token < 0 or json->tokens.data[token].type is_not JSON_BOOL) return fallback;
+  return json->text[json->tokens.data[token].start] is 't';
+}
+
+bool json_string_is(const Json* json, int token, const char* text) {
+  if (token < 0 or json->tokens.data[token].type is_not JSON_STRING) return false;
+  const JsonToken* t = &json->tokens.data[token];
+  return strlen(text) is (size_t)t->length and memcmp(json->text + t->start, text, t->length) is 0;
+}
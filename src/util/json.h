@@ -0,0 +1,55 @@
+#ifndef SRC_UTIL_JSON_H_
+#define SRC_UTIL_JSON_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Minimal JSON reader: the text is split into tokens in document order and
+ * values are looked up in place, nothing is copied or unescaped. Enough for
+ * file headers like glTF, not for editing documents.
+ */
+
+typedef enum JsonType {
+  JSON_NULL,
+  JSON_BOOL,
+  JSON_NUMBER,
+  JSON_STRING,
+  JSON_ARRAY,
+  JSON_OBJECT,
+} JsonType;
+
+typedef struct JsonToken {
+  JsonType type;
+  int start, length;  // in the text, a string without its quotes
+  int children;       // items of an array, keys of an object
+  int next;           // the token after this value and everything in it
+} JsonToken;
+
+#define VECTOR_H JsonToken
+#include "vector.h"  // vec_JsonToken
+
+typedef struct Json {
+  const char* text;  // borrowed
+  vec_JsonToken tokens;  // 0 is the root, an object's keys precede their values
+} Json;
+
+// False, with no tokens, if the text is not one valid JSON value
+bool json_parse(const char* text, size_t length, Json* out);
+void json_free(Json json);
+
+// Token of the value of key in the object, -1 if it is absent or object is
+// not an object. Every function takes -1 and gives -1 back, so lookups chain
+int json_get(const Json* json, int object, const char* key);
+// Token of item i of the array, -1 if out of range
+int json_at(const Json* json, int array, int i);
+int json_length(const Json* json, int array);
+
+// fallback if the token is not a number
+double json_number(const Json* json, int token, double fallback);
+// fallback if the token is not true or false
+bool json_bool(const Json* json, int token, bool fallback);
+// A string token equal to the text, compared without unescaping
+bool json_string_is(const Json* json, int token, const char* text);
+
+#endif  // SRC_UTIL_JSON_H_
@@ -0,0 +1,240 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "logger.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "better_io.h"
+#include "better_string.h"
+#include "prettify_c.h"
+
+// How long the flush thread sleeps when the ring is empty
+#define LOG_FLUSH_INTERVAL_NS 5000000L
+
+static const char* const LEVEL_NAMES[] = {"LOG", "INFO", "WARN", "ERROR"};
+
+// A bounded multi-producer queue: a record is free for the producer that
+// claims position pos when its sequence is pos, and holds a message for the
+// consumer when it is pos + 1
+typedef struct LogRecord {
+  atomic_size_t sequence;
+  size_t length;
+  char text[LOG_RECORD_SIZE];
+} LogRecord;
+
+static LogRecord Ring[LOG_RING_RECORDS];
+static atomic_size_t EnqueuePos = 0;
+// Owned by whoever holds ConsumerBusy
+static size_t DequeuePos = 0;
+static long ReportedDrops = 0;
+static atomic_flag ConsumerBusy = ATOMIC_FLAG_INIT;
+
+static atomic_bool Running = false;
+static atomic_bool Stopping = false;
+static atomic_long Dropped = 0;
+static FILE* Out = null;
+static pthread_t FlushThread;
+
+// OutStream into a fixed buffer that silently cuts what does not fit
+typedef struct LineStream {
+  char* data;
+  size_t length, capacity;
+  bool truncated;
+} LineStream;
+
+static int line_put_slice(LineStream* this, const char* str, size_t length) {
+  size_t space = this->capacity - this->length;
+  if (length > space) {
+    length = space;
+    this->truncated = true;
+  }
+  memcpy(this->data + this->length, str, length);
+  this->length += length;
+  return this->truncated ? EOF : '\n';
+}
+static int line_putc(LineStream* this, int c) {
+  char ch = (char)c;
+  return line_put_slice(this, &ch, 1) is EOF ? EOF : c;
+}
+static int line_puts(LineStream* this, const char* str) {
+  return line_put_slice(this, str, strlen(str));
+}
+static size_t line_available_size(LineStream* this) {
+  return this->capacity - this->length;
+}
+static str_t line_description(LineStream* this) {
+  unused(this);
+  return str_literal("LineStream");
+}
+
+static OutStream outstream_from_line(LineStream* line) {
+  static const OutStreamVtable LINE_VTABLE = {
+      .putc = (void*)line_putc,
+      .puts = (void*)line_puts,
+      .put_slice = (void*)line_put_slice,
+      .get_available_size = (void*)line_available_size,
+      .description = (void*)line_description};
+
+  return (OutStream){.data = line, .vtable = &LINE_VTABLE};
+}
+
+static bool ring_push(const char* text, size_t length) {
+  size_t pos = atomic_load_explicit(&EnqueuePos, memory_order_relaxed);
+  LogRecord* record;
+  for (;;) {
+    record = &Ring[pos % LOG_RING_RECORDS];
+    size_t sequence =
+        atomic_load_explicit(&record->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if (diff is 0) {
+      if (atomic_compare_exchange_weak_explicit(&EnqueuePos, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;  // the consumer is a whole ring behind
+    } else {
+      pos = atomic_load_explicit(&EnqueuePos, memory_order_relaxed);
+    }
+  }
+
+  memcpy(record->text, text, length);
+  record->length = length;
+  atomic_store_explicit(&record->sequence, pos + 1, memory_order_release);
+  return true;
+}
+
+// Writes out published records. Returns how many, 0 when the ring is empty
+static size_t ring_drain() {
+  size_t written = 0;
+  for (;;) {
+    LogRecord* record = &Ring[DequeuePos % LOG_RING_RECORDS];
+    size_t sequence =
+        atomic_load_explicit(&record->sequence, memory_order_acquire);
+    if (sequence is_not DequeuePos + 1) break;
+
+    fwrite(record->text, 1, record->length, Out);
+    atomic_store_explicit(&record->sequence, DequeuePos + LOG_RING_RECORDS,
+                          memory_order_release);
+    DequeuePos++;
+    written++;
+  }
+
+  long drops = atomic_load(&Dropped);
+  if (drops is_not ReportedDrops) {
+    fprintf(Out, "LOG: %ld messages dropped, the log is written too slowly\n",
+            drops - ReportedDrops);
+    ReportedDrops = drops;
+    fflush(Out);
+  } else if (written) {
+    fflush(Out);
+  }
+  return written;
+}
+
+void logger_flush() {
+  if (not atomic_load(&Running)) return;
+
+  while (atomic_flag_test_and_set_explicit(&ConsumerBusy, memory_order_acquire))
+    sched_yield();
+  ring_drain();
+  fflush(Out);
+  atomic_flag_clear_explicit(&ConsumerBusy, memory_order_release);
+}
+
+static void* flush_main(void* arg) {
+  unused(arg);
+  struct timespec interval = {0, LOG_FLUSH_INTERVAL_NS};
+
+  while (not atomic_load(&Stopping)) {
+    size_t written = 0;
+    if (not atomic_flag_test_and_set_explicit(&ConsumerBusy,
+                                              memory_order_acquire)) {
+      written = ring_drain();
+      atomic_flag_clear_explicit(&ConsumerBusy, memory_order_release);
+    }
+    if (written is 0) nanosleep(&interval, null);
+  }
+  return null;
+}
+
+void logger_init(FILE* out) {
+  static bool at_exit_registered = false;
+  if (atomic_load(&Running)) return;
+
+  Out = out ? out : stdout;
+  for (size_t i = 0; i < LOG_RING_RECORDS; i++)
+    atomic_store_explicit(&Ring[i].sequence, i, memory_order_relaxed);
+  atomic_store(&EnqueuePos, 0);
+  DequeuePos = 0;
+  atomic_store(&Dropped, 0);
+  ReportedDrops = 0;
+  atomic_store(&Stopping, false);
+
+  if (pthread_create(&FlushThread, null, flush_main, null) is_not 0) {
+    // Stays synchronous
+    fprintf(Out, "LOG: failed to start the flush thread\n");
+    return;
+  }
+  atomic_store(&Running, true);
+
+  // panic and other exit() calls must not lose what is queued
+  if (not at_exit_registered) {
+    atexit(logger_flush);
+    at_exit_registered = true;
+  }
+}
+
+void logger_shutdown() {
+  if (not atomic_load(&Running)) return;
+
+  atomic_store(&Stopping, true);
+  pthread_join(FlushThread, null);
+  logger_flush();
+  atomic_store(&Running, false);
+  Out = null;
+}
+
+long logger_dropped() { return atomic_load(&Dropped); }
+
+static void put_message(OutStream stream, int level, const char* file,
+                        int line, const char* format, VaListWrap list) {
+  if (file) x_sprintf(stream, "%s (%s:%d): ", LEVEL_NAMES[level], file, line);
+  x_vprintf(stream, format, list);
+}
+
+void log_write(int level, const char* file, int line, bool newline,
+               const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  VaListWrap wrap;
+  va_copy(wrap.list, args);
+
+  if (not atomic_load_explicit(&Running, memory_order_relaxed)) {
+    OutStream stream = outstream_from_file(Out ? Out : stdout);
+    put_message(stream, level, file, line, format, wrap);
+    if (newline) outstream_putc('\n', stream);
+  } else {
+    // Room for the "..." that marks a cut message and for the newline
+    char text[LOG_RECORD_SIZE];
+    LineStream buffer = {.data = text, .capacity = LOG_RECORD_SIZE - 4};
+    put_message(outstream_from_line(&buffer), level, file, line, format, wrap);
+    if (buffer.truncated) {
+      memcpy(text + buffer.length, "...", 3);
+      buffer.length += 3;
+    }
+    if (newline) text[buffer.length++] = '\n';
+
+    if (not ring_push(text, buffer.length))
+      atomic_fetch_add_explicit(&Dropped, 1, memory_order_relaxed);
+  }
+
+  va_end(wrap.list);
+  va_end(args);
+}
@@ -0,0 +1,72 @@
+#ifndef SRC_UTIL_LOGGER_H_
+#define SRC_UTIL_LOGGER_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * Asynchronous logger. Threads format their message on their own stack and
+ * put it into a lock-free ring of fixed-size records; a background thread
+ * writes the records out, so a slow stdout never blocks the caller. When the
+ * ring is full the message is dropped and counted instead of waiting.
+ *
+ * Before logger_init and after logger_shutdown messages are written right
+ * away on the calling thread, so tests and tools need no setup.
+ */
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+// Messages below this level are compiled out, e.g. -DLOG_MIN_LEVEL=2
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Longer messages are cut
+#define LOG_RECORD_SIZE 512
+#define LOG_RING_RECORDS 256
+
+// out may be null for stdout. Drains the ring at exit() too
+void logger_init(FILE* out);
+// Writes out everything queued and stops the flush thread
+void logger_shutdown();
+// Writes out everything queued so far from the calling thread
+void logger_flush();
+// Messages lost to a full ring since logger_init
+long logger_dropped();
+
+// file may be null to skip the "LEVEL (file:line): " prefix
+void log_write(int level, const char* file, int line, bool newline,
+               const char* format, ...);
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define log_debug(...) \
+  log_write(LOG_LEVEL_DEBUG, __FILE__, __LINE__, true, __VA_ARGS__)
+#else
+#define log_debug(...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define log_info(...) \
+  log_write(LOG_LEVEL_INFO, __FILE__, __LINE__, true, __VA_ARGS__)
+#else
+#define log_info(...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define log_warn(...) \
+  log_write(LOG_LEVEL_WARN, __FILE__, __LINE__, true, __VA_ARGS__)
+#else
+#define log_warn(...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define log_error(...) \
+  log_write(LOG_LEVEL_ERROR, __FILE__, __LINE__, true, __VA_ARGS__)
+#else
+#define log_error(...)
+#endif
+
+#endif  // SRC_UTIL_LOGGER_H_
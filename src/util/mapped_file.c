@@ -0,0 +1,72 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mapped_file.h"
+
+#include <stdio.h>
+
+#include "allocator.h"
+#include "prettify_c.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP
+#endif
+
+static bool read_whole_file(const char* path, MappedFile* out) {
+  FILE* file = fopen(path, "rb");
+  if (file is null) return false;
+
+  bool ok = fseek(file, 0, SEEK_END) is 0;
+  long size = ok ? ftell(file) : -1;
+  ok = size >= 0 and fseek(file, 0, SEEK_SET) is 0;
+  char* data = null;
+  if (ok and size > 0) {
+    data = (char*)MALLOC((size_t)size);
+    assert_alloc(data);
+    ok = fread(data, 1, (size_t)size, file) is (size_t)size;
+    if (not ok) FREE(data);
+  }
+  fclose(file);
+
+  if (ok) *out = (MappedFile){.data = data, .size = (size_t)size};
+  return ok;
+}
+
+bool mapped_file_open(const char* path, MappedFile* out) {
+#ifdef MAPPED_FILE_MMAP
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+
+  // A directory or a pipe has no size to read, only a file that mmap
+  // refuses is read into memory instead
+  struct stat st;
+  if (fstat(fd, &st) is_not 0 or not S_ISREG(st.st_mode)) {
+    close(fd);
+    return false;
+  }
+  bool ok = true;
+  if (st.st_size is 0) {
+    *out = (MappedFile){0};
+  } else {
+    void* data = mmap(null, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ok = data is_not MAP_FAILED;
+    if (ok)
+      *out = (MappedFile){
+          .data = data, .size = (size_t)st.st_size, .is_mapped = true};
+  }
+  close(fd);  // the mapping stays valid
+  if (ok) return true;
+#endif
+  return read_whole_file(path, out);
+}
+
+void mapped_file_close(MappedFile* file) {
+#ifdef MAPPED_FILE_MMAP
+  if (file->is_mapped) munmap((void*)file->data, file->size);
+#endif
+  if (not file->is_mapped and file->data) FREE((void*)file->data);
+  *file = (MappedFile){0};
+}
@@ -0,0 +1,23 @@
+#ifndef SRC_UTIL_MAPPED_FILE_H_
+#define SRC_UTIL_MAPPED_FILE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Read-only view of a whole file. On POSIX systems the file is mapped, so
+ * opening costs the same for any size and pages are read in on first touch;
+ * elsewhere it is read into memory. data is aligned for any type either way.
+ */
+typedef struct MappedFile {
+  const char* data;
+  size_t size;
+  bool is_mapped;
+} MappedFile;
+
+// False if the file can not be opened or is not a regular file. An empty
+// file gives data == null
+bool mapped_file_open(const char* path, MappedFile* out);
+void mapped_file_close(MappedFile* file);
+
+#endif  // SRC_UTIL_MAPPED_FILE_H_
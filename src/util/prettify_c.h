@@ -5,6 +5,7 @@
 #include <stdlib.h>
 
 #include "better_io.h"
+#include "logger.h"
 
 #define and &&
 #define or ||
@@ -16,8 +17,10 @@
 
 #define unreachable() __builtin_unreachable()
 
+// Writes out the queued log first, so the panic message comes last
 #define panic(...)                                                          \
   {                                                                         \
+    logger_flush();                                                         \
     OutStream err_stream = outstream_stderr();                              \
     x_sprintf(err_stream, "\n+-+-+-+-+-+-+-+-+-+-\n");                      \
     x_sprintf(err_stream, "Panic in file %s:%d, function %s: \n", __FILE__, \
@@ -36,21 +39,23 @@ void debug_push();
 void debug_pop();
 void debug_print_tabs();
 
-#define debugln(...)                                           \
-  {                                                            \
-    debug_print_tabs();                                        \
-    x_sprintf(DEBUG_OUT, "LOG (%s:%d): ", __FILE__, __LINE__); \
-    x_sprintf(DEBUG_OUT, __VA_ARGS__);                         \
-    x_sprintf(DEBUG_OUT, "\n");                                \
-  }
-#define debug(...)                                             \
-  {                                                            \
-    debug_print_tabs();                                        \
-    x_sprintf(DEBUG_OUT, "LOG (%s:%d): ", __FILE__, __LINE__); \
-    x_sprintf(DEBUG_OUT, __VA_ARGS__);                         \
-  }
+// Debug output goes through the asynchronous logger and is compiled out
+// with LOG_MIN_LEVEL above LOG_LEVEL_DEBUG
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define debugln(...) \
+  { log_write(LOG_LEVEL_DEBUG, __FILE__, __LINE__, true, __VA_ARGS__); }
+#define debug(...) \
+  { log_write(LOG_LEVEL_DEBUG, __FILE__, __LINE__, false, __VA_ARGS__); }
+#define debugc(...) \
+  { log_write(LOG_LEVEL_DEBUG, null, 0, false, __VA_ARGS__); }
+#else
+#define debugln(...) \
+  {}
+#define debug(...) \
+  {}
 #define debugc(...) \
-  { x_sprintf(DEBUG_OUT, __VA_ARGS__); }
+  {}
+#endif
 
 #define assert_alloc(ptr) \
   if (ptr is null) panic("Failed to allocate memory");
@@ -75,14 +80,15 @@ void debug_print_tabs();
 
 #define foreach_extract(item, vec, condition, code)                           \
   {                                                                           \
-    int i;                                                                    \
+    __typeof__((vec).length) i;                                               \
     for (i = 0; i < (vec).length and (condition); i++) {                      \
       item = (vec).data[i];                                                   \
       code;                                                                   \
     }                                                                         \
                                                                               \
     (vec).length -= i;                                                        \
-    for (int j = 0; j < (vec).length; j++) (vec).data[j] = (vec).data[j + i]; \
+    for (__typeof__(i) j = 0; j < (vec).length; j++)                         \
+      (vec).data[j] = (vec).data[j + i];                                      \
   }
 
 #endif  // SRC_PRETTIFY_C_H_
\ No newline at end of file
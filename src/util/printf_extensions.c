@@ -1,6 +1,7 @@
 #include <string.h>
 
 #include "better_io.h"
+#include "better_io/fmt_number.h"
 #include "better_string.h"
 
 #include "../obj_parser/obj_parser.h"
@@ -16,16 +17,27 @@ static void printer_matrix_t(OutStream stream, VaListWrap* list,
                               int* total_written);
 static void printer_face(OutStream stream, VaListWrap* list,
                               int* total_written);
+static void printer_float(OutStream stream, VaListWrap* list,
+                          int* total_written);
+static void printer_double(OutStream stream, VaListWrap* list,
+                           int* total_written);
 
+// %$float and %$double print the shortest text that reads back to the same
+// value. %$float takes a float, promoted to double like for %f
 #define FORMATS \
-  { "$printable", "$matrix_t", "$slice", "$face" }
-#define PRINTERS \
-  { printer_printable, printer_matrix_t, printer_slice, printer_face}
+  { "$printable", "$matrix_t", "$slice", "$face", "$float", "$double" }
+#define PRINTERS                                                      \
+  {                                                                   \
+    printer_printable, printer_matrix_t, printer_slice, printer_face, \
+        printer_float, printer_double                                 \
+  }
 
 int x_printf_ext_fmt_length(const char* format) {
   if (format[0] is '\0') return 0;
 
   format++;
+  // Every extension starts with $, no need to compare plain formats
+  if (format[0] is_not '$') return 0;
 
   const char* const formats[] = FORMATS;
   for (int i = 0; i < (int)LEN(formats); i++) {
@@ -82,3 +94,19 @@ static void printer_face(OutStream stream, VaListWrap* list,
   face_print(&val, stream);
   (*total_written) += 5;  // TODO
 }
+
+static void printer_float(OutStream stream, VaListWrap* list,
+                          int* total_written) {
+  char text[FMT_NUMBER_MAX];
+  int length = fmt_float_shortest(text, (float)va_arg(list->list, double));
+  outstream_put_slice(text, length, stream);
+  (*total_written) += length;
+}
+
+static void printer_double(OutStream stream, VaListWrap* list,
+                           int* total_written) {
+  char text[FMT_NUMBER_MAX];
+  int length = fmt_double_shortest(text, va_arg(list->list, double));
+  outstream_put_slice(text, length, stream);
+  (*total_written) += length;
+}
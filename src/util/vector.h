@@ -11,6 +11,11 @@
 // input macro: VECTOR_MAKE_STATIC - define to make all functions static
 // input macro: DEBUG
 // input macro: VECTOR_NO_HEADERS
+// input macro: VECTOR_INT_SIZES - define before the first include to get the
+// old int length and capacity instead of size_t
+// input macro: VECTOR_HUGE_ALLOC - back this vector with huge_malloc from
+// allocator.h (include it first), for arrays that may grow to gigabytes.
+// Overrides the *_FN macros for this vector only
 
 // input macto: VECTOR_ITEM_CLONE
 
@@ -39,6 +44,21 @@
 #define VECTOR_FREE_FN free
 #endif
 
+#ifdef VECTOR_HUGE_ALLOC
+#ifndef SRC_UTIL_ALLOCATOR_H_
+#error VECTOR_HUGE_ALLOC needs allocator.h to be included before vector.h
+#endif
+#define VEC_MALLOC_FN huge_malloc
+#define VEC_REALLOC_FN huge_realloc
+#define VEC_FREE_FN huge_free
+#else
+#define VEC_MALLOC_FN VECTOR_MALLOC_FN
+#ifdef VECTOR_REALLOC_FN
+#define VEC_REALLOC_FN VECTOR_REALLOC_FN
+#endif
+#define VEC_FREE_FN VECTOR_FREE_FN
+#endif
+
 #ifdef VECTOR_MAKE_STATIC
 #define VEC_STATIC_PREFIX static
 #else
@@ -48,6 +68,15 @@
 
 #include "prettify_c.h"
 
+#ifndef VECTOR_SIZE_T_DEFINED
+#define VECTOR_SIZE_T_DEFINED
+#ifdef VECTOR_INT_SIZES
+typedef int vec_size_t;
+#else
+typedef size_t vec_size_t;
+#endif
+#endif
+
 #ifdef VECTOR_H
 #define VEC_T CONCAT(vec_, VECTOR_H)
 #define ITEM_T VECTOR_H
@@ -64,8 +93,8 @@
 #ifndef VECTOR_NO_HEADERS
 typedef struct {
   VECTOR_ITEM_TYPE* data;
-  int length;
-  int capacity;
+  vec_size_t length;
+  vec_size_t capacity;
 } VEC_T;
 #endif
 
@@ -76,6 +105,11 @@ typedef struct {
 #define VEC_CLONE CONCAT(VEC_T, _clone)
 #define VEC_FROM_RAW CONCAT(VEC_T, _from_raw)
 #define VEC_PUSH CONCAT(VEC_T, _push)
+#define VEC_PUSH_N CONCAT(VEC_T, _push_n)
+#define VEC_RESERVE CONCAT(VEC_T, _reserve)
+#define VEC_RESIZE_UNINIT CONCAT(VEC_T, _resize_uninit)
+#define VEC_SHRINK_TO_FIT CONCAT(VEC_T, _shrink_to_fit)
+#define VEC_GROW_TO CONCAT(VEC_T, _grow_to)
 #define VEC_INSERT CONCAT(VEC_T, _insert)
 #define VEC_POPGET CONCAT(VEC_T, _popget)
 #define VEC_POPFREE CONCAT(VEC_T, _popfree)
@@ -90,20 +124,27 @@ typedef struct {
 // Function declarations
 #ifndef VECTOR_NO_HEADERS
 VEC_STATIC_PREFIX VEC_T VEC_CREATE();
-VEC_STATIC_PREFIX VEC_T VEC_WITH_CAPACITY(int cap);
-VEC_STATIC_PREFIX VEC_T VEC_CREATE_COPY(const ITEM_T* source, int length);
+VEC_STATIC_PREFIX VEC_T VEC_WITH_CAPACITY(vec_size_t cap);
+VEC_STATIC_PREFIX VEC_T VEC_CREATE_COPY(const ITEM_T* source, vec_size_t length);
 VEC_STATIC_PREFIX VEC_T VEC_CLONE(const VEC_T* source);
-VEC_STATIC_PREFIX VEC_T VEC_FROM_RAW(ITEM_T* source, int length);
+VEC_STATIC_PREFIX VEC_T VEC_FROM_RAW(ITEM_T* source, vec_size_t length);
 VEC_STATIC_PREFIX void VEC_PUSH(VEC_T* vec, ITEM_T item);
-VEC_STATIC_PREFIX void VEC_INSERT(VEC_T* vec, ITEM_T item, int index);
+// Appends count items with one memcpy, items are not cloned
+VEC_STATIC_PREFIX void VEC_PUSH_N(VEC_T* vec, const ITEM_T* items, vec_size_t count);
+// Makes room for at least cap items, so pushes up to it do not reallocate
+VEC_STATIC_PREFIX void VEC_RESERVE(VEC_T* vec, vec_size_t cap);
+// Sets the length, new items are left uninitialized for the caller to fill
+VEC_STATIC_PREFIX void VEC_RESIZE_UNINIT(VEC_T* vec, vec_size_t length);
+VEC_STATIC_PREFIX void VEC_SHRINK_TO_FIT(VEC_T* vec);
+VEC_STATIC_PREFIX void VEC_INSERT(VEC_T* vec, ITEM_T item, vec_size_t index);
 VEC_STATIC_PREFIX ITEM_T VEC_POPGET(VEC_T* vec);
 VEC_STATIC_PREFIX void VEC_POPFREE(VEC_T* vec);
-VEC_STATIC_PREFIX ITEM_T VEC_AT(VEC_T* vec, int i);
-VEC_STATIC_PREFIX ITEM_T* VEC_ATREF(VEC_T* vec, int i);
-VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_FAST(VEC_T* vec, int i);
-VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_ORDER(VEC_T* vec, int i);
-VEC_STATIC_PREFIX void VEC_DELETE_FAST(VEC_T* vec, int i);
-VEC_STATIC_PREFIX void VEC_DELETE_ORDER(VEC_T* vec, int i);
+VEC_STATIC_PREFIX ITEM_T VEC_AT(VEC_T* vec, vec_size_t i);
+VEC_STATIC_PREFIX ITEM_T* VEC_ATREF(VEC_T* vec, vec_size_t i);
+VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_FAST(VEC_T* vec, vec_size_t i);
+VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_ORDER(VEC_T* vec, vec_size_t i);
+VEC_STATIC_PREFIX void VEC_DELETE_FAST(VEC_T* vec, vec_size_t i);
+VEC_STATIC_PREFIX void VEC_DELETE_ORDER(VEC_T* vec, vec_size_t i);
 VEC_STATIC_PREFIX void VEC_FREE(VEC_T v);
 #endif
 
@@ -117,15 +158,15 @@ VEC_STATIC_PREFIX VEC_T VEC_CREATE() {
   };
 }
 
-VEC_STATIC_PREFIX VEC_T VEC_WITH_CAPACITY(int cap) {
+VEC_STATIC_PREFIX VEC_T VEC_WITH_CAPACITY(vec_size_t cap) {
   if (cap is 0)
     return VEC_CREATE();
-  else if (cap < 0)
-    panic("Cannot create vector with negative capacity (%d)", cap);
+  else if ((long long)cap < 0)
+    panic("Cannot create vector with negative capacity (%lld)", (long long)cap);
 
   VEC_T result;
 
-  result.data = (ITEM_T*)VECTOR_MALLOC_FN(sizeof(ITEM_T) * cap);
+  result.data = (ITEM_T*)VEC_MALLOC_FN(sizeof(ITEM_T) * cap);
   assert_alloc(result.data);
   result.length = 0;
   result.capacity = cap;
@@ -133,12 +174,12 @@ VEC_STATIC_PREFIX VEC_T VEC_WITH_CAPACITY(int cap) {
   return result;
 }
 
-VEC_STATIC_PREFIX VEC_T VEC_CREATE_COPY(const ITEM_T* source, int length) {
+VEC_STATIC_PREFIX VEC_T VEC_CREATE_COPY(const ITEM_T* source, vec_size_t length) {
   VEC_T result;
 
-  result.data = (ITEM_T*)VECTOR_MALLOC_FN(sizeof(ITEM_T) * length);
+  result.data = (ITEM_T*)VEC_MALLOC_FN(sizeof(ITEM_T) * length);
 #ifdef VECTOR_ITEM_CLONE
-  for (int i = 0; i < length; i++) {
+  for (vec_size_t i = 0; i < length; i++) {
     result.data[i] = VECTOR_ITEM_CLONE(&source[i]);
   }
 #else
@@ -154,7 +195,7 @@ VEC_STATIC_PREFIX VEC_T VEC_CLONE(const VEC_T* source) {
   return VEC_CREATE_COPY(source->data, source->length);
 }
 
-VEC_STATIC_PREFIX VEC_T VEC_FROM_RAW(ITEM_T* source, int length) {
+VEC_STATIC_PREFIX VEC_T VEC_FROM_RAW(ITEM_T* source, vec_size_t length) {
   return (VEC_T){
       .data = source,
       .length = length,
@@ -163,15 +204,15 @@ VEC_STATIC_PREFIX VEC_T VEC_FROM_RAW(ITEM_T* source, int length) {
 }
 
 #ifdef DEBUG
-#define CHECK_LEN_ZERO(vec)                                       \
-  if ((vec)->length <= 0)                                         \
-    panic("%s (at %p) is empty, it's length is %d\n", STR(VEC_T), \
-          (void*)(vec), (vec)->length);
-
-#define CHECK_INDEX(vec, index)                                           \
-  if (index >= (vec)->length)                                             \
-    panic("%s (at %p) index is out of bounds. Index = %d, length = %d\n", \
-          STR(VEC_T), (void*)(vec), index, (vec)->length);
+#define CHECK_LEN_ZERO(vec)                                         \
+  if ((vec)->length <= 0)                                           \
+    panic("%s (at %p) is empty, it's length is %lld\n", STR(VEC_T), \
+          (void*)(vec), (long long)(vec)->length);
+
+#define CHECK_INDEX(vec, index)                                               \
+  if (index >= (vec)->length)                                                 \
+    panic("%s (at %p) index is out of bounds. Index = %lld, length = %lld\n", \
+          STR(VEC_T), (void*)(vec), (long long)index, (long long)(vec)->length);
 #else
 #define CHECK_LEN_ZERO(vec) \
   if ((vec)->length <= 0) unreachable();
@@ -180,43 +221,83 @@ VEC_STATIC_PREFIX VEC_T VEC_FROM_RAW(ITEM_T* source, int length) {
   if (index >= (vec)->length) unreachable();
 #endif
 
+// Reallocates to exactly new_cap items
+static void VEC_GROW_TO(VEC_T* vec, vec_size_t new_cap) {
+#ifdef VEC_REALLOC_FN
+  ITEM_T* new_data =
+      (ITEM_T*)VEC_REALLOC_FN(vec->data, sizeof(ITEM_T) * new_cap);
+#else
+  ITEM_T* new_data = (ITEM_T*)VEC_MALLOC_FN(sizeof(ITEM_T) * new_cap);
+  if (vec->length > 0) memcpy(new_data, vec->data, sizeof(ITEM_T) * vec->length);
+  if (vec->data) VEC_FREE_FN(vec->data);
+#endif
+  assert_alloc(new_data);
+
+  vec->data = new_data;
+  vec->capacity = new_cap;
+}
+
 VEC_STATIC_PREFIX void VEC_PUSH(VEC_T* vec, ITEM_T item) {
-  if (vec->length > vec->capacity) {
 #ifdef DEBUG
+  if (vec->length > vec->capacity)
     panic(
-        "Absurd situation: vector length (%d) is bigger than it's capacity "
-        "(%d)\n",
-        vec->length, vec->capacity);
-#else
-    unreachable();
-#endif
-  } else if (vec->length == vec->capacity) {
-    int new_cap = vec->length * 3 / 2 + 4;
-#ifdef VECTOR_REALLOC_FN
-    ITEM_T* new_data =
-        (ITEM_T*)VECTOR_REALLOC_FN(vec->data, sizeof(ITEM_T) * new_cap);
-#else
-    ITEM_T* new_data = (ITEM_T*)VECTOR_MALLOC_FN(sizeof(ITEM_T) * new_cap);
-    memcpy(new_data, vec->data, sizeof(ITEM_T) * vec->length);
-    VECTOR_FREE_FN(vec->data);
+        "Absurd situation: vector length (%lld) is bigger than it's capacity "
+        "(%lld)\n",
+        (long long)vec->length, (long long)vec->capacity);
 #endif
-
-    vec->data = new_data;
-    vec->capacity = new_cap;
-  }
+  if (__builtin_expect(vec->length == vec->capacity, 0))
+    VEC_GROW_TO(vec, vec->length * 3 / 2 + 4);
 
   vec->data[vec->length] = item;
   vec->length++;
 }
 
-VEC_STATIC_PREFIX void VEC_INSERT(VEC_T* vec, ITEM_T item, int index) {
+VEC_STATIC_PREFIX void VEC_RESERVE(VEC_T* vec, vec_size_t cap) {
+  if (cap > vec->capacity) VEC_GROW_TO(vec, cap);
+}
+
+VEC_STATIC_PREFIX void VEC_PUSH_N(VEC_T* vec, const ITEM_T* items, vec_size_t count) {
+  if (count is 0) return;
+
+  vec_size_t needed = vec->length + count;
+  if (needed > vec->capacity) {
+    vec_size_t grown = vec->capacity * 3 / 2 + 4;
+    VEC_GROW_TO(vec, grown > needed ? grown : needed);
+  }
+
+  memcpy(vec->data + vec->length, items, sizeof(ITEM_T) * count);
+  vec->length = needed;
+}
+
+VEC_STATIC_PREFIX void VEC_RESIZE_UNINIT(VEC_T* vec, vec_size_t length) {
+#ifdef VECTOR_ITEM_DESTRUCTOR
+  for (vec_size_t i = length; i < vec->length; i++)
+    VECTOR_ITEM_DESTRUCTOR(vec->data[i]);
+#endif
+  VEC_RESERVE(vec, length);
+  vec->length = length;
+}
+
+VEC_STATIC_PREFIX void VEC_SHRINK_TO_FIT(VEC_T* vec) {
+  if (vec->capacity is vec->length) return;
+
+  if (vec->length is 0) {
+    VEC_FREE_FN(vec->data);
+    vec->data = NULL;
+    vec->capacity = 0;
+  } else {
+    VEC_GROW_TO(vec, vec->length);
+  }
+}
+
+VEC_STATIC_PREFIX void VEC_INSERT(VEC_T* vec, ITEM_T item, vec_size_t index) {
   if (index == vec->length) {
     VEC_PUSH(vec, item);
   } else {
     CHECK_INDEX(vec, index);
     ITEM_T tmp = vec->data[index];
     vec->data[index] = item;
-    for (int i = index + 1; i < vec->length; i++) {
+    for (vec_size_t i = index + 1; i < vec->length; i++) {
       ITEM_T tmp2 = vec->data[i];
       vec->data[i] = tmp;
       tmp = tmp2;
@@ -240,16 +321,16 @@ VEC_STATIC_PREFIX void VEC_POPFREE(VEC_T* vec) {
 #endif
 }
 
-VEC_STATIC_PREFIX ITEM_T VEC_AT(VEC_T* vec, int i) {
+VEC_STATIC_PREFIX ITEM_T VEC_AT(VEC_T* vec, vec_size_t i) {
   CHECK_INDEX(vec, i);
   return vec->data[i];
 }
-VEC_STATIC_PREFIX ITEM_T* VEC_ATREF(VEC_T* vec, int i) {
+VEC_STATIC_PREFIX ITEM_T* VEC_ATREF(VEC_T* vec, vec_size_t i) {
   CHECK_INDEX(vec, i);
   return &vec->data[i];
 }
 
-VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_FAST(VEC_T* vec, int i) {
+VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_FAST(VEC_T* vec, vec_size_t i) {
   CHECK_LEN_ZERO(vec);
   CHECK_INDEX(vec, i);
 
@@ -259,18 +340,18 @@ VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_FAST(VEC_T* vec, int i) {
   return item;
 }
 
-VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_ORDER(VEC_T* vec, int i) {
+VEC_STATIC_PREFIX ITEM_T VEC_EXTRACT_ORDER(VEC_T* vec, vec_size_t i) {
   CHECK_LEN_ZERO(vec);
   CHECK_INDEX(vec, i);
 
   ITEM_T item = vec->data[i];
-  for (int index = i; index < vec->length - 1; index++)
+  for (vec_size_t index = i; index + 1 < vec->length; index++)
     vec->data[index] = vec->data[index + 1];
   vec->length--;
   return item;
 }
 
-VEC_STATIC_PREFIX void VEC_DELETE_FAST(VEC_T* vec, int i) {
+VEC_STATIC_PREFIX void VEC_DELETE_FAST(VEC_T* vec, vec_size_t i) {
   CHECK_LEN_ZERO(vec);
   CHECK_INDEX(vec, i);
 
@@ -280,7 +361,7 @@ VEC_STATIC_PREFIX void VEC_DELETE_FAST(VEC_T* vec, int i) {
   vec->data[i] = vec->data[vec->length - 1];
   vec->length--;
 }
-VEC_STATIC_PREFIX void VEC_DELETE_ORDER(VEC_T* vec, int i) {
+VEC_STATIC_PREFIX void VEC_DELETE_ORDER(VEC_T* vec, vec_size_t i) {
   CHECK_LEN_ZERO(vec);
   CHECK_INDEX(vec, i);
 
@@ -289,20 +370,21 @@ VEC_STATIC_PREFIX void VEC_DELETE_ORDER(VEC_T* vec, int i) {
 #endif
 
   vec->length--;
-  for (int index = i; index < vec->length; index++) {
+  for (vec_size_t index = i; index < vec->length; index++) {
     vec->data[index] = vec->data[index + 1];
   }
 }
 
 VEC_STATIC_PREFIX void VEC_FREE(VEC_T v) {
 #ifdef VECTOR_ITEM_DESTRUCTOR
-  for (int i = 0; i < v.length; i++) VECTOR_ITEM_DESTRUCTOR(v.data[i]);
+  for (vec_size_t i = 0; i < v.length; i++) VECTOR_ITEM_DESTRUCTOR(v.data[i]);
 #endif
 
-  if (v.data) VECTOR_FREE_FN(v.data);
+  if (v.data) VEC_FREE_FN(v.data);
 
 #ifdef DEBUG
-  printf("Deleted " STR(VEC_T) " at %p (length %d)\n", (void*)v, v->length);
+  printf("Deleted " STR(VEC_T) " at %p (length %lld)\n", (void*)v.data,
+         (long long)v.length);
 #endif
 }
 
@@ -313,6 +395,10 @@ VEC_STATIC_PREFIX void VEC_FREE(VEC_T v) {
 #undef VECTOR_ITEM_TYPE
 #undef VECTOR_ITEM_DESTRUCTOR
 #undef VECTOR_ITEM_CLONE
+#undef VECTOR_HUGE_ALLOC
+#undef VEC_MALLOC_FN
+#undef VEC_REALLOC_FN
+#undef VEC_FREE_FN
 #undef VECTOR_H
 #undef VECTOR_C
 #undef VEC_T